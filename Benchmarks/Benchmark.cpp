@@ -0,0 +1,204 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the benchmark runner: option parsing, the timing loop, thread scaling and
+ * the text and JSON reports. The JSON layout follows Google Benchmark ("context" plus a
+ * "benchmarks" array) so results from two builds can be diffed or fed to its compare tools.
+ */
+#include "Benchmark.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+
+namespace {
+
+    // Swallows everything written to it; used to silence kernels while they are timed.
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    void printUsage(const char* prog) {
+        std::cerr << "Usage: " << prog << " [options]\n"
+                  << "  --size <set>        smoke (64^2, 16^3), default (512^2, 256^3) or full (adds 4K, 512^3)\n"
+                  << "  --filter <text>     only run benchmarks whose name contains <text>\n"
+                  << "  --threads <list>    comma-separated thread counts, e.g. 1,2,4 (default: 1 and all)\n"
+                  << "  --min-time <sec>    minimum timed seconds per benchmark (default 0.5)\n"
+                  << "  --json <file>       also write the results as JSON\n";
+    }
+
+    std::string jsonEscape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    bool writeJson(const std::string& file, const std::vector<BenchmarkResult>& results) {
+        std::ofstream out(file);
+        if (!out) {
+            std::cerr << "[Benchmark] Cannot write " << file << "\n";
+            return false;
+        }
+        std::time_t now = std::time(nullptr);
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+#ifdef NDEBUG
+        const char* buildType = "release";
+#else
+        const char* buildType = "debug";
+#endif
+        out << std::setprecision(6);
+        out << "{\n"
+            << "  \"context\": {\n"
+            << "    \"date\": \"" << date << "\",\n"
+            << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+            << "    \"library_build_type\": \"" << buildType << "\"\n"
+            << "  },\n"
+            << "  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& r = results[i];
+            out << (i ? "," : "") << "\n    {\n"
+                << "      \"name\": \"" << jsonEscape(r.name + "/" + r.size + "/threads:" + std::to_string(r.threads)) << "\",\n"
+                << "      \"benchmark\": \"" << jsonEscape(r.name) << "\",\n"
+                << "      \"size\": \"" << r.size << "\",\n"
+                << "      \"threads\": " << r.threads << ",\n"
+                << "      \"iterations\": " << r.iterations << ",\n"
+                << "      \"real_time\": " << r.seconds * 1e9 << ",\n"
+                << "      \"time_unit\": \"ns\",\n"
+                << "      \"items_per_iteration\": " << r.pixels << ",\n"
+                << "      \"ns_per_pixel\": " << r.nsPerPixel << ",\n"
+                << "      \"bytes_per_second\": " << r.gbPerSecond * 1e9 << ",\n"
+                << "      \"speedup\": " << r.speedup << "\n"
+                << "    }";
+        }
+        out << "\n  ]\n}\n";
+        std::cout << "Wrote " << results.size() << " results to " << file << "\n";
+        return true;
+    }
+
+} // end anonymous namespace
+
+void BenchmarkSuite::add(const std::string& name, const std::string& size, long long pixels, double bytes, Body body) {
+    entries_.push_back({ name, size, pixels, bytes, std::move(body) });
+}
+
+int BenchmarkSuite::run(const BenchmarkOptions& options) {
+    std::vector<int> threadCounts = options.threads;
+    if (threadCounts.empty()) {
+        threadCounts = { 1, std::max(1, static_cast<int>(std::thread::hardware_concurrency())) };
+    }
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+
+    std::cout << std::left << std::setw(28) << "Benchmark" << std::setw(14) << "Size"
+              << std::right << std::setw(8) << "Threads" << std::setw(8) << "Iters"
+              << std::setw(14) << "ms/iter" << std::setw(12) << "ns/pixel"
+              << std::setw(10) << "GB/s" << std::setw(10) << "Speedup" << "\n";
+
+    NullBuffer nullBuffer;
+    std::vector<BenchmarkResult> results;
+    for (const Entry& entry : entries_) {
+        if (!options.filter.empty() && entry.name.find(options.filter) == std::string::npos) continue;
+
+        double oneThreadSeconds = 0.0;
+        for (int threads : threadCounts) {
+            parallelThreadLimit() = threads;
+            std::streambuf* saved = std::cout.rdbuf(&nullBuffer);
+            double total = 0.0;
+            int iterations = 0;
+            while (total < options.minTime || iterations == 0) {
+                total += entry.body();
+                ++iterations;
+            }
+            std::cout.rdbuf(saved);
+
+            BenchmarkResult r;
+            r.name = entry.name;
+            r.size = entry.size;
+            r.pixels = entry.pixels;
+            r.bytes = entry.bytes;
+            r.threads = threads;
+            r.iterations = iterations;
+            r.seconds = total / iterations;
+            r.nsPerPixel = r.seconds * 1e9 / static_cast<double>(entry.pixels);
+            r.gbPerSecond = entry.bytes / r.seconds / 1e9;
+            if (threads == threadCounts.front()) oneThreadSeconds = r.seconds;
+            r.speedup = oneThreadSeconds / r.seconds;
+            results.push_back(r);
+
+            std::cout << std::left << std::setw(28) << r.name << std::setw(14) << r.size
+                      << std::right << std::setw(8) << r.threads << std::setw(8) << r.iterations
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(14) << r.seconds * 1e3 << std::setw(12) << r.nsPerPixel
+                      << std::setw(10) << r.gbPerSecond << std::setw(10) << std::setprecision(2) << r.speedup
+                      << std::defaultfloat << "\n";
+        }
+    }
+    parallelThreadLimit() = 0;
+
+    if (!options.jsonFile.empty() && !writeJson(options.jsonFile, results)) {
+        return 1;
+    }
+    return 0;
+}
+
+bool parseBenchmarkOptions(int argc, char* argv[], BenchmarkOptions& options) {
+    for (int idx = 1; idx < argc; ++idx) {
+        std::string opt = argv[idx];
+        bool hasValue = idx + 1 < argc;
+        if (opt == "--size" && hasValue) {
+            options.sizeSet = argv[++idx];
+            if (options.sizeSet != "smoke" && options.sizeSet != "default" && options.sizeSet != "full") {
+                std::cerr << "[Error] Unknown size set: " << options.sizeSet << "\n";
+                printUsage(argv[0]);
+                return false;
+            }
+        }
+        else if (opt == "--filter" && hasValue) {
+            options.filter = argv[++idx];
+        }
+        else if (opt == "--json" && hasValue) {
+            options.jsonFile = argv[++idx];
+        }
+        else if (opt == "--min-time" && hasValue) {
+            options.minTime = std::stod(argv[++idx]);
+        }
+        else if (opt == "--threads" && hasValue) {
+            std::stringstream list(argv[++idx]);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                int count = std::stoi(item);
+                if (count < 1) {
+                    std::cerr << "[Error] Thread counts must be positive\n";
+                    return false;
+                }
+                options.threads.push_back(count);
+            }
+        }
+        else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
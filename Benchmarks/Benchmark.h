@@ -0,0 +1,109 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Measures one timed region inside a benchmark body.
+ *
+ * Bodies usually copy their input first (filters work in place) and only time the kernel:
+ * @code
+ *   Image img = copyOf(input);
+ *   BenchmarkTimer timer;
+ *   filter->apply(img);
+ *   return timer.seconds();
+ * @endcode
+ */
+class BenchmarkTimer {
+public:
+    BenchmarkTimer() : start_(std::chrono::steady_clock::now()) {}
+
+    /**
+     * @brief Seconds elapsed since construction.
+     */
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Command line settings of the benchmark executable.
+ */
+struct BenchmarkOptions {
+    std::string sizeSet = "default";  ///< smoke, default or full.
+    std::string filter;               ///< Only run benchmarks whose name contains this.
+    std::string jsonFile;             ///< Write results here as JSON (empty = no file).
+    double minTime = 0.5;             ///< Minimum timed seconds per benchmark and thread count.
+    std::vector<int> threads;         ///< Thread counts to run (empty = 1 and all hardware threads).
+};
+
+/**
+ * @brief Result of one benchmark at one thread count.
+ */
+struct BenchmarkResult {
+    std::string name;      ///< Benchmark name, e.g. "BoxBlur5".
+    std::string size;      ///< Input size label, e.g. "512x512".
+    long long pixels;      ///< Pixels or voxels processed per iteration.
+    double bytes;          ///< Bytes read and written per iteration.
+    int threads;           ///< Worker threads allowed.
+    int iterations;        ///< Number of timed iterations.
+    double seconds;        ///< Mean time of one iteration.
+    double nsPerPixel;     ///< Mean nanoseconds per pixel or voxel.
+    double gbPerSecond;    ///< Throughput in GB/s (bytes / seconds).
+    double speedup;        ///< Time at one thread divided by time at this thread count.
+};
+
+/**
+ * @class BenchmarkSuite
+ * @brief Registers benchmark bodies, times them at several thread counts and reports results.
+ *
+ * Each body runs one iteration and returns the seconds spent in its timed region. Bodies are
+ * repeated until they have accumulated at least BenchmarkOptions::minTime seconds. Output
+ * printed by the kernels themselves is suppressed while they run.
+ */
+class BenchmarkSuite {
+public:
+    using Body = std::function<double()>;
+
+    /**
+     * @brief Adds a benchmark.
+     * @param name Benchmark name.
+     * @param size Input size label.
+     * @param pixels Pixels or voxels processed per iteration (for ns/pixel).
+     * @param bytes Bytes read and written per iteration (for GB/s).
+     * @param body Runs one iteration and returns its timed seconds.
+     */
+    void add(const std::string& name, const std::string& size, long long pixels, double bytes, Body body);
+
+    /**
+     * @brief Runs every registered benchmark that matches the options.
+     * @param options Filter, thread counts, minimum time and JSON output file.
+     * @return 0 on success, 1 if the JSON file could not be written.
+     */
+    int run(const BenchmarkOptions& options);
+
+private:
+    struct Entry {
+        std::string name;
+        std::string size;
+        long long pixels;
+        double bytes;
+        Body body;
+    };
+
+    std::vector<Entry> entries_;
+};
+
+/**
+ * @brief Parses the benchmark command line.
+ * @return False if the arguments are invalid (usage has been printed).
+ */
+bool parseBenchmarkOptions(int argc, char* argv[], BenchmarkOptions& options);
+
+#endif // BENCHMARK_H
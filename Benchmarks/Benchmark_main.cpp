@@ -0,0 +1,453 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * Benchmarks for every 2D filter factory, both 3D filters, the four projections, volume
+ * slicing, bit-packed masks, compressed-volume decoding, the channel reduction used by normalisation, the output mapping, and PNG encoding. Inputs are synthetic (smooth gradients plus deterministic noise), so runs are
+ * repeatable without any data files. Each benchmark copies its input outside the timed region,
+ * because the filters work in place. PNG decoding is timed on the project's own Images/ and
+ * Scans/TestVolume files, with both decoder backends, when they can be found.
+ */
+#include "Benchmark.h"
+#include "BitMask.h"
+#include "CompressedVolume.h"
+#include "Convolution.h"
+#include "Filter.h"
+#include "Image.h"
+#include "OutputMapping.h"
+#include "PngDecoder.h"
+#include "PngEncoder.h"
+#include "Projection.h"
+#include "Reduction.h"
+#include "Segmentation.h"
+#include "Slice.h"
+#include "Volume.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct ImageSize {
+        int width, height;
+        std::string label;
+    };
+
+    // Deterministic noise so every run (and every build) sees the same data.
+    inline unsigned char noise(uint32_t& state) {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<unsigned char>(state >> 24);
+    }
+
+    std::shared_ptr<Image> makeImage(int w, int h, int ch) {
+        auto* data = static_cast<unsigned char*>(std::malloc(static_cast<size_t>(w) * h * ch));
+        uint32_t state = 12345;
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                for (int c = 0; c < ch; ++c) {
+                    int value = (x * 255 / w + y * 255 / h) / 2 + c * 40 + (noise(state) >> 3);
+                    data[(static_cast<size_t>(y) * w + x) * ch + c] = static_cast<unsigned char>(value & 255);
+                }
+            }
+        }
+        auto img = std::make_shared<Image>(w, h, ch, data);
+        img->setVerbose(false);
+        return img;
+    }
+
+    // With `air`, the background outside the ball is a constant, as in a CT scan.
+    std::shared_ptr<Volume> makeVolume(int n, bool air = false) {
+        auto vol = std::make_shared<Volume>(n, n, n, 1);
+        uint32_t state = 6789;
+        const float c = (n - 1) * 0.5f;
+        for (int z = 0; z < n; ++z) {
+            unsigned char* slice = vol->getSlices()[z].getData();
+            for (int y = 0; y < n; ++y) {
+                for (int x = 0; x < n; ++x) {
+                    // A bright ball in a darker, noisy background.
+                    float r2 = (x - c) * (x - c) + (y - c) * (y - c) + (z - c) * (z - c);
+                    const bool inside = r2 < c * c * 0.5f;
+                    int value = inside ? 180 + (noise(state) >> 2) : air ? 0 : 40 + (noise(state) >> 2);
+                    slice[static_cast<size_t>(y) * n + x] = static_cast<unsigned char>(std::min(value, 255));
+                }
+            }
+        }
+        return vol;
+    }
+
+    Image copyImage(const Image& img) {
+        const size_t size = static_cast<size_t>(img.getWidth()) * img.getHeight() * img.getChannels();
+        auto* data = static_cast<unsigned char*>(std::malloc(size));
+        std::memcpy(data, img.getData(), size);
+        Image copy(img.getWidth(), img.getHeight(), img.getChannels(), data);
+        copy.setVerbose(false);
+        return copy;
+    }
+
+    Volume copyVolume(const Volume& vol) {
+        Volume copy(vol.getWidth(), vol.getHeight(), vol.getDepth(), vol.getChannels());
+        const size_t sliceSize = static_cast<size_t>(vol.getWidth()) * vol.getHeight() * vol.getChannels();
+        for (int z = 0; z < vol.getDepth(); ++z) {
+            std::memcpy(copy.getSlices()[z].getData(), vol.getSlices()[z].getData(), sliceSize);
+        }
+        return copy;
+    }
+
+    // A 2D filter benchmark: the factory is called once per iteration, outside the timer.
+    template <typename Factory>
+    void addFilter2D(BenchmarkSuite& suite, const std::string& name, const std::shared_ptr<Image>& input,
+                     const std::string& label, Factory factory) {
+        const long long pixels = static_cast<long long>(input->getWidth()) * input->getHeight();
+        const double bytes = 2.0 * pixels * input->getChannels();
+        suite.add(name, label, pixels, bytes, [input, factory]() {
+            Image img = copyImage(*input);
+            Filter2D* filter = factory();
+            BenchmarkTimer timer;
+            filter->apply(img);
+            double seconds = timer.seconds();
+            delete filter;
+            return seconds;
+        });
+    }
+
+    template <typename Factory>
+    void addFilter3D(BenchmarkSuite& suite, const std::string& name, const std::shared_ptr<Volume>& input,
+                     const std::string& label, Factory factory) {
+        const long long voxels = static_cast<long long>(input->getWidth()) * input->getHeight() * input->getDepth();
+        const double bytes = 2.0 * voxels * input->getChannels();
+        suite.add(name, label, voxels, bytes, [input, factory]() {
+            Volume vol = copyVolume(*input);
+            Filter3D* filter = factory();
+            BenchmarkTimer timer;
+            filter->apply(vol);
+            double seconds = timer.seconds();
+            delete filter;
+            return seconds;
+        });
+    }
+
+    // A ball of radius r (a disc when depth is 1): dense and not an outer product.
+    ConvolutionKernel ballKernel(int r, bool flat) {
+        ConvolutionKernel kernel;
+        kernel.width = kernel.height = 2 * r + 1;
+        kernel.depth = flat ? 1 : 2 * r + 1;
+        const int rz = flat ? 0 : r;
+        for (int z = -rz; z <= rz; ++z) {
+            for (int y = -r; y <= r; ++y) {
+                for (int x = -r; x <= r; ++x) kernel.weights.push_back(x * x + y * y + z * z <= r * r ? 1.0 : 0.0);
+            }
+        }
+        double sum = 0.0;
+        for (double w : kernel.weights) sum += w;
+        for (double& w : kernel.weights) w /= sum;
+        return kernel;
+    }
+
+    // A Gaussian of the given size along each axis: an outer product.
+    ConvolutionKernel gaussianKernel(int size, bool flat) {
+        std::vector<double> g(size);
+        for (int i = 0; i < size; ++i) g[i] = std::exp(-0.5 * (i - size / 2) * (i - size / 2) / (size * size / 16.0));
+        ConvolutionKernel kernel;
+        kernel.width = kernel.height = size;
+        kernel.depth = flat ? 1 : size;
+        for (int z = 0; z < kernel.depth; ++z) {
+            for (int y = 0; y < size; ++y) {
+                for (int x = 0; x < size; ++x) kernel.weights.push_back(g[x] * g[y] * (flat ? 1.0 : g[z]));
+            }
+        }
+        double sum = 0.0;
+        for (double w : kernel.weights) sum += w;
+        for (double& w : kernel.weights) w /= sum;
+        return kernel;
+    }
+
+    // One kernel applied to an image with a fixed method, to compare the methods' costs.
+    void addConvolution2D(BenchmarkSuite& suite, const std::string& name, const std::shared_ptr<Image>& input,
+                          const std::string& label, const ConvolutionKernel& kernel, ConvolutionMethod method) {
+        const long long pixels = static_cast<long long>(input->getWidth()) * input->getHeight();
+        const double bytes = 2.0 * pixels * input->getChannels();
+        suite.add(name, label, pixels, bytes, [input, kernel, method]() {
+            Image img = copyImage(*input);
+            BenchmarkTimer timer;
+            Convolution::apply(img.getData(), img.getWidth(), img.getHeight(), 1, img.getChannels(), kernel,
+                               EdgeMode::Extend, method);
+            return timer.seconds();
+        });
+    }
+
+    void addImageBenchmarks(BenchmarkSuite& suite, const ImageSize& size) {
+        auto rgb = makeImage(size.width, size.height, 3);
+        auto grey = makeImage(size.width, size.height, 1);
+        const std::string& l = size.label;
+
+        addFilter2D(suite, "Greyscale", rgb, l, [] { return createGreyscaleFilter(); });
+        addFilter2D(suite, "Brightness", rgb, l, [] { return createBrightnessFilter(40); });
+        addFilter2D(suite, "BrightnessAuto", rgb, l, [] { return createBrightnessFilter(); });
+        addFilter2D(suite, "HistogramHSV", rgb, l, [] { return createHistogramEqualisationFilter("HSV"); });
+        addFilter2D(suite, "HistogramHSL", rgb, l, [] { return createHistogramEqualisationFilter("HSL"); });
+        addFilter2D(suite, "ThresholdGrey", grey, l, [] { return createThresholdFilter(128, "Grayscale"); });
+        addFilter2D(suite, "ThresholdHSV", rgb, l, [] { return createThresholdFilter(128, "HSV"); });
+        addFilter2D(suite, "SaltPepper", rgb, l, [] { return createSaltPepperFilter(10.0f); });
+        addFilter2D(suite, "BoxBlur5", rgb, l, [] { return createBoxBlurFilter(5); });
+        addFilter2D(suite, "GaussianBlur5", rgb, l, [] { return createGaussianBlurFilter(5, 2.0); });
+        addFilter2D(suite, "MedianBlur5", rgb, l, [] { return createMedianBlurFilter(5); });
+        addFilter2D(suite, "Sharpen", rgb, l, [] { return createSharpenFilter(); });
+        addFilter2D(suite, "EdgeSobel", rgb, l, [] { return createEdgeDetectionFilter("Sobel"); });
+        addFilter2D(suite, "EdgePrewitt", rgb, l, [] { return createEdgeDetectionFilter("Prewitt"); });
+        addFilter2D(suite, "EdgeScharr", rgb, l, [] { return createEdgeDetectionFilter("Scharr"); });
+        addFilter2D(suite, "EdgeRobertsCross", rgb, l, [] { return createEdgeDetectionFilter("RobertsCross"); });
+        addFilter2D(suite, "DistanceTransform", grey, l, [] { return createDistanceTransformFilter(); });
+        addFilter2D(suite, "Erode3", grey, l, [] { return createMorphologyFilter("Erode", 3, 3); });
+        addFilter2D(suite, "Erode31", grey, l, [] { return createMorphologyFilter("Erode", 31, 31); });
+
+        // Convolution: the method Auto picks for each kernel against the alternatives.
+        addConvolution2D(suite, "Convolve3Direct", grey, l, ballKernel(1, true), ConvolutionMethod::Direct);
+        addConvolution2D(suite, "Convolve3FFT", grey, l, ballKernel(1, true), ConvolutionMethod::FFT);
+        addConvolution2D(suite, "Convolve15Separable", grey, l, gaussianKernel(15, true), ConvolutionMethod::Separable);
+        addConvolution2D(suite, "Convolve15Direct", grey, l, gaussianKernel(15, true), ConvolutionMethod::Direct);
+        addConvolution2D(suite, "Convolve15FFT", grey, l, gaussianKernel(15, true), ConvolutionMethod::FFT);
+        addConvolution2D(suite, "Convolve7Direct", grey, l, ballKernel(3, true), ConvolutionMethod::Direct);
+        addConvolution2D(suite, "Convolve7FFT", grey, l, ballKernel(3, true), ConvolutionMethod::FFT);
+        addConvolution2D(suite, "Convolve31Direct", grey, l, ballKernel(15, true), ConvolutionMethod::Direct);
+        addConvolution2D(suite, "Convolve31FFT", grey, l, ballKernel(15, true), ConvolutionMethod::FFT);
+
+        // The min/max/sum pass behind auto brightness and output normalisation (read-only).
+        const long long pixels = static_cast<long long>(size.width) * size.height;
+        suite.add("ReduceChannels", l, pixels, 3.0 * pixels, [rgb]() {
+            BenchmarkTimer timer;
+            reduceChannels(rgb->getData(), static_cast<size_t>(rgb->getWidth()) * rgb->getHeight(), rgb->getChannels());
+            return timer.seconds();
+        });
+
+        // Encoding reads the pixels once and writes the (smaller) file.
+        for (int level : { 0, 1, 6 }) {
+            suite.add("EncodePng" + std::to_string(level), l, pixels, 3.0 * pixels, [rgb, level]() {
+                std::vector<unsigned char> png;
+                BenchmarkTimer timer;
+                encodePng(rgb->getData(), rgb->getWidth(), rgb->getHeight(), rgb->getChannels(), PngOptions{ level, 0 }, png);
+                return timer.seconds();
+            });
+        }
+    }
+
+    void addVolumeBenchmarks(BenchmarkSuite& suite, int n) {
+        auto vol = makeVolume(n);
+        const std::string label = std::to_string(n) + "^3";
+        const long long voxels = static_cast<long long>(n) * n * n;
+
+        addFilter3D(suite, "GaussianBlur3D", vol, label, [] { return createGaussianBlur3DFilter(3, 1.0); });
+        addFilter3D(suite, "MedianBlur3D", vol, label, [] { return createMedianBlur3DFilter(3); });
+        addFilter3D(suite, "Dilate3D3", vol, label, [] { return createMorphology3DFilter("Dilate", 3, 3, 3); });
+        addFilter3D(suite, "Dilate3D15", vol, label, [] { return createMorphology3DFilter("Dilate", 15, 15, 15); });
+        addFilter3D(suite, "DistanceTransform3D", vol, label, [] { return createDistanceTransform3DFilter(); });
+
+        // Convolution of the volume with a fixed method (see Convolution::chooseMethod).
+        const auto addConvolution3D = [&](const std::string& name, const ConvolutionKernel& kernel,
+                                          ConvolutionMethod method) {
+            suite.add(name, label, voxels, 2.0 * voxels, [vol, kernel, method]() {
+                Volume copy = copyVolume(*vol);
+                BenchmarkTimer timer;
+                Convolution::apply(copy.getVoxelData(), copy.getWidth(), copy.getHeight(), copy.getDepth(),
+                                   copy.getChannels(), kernel, EdgeMode::Extend, method);
+                return timer.seconds();
+            });
+        };
+        addConvolution3D("Convolve3D3Direct", ballKernel(1, false), ConvolutionMethod::Direct);
+        addConvolution3D("Convolve3D3FFT", ballKernel(1, false), ConvolutionMethod::FFT);
+        addConvolution3D("Convolve3D7Separable", gaussianKernel(7, false), ConvolutionMethod::Separable);
+        addConvolution3D("Convolve3D9Direct", ballKernel(4, false), ConvolutionMethod::Direct);
+        addConvolution3D("Convolve3D9FFT", ballKernel(4, false), ConvolutionMethod::FFT);
+
+        // Projections read every voxel and write one slice.
+        const double projBytes = static_cast<double>(voxels) + static_cast<double>(n) * n;
+        auto addProjection = [&](const std::string& name, Image (*project)(const Volume&)) {
+            suite.add(name, label, voxels, projBytes, [vol, project]() {
+                BenchmarkTimer timer;
+                Image result = project(*vol);
+                return timer.seconds();
+            });
+        };
+        addProjection("ProjectionMIP", &Projection::maximumIntensityProjection<unsigned char>);
+        addProjection("ProjectionMinIP", &Projection::minimumIntensityProjection<unsigned char>);
+        addProjection("ProjectionMean", &Projection::meanIntensityProjection<unsigned char>);
+        addProjection("ProjectionMedian", &Projection::medianIntensityProjection<unsigned char>);
+
+        // Segmentation of the ball plus the brightest background noise, which adds many small components.
+        for (int connectivity : { 6, 26 }) {
+            suite.add("Components" + std::to_string(connectivity), label, voxels, voxels * 5.0, [vol, connectivity]() {
+                BenchmarkTimer timer;
+                ComponentLabels result = Segmentation::labelComponents(*vol, 100, connectivity);
+                return timer.seconds();
+            });
+        }
+
+        // Bit-packed masks: packing a threshold, then word-parallel kernels on 1/8 byte per voxel.
+        suite.add("MaskFromVolume", label, voxels, voxels * 1.125, [vol]() {
+            BenchmarkTimer timer;
+            BitMask result = BitMask::fromVolume(*vol, 100);
+            return timer.seconds();
+        });
+        auto mask = std::make_shared<BitMask>(BitMask::fromVolume(*vol, 100));
+        const double maskBytes = static_cast<double>(mask->memoryBytes());
+        suite.add("MaskAnd", label, voxels, 3.0 * maskBytes, [mask]() {
+            BitMask result = *mask;
+            BenchmarkTimer timer;
+            result &= *mask;
+            return timer.seconds();
+        });
+        suite.add("MaskCount", label, voxels, maskBytes, [mask]() {
+            BenchmarkTimer timer;
+            std::size_t count = mask->count();
+            (void)count;
+            return timer.seconds();
+        });
+        for (int radius : { 1, 7 }) {
+            suite.add("MaskDilate" + std::to_string(radius), label, voxels, 6.0 * maskBytes, [mask, radius]() {
+                BitMask result = *mask;
+                BenchmarkTimer timer;
+                result.dilate(radius, radius, radius);
+                return timer.seconds();
+            });
+        }
+
+        // The CLI path: a raw projection and the fused output mapping instead of normalisation.
+        suite.add("ProjectionMIPMapped", label, voxels, projBytes, [vol, n]() {
+            BenchmarkTimer timer;
+            Image result = mapToImage(Projection::rawProjection(*vol, ProjectionMode::MIP, 1, n), OutputMapping());
+            return timer.seconds();
+        });
+
+        // A slice reads and writes one plane.
+        const double sliceBytes = 2.0 * n * n;
+        for (const std::string plane : { "XY", "XZ", "YZ" }) {
+            suite.add("Slice" + plane, label, static_cast<long long>(n) * n, sliceBytes, [vol, plane, n]() {
+                BenchmarkTimer timer;
+                Image result = Slice::sliceVolume(*vol, plane, n / 2);
+                return timer.seconds();
+            });
+        }
+
+        // Run-length encoded residency: GB/s counts the decoded bytes, so it is the decompression rate.
+        auto scan = std::make_shared<CompressedVolume>(*makeVolume(n, true));
+        suite.add("DecompressVolume", label, voxels, static_cast<double>(voxels), [scan]() {
+            BenchmarkTimer timer;
+            Volume result = scan->decompress();
+            return timer.seconds();
+        });
+        suite.add("ProjectionMIPCompressed", label, voxels, projBytes, [scan, n]() {
+            BenchmarkTimer timer;
+            BasicImage<float> result = Projection::rawProjection(*scan, ProjectionMode::MIP, 1, n);
+            return timer.seconds();
+        });
+
+        // Empty-space skipping: the same mostly-air volume with and without its tile ranges.
+        auto addSparseMIP = [&](const std::string& name, bool bricks) {
+            auto sparse = makeVolume(n, true);
+            if (bricks) sparse->buildBrickMap();
+            suite.add(name, label, voxels, projBytes, [sparse, n]() {
+                BenchmarkTimer timer;
+                BasicImage<float> result = Projection::rawProjection(*sparse, ProjectionMode::MIP, 1, n);
+                return timer.seconds();
+            });
+        };
+        addSparseMIP("ProjectionMIPSparse", false);
+        addSparseMIP("ProjectionMIPBricks", true);
+    }
+
+    /*
+     * Loads the same files with the built-in decoder and with stb_image. Each file in Images/
+     * is one benchmark and the TestVolume slices are loaded together as another; inputs that
+     * are not found (the suite is run from the build directory) are skipped.
+     */
+    void addDecodeBenchmarks(BenchmarkSuite& suite) {
+        namespace fs = std::filesystem;
+        std::vector<std::pair<std::string, std::vector<std::string>>> inputs;
+        std::vector<std::string> slices;
+        std::error_code error;
+        for (const auto& entry : fs::directory_iterator("../Images", error)) {
+            if (entry.path().extension() == ".png") inputs.push_back({ entry.path().filename().string(), { entry.path().string() } });
+        }
+        for (const auto& entry : fs::directory_iterator("../Scans/TestVolume", error)) {
+            if (entry.path().extension() == ".png") slices.push_back(entry.path().string());
+        }
+        std::sort(inputs.begin(), inputs.end());
+        std::sort(slices.begin(), slices.end());
+        if (!slices.empty()) inputs.push_back({ "TestVolume", slices });
+
+        for (const auto& [label, files] : inputs) {
+            long long pixels = 0;
+            double bytes = 0;
+            for (const std::string& file : files) {
+                Image img;
+                img.setVerbose(false);
+                if (!img.load(file)) continue;
+                pixels += static_cast<long long>(img.getWidth()) * img.getHeight();
+                bytes += static_cast<double>(fs::file_size(file, error)) +
+                         static_cast<double>(img.getWidth()) * img.getHeight() * img.getChannels();
+            }
+            if (pixels == 0) continue;
+            for (PngBackend backend : { PngBackend::Fast, PngBackend::Stb }) {
+                const std::string name = backend == PngBackend::Fast ? "DecodePngFast" : "DecodePngStb";
+                suite.add(name, label, pixels, bytes, [files, backend]() {
+                    const PngBackend saved = pngDecodeBackend().exchange(backend);
+                    BenchmarkTimer timer;
+                    for (const std::string& file : files) {
+                        Image img;
+                        img.setVerbose(false);
+                        img.load(file);
+                    }
+                    double seconds = timer.seconds();
+                    pngDecodeBackend() = saved;
+                    return seconds;
+                });
+            }
+        }
+    }
+
+} // end anonymous namespace
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    if (!parseBenchmarkOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<ImageSize> imageSizes;
+    std::vector<int> volumeSizes;
+    if (options.sizeSet == "smoke") {
+        imageSizes = { { 64, 64, "64x64" } };
+        volumeSizes = { 16 };
+    } else {
+        imageSizes = { { 512, 512, "512x512" } };
+        volumeSizes = { 256 };
+        if (options.sizeSet == "full") {
+            imageSizes.push_back({ 3840, 2160, "3840x2160" });
+            volumeSizes.push_back(512);
+        }
+    }
+
+    BenchmarkSuite suite;
+    for (const ImageSize& size : imageSizes) {
+        addImageBenchmarks(suite, size);
+    }
+    for (int n : volumeSizes) {
+        addVolumeBenchmarks(suite, n);
+    }
+    addDecodeBenchmarks(suite);
+    return suite.run(options);
+}
@@ -4,7 +4,12 @@
 #include <cassert>
 #include <iostream>
 #include <string>
+#include <vector>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
 
 // Helper function: get the pixel value from the Image using getPixel() method.
 unsigned char get_pixel(const Image& img, int x, int y, int channel) {
@@ -188,6 +193,82 @@ void testMedianBlur() {
     std::cout << "testMedianBlur passed." << std::endl;
 }
 
+namespace {
+
+    // Where an outside coordinate reads from under each edge mode, or -1 to leave it out.
+    int referenceEdge(EdgeMode mode, int c, int n) {
+        if (c >= 0 && c < n) return c;
+        switch (mode) {
+        case EdgeMode::Extend: return std::clamp(c, 0, n - 1);
+        case EdgeMode::Constant: return -1;
+        case EdgeMode::Wrap: return ((c % n) + n) % n;
+        case EdgeMode::Reflect:
+            while (c < 0 || c >= n) c = c < 0 ? -c - 1 : 2 * n - c - 1;
+            return c;
+        }
+        return -1;
+    }
+
+} // end anonymous namespace
+
+// Test the channel- and edge-mode-specialised blur kernels against a direct box blur and median
+// under every edge mode, including a 2-channel image (runtime channel path) and images smaller
+// than the kernel.
+void testBlurKernelChannels() {
+    std::cout << "Running testBlurKernelChannels..." << std::endl;
+
+    const int sizes[][2] = { { 23, 17 }, { 3, 2 } };
+    const EdgeMode modes[] = { EdgeMode::Extend, EdgeMode::Reflect, EdgeMode::Constant, EdgeMode::Wrap };
+    for (EdgeMode mode : modes) {
+        for (const auto& size : sizes) {
+            for (int ch = 1; ch <= 4; ch++) {
+                int w = size[0];
+                int h = size[1];
+                const size_t total = (size_t)w * h * ch;
+                std::vector<unsigned char> pixels(total);
+                for (size_t i = 0; i < total; i++) pixels[i] = (unsigned char)((i * 37 + (i / 7) * 11) % 256);
+
+                for (int kind = 0; kind < 2; kind++) {
+                    unsigned char* data = (unsigned char*)std::malloc(total);
+                    std::memcpy(data, pixels.data(), total);
+                    Image img(w, h, ch, data);
+                    img.setVerbose(false);
+                    Filter2D* filter = (kind == 0) ? createBoxBlurFilter(5, mode) : createMedianBlurFilter(5, mode);
+                    filter->apply(img);
+                    delete filter;
+
+                    for (int y = 0; y < h; y++) {
+                        for (int x = 0; x < w; x++) {
+                            for (int c = 0; c < ch; c++) {
+                                std::vector<int> window;
+                                for (int dy = -2; dy <= 2; dy++) {
+                                    for (int dx = -2; dx <= 2; dx++) {
+                                        int nx = referenceEdge(mode, x + dx, w);
+                                        int ny = referenceEdge(mode, y + dy, h);
+                                        if (nx < 0 || ny < 0) continue;
+                                        window.push_back(pixels[((size_t)ny * w + nx) * ch + c]);
+                                    }
+                                }
+                                int expected;
+                                if (kind == 0) {
+                                    int sum = 0;
+                                    for (int v : window) sum += v;
+                                    expected = sum / (int)window.size();
+                                } else {
+                                    std::nth_element(window.begin(), window.begin() + window.size() / 2, window.end());
+                                    expected = window[window.size() / 2];
+                                }
+                                assert(get_pixel(img, x, y, c) == expected && "Blur kernel differs from direct reference");
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "testBlurKernelChannels passed." << std::endl;
+}
+
 void testSharpen() {
     std::cout << "Running testSharpen..." << std::endl;
     Image img;
@@ -446,6 +527,1899 @@ void testMedianBlur3D() {
     std::cout << "MedianBlur3D test passed." << std::endl;
 }
 
+//--------------------------------------------------------------------------
+// Pyramid Test: 2x reductions of images and volumes
+//--------------------------------------------------------------------------
+#include "Pyramid.h"
+
+void testPyramid() {
+    std::cout << "Running testPyramid..." << std::endl;
+
+    Image img;
+    bool loaded = img.load("../Images/gracehopper.png");
+    assert(loaded && "Failed to load test image.");
+
+    std::vector<Image> levels = Pyramid::build(img, 3, ReduceMode::Gaussian);
+    assert(levels.size() == 3 && "Pyramid: expected 3 image levels");
+    assert(levels[1].getWidth() == (img.getWidth() + 1) / 2 && "Pyramid: level 1 width incorrect");
+    assert(levels[1].getHeight() == (img.getHeight() + 1) / 2 && "Pyramid: level 1 height incorrect");
+    assert(levels[2].getWidth() == (levels[1].getWidth() + 1) / 2 && "Pyramid: level 2 width incorrect");
+    assert(levels[2].getChannels() == img.getChannels() && "Pyramid: channels changed");
+    checkPixelRange(levels[2]);
+
+    // A constant 2x2 block must reduce to the same constant.
+    unsigned char* flat = (unsigned char*)std::malloc(4);
+    std::memset(flat, 77, 4);
+    Image tiny(2, 2, 1, flat);
+    Image reduced = Pyramid::reduce(tiny, ReduceMode::Box);
+    assert(reduced.getWidth() == 1 && reduced.getHeight() == 1 && "Pyramid: 2x2 should reduce to 1x1");
+    assert(get_pixel(reduced, 0, 0, 0) == 77 && "Pyramid: box reduce of a constant changed the value");
+
+    Volume vol;
+    loaded = vol.load("../Scans/TestVolume/vol");
+    assert(loaded && "Failed to load volume for pyramid test");
+
+    Volume half = Pyramid::atLevel(vol, 1, ReduceMode::Box);
+    assert(half.getWidth() == (vol.getWidth() + 1) / 2 && "Pyramid: volume width incorrect");
+    assert(half.getHeight() == (vol.getHeight() + 1) / 2 && "Pyramid: volume height incorrect");
+    assert(half.getDepth() == (vol.getDepth() + 1) / 2 && "Pyramid: volume depth incorrect");
+
+    // Projections and slices run on a reduced level like on the native volume.
+    Image mip = Projection::maximumIntensityProjection(half);
+    assert(mip.getWidth() == half.getWidth() && mip.getHeight() == half.getHeight() && "Pyramid: MIP size incorrect");
+    Image slice = Slice::sliceVolume(half, "XZ", half.getHeight() / 2);
+    assert(slice.getHeight() == half.getDepth() && "Pyramid: slice height incorrect");
+
+    std::cout << "testPyramid passed." << std::endl;
+}
+
+//--------------------------------------------------------------------------
+// ProjectionAccumulator Test: incremental MIP/MinIP/mean must match a full recompute
+//--------------------------------------------------------------------------
+void testProjectionAccumulator() {
+    std::cout << "Running testProjectionAccumulator..." << std::endl;
+
+    Volume vol;
+    bool loaded = vol.load("../Scans/TestVolume/vol");
+    assert(loaded && "Failed to load volume for accumulator test");
+    int w = vol.getWidth();
+    int h = vol.getHeight();
+    int d = vol.getDepth();
+    int ch = vol.getChannels();
+
+    auto copySlice = [&](int z) {
+        Image slice;
+        slice.setVerbose(false);
+        slice.setData(vol.getSlices()[z].getData(), w, h, ch);
+        return slice;
+    };
+    auto sameImage = [](const Image& a, const Image& b) {
+        if (a.getWidth() != b.getWidth() || a.getHeight() != b.getHeight() ||
+            a.getChannels() != b.getChannels()) return false;
+        size_t total = (size_t)a.getWidth() * a.getHeight() * a.getChannels();
+        return std::memcmp(a.getData(), b.getData(), total) == 0;
+    };
+
+    ProjectionAccumulator mip(ProjectionMode::MIP);
+    ProjectionAccumulator minip(ProjectionMode::MinIP);
+    ProjectionAccumulator mean(ProjectionMode::Mean);
+    for (int z = 0; z < d; z++) {
+        bool accepted = mip.setSlice(z, copySlice(z));
+        accepted = minip.setSlice(z, copySlice(z)) && accepted;
+        accepted = mean.setSlice(z, copySlice(z)) && accepted;
+        assert(accepted && "Accumulator: slice rejected");
+    }
+    assert(mip.getSliceCount() == d && "Accumulator: wrong slice count");
+    assert(sameImage(mip.result(), Projection::maximumIntensityProjection(vol)) && "Accumulator: MIP mismatch");
+    assert(sameImage(minip.result(), Projection::minimumIntensityProjection(vol)) && "Accumulator: MinIP mismatch");
+    assert(sameImage(mean.result(), Projection::meanIntensityProjection(vol)) && "Accumulator: mean mismatch");
+
+    // Replace the brightest and darkest slices with mid-grey and compare against a recompute.
+    std::vector<unsigned char> grey((size_t)w * h * ch, 128);
+    for (int z : {0, d / 2, d - 1}) {
+        Image replacement(w, h, ch, (unsigned char*)std::malloc(grey.size()));
+        std::memcpy(replacement.getData(), grey.data(), grey.size());
+        std::memcpy(vol.getSlices()[z].getData(), grey.data(), grey.size());
+        bool accepted = mip.setSlice(z, std::move(replacement));
+        accepted = minip.setSlice(z, copySlice(z)) && accepted;
+        accepted = mean.setSlice(z, copySlice(z)) && accepted;
+        assert(accepted && "Accumulator: replacement rejected");
+    }
+    assert(mip.getSliceCount() == d && "Accumulator: replacement changed the slice count");
+    assert(sameImage(mip.result(), Projection::maximumIntensityProjection(vol)) && "Accumulator: MIP mismatch after replace");
+    assert(sameImage(minip.result(), Projection::minimumIntensityProjection(vol)) && "Accumulator: MinIP mismatch after replace");
+    assert(sameImage(mean.result(), Projection::meanIntensityProjection(vol)) && "Accumulator: mean mismatch after replace");
+
+    // Syncing from the scan directory picks up every slice once, then nothing.
+    ProjectionAccumulator synced(ProjectionMode::MIP);
+    int firstSync = synced.sync("../Scans/TestVolume/vol");
+    int secondSync = synced.sync("../Scans/TestVolume/vol");
+    assert(firstSync == d && "Accumulator: sync did not load all slices");
+    assert(secondSync == 0 && "Accumulator: unchanged slices were reloaded");
+
+    std::cout << "testProjectionAccumulator passed." << std::endl;
+}
+
+//--------------------------------------------------------------------------
+// Slab Stack Test: sliding MIP/MinIP/mean against a brute-force recompute
+//--------------------------------------------------------------------------
+void testSlabStack() {
+    std::cout << "Running testSlabStack..." << std::endl;
+
+    Volume vol;
+    bool loaded = vol.load("../Scans/TestVolume/vol");
+    assert(loaded && "Failed to load volume for slab test");
+    int w = vol.getWidth();
+    int h = vol.getHeight();
+    int d = vol.getDepth();
+    int ch = vol.getChannels();
+    size_t sliceSize = (size_t)w * h * ch;
+    const int t = 5;
+
+    ProjectionMode modes[] = { ProjectionMode::MIP, ProjectionMode::MinIP, ProjectionMode::Mean };
+    for (ProjectionMode mode : modes) {
+        Volume stack = Projection::slabStack(vol, mode, t);
+        assert(stack.getDepth() == d - t + 1 && "Slab: wrong number of frames");
+        assert(stack.getWidth() == w && stack.getHeight() == h && "Slab: frame size incorrect");
+
+        // Brute-force raw slabs, then the shared min/max normalisation.
+        std::vector<int> raw(sliceSize * stack.getDepth());
+        for (int k = 0; k < stack.getDepth(); k++) {
+            for (size_t i = 0; i < sliceSize; i++) {
+                int best = vol.getSlices()[k].getData()[i];
+                int sum = 0;
+                for (int z = k; z < k + t; z++) {
+                    int v = vol.getSlices()[z].getData()[i];
+                    sum += v;
+                    if (mode == ProjectionMode::MIP) best = std::max(best, v);
+                    if (mode == ProjectionMode::MinIP) best = std::min(best, v);
+                }
+                if (mode == ProjectionMode::Mean) {
+                    float mean = (float)sum / t;
+                    best = (int)(mean + 0.5f);
+                }
+                raw[k * sliceSize + i] = best;
+            }
+        }
+        int minVal = *std::min_element(raw.begin(), raw.end());
+        int maxVal = *std::max_element(raw.begin(), raw.end());
+        for (int k = 0; k < stack.getDepth(); k++) {
+            for (size_t i = 0; i < sliceSize; i++) {
+                int expected = raw[k * sliceSize + i];
+                if (maxVal > minVal) {
+                    expected = (int)((expected - minVal) * (255.0f / (maxVal - minVal)) + 0.5f);
+                }
+                assert(stack.getSlices()[k].getData()[i] == expected && "Slab: value mismatch");
+            }
+        }
+    }
+    std::cout << "testSlabStack passed." << std::endl;
+}
+
+//--------------------------------------------------------------------------
+// RayCaster Test: the axis-aligned view must match the z projection
+//--------------------------------------------------------------------------
+#include "RayCaster.h"
+
+void testRayCaster() {
+    std::cout << "Running testRayCaster..." << std::endl;
+
+    Volume vol;
+    bool loaded = vol.load("../Scans/TestVolume/vol");
+    assert(loaded && "Failed to load volume for ray-cast test");
+    int w = vol.getWidth();
+    int h = vol.getHeight();
+    int ch = vol.getChannels();
+
+    RenderSettings settings;
+    settings.outWidth = w;
+    settings.outHeight = h;
+    Image ray = RayCaster::render(vol, ProjectionMode::MIP, settings);
+    Image mip = Projection::maximumIntensityProjection(vol);
+    assert(ray.getWidth() == w && ray.getHeight() == h && ray.getChannels() == ch && "RayCaster: wrong output size");
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            for (int c = 0; c < ch; c++) {
+                int diff = std::abs(get_pixel(ray, x, y, c) - get_pixel(mip, x, y, c));
+                assert(diff <= 1 && "RayCaster: axis-aligned MIP differs from Projection MIP");
+            }
+        }
+    }
+
+    // Opposite views of a MIP are mirror images.
+    Volume orbit = RayCaster::renderOrbit(vol, ProjectionMode::MIP, 2, settings);
+    assert(orbit.getDepth() == 2 && "RayCaster: wrong number of orbit views");
+    const Image& front = orbit.getSlices()[0];
+    const Image& back = orbit.getSlices()[1];
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int diff = std::abs(get_pixel(front, x, y, 0) - get_pixel(back, w - 1 - x, y, 0));
+            assert(diff <= 1 && "RayCaster: opposite views are not mirrored");
+        }
+    }
+
+    // Rays that miss the volume must not set the MinIP range: with a one-pixel ring of misses the
+    // volume still matches the z projection, and the ring is white.
+    settings.outWidth = w + 2;
+    settings.outHeight = h + 2;
+    Image minRay = RayCaster::render(vol, ProjectionMode::MinIP, settings);
+    Image minip = Projection::minimumIntensityProjection(vol);
+    for (int y = 0; y < h + 2; y++) {
+        for (int x = 0; x < w + 2; x++) {
+            for (int c = 0; c < ch; c++) {
+                if (x == 0 || y == 0 || x == w + 1 || y == h + 1) {
+                    assert(get_pixel(minRay, x, y, c) == 255 && "RayCaster: missed MinIP ray is not white");
+                } else {
+                    int diff = std::abs(get_pixel(minRay, x, y, c) - get_pixel(minip, x - 1, y - 1, c));
+                    assert(diff <= 1 && "RayCaster: MinIP range includes missed rays");
+                }
+            }
+        }
+    }
+
+    // Oblique views with default size cover the whole volume diagonal.
+    settings = RenderSettings();
+    settings.azimuthDeg = 35.0f;
+    settings.elevationDeg = 20.0f;
+    Image oblique = RayCaster::render(vol, ProjectionMode::Mean, settings);
+    assert(oblique.getWidth() >= w && oblique.getHeight() >= h && "RayCaster: oblique view too small");
+    checkPixelRange(oblique);
+
+    std::cout << "testRayCaster passed." << std::endl;
+}
+
+// Test oblique and curved reformats against the axis-aligned slices they generalise.
+void testMultiPlanarReformat() {
+    std::cout << "Running testMultiPlanarReformat..." << std::endl;
+
+    Volume vol;
+    bool loaded = vol.load("../Scans/TestVolume/vol");
+    assert(loaded && "Failed to load volume for reformat test");
+    int w = vol.getWidth();
+    int h = vol.getHeight();
+    int d = vol.getDepth();
+    int ch = vol.getChannels();
+    float cx = (w - 1) * 0.5f;
+    float cy = (h - 1) * 0.5f;
+    float cz = (d - 1) * 0.5f;
+
+    // A +z normal through the centre of slice z is that XY slice.
+    int z = d / 3;
+    Image xy = Slice::sliceVolume(vol, "XY", z);
+    Image planeXY = Slice::obliqueSlice(vol, Vec3{ cx, cy, static_cast<float>(z) }, Vec3{ 0, 0, 1 },
+                                        Interpolation::Trilinear, w, h);
+    assert(planeXY.getWidth() == w && planeXY.getHeight() == h && planeXY.getChannels() == ch &&
+           "obliqueSlice: wrong output size");
+    assert(std::memcmp(planeXY.getData(), xy.getData(), (size_t)w * h * ch) == 0 &&
+           "obliqueSlice: +z normal does not reproduce the XY slice");
+
+    // A +y normal gives the XZ slice.
+    int y = h / 2;
+    Image xz = Slice::sliceVolume(vol, "XZ", y);
+    Image planeXZ = Slice::obliqueSlice(vol, Vec3{ cx, static_cast<float>(y), cz }, Vec3{ 0, 1, 0 },
+                                        Interpolation::Nearest, w, d);
+    assert(std::memcmp(planeXZ.getData(), xz.getData(), (size_t)w * d * ch) == 0 &&
+           "obliqueSlice: +y normal does not reproduce the XZ slice");
+
+    // Tilted planes with the default size cover the diagonal and leave the corners empty.
+    Image tilted = Slice::obliqueSlice(vol, Vec3{ cx, cy, cz }, Vec3{ 1, 1, 1 });
+    assert(tilted.getWidth() >= w && tilted.getHeight() >= h && "obliqueSlice: tilted plane too small");
+    assert(get_pixel(tilted, 0, 0, 0) == 0 && "obliqueSlice: samples outside the volume should be 0");
+
+    // A straight curve along x, extruded along z, is again the XZ slice.
+    std::vector<Vec3> line = { Vec3{ 0, static_cast<float>(y), 0 },
+                               Vec3{ cx, static_cast<float>(y), 0 },
+                               Vec3{ static_cast<float>(w - 1), static_cast<float>(y), 0 } };
+    Image curved = Slice::curvedSlice(vol, line, Interpolation::Trilinear);
+    assert(curved.getWidth() == w && curved.getHeight() == d && "curvedSlice: wrong output size");
+    for (int j = 0; j < d; j++) {
+        for (int i = 0; i < w; i++) {
+            int diff = std::abs(get_pixel(curved, i, j, 0) - get_pixel(xz, i, j, 0));
+            assert(diff <= 1 && "curvedSlice: straight curve differs from the XZ slice");
+        }
+    }
+
+    std::cout << "testMultiPlanarReformat passed." << std::endl;
+}
+
+// Test that 16-bit slices keep their full range through loading, projection, slicing and blur.
+void testSixteenBitVolume() {
+    std::cout << "Running testSixteenBitVolume..." << std::endl;
+
+    const std::string dir = "../Scans/TestVolume16/vol";
+    assert(isSixteenBitFile("../Scans/TestVolume16/vol003.png") && "16-bit slice not detected");
+    assert(!isSixteenBitFile("../Scans/TestVolume/vol000.png") && "8-bit slice reported as 16-bit");
+
+    // Raw values are 1000 + up to 120, so they differ only in the low byte.
+    Image16 slice;
+    slice.setVerbose(false);
+    bool sliceLoaded = slice.load("../Scans/TestVolume16/vol003.png");
+    assert(sliceLoaded && "Failed to load 16-bit slice");
+    assert(slice.getPixel(0, 0)[0] == 1000 && "16-bit background value changed on load");
+    assert(slice.getPixel(7, 7)[0] == 1118 && "16-bit centre value changed on load");
+
+    ImageF sliceF;
+    sliceF.setVerbose(false);
+    bool floatLoaded = sliceF.load("../Scans/TestVolume16/vol003.png");
+    assert(floatLoaded && "Failed to load slice as float");
+    assert(std::fabs(sliceF.getPixel(7, 7)[0] - 1118.0f / 65535.0f) < 1e-6f && "Float load is not scaled to [0, 1]");
+
+    Volume16 vol;
+    bool loaded = vol.load(dir);
+    assert(loaded && vol.getDepth() == 8 && "Failed to load 16-bit volume");
+
+    // The MIP keeps every intensity step; the same data read as 8 bits collapses to two levels.
+    auto countLevels = [](const auto& img) {
+        std::vector<int> values;
+        for (int i = 0; i < img.getWidth() * img.getHeight(); i++) values.push_back(img.getData()[i]);
+        std::sort(values.begin(), values.end());
+        return static_cast<int>(std::unique(values.begin(), values.end()) - values.begin());
+    };
+    Image16 mip = Projection::maximumIntensityProjection(vol);
+    assert(mip.getPixel(0, 0)[0] == 0 && mip.getPixel(7, 7)[0] == 65535 && "16-bit MIP not normalised to full range");
+    Volume vol8;
+    bool loaded8 = vol8.load(dir);
+    assert(loaded8 && "Failed to load 16-bit volume as 8-bit");
+    Image mip8 = Projection::maximumIntensityProjection(vol8);
+    assert(countLevels(mip) > 50 && countLevels(mip8) <= 2 && "16-bit MIP lost dynamic range");
+
+    Image16 xz = Slice::sliceVolume(vol, "XZ", 7);
+    assert(xz.getWidth() == 16 && xz.getHeight() == 8 && xz.getPixel(7, 3)[0] == 1118 && "16-bit XZ slice changed values");
+
+    Filter3D* blur = createGaussianBlur3DFilter(3, 1.0);
+    blur->apply(vol);
+    delete blur;
+    unsigned short centre = vol.getVoxel(7, 7, 3)[0];
+    assert(centre > 1000 && centre < 1118 && "16-bit Gaussian blur out of range");
+    assert(vol.getVoxel(0, 0, 0)[0] == 1000 && "16-bit Gaussian blur changed flat background");
+
+    std::cout << "testSixteenBitVolume passed." << std::endl;
+}
+
+#include "Profiler.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+void testProfiler() {
+    std::cout << "Running testProfiler..." << std::endl;
+
+    // Nothing is recorded until profiling is enabled.
+    Profiler::disable();
+    size_t before = Profiler::events().size();
+    {
+        ProfileScope scope("ignored");
+    }
+    assert(Profiler::events().size() == before && "Disabled profiler recorded an event");
+
+    Profiler::enable();
+    assert(Profiler::events().empty() && "enable() did not clear earlier events");
+    {
+        ProfileScope outer("outer");
+        unsigned char* data = (unsigned char*)std::malloc(32 * 32 * 3);
+        std::memset(data, 100, 32 * 32 * 3);
+        Image img(32, 32, 3, data);
+        Filter2D* blur = createBoxBlurFilter(3);
+        blur->apply(img);
+        delete blur;
+    }
+    Profiler::disable();
+
+    std::vector<ProfileEvent> events = Profiler::events();
+    assert(events.size() == 2 && "Expected the filter and the outer scope");
+    assert(events[0].name == "BoxBlur" && events[0].category == "filter" && "Filter apply not instrumented");
+    assert(events[1].name == "outer" && "Scopes must be recorded as they finish");
+    assert(events[1].startUs <= events[0].startUs &&
+           events[1].startUs + events[1].durationUs >= events[0].startUs + events[0].durationUs &&
+           "Inner scope not nested inside outer scope");
+
+    const std::string traceFile = "profiler_test_trace.json";
+    bool written = Profiler::writeTrace(traceFile);
+    assert(written && "Failed to write trace");
+    std::ifstream in(traceFile);
+    std::stringstream text;
+    text << in.rdbuf();
+    assert(text.str().find("\"traceEvents\"") != std::string::npos && "Trace is missing traceEvents");
+    assert(text.str().find("\"name\": \"BoxBlur\"") != std::string::npos && "Trace is missing the filter event");
+    in.close();
+    std::remove(traceFile.c_str());
+
+    std::ostringstream summary;
+    Profiler::printSummary(summary);
+    assert(summary.str().find("BoxBlur") != std::string::npos && "Summary is missing the filter row");
+
+    // A stage that allocates and frees a large buffer reports it as its peak, and so does the
+    // scope around it, although nothing is left allocated at the end.
+    Profiler::enable();
+    {
+        ProfileScope holder("holder");
+        {
+            ProfileScope temporary("temporary");
+            Image pixels(1024, 1024, 4, (unsigned char*)std::malloc(4 << 20));
+            std::vector<unsigned char> scratch(4 << 20, 1);
+            std::memset(pixels.getData(), scratch[12345], 4 << 20);
+        }
+    }
+    Profiler::disable();
+    events = Profiler::events();
+    assert(events.size() == 2 && events[0].name == "temporary" && events[1].name == "holder");
+    for (const ProfileEvent& e : events) {
+        assert(e.allocPeakKB >= 8 * 1024 && "Temporary buffers missing from the stage peak");
+        assert(e.allocNetKB < 1024 && "Freed buffers counted as kept");
+    }
+
+    std::cout << "testProfiler passed." << std::endl;
+}
+
+#include "Server.h"
+#include <thread>
+
+void testServer() {
+    std::cout << "Running testServer..." << std::endl;
+
+    std::vector<std::string> args = splitRequest("-d \"dir with space/vol\"  -p MIP -");
+    assert(args.size() == 5 && args[1] == "dir with space/vol" && args[4] == "-" && "Request not split correctly");
+    assert(splitRequest(joinRequest(args)) == args && "joinRequest does not round-trip");
+
+    // A one-byte budget keeps only the most recently used volume.
+    VolumeCache cache(1);
+    auto first = cache.getVolume("../Scans/TestVolume/vol");
+    assert(first && first->getDepth() > 0 && "Cache failed to load volume");
+    assert(cache.getVolume("../Scans/TestVolume/vol") == first && "Second lookup was not a hit");
+    auto wide = cache.getVolume16("../Scans/TestVolume16/vol");
+    assert(wide && "Cache failed to load 16-bit volume");
+    VolumeCache::Stats stats = cache.stats();
+    assert(stats.hits == 1 && stats.misses == 2 && stats.evictions == 1 && stats.entries == 1 && "LRU eviction wrong");
+    assert(first->getDepth() > 0 && "Evicted volume freed while still in use");
+
+    // Requests: the result comes back as PNG bytes and the cached volume is reused, unchanged.
+    Server server(ServerOptions{ "", size_t(64) * 1024 * 1024 });
+    ServerResponse mip = server.handle("-d ../Scans/TestVolume/vol -p MIP -");
+    assert(mip.ok && mip.data.size() > 8 && mip.data[1] == 'P' && mip.data[2] == 'N' && mip.data[3] == 'G' &&
+           "MIP request did not return a PNG");
+    ServerResponse blurred = server.handle("-d ../Scans/TestVolume/vol --blur3d Gaussian 3 1.0 -p MIP -");
+    assert(blurred.ok && blurred.data != mip.data && "Blurred request returned the plain MIP");
+    ServerResponse again = server.handle("-d ../Scans/TestVolume/vol -p MIP -");
+    assert(again.ok && again.data == mip.data && "Filter changed the cached volume");
+    assert(server.cache().stats().misses == 1 && server.cache().stats().hits == 2 && "Volume was loaded more than once");
+    assert(!server.handle("BOGUS").ok && !server.handle("-d ../Scans/TestVolume/vol -s XZ x -").ok &&
+           "Invalid requests must fail");
+
+    // Round trip over the socket.
+    Server socketServer(ServerOptions{ "apif_test.sock", size_t(64) * 1024 * 1024 });
+    std::thread serverThread([&socketServer]() { socketServer.run(); });
+    ServerConnection connection;
+    bool connected = false;
+    for (int attempt = 0; attempt < 50 && !connected; attempt++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        connected = connection.connect("apif_test.sock");
+    }
+    assert(connected && "Could not connect to the server socket");
+    ServerResponse pong, slice, shutdown;
+    bool sent = connection.request("PING", pong) &&
+                connection.request("-d ../Scans/TestVolume/vol -s XZ 8 -", slice) &&
+                connection.request("SHUTDOWN", shutdown);
+    connection.close();
+    serverThread.join();
+    assert(sent && pong.ok && std::string(pong.data.begin(), pong.data.end()) == "pong" && "PING failed");
+    assert(slice.ok && slice.data.size() > 8 && "Slice over the socket failed");
+    assert(shutdown.ok && "SHUTDOWN failed");
+
+    std::cout << "testServer passed." << std::endl;
+}
+
+#include "AsyncImageWriter.h"
+#include "Deflate.h"
+#include "PngEncoder.h"
+#include "stb_image.h"
+
+void testPngEncoder() {
+    // Adler-32 of two pieces, combined, matches the checksum of the whole.
+    std::vector<unsigned char> bytes(100000);
+    for (size_t i = 0; i < bytes.size(); i++) bytes[i] = static_cast<unsigned char>((i * 7919) >> 5);
+    const size_t cut = 33333;
+    uint32_t whole = adler32Update(1, bytes.data(), bytes.size());
+    uint32_t combined = adler32Combine(adler32Update(1, bytes.data(), cut),
+                                       adler32Update(1, bytes.data() + cut, bytes.size() - cut), bytes.size() - cut);
+    assert(whole == combined && "adler32Combine mismatch");
+    const unsigned char check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    assert(crc32Update(0, check, 9) == 0xCBF43926u && "CRC-32 check value wrong");
+
+    // Every channel count, level and strip count decodes back to the exact pixels.
+    for (int channels = 1; channels <= 4; channels++) {
+        const int w = 300, h = 300;
+        std::vector<unsigned char> pixels(static_cast<size_t>(w) * h * channels);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                for (int c = 0; c < channels; c++) {
+                    // Smooth gradients, a repeating pattern and some noise.
+                    unsigned char v = static_cast<unsigned char>(x + y * c);
+                    if ((x / 16 + y / 16) % 2) v = static_cast<unsigned char>((x * 31 + y * 17 + c * 5) % 7 * 36);
+                    if (y > 250) v = static_cast<unsigned char>((x * 2654435761u + y * 40503u + c) >> 13);
+                    pixels[(static_cast<size_t>(y) * w + x) * channels + c] = v;
+                }
+            }
+        }
+        size_t storedSize = 0;
+        for (int level : { 0, 1, 6, 9 }) {
+            for (int strips : { 1, 4 }) {
+                std::vector<unsigned char> png;
+                assert(encodePng(pixels.data(), w, h, channels, PngOptions{ level, strips }, png) && "encodePng failed");
+                int dw = 0, dh = 0, dc = 0;
+                unsigned char* decoded = stbi_load_from_memory(png.data(), static_cast<int>(png.size()), &dw, &dh, &dc, 0);
+                assert(decoded && dw == w && dh == h && dc == channels && "PNG did not decode");
+                assert(std::memcmp(decoded, pixels.data(), pixels.size()) == 0 && "PNG round trip changed pixels");
+                stbi_image_free(decoded);
+                if (level == 0) storedSize = png.size();
+                else assert(png.size() < storedSize && "Compressed PNG not smaller than stored");
+            }
+        }
+    }
+
+    // Background writer: files exist and match after wait().
+    const int w = 64, h = 48;
+    {
+        AsyncImageWriter writer(2, 1);
+        for (int i = 0; i < 3; i++) {
+            unsigned char* data = (unsigned char*)std::malloc(w * h * 3);
+            for (int p = 0; p < w * h * 3; p++) data[p] = static_cast<unsigned char>(p * (i + 1));
+            Image img(w, h, 3, data);
+            img.setVerbose(false);
+            writer.submit(std::move(img), "apif_async_" + std::to_string(i) + ".png", i * 4);
+        }
+        assert(writer.wait() && "Async writes failed");
+        writer.submit([]() { return false; });
+        assert(!writer.wait() && "Async failure not reported");
+    }
+    for (int i = 0; i < 3; i++) {
+        const std::string file = "apif_async_" + std::to_string(i) + ".png";
+        Image back;
+        back.setVerbose(false);
+        assert(back.load(file) && back.getWidth() == w && back.getHeight() == h && "Async image not written");
+        for (int p = 0; p < w * h * 3; p++) {
+            assert(back.getData()[p] == static_cast<unsigned char>(p * (i + 1)) && "Async image differs");
+        }
+        std::remove(file.c_str());
+    }
+
+    std::cout << "testPngEncoder passed." << std::endl;
+}
+
+#include "PngDecoder.h"
+
+void testPngDecoder() {
+    // Encoder output at every level and strip count decodes back to the exact pixels.
+    for (int channels = 1; channels <= 4; channels++) {
+        const int w = 173, h = 91;
+        std::vector<unsigned char> pixels(static_cast<size_t>(w) * h * channels);
+        for (size_t i = 0; i < pixels.size(); i++) {
+            pixels[i] = static_cast<unsigned char>(i % 3 ? i / 7 : (i * 2654435761u) >> 11);
+        }
+        for (int level : { 0, 1, 6, 9 }) {
+            for (int strips : { 1, 4 }) {
+                std::vector<unsigned char> png;
+                assert(encodePng(pixels.data(), w, h, channels, PngOptions{ level, strips }, png) && "encodePng failed");
+                int dw = 0, dh = 0, dc = 0;
+                unsigned char* decoded = static_cast<unsigned char*>(decodePng(png.data(), png.size(), 8, 0, dw, dh, dc));
+                assert(decoded && dw == w && dh == h && dc == channels && "decodePng failed");
+                assert(std::memcmp(decoded, pixels.data(), pixels.size()) == 0 && "decodePng changed pixels");
+                std::free(decoded);
+
+                unsigned short* wide = static_cast<unsigned short*>(decodePng(png.data(), png.size(), 16, 0, dw, dh, dc));
+                assert(wide && "16-bit decodePng failed");
+                for (size_t i = 0; i < pixels.size(); i++) {
+                    assert(wide[i] == pixels[i] * 257 && "8-bit PNG not widened like stbi_load_16");
+                }
+                std::free(wide);
+
+                // A truncated file is rejected, not read past its end.
+                png.resize(png.size() / 2);
+                assert(!decodePng(png.data(), png.size(), 8, 0, dw, dh, dc) && "Truncated PNG decoded");
+            }
+        }
+    }
+
+    // The project's images and 8/16-bit scans load identically through both backends.
+    const PngBackend saved = pngDecodeBackend();
+    for (const std::string file : { "../Images/gracehopper.png", "../Images/stinkbug.png",
+                                    "../Scans/TestVolume/vol000.png", "../Scans/TestVolume16/vol000.png" }) {
+        Image fast, stb;
+        Image16 fast16, stb16;
+        for (auto* img : { &fast, &stb }) img->setVerbose(false);
+        for (auto* img : { &fast16, &stb16 }) img->setVerbose(false);
+        pngDecodeBackend() = PngBackend::Fast;
+        const bool loaded = fast.load(file) && fast16.load(file);
+        pngDecodeBackend() = PngBackend::Stb;
+        assert(loaded == (stb.load(file) && stb16.load(file)) && "Backends disagree on loading");
+        if (!loaded) continue;
+        const size_t n = static_cast<size_t>(fast.getWidth()) * fast.getHeight() * fast.getChannels();
+        assert(fast.getWidth() == stb.getWidth() && fast.getChannels() == stb.getChannels() && "Decoded sizes differ");
+        assert(std::memcmp(fast.getData(), stb.getData(), n) == 0 && "8-bit decode differs from stb_image");
+        assert(std::memcmp(fast16.getData(), stb16.getData(), n * 2) == 0 && "16-bit decode differs from stb_image");
+    }
+    pngDecodeBackend() = saved;
+
+    std::cout << "testPngDecoder passed." << std::endl;
+}
+
+void testDecodeInto() {
+    // A slice decoded into a padded, reused buffer matches Image::load, for both backends.
+    const std::string file = "../Scans/TestVolume/vol003.png";
+    Image reference;
+    reference.setVerbose(false);
+    assert(reference.load(file) && "Reference slice not loaded");
+    const int w = reference.getWidth(), h = reference.getHeight(), ch = reference.getChannels();
+    int iw = 0, ih = 0, ich = 0;
+    assert(readImageInfo(file, iw, ih, ich) && iw == w && ih == h && ich == ch && "readImageInfo wrong");
+
+    const size_t stride = static_cast<size_t>(w) * ch + 7;
+    std::vector<unsigned char> buffer(stride * h, 0xAB);
+    const PngBackend saved = pngDecodeBackend();
+    for (PngBackend backend : { PngBackend::Fast, PngBackend::Stb }) {
+        pngDecodeBackend() = backend;
+        assert(Image::loadInto(file, buffer.data(), w, h, ch, stride) && "loadInto failed");
+        for (int y = 0; y < h; y++) {
+            assert(std::memcmp(buffer.data() + y * stride, reference.getData() + y * w * ch, w * ch) == 0 && "loadInto row differs");
+            assert(buffer[y * stride + w * ch] == 0xAB && "loadInto wrote into the row padding");
+        }
+        assert(!Image::loadInto(file, buffer.data(), w + 1, h, ch, stride) && "Size mismatch not rejected");
+    }
+    pngDecodeBackend() = saved;
+
+    // A view never frees the memory it looks at, and moving keeps it a view.
+    {
+        Image view = Image::view(w, h, ch, buffer.data());
+        Image moved = std::move(view);
+        assert(!moved.ownsData() && moved.getData() == buffer.data() && "View lost on move");
+    }
+    Image owned;
+    owned.setVerbose(false);
+    owned.setData(buffer.data(), w, h, ch);
+    assert(owned.ownsData() && owned.getData() != buffer.data() && "setData did not copy");
+
+    // Volume slices are views of one contiguous store, in slice order, 8- and 16-bit.
+    Volume vol;
+    assert(vol.load("../Scans/TestVolume/vol") && "Volume not loaded");
+    const size_t sliceSamples = static_cast<size_t>(vol.getWidth()) * vol.getHeight() * vol.getChannels();
+    for (int z = 0; z < vol.getDepth(); z++) {
+        assert(vol.getSlices()[z].getData() == vol.getVoxelData() + z * sliceSamples && "Slice not in the voxel store");
+        assert(!vol.getSlices()[z].ownsData() && "Volume slice owns its data");
+    }
+    assert(std::memcmp(vol.getSlices()[3].getData(), reference.getData(), sliceSamples) == 0 && "Slice 3 differs from its file");
+    Volume moved = std::move(vol);
+    assert(moved.getSlices()[1].getData() == moved.getVoxelData() + sliceSamples && "Store lost on move");
+
+    Volume16 vol16;
+    assert(vol16.load("../Scans/TestVolume16/vol") && "16-bit volume not loaded");
+    Image16 slice16;
+    slice16.setVerbose(false);
+    assert(slice16.load("../Scans/TestVolume16/vol003.png") && "16-bit slice not loaded");
+    const size_t slice16Samples = static_cast<size_t>(vol16.getWidth()) * vol16.getHeight() * vol16.getChannels();
+    assert(std::memcmp(vol16.getVoxelData() + 3 * slice16Samples, slice16.getData(), slice16Samples * 2) == 0 &&
+           "16-bit slice differs from its file");
+
+    std::cout << "testDecodeInto passed." << std::endl;
+}
+
+#include "Parallel.h"
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+
+void testThreadPool() {
+    // Every index runs exactly once, whatever the thread count.
+    ThreadPool pool;
+    for (int threads : { 1, 2, 4, 7 }) {
+        std::vector<std::atomic<int>> hits(1000);
+        pool.run(1000, threads, [&](int i) { hits[i]++; });
+        for (const auto& hit : hits) {
+            assert(hit == 1 && "Index not run exactly once");
+        }
+    }
+    assert(pool.workerCount() == 6 && "Workers not reused");
+
+    // A range started from inside a running index runs inline instead of deadlocking.
+    std::atomic<int> nested{ 0 };
+    pool.run(8, 4, [&](int) { pool.run(10, 4, [&](int) { nested++; }); });
+    assert(nested == 80 && "Nested range incomplete");
+
+    // The first exception thrown by an index reaches the caller.
+    bool thrown = false;
+    try {
+        pool.run(100, 4, [](int i) {
+            if (i == 42) throw std::runtime_error("index 42");
+        });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && "Exception not propagated");
+
+    // Row bands cover every row once and their halo stays inside the image.
+    const int height = 1000;
+    std::vector<int> covered(height, 0);
+    parallelRowBands(height, 4096, 2, [&](const RowBand& band) {
+        assert(band.inY0 == std::max(0, band.y0 - 2) && band.inY1 == std::min(height, band.y1 + 2) && "Halo wrong");
+        for (int y = band.y0; y < band.y1; y++) covered[y]++;
+    });
+    assert(std::all_of(covered.begin(), covered.end(), [](int c) { return c == 1; }) && "Rows not covered once");
+    assert(rowBandHeight(4096, 2) < height && "Image not split into bands");
+
+    // The banded 2D filters give the same image on one thread as on four.
+    std::vector<std::function<Filter2D*()>> makers = {
+        [] { return createGreyscaleFilter(); },
+        [] { return createBrightnessFilter(40); },
+        [] { return createBrightnessFilter(); },
+        [] { return createHistogramEqualisationFilter("HSV"); },
+        [] { return createThresholdFilter(100, "HSL"); },
+        [] { return createBoxBlurFilter(5); },
+        [] { return createGaussianBlurFilter(5, 2.0); },
+        [] { return createMedianBlurFilter(5); },
+        [] { return createSharpenFilter(); },
+        [] { return createEdgeDetectionFilter("Sobel"); },
+        [] { return createEdgeDetectionFilter("RobertsCross"); },
+    };
+    const int savedLimit = parallelThreadLimit();
+    for (auto& make : makers) {
+        Image results[2];
+        const int limits[2] = { 1, 4 };
+        for (int r = 0; r < 2; r++) {
+            parallelThreadLimit() = limits[r];
+            results[r].setVerbose(false);
+            bool loaded = results[r].load("../Images/gracehopper.png");
+            assert(loaded && "Image not loaded");
+            Filter2D* filter = make();
+            filter->apply(results[r]);
+            delete filter;
+        }
+        const size_t samples = static_cast<size_t>(results[0].getWidth()) * results[0].getHeight() * results[0].getChannels();
+        assert(results[0].getChannels() == results[1].getChannels() &&
+               std::memcmp(results[0].getData(), results[1].getData(), samples) == 0 && "Filter output depends on thread count");
+    }
+    parallelThreadLimit() = savedLimit;
+
+    std::cout << "testThreadPool passed." << std::endl;
+}
+
+#include "Reduction.h"
+#include <limits>
+
+namespace {
+
+    // Checks reduceChannels against a plain per-channel loop, and remapChannels against a direct remap.
+    template <typename T>
+    void checkReduction(int channels, size_t pixels, uint32_t seed) {
+        std::vector<T> data(pixels * channels);
+        for (T& v : data) {
+            seed = seed * 1664525u + 1013904223u;
+            if constexpr (std::is_floating_point_v<T>) {
+                v = static_cast<T>((seed >> 8) / 16777216.0);
+            } else {
+                v = static_cast<T>(seed >> 8);
+            }
+        }
+        const ChannelStats<T> stats = reduceChannels(data.data(), pixels, channels);
+        assert(stats.pixels == pixels && "Pixel count wrong");
+        for (int c = 0; c < channels; c++) {
+            T lo = std::numeric_limits<T>::max(), hi = std::numeric_limits<T>::lowest();
+            double sum = 0.0;
+            for (size_t i = 0; i < pixels; i++) {
+                const T v = data[i * channels + c];
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+                sum += v;
+            }
+            assert(stats.min[c] == lo && stats.max[c] == hi && "Channel min/max wrong");
+            assert(std::abs(stats.sum[c] - sum) <= 1e-9 * std::max(1.0, sum) && "Channel sum wrong");
+        }
+
+        std::vector<T> expected = data;
+        for (size_t i = 0; i < expected.size(); i++) {
+            const int c = static_cast<int>(i % channels);
+            expected[i] = c == 0 ? expected[i] : static_cast<T>(PixelTraits<T>::maxValue - expected[i]);
+        }
+        remapChannels(data.data(), pixels, channels, [](int c, T v) {
+            return c == 0 ? v : static_cast<T>(PixelTraits<T>::maxValue - v);
+        });
+        assert(data == expected && "Remap wrong");
+    }
+
+} // end anonymous namespace
+
+void testReduction() {
+    // Lengths around the 16-byte SIMD step and the 65536-pixel chunk, for 1-5 channels.
+    for (int channels = 1; channels <= 5; channels++) {
+        for (size_t pixels : { size_t(1), size_t(15), size_t(16), size_t(17), size_t(65536), size_t(65537), size_t(200003) }) {
+            checkReduction<unsigned char>(channels, pixels, 11u * channels + static_cast<uint32_t>(pixels));
+            checkReduction<std::uint16_t>(channels, pixels, 13u * channels + static_cast<uint32_t>(pixels));
+            checkReduction<float>(channels, pixels, 17u * channels + static_cast<uint32_t>(pixels));
+        }
+    }
+
+    // The result does not depend on the thread count, float sums included.
+    std::vector<float> samples(300000 * 3);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = static_cast<float>((i * 2654435761u) % 1000) / 999.0f;
+    const int savedLimit = parallelThreadLimit();
+    parallelThreadLimit() = 1;
+    const ChannelStats<float> serial = reduceChannels(samples.data(), 300000, 3);
+    parallelThreadLimit() = 4;
+    const ChannelStats<float> threaded = reduceChannels(samples.data(), 300000, 3);
+    parallelThreadLimit() = savedLimit;
+    assert(serial.sum == threaded.sum && serial.min == threaded.min && serial.max == threaded.max && "Reduction depends on thread count");
+
+    // Auto brightness shifts the colour channels by 128 minus their mean and leaves alpha alone.
+    const int w = 37, h = 23;
+    unsigned char* pixels = static_cast<unsigned char*>(std::malloc(w * h * 4));
+    for (int i = 0; i < w * h; i++) {
+        pixels[i * 4 + 0] = 10;
+        pixels[i * 4 + 1] = 20;
+        pixels[i * 4 + 2] = static_cast<unsigned char>(i % 2 ? 250 : 30);
+        pixels[i * 4 + 3] = 77;
+    }
+    Image img(w, h, 4, pixels);
+    img.setVerbose(false);
+    const double mean = (10.0 * w * h + 20.0 * w * h + (250.0 * (w * h / 2) + 30.0 * (w * h - w * h / 2))) / (3.0 * w * h);
+    const int delta = static_cast<int>(128 - mean + 0.5);
+    Filter2D* autoBrightness = createBrightnessFilter();
+    autoBrightness->apply(img);
+    delete autoBrightness;
+    for (int i = 0; i < w * h; i++) {
+        const unsigned char* px = img.getData() + i * 4;
+        assert(px[0] == 10 + delta && px[1] == 20 + delta && px[3] == 77 && "Auto brightness wrong");
+        assert(px[2] == std::min(255, (i % 2 ? 250 : 30) + delta) && "Auto brightness not clamped");
+    }
+
+    std::cout << "testReduction passed." << std::endl;
+}
+
+namespace {
+
+    template <typename T>
+    void checkStreamedProjections(const std::string& basename) {
+        BasicVolume<T> vol;
+        bool loaded = vol.load(basename);
+        assert(loaded && "Failed to load volume for streaming");
+        SliceSeries series;
+        bool opened = series.open(basename);
+        assert(opened && series.getDepth() == vol.getDepth() && series.width == vol.getWidth() && "Series does not match volume");
+
+        const int depth = vol.getDepth();
+        const int ranges[][2] = { { 1, depth }, { 3, 7 }, { 2, 2 }, { 0, depth + 5 } };
+        for (const auto& range : ranges) {
+            const BasicImage<T> expected[] = {
+                Projection::maximumIntensityProjection(vol, range[0], range[1]),
+                Projection::minimumIntensityProjection(vol, range[0], range[1]),
+                Projection::meanIntensityProjection(vol, range[0], range[1]),
+            };
+            const ProjectionMode modes[] = { ProjectionMode::MIP, ProjectionMode::MinIP, ProjectionMode::Mean };
+            for (int m = 0; m < 3; m++) {
+                for (int threads : { 1, 4 }) {
+                    parallelThreadLimit() = threads;
+                    BasicImage<T> streamed = Projection::streamProjection<T>(series, modes[m], range[0], range[1]);
+                    const size_t samples = static_cast<size_t>(streamed.getWidth()) * streamed.getHeight() * streamed.getChannels();
+                    assert(streamed.getWidth() == expected[m].getWidth() && streamed.getHeight() == expected[m].getHeight() &&
+                           "Streamed projection has the wrong size");
+                    assert(std::equal(streamed.getData(), streamed.getData() + samples, expected[m].getData()) &&
+                           "Streamed projection differs from the in-memory one");
+                }
+            }
+        }
+        parallelThreadLimit() = 0;
+
+        // An empty range gives an empty image, like the in-memory projections.
+        BasicImage<T> empty = Projection::streamProjection<T>(series, ProjectionMode::MIP, 5, 4);
+        assert(empty.getData() == nullptr && "Empty z range not rejected");
+    }
+
+} // end anonymous namespace
+
+void testStreamingProjection() {
+    std::cout << "Running testStreamingProjection..." << std::endl;
+    checkStreamedProjections<unsigned char>("../Scans/TestVolume/vol");
+    checkStreamedProjections<std::uint16_t>("../Scans/TestVolume16/vol");
+
+    SliceSeries missing;
+    bool opened = missing.open("../Scans/TestVolume/nothing");
+    assert(!opened && missing.getDepth() == 0 && "Missing series opened");
+    std::cout << "testStreamingProjection passed." << std::endl;
+}
+
+#include "OutputMapping.h"
+
+void testOutputMapping() {
+    std::cout << "Running testOutputMapping..." << std::endl;
+
+    // A [0, 1] window is a plain clamp-and-round, for every channel count and on the
+    // vector body as well as the scalar tail.
+    OutputMapping unit;
+    unit.type = MappingType::Window;
+    unit.center = 0.5f;
+    unit.width = 1.0f;
+    for (int channels = 1; channels <= 5; channels++) {
+        const int w = 37, h = 5;
+        float* data = static_cast<float*>(std::malloc(sizeof(float) * w * h * channels));
+        for (int i = 0; i < w * h * channels; i++) data[i] = ((i * 7919) % 1400) / 1000.0f - 0.2f;
+        BasicImage<float> raw(w, h, channels, data);
+        Image mapped = mapToImage(raw, unit);
+        assert(mapped.getWidth() == w && mapped.getHeight() == h && mapped.getChannels() == channels && "Mapped size wrong");
+        for (int i = 0; i < w * h * channels; i++) {
+            const float x = std::clamp(data[i] * 255.0f, 0.0f, 255.0f);
+            assert(mapped.getData()[i] == static_cast<unsigned char>(x + 0.5f) && "Window mapping wrong");
+        }
+    }
+
+    // MinMax stretches each channel on its own; a flat channel keeps its value.
+    float* pixels = static_cast<float*>(std::malloc(sizeof(float) * 4 * 2));
+    const float values[] = { 0.25f, 0.5f, 0.5f, 0.5f, 0.75f, 0.5f, 0.375f, 0.5f };
+    std::copy(values, values + 8, pixels);
+    BasicImage<float> twoChannel(4, 1, 2, pixels);
+    Image stretched = mapToImage(twoChannel, OutputMapping());
+    const unsigned char expected[] = { 0, 128, 128, 128, 255, 128, 64, 128 };
+    assert(std::equal(expected, expected + 8, stretched.getData()) && "MinMax mapping wrong");
+
+    // Gamma 2 lifts a quarter of the range to about half.
+    OutputMapping gamma;
+    gamma.type = MappingType::Gamma;
+    gamma.gamma = 2.0f;
+    float* ramp = static_cast<float*>(std::malloc(sizeof(float) * 5));
+    for (int i = 0; i < 5; i++) ramp[i] = i / 4.0f;
+    Image lifted = mapToImage(BasicImage<float>(5, 1, 1, ramp), gamma);
+    assert(lifted.getData()[0] == 0 && lifted.getData()[4] == 255 && std::abs(lifted.getData()[1] - 128) <= 1 &&
+           "Gamma mapping wrong");
+
+    // A percentile clip ignores a single bright outlier that squashes a min/max stretch.
+    const int count = 1000;
+    float* spread = static_cast<float*>(std::malloc(sizeof(float) * (count + 1)));
+    for (int i = 0; i < count; i++) spread[i] = i / 1000.0f;
+    spread[count] = 1000.0f;
+    BasicImage<float> outlier(count + 1, 1, 1, spread);
+    OutputMapping percentile;
+    percentile.type = MappingType::Percentile;
+    percentile.lowPercent = 0.0f;
+    percentile.highPercent = 99.0f;
+    Image clipped = mapToImage(outlier, percentile);
+    Image squashed = mapToImage(outlier, OutputMapping());
+    assert(squashed.getData()[count / 2] == 0 && "MinMax should be squashed by the outlier");
+    assert(std::abs(clipped.getData()[count / 2] - 128) <= 2 && clipped.getData()[count] == 255 && "Percentile mapping wrong");
+
+    // Raw projections keep the voxel values; the default mapping reproduces the normalised MIP.
+    Volume vol;
+    bool loaded = vol.load("../Scans/TestVolume/vol");
+    assert(loaded && "Failed to load volume from Scans/TestVolume/vol");
+    BasicImage<float> rawMip = Projection::rawProjection(vol, ProjectionMode::MIP, 1, vol.getDepth());
+    Image mip = Projection::maximumIntensityProjection(vol);
+    Image mappedMip = mapToImage(rawMip, OutputMapping());
+    const size_t samples = static_cast<size_t>(mip.getWidth()) * mip.getHeight() * mip.getChannels();
+    assert(std::equal(mip.getData(), mip.getData() + samples, mappedMip.getData()) && "Mapped raw MIP differs");
+    const unsigned char* first = vol.getSlices()[0].getData();
+    assert(std::all_of(rawMip.getData(), rawMip.getData() + samples, [](float v) { return v >= 0.0f && v <= 1.0f; }) &&
+           rawMip.getData()[0] * 255.0f >= first[0] - 0.01f && "Raw MIP out of range");
+
+    // Parsing.
+    OutputMapping parsed;
+    bool ok = parseOutputMapping({ "window", "1040", "400" }, parsed);
+    assert(ok && parsed.type == MappingType::Window && parsed.center == 1040.0f && parsed.width == 400.0f && "Window not parsed");
+    ok = parseOutputMapping({ "percentile", "99", "1" }, parsed);
+    assert(!ok && "Reversed percentiles accepted");
+    ok = parseOutputMapping({ "gamma", "x" }, parsed);
+    assert(!ok && "Non-numeric gamma accepted");
+    ok = parseOutputMapping({ "sepia" }, parsed);
+    assert(!ok && outputMappingArgCount("sepia") < 0 && "Unknown mapping accepted");
+
+    std::cout << "testOutputMapping passed." << std::endl;
+}
+
+#include <filesystem>
+
+void testChannelCollapse() {
+    std::cout << "Running testChannelCollapse..." << std::endl;
+    namespace fs = std::filesystem;
+    const int w = 9, h = 7, d = 5;
+
+    // Grey RGB and RGBA volumes, and an RGB one whose last slice (past the probed ones) has colour.
+    Volume grey(w, h, d, 3), greyAlpha(w, h, d, 4), colour(w, h, d, 3);
+    for (int z = 0; z < d; z++) {
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                const unsigned char v = static_cast<unsigned char>((x * 7 + y * 13 + z * 29) % 256);
+                const unsigned char rgb[3] = { v, v, v };
+                const unsigned char rgba[4] = { v, v, v, 255 };
+                grey.setVoxel(x, y, z, rgb);
+                greyAlpha.setVoxel(x, y, z, rgba);
+                colour.setVoxel(x, y, z, rgb);
+            }
+        }
+    }
+    const unsigned char tint[3] = { 10, 200, 10 };
+    colour.setVoxel(3, 2, d - 1, tint);
+    bool saved = grey.save("apif_grey/vol") && greyAlpha.save("apif_grey_alpha/vol") && colour.save("apif_colour/vol");
+    assert(saved && "Failed to save test volumes");
+
+    Volume vol;
+    bool loaded = vol.load("apif_grey/vol", ChannelMode::Auto);
+    assert(loaded && vol.getChannels() == 1 && vol.getSourceChannels() == 3 && "Grey RGB not collapsed");
+    for (int z = 0; z < d; z++) {
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                assert(*vol.getVoxel(x, y, z) == *grey.getVoxel(x, y, z) && "Collapsed voxel differs");
+            }
+        }
+    }
+    loaded = vol.load("apif_grey/vol");
+    assert(loaded && vol.getChannels() == 3 && vol.getSourceChannels() == 3 && "Keep collapsed the channels");
+    loaded = vol.load("apif_grey_alpha/vol", ChannelMode::Auto);
+    assert(loaded && vol.getChannels() == 1 && vol.getSourceChannels() == 4 && "Grey RGBA not collapsed");
+    loaded = vol.load("apif_colour/vol", ChannelMode::Auto);
+    assert(loaded && vol.getChannels() == 3 && *vol.getVoxel(3, 2, d - 1) == 10 && "Colour slice collapsed");
+    loaded = vol.load("apif_colour/vol", ChannelMode::Collapse);
+    assert(loaded && vol.getChannels() == 1 && vol.getSourceChannels() == 3 && "Collapse kept the channels");
+
+    // Streaming makes the same choice as loading.
+    Volume collapsed;
+    loaded = collapsed.load("apif_grey/vol", ChannelMode::Auto);
+    assert(loaded && "Failed to load the grey volume");
+    SliceSeries series;
+    bool opened = series.open("apif_grey/vol", ChannelMode::Auto);
+    assert(opened && series.channels == 1 && series.sourceChannels == 3 && "Grey series not collapsed");
+    Image streamed = Projection::streamProjection<unsigned char>(series, ProjectionMode::MIP, 1, d);
+    Image mip = Projection::maximumIntensityProjection(collapsed);
+    assert(streamed.getChannels() == 1 && std::equal(mip.getData(), mip.getData() + w * h, streamed.getData()) &&
+           "Streamed grey MIP differs");
+    opened = series.open("apif_colour/vol", ChannelMode::Auto);
+    assert(opened && series.channels == 1 && "Colour series probe should only see grey slices");
+    streamed = Projection::streamProjection<unsigned char>(series, ProjectionMode::MIP, 1, d);
+    assert(streamed.getChannels() == 3 && "Streamed colour MIP collapsed");
+
+    const unsigned char translucent[8] = { 5, 5, 5, 255, 6, 6, 6, 128 };
+    const unsigned char greyAlphaPair[4] = { 5, 255, 6, 255 };
+    assert(!Volume::isGrey(translucent, 2, 4) && Volume::isGrey(translucent, 1, 4) && "Alpha not checked");
+    assert(Volume::isGrey(greyAlphaPair, 2, 2) && Volume::isGrey(translucent, 8, 1) && "Grey data rejected");
+
+    for (const char* dir : { "apif_grey", "apif_grey_alpha", "apif_colour" }) fs::remove_all(dir);
+    std::cout << "testChannelCollapse passed." << std::endl;
+}
+
+#include "CompressedVolume.h"
+
+void testCompressedVolume() {
+    std::cout << "Running testCompressedVolume..." << std::endl;
+
+    // A CT-like volume: constant air around a noisy ball, in 1 and 3 channels.
+    const int n = 64;
+    Volume scan(n, n, n, 1), colour(n, n, n, 3);
+    uint32_t state = 17;
+    for (int z = 0; z < n; z++) {
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                const int r2 = (x - 32) * (x - 32) + (y - 32) * (y - 32) + (z - 32) * (z - 32);
+                state = state * 1664525u + 1013904223u;
+                const unsigned char v = r2 < 144 ? static_cast<unsigned char>(100 + (state >> 26)) : 3;
+                const unsigned char rgb[3] = { v, static_cast<unsigned char>(v / 2), 7 };
+                scan.setVoxel(x, y, z, &v);
+                colour.setVoxel(x, y, z, rgb);
+            }
+        }
+    }
+    for (const Volume* vol : { &scan, &colour }) {
+        CompressedVolume packed(*vol);
+        assert(packed.getDepth() == n && packed.getChannels() == vol->getChannels() && "Compressed size wrong");
+        assert(packed.compressedBytes() * 2 < packed.rawBytes() && "Air did not compress");
+        Volume unpacked = packed.decompress();
+        assert(std::equal(vol->getVoxelData(), vol->getVoxelData() + packed.rawBytes(), unpacked.getVoxelData()) &&
+               "Decompressed volume differs");
+        for (ProjectionMode mode : { ProjectionMode::MIP, ProjectionMode::MinIP, ProjectionMode::Mean }) {
+            BasicImage<float> expected = Projection::rawProjection(*vol, mode, 3, n - 4);
+            BasicImage<float> actual = Projection::rawProjection(packed, mode, 3, n - 4);
+            const size_t samples = static_cast<size_t>(n) * n * vol->getChannels();
+            assert(std::equal(expected.getData(), expected.getData() + samples, actual.getData()) &&
+                   "Compressed projection differs");
+        }
+        for (const std::string plane : { "XY", "XZ", "YZ" }) {
+            Image expected = Slice::sliceVolume(*vol, plane, 30);
+            Image actual = Slice::sliceVolume(packed, plane, 30);
+            const size_t samples = static_cast<size_t>(n) * n * vol->getChannels();
+            assert(actual.getWidth() == expected.getWidth() && actual.getHeight() == expected.getHeight() &&
+                   std::equal(expected.getData(), expected.getData() + samples, actual.getData()) &&
+                   "Compressed slice differs");
+        }
+    }
+
+    // Rows longer than one token, and noise that has no runs at all.
+    Volume16 wide(70000, 2, 1, 1);
+    for (int x = 0; x < 70000; x++) {
+        state = state * 1664525u + 1013904223u;
+        const std::uint16_t v = static_cast<std::uint16_t>(state >> 16);
+        wide.setVoxel(x, 1, 0, &v);
+    }
+    CompressedVolume16 packedWide(wide);
+    Volume16 unpackedWide = packedWide.decompress();
+    assert(std::equal(wide.getVoxelData(), wide.getVoxelData() + 140000, unpackedWide.getVoxelData()) &&
+           "Long rows decompressed wrong");
+    assert(packedWide.compressedBytes() < packedWide.rawBytes() / 2 + 64 && "Noise row grew");
+
+    // Runs are found bitwise: +0.0 and -0.0 compare equal but must not share a run.
+    VolumeF zeros(32, 1, 1, 1);
+    for (int x = 16; x < 32; x++) {
+        const float negative = -0.0f;
+        zeros.setVoxel(x, 0, 0, &negative);
+    }
+    VolumeF unpackedZeros = BasicCompressedVolume<float>(zeros).decompress();
+    assert(std::memcmp(zeros.getVoxelData(), unpackedZeros.getVoxelData(), 32 * sizeof(float)) == 0 &&
+           "Signed zeros merged into one run");
+
+    // Loading compresses slice by slice and matches the volume loaded in full.
+    Volume16 ct;
+    bool loaded = ct.load("../Scans/TestVolume16/vol");
+    assert(loaded && "Failed to load volume from Scans/TestVolume16/vol");
+    CompressedVolume16 packedCt;
+    loaded = packedCt.load("../Scans/TestVolume16/vol");
+    assert(loaded && packedCt.getDepth() == ct.getDepth() && packedCt.getWidth() == ct.getWidth() && "Compressed load failed");
+    Volume16 unpackedCt = packedCt.decompress();
+    assert(std::equal(ct.getVoxelData(), ct.getVoxelData() + packedCt.rawBytes() / 2, unpackedCt.getVoxelData()) &&
+           "Compressed load differs");
+    CompressedVolume missing;
+    loaded = missing.load("../Scans/TestVolume/nothing");
+    assert(!loaded && missing.getDepth() == 0 && "Missing volume loaded");
+
+    std::cout << "testCompressedVolume passed." << std::endl;
+}
+
+namespace {
+
+    // Fills a volume with zero background and a few bright noisy blobs, so most tiles are flat.
+    template <typename T>
+    void fillSparse(BasicVolume<T>& vol, uint32_t seed) {
+        const int ch = vol.getChannels();
+        std::vector<T> pixel(ch);
+        for (int z = 0; z < vol.getDepth(); z++) {
+            for (int y = 0; y < vol.getHeight(); y++) {
+                for (int x = 0; x < vol.getWidth(); x++) {
+                    seed = seed * 1664525u + 1013904223u;
+                    const int dx = x - 20 - z, dy = y - 30;
+                    const bool blob = dx * dx + dy * dy < 100 || (x > 60 && y < 10 && z % 7 == 0);
+                    for (int c = 0; c < ch; c++) {
+                        pixel[c] = blob ? static_cast<T>(50 + (seed >> (26 - c)) % 150) : T(0);
+                    }
+                    vol.setVoxel(x, y, z, pixel.data());
+                }
+            }
+        }
+    }
+
+    // Compares projections and thresholds that use the tile ranges with direct loops.
+    template <typename T>
+    void checkBrickMap(int channels) {
+        const int w = 80, h = 70, d = 40;
+        BasicVolume<T> plain(w, h, d, channels), mapped(w, h, d, channels);
+        fillSparse(plain, 5);
+        fillSparse(mapped, 5);
+        assert(!mapped.getBrickMap() && "Edited volume kept its brick map");
+
+        const size_t samples = static_cast<size_t>(w) * h * channels;
+        const T* voxels = static_cast<const BasicVolume<T>&>(plain).getVoxelData();
+        const int ranges[][2] = { { 1, d }, { 5, 20 }, { 12, 12 }, { 0, d + 3 } };
+        for (const auto& range : ranges) {
+            const int z0 = std::max(1, range[0]) - 1;
+            const int z1 = std::min(d, range[1]) - 1;
+            for (ProjectionMode mode : { ProjectionMode::MIP, ProjectionMode::MinIP }) {
+                BasicImage<float> actual = Projection::rawProjection(mapped, mode, range[0], range[1]);
+                assert(mapped.getBrickMap() && mapped.getBrickMap()->getTilesX() == 3 &&
+                       "Projection did not build the brick map");
+                for (size_t i = 0; i < samples; i++) {
+                    T expected = voxels[z0 * samples + i];
+                    for (int z = z0 + 1; z <= z1; z++) {
+                        const T v = voxels[z * samples + i];
+                        expected = mode == ProjectionMode::MIP ? std::max(expected, v) : std::min(expected, v);
+                    }
+                    const float scaled = static_cast<float>(static_cast<double>(expected) / PixelTraits<T>::maxValue);
+                    assert(actual.getData()[i] == scaled && "Projection with brick map differs");
+                }
+            }
+        }
+
+        Filter3D* threshold = createThreshold3DFilter(120);
+        threshold->apply(mapped);
+        delete threshold;
+        const T high = static_cast<T>(PixelTraits<T>::maxValue);
+        const T* thresholded = static_cast<const BasicVolume<T>&>(mapped).getVoxelData();
+        for (size_t i = 0; i < samples * d; i++) {
+            assert(thresholded[i] == (voxels[i] < 120 ? T(0) : high) && "Threshold with brick map differs");
+        }
+        const BrickMap<T>* kept = mapped.getBrickMap();
+        assert(kept && "Threshold dropped the brick map");
+        std::copy(thresholded, thresholded + samples * d, plain.getVoxelData());
+        plain.buildBrickMap();
+        const BrickMap<T>* rebuilt = plain.getBrickMap();
+        for (int z = 0; z < d; z++) {
+            for (int ty = 0; ty < rebuilt->getTilesY(); ty++) {
+                for (int tx = 0; tx < rebuilt->getTilesX(); tx++) {
+                    assert(kept->minimum(tx, ty, z) == rebuilt->minimum(tx, ty, z) &&
+                           kept->maximum(tx, ty, z) == rebuilt->maximum(tx, ty, z) && "Threshold left a wrong range");
+                }
+            }
+        }
+
+        const T bright[4] = { 255, 255, 255, 255 };
+        mapped.setVoxel(1, 1, 1, bright);
+        assert(!mapped.getBrickMap() && "Brick map survived setVoxel");
+    }
+
+} // end anonymous namespace
+
+void testBrickMap() {
+    std::cout << "Running testBrickMap..." << std::endl;
+
+    checkBrickMap<unsigned char>(1);
+    checkBrickMap<unsigned char>(3);
+    checkBrickMap<std::uint16_t>(1);
+
+    Volume scan;
+    bool loaded = scan.load("../Scans/TestVolume/vol");
+    assert(loaded && "Failed to load volume from Scans/TestVolume/vol");
+    assert(!scan.getBrickMap() && "Load built the brick map before anything used it");
+    Image mip = Projection::maximumIntensityProjection(scan);
+    assert(scan.getBrickMap() && scan.getBrickMap()->getDepth() == scan.getDepth() && "MIP did not build the brick map");
+
+    std::cout << "testBrickMap passed." << std::endl;
+}
+
+#include "Segmentation.h"
+
+namespace {
+
+    // Labels by breadth-first search from each unlabelled voxel in z, y, x order, which
+    // numbers components in the same order as labelComponents.
+    std::vector<uint32_t> floodLabels(const Volume& vol, int threshold, int connectivity) {
+        const int w = vol.getWidth(), h = vol.getHeight(), d = vol.getDepth();
+        const int reach = connectivity == 6 ? 1 : connectivity == 18 ? 2 : 3;
+        std::vector<uint32_t> labels(static_cast<size_t>(w) * h * d, 0);
+        auto fore = [&](int x, int y, int z) {
+            return vol.getSlices()[z].getData()[(static_cast<size_t>(y) * w + x) * vol.getChannels()] >= threshold;
+        };
+        uint32_t next = 0;
+        std::vector<int> queue;
+        for (int z = 0; z < d; z++) {
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    const size_t start = (static_cast<size_t>(z) * h + y) * w + x;
+                    if (!fore(x, y, z) || labels[start]) continue;
+                    labels[start] = ++next;
+                    queue.assign(1, static_cast<int>(start));
+                    for (size_t q = 0; q < queue.size(); q++) {
+                        const int cx = queue[q] % w, cy = queue[q] / w % h, cz = queue[q] / (w * h);
+                        for (int dz = -1; dz <= 1; dz++) {
+                            for (int dy = -1; dy <= 1; dy++) {
+                                for (int dx = -1; dx <= 1; dx++) {
+                                    const int nx = cx + dx, ny = cy + dy, nz = cz + dz;
+                                    if (std::abs(dx) + std::abs(dy) + std::abs(dz) > reach) continue;
+                                    if (nx < 0 || ny < 0 || nz < 0 || nx >= w || ny >= h || nz >= d) continue;
+                                    const size_t n = (static_cast<size_t>(nz) * h + ny) * w + nx;
+                                    if (labels[n] || !fore(nx, ny, nz)) continue;
+                                    labels[n] = next;
+                                    queue.push_back(static_cast<int>(n));
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return labels;
+    }
+
+} // end anonymous namespace
+
+void testConnectedComponents() {
+    std::cout << "Running testConnectedComponents..." << std::endl;
+
+    // Edge and corner contacts tell the connectivities apart.
+    Volume pairs(8, 8, 8, 1);
+    const unsigned char on = 200;
+    pairs.setVoxel(1, 1, 1, &on);
+    pairs.setVoxel(2, 2, 1, &on); // shares an edge with (1, 1, 1)
+    pairs.setVoxel(5, 5, 5, &on);
+    pairs.setVoxel(6, 6, 6, &on); // shares a corner with (5, 5, 5)
+    assert(Segmentation::labelComponents(pairs, 100, 6).components.size() == 4 && "6-connectivity wrong");
+    assert(Segmentation::labelComponents(pairs, 100, 18).components.size() == 3 && "18-connectivity wrong");
+    ComponentLabels corner = Segmentation::labelComponents(pairs, 100, 26);
+    assert(corner.components.size() == 2 && "26-connectivity wrong");
+    const Component& second = corner.components[1];
+    assert(second.label == 2 && second.voxels == 2 && second.minX == 5 && second.maxZ == 6 &&
+           corner.at(6, 6, 6) == 2 && corner.at(0, 0, 0) == 0 && "Component stats wrong");
+    assert(!Segmentation::labelComponents(pairs, 100, 10).labels && "Bad connectivity accepted");
+
+    // Random foreground against a flood fill, with one slab and with several, so
+    // components are merged across slab boundaries.
+    const int w = 37, h = 29, d = 31;
+    Volume noise(w, h, d, 2);
+    uint32_t state = 99;
+    for (int z = 0; z < d; z++) {
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                state = state * 1664525u + 1013904223u;
+                const unsigned char v[2] = { static_cast<unsigned char>(state >> 24), 0 };
+                noise.setVoxel(x, y, z, v);
+            }
+        }
+    }
+    const int savedLimit = parallelThreadLimit();
+    for (int connectivity : { 6, 18, 26 }) {
+        const int threshold = connectivity == 6 ? 150 : 200;
+        const std::vector<uint32_t> expected = floodLabels(noise, threshold, connectivity);
+        for (int threads : { 1, 3, 8 }) {
+            parallelThreadLimit() = threads;
+            ComponentLabels result = Segmentation::labelComponents(noise, threshold, connectivity);
+            assert(std::equal(expected.begin(), expected.end(), result.labels.get()) && "Labels differ from flood fill");
+            std::vector<size_t> voxels(result.components.size(), 0);
+            for (uint32_t label : expected) {
+                if (label) voxels[label - 1]++;
+            }
+            for (size_t i = 0; i < voxels.size(); i++) {
+                assert(result.components[i].voxels == voxels[i] && "Component size wrong");
+            }
+            assert(result.components.size() > 20 && "Too few components to test merging");
+        }
+    }
+    parallelThreadLimit() = savedLimit;
+
+    std::cout << "testConnectedComponents passed." << std::endl;
+}
+
+namespace {
+
+    // Brute-force squared distance from (x, y, z) to the nearest 0 of channel c, or -1 if none.
+    template <typename T>
+    double nearestZero2(const T* data, int w, int h, int d, int ch, int c, int x, int y, int z) {
+        double best = -1;
+        for (int zz = 0; zz < d; zz++) {
+            for (int yy = 0; yy < h; yy++) {
+                for (int xx = 0; xx < w; xx++) {
+                    if (data[((static_cast<size_t>(zz) * h + yy) * w + xx) * ch + c] != T(0)) continue;
+                    const double d2 = double(xx - x) * (xx - x) + double(yy - y) * (yy - y) + double(zz - z) * (zz - z);
+                    if (best < 0 || d2 < best) best = d2;
+                }
+            }
+        }
+        return best;
+    }
+
+    template <typename T>
+    void checkDistanceVolume(int w, int h, int d, int ch, double scale, int zeroOneIn, uint32_t seed) {
+        BasicVolume<T> vol(w, h, d, ch);
+        T* data = vol.getVoxelData();
+        const size_t samples = static_cast<size_t>(w) * h * d * ch;
+        for (size_t i = 0; i < samples; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            data[i] = (seed >> 16) % zeroOneIn == 0 ? T(0) : T(1);
+        }
+        const std::vector<T> mask(data, data + samples);
+        Filter3D* distance = createDistanceTransform3DFilter(scale);
+        distance->apply(vol);
+        delete distance;
+        data = vol.getVoxelData();
+        for (int z = 0; z < d; z++) {
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    for (int c = 0; c < ch; c++) {
+                        const double d2 = nearestZero2(mask.data(), w, h, d, ch, c, x, y, z);
+                        const double expected = d2 < 0 ? std::numeric_limits<double>::infinity() : std::sqrt(d2) * scale;
+                        const T actual = data[((static_cast<size_t>(z) * h + y) * w + x) * ch + c];
+                        if constexpr (std::is_floating_point_v<T>) {
+                            assert((d2 < 0 ? std::isinf(actual) : std::abs(actual - expected) < 1e-4 * (1 + expected)) &&
+                                   "Float distance wrong");
+                        } else {
+                            assert(actual == pixelCast<T>(expected) && "Distance wrong");
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+} // end anonymous namespace
+
+void testDistanceTransform() {
+    std::cout << "Running testDistanceTransform..." << std::endl;
+
+    // Sparse zeros give long distances; dense ones short. Channel 2 of the sparse volumes
+    // often has no zero at all along a line, which tests the infinite samples.
+    checkDistanceVolume<unsigned char>(19, 13, 11, 1, 1.0, 40, 1);
+    checkDistanceVolume<unsigned char>(17, 15, 9, 3, 4.0, 200, 2);
+    checkDistanceVolume<std::uint16_t>(21, 11, 13, 1, 100.0, 7, 3);
+    checkDistanceVolume<float>(16, 16, 16, 2, 0.5, 300, 4);
+
+    // A volume with no zero saturates; float stays infinite.
+    Volume solid(5, 4, 3, 1);
+    std::fill(solid.getVoxelData(), solid.getVoxelData() + 60, static_cast<unsigned char>(9));
+    Filter3D* distance = createDistanceTransform3DFilter();
+    distance->apply(solid);
+    delete distance;
+    assert(solid.getVoxelData()[17] == 255 && "Volume without zeros not saturated");
+
+    // The 2D form matches the volume of one slice.
+    const int w = 40, h = 30;
+    Image img(w, h, 3, (unsigned char*)std::malloc(w * h * 3));
+    Volume slab(w, h, 1, 3);
+    uint32_t state = 5;
+    for (int i = 0; i < w * h * 3; i++) {
+        state = state * 1664525u + 1013904223u;
+        img.getData()[i] = slab.getVoxelData()[i] = (state >> 16) % 60 == 0 ? 0 : 255;
+    }
+    Filter2D* distance2D = createDistanceTransformFilter(2.0);
+    distance2D->apply(img);
+    delete distance2D;
+    distance = createDistanceTransform3DFilter(2.0);
+    distance->apply(slab);
+    delete distance;
+    assert(std::equal(img.getData(), img.getData() + w * h * 3, slab.getVoxelData()) && "2D distance differs");
+
+    std::cout << "testDistanceTransform passed." << std::endl;
+}
+
+namespace {
+
+    // Brute-force erosion or dilation over a box, one window per sample.
+    template <typename T>
+    std::vector<T> referenceExtreme(const std::vector<T>& in, int w, int h, int d, int ch, const int size[3],
+                                    bool dilate, EdgeMode mode) {
+        std::vector<T> out(in.size());
+        for (int z = 0; z < d; z++) {
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    for (int c = 0; c < ch; c++) {
+                        bool any = false;
+                        T best = T(0);
+                        for (int k = 0; k < size[2]; k++) {
+                            const int zz = referenceEdge(mode, z - size[2] / 2 + k, d);
+                            for (int j = 0; j < size[1]; j++) {
+                                const int yy = referenceEdge(mode, y - size[1] / 2 + j, h);
+                                for (int i = 0; i < size[0]; i++) {
+                                    const int xx = referenceEdge(mode, x - size[0] / 2 + i, w);
+                                    if (zz < 0 || yy < 0 || xx < 0) continue;
+                                    const T v = in[((static_cast<size_t>(zz) * h + yy) * w + xx) * ch + c];
+                                    if (!any || (dilate ? v > best : v < best)) best = v;
+                                    any = true;
+                                }
+                            }
+                        }
+                        out[((static_cast<size_t>(z) * h + y) * w + x) * ch + c] = best;
+                    }
+                }
+            }
+        }
+        return out;
+    }
+
+    template <typename T>
+    void checkMorphologyVolume(int w, int h, int d, int ch, int sx, int sy, int sz, EdgeMode mode, uint32_t seed) {
+        BasicVolume<T> vol(w, h, d, ch);
+        const size_t samples = static_cast<size_t>(w) * h * d * ch;
+        for (size_t i = 0; i < samples; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            vol.getVoxelData()[i] = static_cast<T>((seed >> 16) % 200);
+        }
+        const std::vector<T> input(vol.getVoxelData(), vol.getVoxelData() + samples);
+        const int size[3] = {sx, sy, sz};
+        const std::vector<T> eroded = referenceExtreme(input, w, h, d, ch, size, false, mode);
+        const std::vector<T> dilated = referenceExtreme(input, w, h, d, ch, size, true, mode);
+        const std::vector<T> opened = referenceExtreme(eroded, w, h, d, ch, size, true, mode);
+        const std::vector<T> closed = referenceExtreme(dilated, w, h, d, ch, size, false, mode);
+        const std::pair<const char*, const std::vector<T>*> cases[] = {
+            {"Erode", &eroded}, {"Dilate", &dilated}, {"Open", &opened}, {"Close", &closed}};
+        for (const auto& [operation, expected] : cases) {
+            BasicVolume<T> copy(w, h, d, ch);
+            std::copy(input.begin(), input.end(), copy.getVoxelData());
+            Filter3D* filter = createMorphology3DFilter(operation, sx, sy, sz, mode);
+            filter->apply(copy);
+            delete filter;
+            assert(std::equal(expected->begin(), expected->end(), copy.getVoxelData()) && "Morphology differs");
+        }
+    }
+
+} // end anonymous namespace
+
+void testMorphology() {
+    std::cout << "Running testMorphology..." << std::endl;
+
+    // Odd, even and oversized boxes (wider than the volume, so Reflect and Wrap go round) and
+    // strips of more than one lane along y and z (a row of 300 samples).
+    const EdgeMode modes[] = {EdgeMode::Extend, EdgeMode::Reflect, EdgeMode::Constant, EdgeMode::Wrap};
+    uint32_t seed = 11;
+    for (EdgeMode mode : modes) {
+        checkMorphologyVolume<unsigned char>(13, 9, 7, 1, 3, 5, 3, mode, seed++);
+        checkMorphologyVolume<unsigned char>(100, 5, 4, 3, 4, 2, 6, mode, seed++);
+        checkMorphologyVolume<std::uint16_t>(6, 7, 5, 2, 9, 1, 11, mode, seed++);
+        checkMorphologyVolume<float>(11, 8, 6, 1, 5, 4, 2, mode, seed++);
+    }
+
+    // The 2D filter matches the volume filter on one slice.
+    const int w = 37, h = 23, ch = 3;
+    Image img(w, h, ch, (unsigned char*)std::malloc(w * h * ch));
+    Volume slab(w, h, 1, ch);
+    for (int i = 0; i < w * h * ch; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        img.getData()[i] = slab.getVoxelData()[i] = static_cast<unsigned char>(seed >> 24);
+    }
+    Filter2D* filter2D = createMorphologyFilter("Close", 7, 4, EdgeMode::Reflect);
+    filter2D->apply(img);
+    delete filter2D;
+    Filter3D* filter3D = createMorphology3DFilter("Close", 7, 4, 5, EdgeMode::Reflect);
+    filter3D->apply(slab);
+    delete filter3D;
+    assert(std::equal(img.getData(), img.getData() + w * h * ch, slab.getVoxelData()) && "2D morphology differs");
+
+    // An unknown operation leaves the image unchanged.
+    std::vector<unsigned char> before(img.getData(), img.getData() + w * h * ch);
+    filter2D = createMorphologyFilter("Thin", 3, 3);
+    filter2D->apply(img);
+    delete filter2D;
+    assert(std::equal(before.begin(), before.end(), img.getData()) && "Unknown operation changed the image");
+
+    std::cout << "testMorphology passed." << std::endl;
+}
+
+#include "BitMask.h"
+
+namespace {
+
+    // Brute-force box dilation (any set pixel in the box) or erosion (every in-bounds pixel set).
+    std::vector<char> referenceBox(const std::vector<char>& in, int w, int h, int d, int rx, int ry, int rz, bool dilate) {
+        std::vector<char> out(in.size());
+        for (int z = 0; z < d; z++) {
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    bool result = !dilate;
+                    for (int zz = std::max(0, z - rz); zz <= std::min(d - 1, z + rz); zz++) {
+                        for (int yy = std::max(0, y - ry); yy <= std::min(h - 1, y + ry); yy++) {
+                            for (int xx = std::max(0, x - rx); xx <= std::min(w - 1, x + rx); xx++) {
+                                const bool v = in[(static_cast<size_t>(zz) * h + yy) * w + xx] != 0;
+                                result = dilate ? (result || v) : (result && v);
+                            }
+                        }
+                    }
+                    out[(static_cast<size_t>(z) * h + y) * w + x] = result;
+                }
+            }
+        }
+        return out;
+    }
+
+    void checkMaskEquals(const BitMask& mask, const std::vector<char>& expected, const char* what) {
+        const int w = mask.getWidth(), h = mask.getHeight();
+        for (int z = 0; z < mask.getDepth(); z++) {
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    if (mask.get(x, y, z) != (expected[(static_cast<size_t>(z) * h + y) * w + x] != 0)) {
+                        std::cerr << what << " differs at " << x << ", " << y << ", " << z << std::endl;
+                        assert(false && "BitMask differs from reference");
+                    }
+                }
+            }
+            // Bits past the width stay clear.
+            for (int y = 0; y < h; y++) {
+                if (w % 64 != 0) {
+                    assert((mask.row(y, z)[mask.getWordsPerRow() - 1] >> (w % 64)) == 0 && "BitMask padding set");
+                }
+            }
+        }
+    }
+
+    // A random mask, set with probability 1 / oneIn, as a Volume16 thresholded at 1.
+    std::vector<char> randomMask(Volume16& vol, int oneIn, uint32_t seed) {
+        std::vector<char> bits(static_cast<size_t>(vol.getWidth()) * vol.getHeight() * vol.getDepth());
+        for (size_t i = 0; i < bits.size(); i++) {
+            seed = seed * 1664525u + 1013904223u;
+            bits[i] = (seed >> 16) % oneIn == 0;
+            vol.getVoxelData()[i * vol.getChannels()] = bits[i] ? 700 : 0;
+        }
+        return bits;
+    }
+
+} // end anonymous namespace
+
+void testBitMask() {
+    std::cout << "Running testBitMask..." << std::endl;
+
+    // Widths below, at and across word boundaries; radii beyond one word along x.
+    const int sizes[][3] = {{13, 9, 7}, {64, 5, 4}, {130, 6, 5}};
+    const int radii[][3] = {{0, 0, 0}, {1, 1, 1}, {2, 0, 3}, {5, 3, 0}, {70, 1, 2}};
+    uint32_t seed = 3;
+    for (const auto& size : sizes) {
+        const int w = size[0], h = size[1], d = size[2];
+        Volume16 vol(w, h, d, 2);
+        const std::vector<char> bits = randomMask(vol, 9, seed++);
+        const BitMask mask = BitMask::fromVolume(vol);
+        checkMaskEquals(mask, bits, "fromVolume");
+        assert(mask.memoryBytes() == mask.getWordsPerRow() * 8 * h * d && "BitMask size wrong");
+
+        size_t expectedCount = 0;
+        std::vector<size_t> expectedSlices(d, 0);
+        for (size_t i = 0; i < bits.size(); i++) {
+            expectedCount += bits[i];
+            expectedSlices[i / (static_cast<size_t>(w) * h)] += bits[i];
+        }
+        assert(mask.count() == expectedCount && "BitMask count wrong");
+        assert(mask.sliceCounts() == expectedSlices && "BitMask slice counts wrong");
+
+        for (const auto& r : radii) {
+            BitMask dilated = BitMask::fromVolume(vol);
+            dilated.dilate(r[0], r[1], r[2]);
+            checkMaskEquals(dilated, referenceBox(bits, w, h, d, r[0], r[1], r[2], true), "dilate");
+            BitMask eroded = dilated;
+            eroded.erode(r[0], r[1], r[2]);
+            checkMaskEquals(eroded, referenceBox(referenceBox(bits, w, h, d, r[0], r[1], r[2], true),
+                                                 w, h, d, r[0], r[1], r[2], false), "erode");
+        }
+
+        // Boolean operations against a second mask.
+        Volume16 other(w, h, d, 2);
+        const std::vector<char> otherBits = randomMask(other, 3, seed++);
+        const BitMask b = BitMask::fromVolume(other);
+        std::vector<char> both(bits.size()), either(bits.size()), one(bits.size()), minus(bits.size()), inverse(bits.size());
+        for (size_t i = 0; i < bits.size(); i++) {
+            both[i] = bits[i] && otherBits[i];
+            either[i] = bits[i] || otherBits[i];
+            one[i] = bits[i] != otherBits[i];
+            minus[i] = bits[i] && !otherBits[i];
+            inverse[i] = !bits[i];
+        }
+        BitMask m = mask;
+        m &= b;
+        checkMaskEquals(m, both, "AND");
+        m = mask;
+        m |= b;
+        checkMaskEquals(m, either, "OR");
+        m = mask;
+        m ^= b;
+        checkMaskEquals(m, one, "XOR");
+        m = mask;
+        m.subtract(b);
+        checkMaskEquals(m, minus, "subtract");
+        m = mask;
+        m.invert();
+        checkMaskEquals(m, inverse, "invert");
+        assert(m.count() == bits.size() - expectedCount && "Inverted count wrong");
+
+        // A mask of another size is left unchanged.
+        m = mask;
+        m &= BitMask(w + 1, h, d);
+        checkMaskEquals(m, bits, "mismatched AND");
+
+        // Back to voxels.
+        const Volume back = mask.toVolume<unsigned char>();
+        for (size_t i = 0; i < bits.size(); i++) {
+            assert(back.getVoxelData()[i] == (bits[i] ? 255 : 0) && "toVolume wrong");
+        }
+    }
+
+    // Thresholds on the voxel scale, and the output of a 2D threshold filter.
+    Volume16 vol(20, 3, 2, 1);
+    for (int i = 0; i < 120; i++) vol.getVoxelData()[i] = static_cast<std::uint16_t>(i * 500);
+    assert(BitMask::fromVolume(vol, 30000.5).count() == 59 && "Threshold between values wrong");
+    assert(BitMask::fromVolume(vol, 70000).count() == 0 && "Threshold above range wrong");
+    assert(BitMask::fromVolume(vol, -5).count() == 120 && "Threshold below range wrong");
+
+    Image img;
+    img.load("../Images/small.png");
+    Filter2D* threshold = createThresholdFilter(128, "HSV");
+    threshold->apply(img);
+    delete threshold;
+    const BitMask imageMask = BitMask::fromImage(img);
+    const Image expanded = imageMask.toImage();
+    size_t set = 0;
+    for (int i = 0; i < img.getWidth() * img.getHeight(); i++) {
+        const unsigned char v = img.getData()[i * img.getChannels()];
+        assert((v == 0 || v == 255) && "Threshold output not binary");
+        assert(expanded.getData()[i] == v && "toImage does not match the threshold output");
+        set += v != 0;
+    }
+    assert(imageMask.count() == set && "Image mask count wrong");
+    assert(imageMask.memoryBytes() * 8 <= static_cast<size_t>(img.getHeight()) * (img.getWidth() + 63) &&
+           "Image mask not bit-packed");
+
+    std::cout << "testBitMask passed." << std::endl;
+}
+
+#include "Convolution.h"
+#include "FFT.h"
+#include <complex>
+#include <sstream>
+
+namespace {
+
+    double randomWeight(uint32_t& seed) {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<double>(seed >> 8) / (1u << 24) * 1.5 - 0.5;
+    }
+
+    ConvolutionKernel randomKernel(int kw, int kh, int kd, uint32_t& seed) {
+        ConvolutionKernel kernel;
+        kernel.width = kw;
+        kernel.height = kh;
+        kernel.depth = kd;
+        for (int i = 0; i < kw * kh * kd; i++) kernel.weights.push_back(randomWeight(seed) * 2.0 / (kw * kh * kd));
+        return kernel;
+    }
+
+    ConvolutionKernel outerProductKernel(int kw, int kh, int kd, uint32_t& seed) {
+        std::vector<double> fx(kw), fy(kh), fz(kd);
+        for (double& f : fx) f = randomWeight(seed) + 0.6;
+        for (double& f : fy) f = randomWeight(seed) + 0.6;
+        for (double& f : fz) f = randomWeight(seed) + 0.6;
+        ConvolutionKernel kernel;
+        kernel.width = kw;
+        kernel.height = kh;
+        kernel.depth = kd;
+        for (int k = 0; k < kd; k++) {
+            for (int j = 0; j < kh; j++) {
+                for (int i = 0; i < kw; i++) kernel.weights.push_back(fx[i] * fy[j] * fz[k] / (kw * kh * kd));
+            }
+        }
+        return kernel;
+    }
+
+    // Brute-force correlation: every tap of every sample, read through the edge mode.
+    template <typename T>
+    std::vector<T> referenceConvolution(const std::vector<T>& in, int w, int h, int d, int ch,
+                                        const ConvolutionKernel& kernel, EdgeMode mode) {
+        std::vector<T> out(in.size());
+        for (int z = 0; z < d; z++) {
+            for (int y = 0; y < h; y++) {
+                for (int x = 0; x < w; x++) {
+                    for (int c = 0; c < ch; c++) {
+                        double sum = 0.0;
+                        for (int k = 0; k < kernel.depth; k++) {
+                            const int zz = referenceEdge(mode, z - kernel.depth / 2 + k, d);
+                            for (int j = 0; j < kernel.height; j++) {
+                                const int yy = referenceEdge(mode, y - kernel.height / 2 + j, h);
+                                for (int i = 0; i < kernel.width; i++) {
+                                    const int xx = referenceEdge(mode, x - kernel.width / 2 + i, w);
+                                    if (zz < 0 || yy < 0 || xx < 0) continue;
+                                    sum += kernel.at(i, j, k) * in[((static_cast<size_t>(zz) * h + yy) * w + xx) * ch + c];
+                                }
+                            }
+                        }
+                        out[((static_cast<size_t>(z) * h + y) * w + x) * ch + c] = pixelCast<T>(sum);
+                    }
+                }
+            }
+        }
+        return out;
+    }
+
+    // Integer results may round the other way at .5; float ones differ by float rounding.
+    template <typename T>
+    void checkConvolution(int w, int h, int d, int ch, const ConvolutionKernel& kernel, EdgeMode mode,
+                          ConvolutionMethod method, uint32_t seed) {
+        const size_t samples = static_cast<size_t>(w) * h * d * ch;
+        std::vector<T> data(samples);
+        for (T& v : data) {
+            seed = seed * 1664525u + 1013904223u;
+            v = static_cast<T>((seed >> 16) % 200);
+        }
+        const std::vector<T> expected = referenceConvolution(data, w, h, d, ch, kernel, mode);
+        Convolution::apply(data.data(), w, h, d, ch, kernel, mode, method);
+        const double tolerance = std::is_floating_point_v<T> ? 1e-2 : 1.0;
+        for (size_t i = 0; i < samples; i++) {
+            assert(std::abs(static_cast<double>(data[i]) - expected[i]) <= tolerance && "Convolution differs");
+        }
+    }
+
+} // end anonymous namespace
+
+void testConvolution() {
+    std::cout << "Running testConvolution..." << std::endl;
+
+    // The FFT matches a direct DFT, and the inverse undoes it.
+    uint32_t seed = 17;
+    for (int n : {1, 2, 8, 64}) {
+        std::vector<std::complex<double>> x(n);
+        for (auto& v : x) v = {randomWeight(seed), randomWeight(seed)};
+        std::vector<std::complex<double>> X = x;
+        const FFT fft(n);
+        fft.forward(X.data());
+        for (int k = 0; k < n; k++) {
+            std::complex<double> sum = 0.0;
+            for (int j = 0; j < n; j++) sum += x[j] * std::polar(1.0, -2.0 * M_PI * j * k / n);
+            assert(std::abs(X[k] - sum) < 1e-9 * n && "FFT differs from the DFT");
+        }
+        fft.inverse(X.data());
+        for (int j = 0; j < n; j++) assert(std::abs(X[j] - x[j]) < 1e-12 * n && "Inverse FFT differs");
+    }
+    assert(FFT::nextPowerOfTwo(1) == 1 && FFT::nextPowerOfTwo(33) == 64 && FFT::nextPowerOfTwo(64) == 64);
+
+    // Kernel text: commas or spaces, comments, slices split by blank lines, normalize.
+    ConvolutionKernel kernel;
+    std::istringstream text("# two slices\n1, 2, 3\n4 5 6\n\n\n7 8 9\n10 11 12\n");
+    assert(ConvolutionKernel::parse(text, "text", kernel));
+    assert(kernel.width == 3 && kernel.height == 2 && kernel.depth == 2);
+    assert(kernel.at(2, 0) == 3.0 && kernel.at(0, 1, 1) == 10.0);
+    std::istringstream normalized("normalize\n1 1\n1 1\n");
+    assert(ConvolutionKernel::parse(normalized, "text", kernel) && kernel.at(1, 1) == 0.25);
+    for (const char* bad : {"1 2\n3\n", "1 2\n3 4\n\n5 6\n", "1 x\n", "# nothing\n", "normalize\n1 -1\n"}) {
+        std::istringstream in(bad);
+        assert(!ConvolutionKernel::parse(in, "text", kernel) && "Malformed kernel accepted");
+    }
+
+    // Outer products split into factors; other kernels do not.
+    std::vector<double> fx, fy, fz;
+    const ConvolutionKernel separable = outerProductKernel(5, 3, 4, seed);
+    assert(Convolution::separate(separable, fx, fy, fz));
+    for (int k = 0; k < 4; k++) {
+        for (int j = 0; j < 3; j++) {
+            for (int i = 0; i < 5; i++) assert(std::abs(fx[i] * fy[j] * fz[k] - separable.at(i, j, k)) < 1e-12);
+        }
+    }
+    assert(!Convolution::separate(randomKernel(3, 3, 1, seed), fx, fy, fz));
+
+    // Small kernels run directly, outer products per axis and large dense kernels with the FFT.
+    assert(Convolution::chooseMethod(randomKernel(3, 3, 1, seed), 512, 512, 1) == ConvolutionMethod::Direct);
+    assert(Convolution::chooseMethod(outerProductKernel(15, 15, 1, seed), 512, 512, 1) == ConvolutionMethod::Separable);
+    assert(Convolution::chooseMethod(randomKernel(31, 31, 1, seed), 512, 512, 1) == ConvolutionMethod::FFT);
+    assert(Convolution::chooseMethod(randomKernel(9, 9, 9, seed), 128, 128, 128) == ConvolutionMethod::FFT);
+
+    // Every method matches brute force for every edge mode, including odd and even kernels,
+    // kernels larger than the data, and FFT tilings with several tiles (and an odd count).
+    const EdgeMode modes[] = {EdgeMode::Extend, EdgeMode::Reflect, EdgeMode::Constant, EdgeMode::Wrap};
+    const ConvolutionMethod methods[] = {ConvolutionMethod::Direct, ConvolutionMethod::Separable, ConvolutionMethod::FFT};
+    for (EdgeMode mode : modes) {
+        for (ConvolutionMethod method : methods) {
+            const auto make = [&](int kw, int kh, int kd) {
+                return method == ConvolutionMethod::Separable ? outerProductKernel(kw, kh, kd, seed)
+                                                              : randomKernel(kw, kh, kd, seed);
+            };
+            checkConvolution<unsigned char>(23, 17, 1, 3, make(5, 3, 1), mode, method, seed++);
+            checkConvolution<std::uint16_t>(13, 11, 6, 2, make(3, 4, 5), mode, method, seed++);
+            checkConvolution<float>(9, 7, 5, 1, make(4, 3, 2), mode, method, seed++);
+            checkConvolution<float>(6, 5, 1, 1, make(9, 7, 1), mode, method, seed++);
+        }
+        checkConvolution<unsigned char>(270, 50, 1, 1, randomKernel(9, 9, 1, seed), mode, ConvolutionMethod::FFT, seed++);
+        checkConvolution<unsigned char>(300, 130, 1, 1, randomKernel(9, 9, 1, seed), mode, ConvolutionMethod::FFT, seed++);
+        checkConvolution<float>(70, 40, 40, 1, randomKernel(5, 5, 5, seed), mode, ConvolutionMethod::FFT, seed++);
+    }
+
+    // The filters read kernel files; a missing file or a 3D kernel for an image changes nothing.
+    const std::string path = "test_convolution_kernel.txt";
+    {
+        std::ofstream file(path);
+        file << "# emboss\n-2 -1 0\n-1 1 1\n0 1 2\n";
+    }
+    const int w = 31, h = 19, ch = 3;
+    Image img(w, h, ch, (unsigned char*)std::malloc(w * h * ch));
+    for (int i = 0; i < w * h * ch; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        img.getData()[i] = static_cast<unsigned char>(seed >> 24);
+    }
+    std::vector<unsigned char> before(img.getData(), img.getData() + w * h * ch);
+    assert(ConvolutionKernel::load(path, kernel));
+    std::vector<unsigned char> expected = before;
+    Convolution::apply(expected.data(), w, h, 1, ch, kernel, EdgeMode::Reflect);
+    Filter2D* filter = createConvolutionFilter(path, EdgeMode::Reflect);
+    filter->apply(img);
+    delete filter;
+    assert(std::equal(expected.begin(), expected.end(), img.getData()) && "Convolution filter differs");
+    std::copy(before.begin(), before.end(), img.getData());
+    filter = createConvolutionFilter("no_such_kernel.txt");
+    filter->apply(img);
+    delete filter;
+    {
+        std::ofstream file(path);
+        file << "1\n\n1\n";
+    }
+    filter = createConvolutionFilter(path);
+    filter->apply(img);
+    delete filter;
+    assert(std::equal(before.begin(), before.end(), img.getData()) && "Convolution filter changed the image");
+    Volume vol(w, h, 1, ch);
+    std::copy(before.begin(), before.end(), vol.getVoxelData());
+    Filter3D* filter3D = createConvolution3DFilter(path, EdgeMode::Constant);
+    filter3D->apply(vol);
+    delete filter3D;
+    assert(std::equal(before.begin(), before.end(), vol.getVoxelData()) && "Identity kernel changed the volume");
+    std::remove(path.c_str());
+
+    std::cout << "testConvolution passed." << std::endl;
+}
+
 // Implementation of TestSuite class: manages and runs all tests.
 int TestSuite::runAllTests() {
     int failCount = 0;
@@ -63,6 +63,9 @@ void testGaussianBlur();
 /** @brief Tests median blur functionality. */
 void testMedianBlur();
 
+/** @brief Tests the per-channel blur kernel specialisations against a direct reference. */
+void testBlurKernelChannels();
+
 /** @brief Tests image sharpening functionality. */
 void testSharpen();
 
@@ -82,4 +85,73 @@ void testGaussianBlur3D();
 /** @brief Tests 3D median blur functionality. */
 void testMedianBlur3D();
 
+/** @brief Tests image and volume pyramid construction. */
+void testPyramid();
+
+/** @brief Tests incremental projection updates. */
+void testProjectionAccumulator();
+
+/** @brief Tests sliding thick-slab projection stacks. */
+void testSlabStack();
+
+/** @brief Tests ray-cast projections from arbitrary directions. */
+void testRayCaster();
+
+/** @brief Tests oblique and curved multi-planar reformats. */
+void testMultiPlanarReformat();
+
+/** @brief Tests loading, projecting, slicing and blurring 16-bit volumes. */
+void testSixteenBitVolume();
+
+/** @brief Tests per-stage profiling scopes and the trace export. */
+void testProfiler();
+
+/** @brief Tests the volume cache, request handling and socket round trip of the server. */
+void testServer();
+
+/** @brief Tests the deflate checksums, PNG round trips at every level and the async writer. */
+void testPngEncoder();
+
+/** @brief Tests the built-in PNG decoder on encoder output, truncated files and stb_image parity. */
+void testPngDecoder();
+
+/** @brief Tests decoding into caller buffers, image views and the contiguous volume store. */
+void testDecodeInto();
+
+/** @brief Tests the shared thread pool, row-band tiling and thread-count independence of the 2D filters. */
+void testThreadPool();
+
+/** @brief Tests the per-channel min/max/sum reduction, the fused remap and auto brightness on top of them. */
+void testReduction();
+
+/** @brief Tests that projections streamed from disk match the in-memory MIP, MinIP and mean. */
+void testStreamingProjection();
+
+/** @brief Tests the fused output mappings (window, min/max, gamma, percentile) and raw projections. */
+void testOutputMapping();
+
+/** @brief Tests collapsing grey RGB/RGBA slices to one channel when loading and streaming. */
+void testChannelCollapse();
+
+/** @brief Tests the run-length encoded volume store and the projections and slices read from it. */
+void testCompressedVolume();
+
+/** @brief Tests the per-tile min/max ranges and the MIP, MinIP and threshold paths that skip tiles with them. */
+void testBrickMap();
+
+/** @brief Tests 3D connected-component labelling against a flood fill for 6, 18 and 26 connectivity. */
+void testConnectedComponents();
+
+/** @brief Tests the 2D and 3D Euclidean distance transforms against a brute-force nearest-zero search. */
+void testDistanceTransform();
+
+/** @brief Tests 2D and 3D erosion, dilation, opening and closing against brute force for every edge mode. */
+void testMorphology();
+
+/** @brief Tests bit-packed masks: conversion, counts, boolean operations and dilation/erosion against brute force. */
+void testBitMask();
+
+/** @brief Tests the FFT, kernel files and direct, separable and FFT convolution against brute force for every edge mode. */
+void testConvolution();
+
 #endif // TEST_H
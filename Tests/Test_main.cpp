@@ -12,6 +12,7 @@ int main() {
     suite.addTest(testBoxBlur, "testBoxBlur");
     suite.addTest(testGaussianBlur, "testGaussianBlur");
     suite.addTest(testMedianBlur, "testMedianBlur");
+    suite.addTest(testBlurKernelChannels, "testBlurKernelChannels");
     suite.addTest(testSharpen, "testSharpen");
     suite.addTest(testEdgeDetection, "testEdgeDetection");
 
@@ -20,6 +21,29 @@ int main() {
     suite.addTest(testSlice3D, "testSlice3D");
     suite.addTest(testGaussianBlur3D, "testGaussianBlur3D");
     suite.addTest(testMedianBlur3D, "testMedianBlur3D");
+    suite.addTest(testPyramid, "testPyramid");
+    suite.addTest(testProjectionAccumulator, "testProjectionAccumulator");
+    suite.addTest(testSlabStack, "testSlabStack");
+    suite.addTest(testRayCaster, "testRayCaster");
+    suite.addTest(testMultiPlanarReformat, "testMultiPlanarReformat");
+    suite.addTest(testSixteenBitVolume, "testSixteenBitVolume");
+    suite.addTest(testProfiler, "testProfiler");
+    suite.addTest(testServer, "testServer");
+    suite.addTest(testPngEncoder, "testPngEncoder");
+    suite.addTest(testPngDecoder, "testPngDecoder");
+    suite.addTest(testDecodeInto, "testDecodeInto");
+    suite.addTest(testThreadPool, "testThreadPool");
+    suite.addTest(testReduction, "testReduction");
+    suite.addTest(testStreamingProjection, "testStreamingProjection");
+    suite.addTest(testOutputMapping, "testOutputMapping");
+    suite.addTest(testChannelCollapse, "testChannelCollapse");
+    suite.addTest(testCompressedVolume, "testCompressedVolume");
+    suite.addTest(testBrickMap, "testBrickMap");
+    suite.addTest(testConnectedComponents, "testConnectedComponents");
+    suite.addTest(testDistanceTransform, "testDistanceTransform");
+    suite.addTest(testMorphology, "testMorphology");
+    suite.addTest(testBitMask, "testBitMask");
+    suite.addTest(testConvolution, "testConvolution");
 
     // Run all tests and return the number of failures
     int failures = suite.runAllTests();
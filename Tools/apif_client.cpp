@@ -0,0 +1,75 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * Minimal client for `APImageFilters --serve`. The arguments after the socket path are sent
+ * as one request, exactly as they would be passed to APImageFilters:
+ *
+ *   apif_client /tmp/apif.sock -d Scans/TestVolume/vol -p MIP out.png
+ *   apif_client /tmp/apif.sock --save slice.png -d Scans/TestVolume/vol -s XZ 16 -
+ *   apif_client /tmp/apif.sock STATS
+ *
+ * Paths are resolved by the server, relative to its working directory. With an output of
+ * "-", the returned PNG is written to the --save file, or to stdout.
+ */
+#include "ServerProtocol.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <socket_path> [--save <file>] <request arguments...>\n";
+        return 1;
+    }
+    const std::string socketPath = argv[1];
+    std::string saveFile;
+    int idx = 2;
+    if (std::string(argv[idx]) == "--save" && idx + 1 < argc) {
+        saveFile = argv[idx + 1];
+        idx += 2;
+    }
+    std::vector<std::string> args(argv + idx, argv + argc);
+    if (args.empty()) {
+        std::cerr << "[Client] Nothing to send.\n";
+        return 1;
+    }
+
+    ServerConnection connection;
+    if (!connection.connect(socketPath)) {
+        return 1;
+    }
+    ServerResponse response;
+    if (!connection.request(joinRequest(args), response)) {
+        std::cerr << "[Client] Connection to the server was lost.\n";
+        return 1;
+    }
+    if (!response.ok) {
+        std::cerr << "[Client] Server error: " << response.message << "\n";
+        return 1;
+    }
+    if (response.data.empty()) {
+        return 0;
+    }
+    if (!saveFile.empty()) {
+        std::ofstream out(saveFile, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(response.data.data()), static_cast<std::streamsize>(response.data.size()));
+        if (!out) {
+            std::cerr << "[Client] Cannot write " << saveFile << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    std::cout.write(reinterpret_cast<const char*>(response.data.data()), static_cast<std::streamsize>(response.data.size()));
+    return 0;
+}
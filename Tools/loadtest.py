@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Load test for `APImageFilters --serve`.
+
+Opens --concurrency persistent connections and sends the same request on each until
+--requests have completed, then reports throughput and latency percentiles. Start the
+server first, e.g.
+
+    ./build/APImageFilters --serve /tmp/apif.sock &
+    python3 Tools/loadtest.py /tmp/apif.sock --requests 500 --concurrency 4 \
+        --request "-d Scans/TestVolume/vol -p MIP -"
+
+The first request for a volume loads it into the server's cache; use --warmup (default 1)
+to keep that load out of the measurements.
+"""
+import argparse
+import socket
+import sys
+import threading
+import time
+
+
+def read_response(sock, buf):
+    """Reads one "OK <n>" / "ERR <msg>" response. Returns (ok, payload_or_message, buf)."""
+    while b"\n" not in buf:
+        chunk = sock.recv(65536)
+        if not chunk:
+            raise ConnectionError("server closed the connection")
+        buf += chunk
+    header, buf = buf.split(b"\n", 1)
+    header = header.decode()
+    if header.startswith("ERR "):
+        return False, header[4:], buf
+    size = int(header[3:])
+    while len(buf) < size:
+        chunk = sock.recv(65536)
+        if not chunk:
+            raise ConnectionError("server closed the connection")
+        buf += chunk
+    return True, buf[:size], buf[size:]
+
+
+def connect(path):
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(path)
+    return sock
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return 0.0
+    k = min(len(sorted_values) - 1, max(0, int(round(p / 100.0 * len(sorted_values))) - 1))
+    return sorted_values[k]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("socket", help="server socket path")
+    parser.add_argument("--request", default="-d Scans/TestVolume/vol -p MIP -",
+                        help="request line (CLI arguments without the program name)")
+    parser.add_argument("--requests", type=int, default=200, help="total timed requests")
+    parser.add_argument("--concurrency", type=int, default=1, help="parallel connections")
+    parser.add_argument("--warmup", type=int, default=1, help="untimed requests sent first")
+    args = parser.parse_args()
+
+    line = (args.request.strip() + "\n").encode()
+
+    sock = connect(args.socket)
+    buf = b""
+    for _ in range(args.warmup):
+        sock.sendall(line)
+        ok, payload, buf = read_response(sock, buf)
+        if not ok:
+            sys.exit("warm-up request failed: %s" % payload)
+    sock.close()
+
+    latencies = []
+    errors = [0]
+    lock = threading.Lock()
+    remaining = [args.requests]
+
+    def worker():
+        conn = connect(args.socket)
+        pending = b""
+        while True:
+            with lock:
+                if remaining[0] == 0:
+                    break
+                remaining[0] -= 1
+            start = time.perf_counter()
+            conn.sendall(line)
+            ok, _, pending = read_response(conn, pending)
+            elapsed = time.perf_counter() - start
+            with lock:
+                latencies.append(elapsed)
+                if not ok:
+                    errors[0] += 1
+        conn.close()
+
+    threads = [threading.Thread(target=worker) for _ in range(max(1, args.concurrency))]
+    wall_start = time.perf_counter()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    wall = time.perf_counter() - wall_start
+
+    latencies.sort()
+    ms = lambda s: s * 1000.0
+    print("requests     %d (%d errors) over %d connection(s)" % (len(latencies), errors[0], len(threads)))
+    print("throughput   %.1f requests/s" % (len(latencies) / wall if wall > 0 else 0.0))
+    print("latency ms   p50 %.2f  p90 %.2f  p99 %.2f  max %.2f" % (
+        ms(percentile(latencies, 50)), ms(percentile(latencies, 90)),
+        ms(percentile(latencies, 99)), ms(latencies[-1]) if latencies else 0.0))
+    return 1 if errors[0] else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -29,6 +29,52 @@ add_test(NAME ThresholdHSL64 COMMAND APImageFilters -i ${SOURCE_DIR}/Images/smal
 add_test(NAME MultiFilter COMMAND APImageFilters
          -i ${SOURCE_DIR}/Images/small.png -b 100 -g -r Gaussian 5 1.0 -e Sobel ${OUTPUT_DIR}/multifilter.png)
 
+add_test(NAME PyramidLevelBox COMMAND APImageFilters -i ${SOURCE_DIR}/Images/gracehopper.png --level 2 -g ${OUTPUT_DIR}/pyramid1.png)
+add_test(NAME PyramidLevelGaussian COMMAND APImageFilters -i ${SOURCE_DIR}/Images/gracehopper.png --level 1 Gaussian -r Box 3 ${OUTPUT_DIR}/pyramid2.png)
+
+# Oblique and curved multi-planar reformats
+add_test(NAME SliceOblique COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --oblique 16 16 16 1 1 1 ${OUTPUT_DIR}/sliceOblique.png)
+add_test(NAME SliceCurved COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --curved "1,1,1;16,24,1;32,8,1" Nearest ${OUTPUT_DIR}/sliceCurved.png)
+
+# 16-bit CT slices are projected and sliced at full precision
+add_test(NAME SixteenBitProjectionMIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume16/vol -p MIP ${OUTPUT_DIR}/projectionMIP16.png)
+add_test(NAME SixteenBitSliceXZGaussian COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume16/vol --blur3d Gaussian 3 1.0 -s XZ 8 ${OUTPUT_DIR}/sliceXZ16.png)
+add_test(NAME ProfileProjectionMIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol -p MIP --profile ${OUTPUT_DIR}/profileMIP.json ${OUTPUT_DIR}/projectionMIPProfiled.png)
+add_test(NAME SlabStackStoredPng COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --slab MIP 8 --png-level 0 ${OUTPUT_DIR}/slabStored/slab.png)
+add_test(NAME BlurGaussianTwoThreads COMMAND APImageFilters
+         -i ${SOURCE_DIR}/Images/gracehopper.png -r Gaussian 5 2.0 --threads 2 ${OUTPUT_DIR}/blurThreads2.png)
+add_test(NAME SixteenBitProjectionMIPWindow COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume16/vol -p MIP --map window 1040 400 ${OUTPUT_DIR}/projectionMIP16Window.png)
+add_test(NAME ProjectionMeanPercentile COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol -p meanAIP --map percentile 2 98 ${OUTPUT_DIR}/projectionMeanPercentile.png)
+add_test(NAME CompressedProjectionMIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol -p MIP --compressed ${OUTPUT_DIR}/projectionMIPCompressed.png)
+add_test(NAME CompressedSixteenBitSliceYZ COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume16/vol -s YZ 5 --compressed ${OUTPUT_DIR}/sliceYZ16Compressed.png)
+add_test(NAME ThresholdProjectionMIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --threshold3d 100 -p MIP ${OUTPUT_DIR}/projectionMIPThreshold.png)
+add_test(NAME ComponentsCsv COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --components 100 6 ${OUTPUT_DIR}/components.csv)
+add_test(NAME DistanceProjectionMIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --threshold3d 100 --distance3d 4 -p MIP ${OUTPUT_DIR}/projectionMIPDistance.png)
+add_test(NAME DistanceImage COMMAND APImageFilters -i ${SOURCE_DIR}/Images/small.png -t 128 HSV --distance 2 ${OUTPUT_DIR}/distance.png)
+add_test(NAME MorphologyImage COMMAND APImageFilters -i ${SOURCE_DIR}/Images/small.png -t 128 HSV --morph Open 5 Reflect ${OUTPUT_DIR}/morphology.png)
+add_test(NAME MorphologyProjectionMIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --threshold3d 100 --morph3d Close 7 -p MIP ${OUTPUT_DIR}/projectionMIPClosed.png)
+add_test(NAME ConvolveImage COMMAND APImageFilters -i ${SOURCE_DIR}/Images/small.png --convolve ${SOURCE_DIR}/Kernels/emboss.txt ${OUTPUT_DIR}/emboss.png)
+add_test(NAME ConvolveDiscImage COMMAND APImageFilters -i ${SOURCE_DIR}/Images/small.png --convolve ${SOURCE_DIR}/Kernels/disc21.txt Reflect ${OUTPUT_DIR}/disc.png)
+add_test(NAME ConvolveProjectionMIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --convolve3d ${SOURCE_DIR}/Kernels/binomial3d.txt -p MIP ${OUTPUT_DIR}/projectionMIPConvolved.png)
+add_test(NAME ConvolveMissingKernel COMMAND APImageFilters -i ${SOURCE_DIR}/Images/small.png --convolve ${SOURCE_DIR}/Kernels/no_such_kernel.txt ${OUTPUT_DIR}/missingKernel.png)
+add_test(NAME BenchmarkSmoke COMMAND benchmarks
+         --size smoke --min-time 0 --threads 1,2 --json ${OUTPUT_DIR}/benchmarks.json)
+
 # Give these short timeouts, since the test image is small
 set_tests_properties(Brightness1 PROPERTIES TIMEOUT 10)
 set_tests_properties(Brightness2 PROPERTIES TIMEOUT 10)
@@ -50,6 +96,8 @@ set_tests_properties(SaltPepper75 PROPERTIES TIMEOUT 10)
 set_tests_properties(ThresholdHSV128 PROPERTIES TIMEOUT 10)
 set_tests_properties(ThresholdHSL64 PROPERTIES TIMEOUT 10)
 set_tests_properties(MultiFilter PROPERTIES TIMEOUT 60)
+set_tests_properties(PyramidLevelBox PROPERTIES TIMEOUT 10)
+set_tests_properties(PyramidLevelGaussian PROPERTIES TIMEOUT 10)
 
 ### TEST CORE VOLUME PROCESSING FUNCTIONALITY ###
 add_test(NAME SliceXZ COMMAND APImageFilters -d ${SOURCE_DIR}/Scans/TestVolume/vol -s XZ 16 ${OUTPUT_DIR}/sliceXZ.png)
@@ -83,6 +131,24 @@ add_test(NAME ThinSlabSliceXZGaussian COMMAND APImageFilters
 add_test(NAME ThinSlabProjectMIPMedian COMMAND APImageFilters
          -d ${SOURCE_DIR}/Scans/TestVolume/vol --first 4 --last 28 -r Median 3 -p MIP ${OUTPUT_DIR}/projectionMIPMedianthinslab.png)
 
+# Preview runs on a reduced pyramid level
+add_test(NAME PyramidProjectionMIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --level 1 -p MIP ${OUTPUT_DIR}/projectionMIPlevel1.png)
+add_test(NAME PyramidSliceXZ COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --level 1 Gaussian -s XZ 8 ${OUTPUT_DIR}/sliceXZlevel1.png)
+
+# Thick-slab movies written as numbered series
+add_test(NAME SlabStackMIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --slab MIP 8 ${OUTPUT_DIR}/slabMIP/frame.png)
+add_test(NAME SlabStackMeanAIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --slab meanAIP 4 ${OUTPUT_DIR}/slabMean/frame.png)
+
+# Ray-cast views from arbitrary directions
+add_test(NAME RenderMIPOblique COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --render MIP 30 20 ${OUTPUT_DIR}/renderMIP.png)
+add_test(NAME RenderOrbitMeanAIP COMMAND APImageFilters
+         -d ${SOURCE_DIR}/Scans/TestVolume/vol --orbit meanAIP 8 15 ${OUTPUT_DIR}/orbitMean/view.png)
+
 # Give these short timeouts, since the test volume is small
 set_tests_properties(SliceXZ PROPERTIES TIMEOUT 60)
 set_tests_properties(SliceYZ PROPERTIES TIMEOUT 60)
@@ -102,4 +168,31 @@ set_tests_properties(ThinSlabProjectionMIP PROPERTIES TIMEOUT 60)
 set_tests_properties(ThinSlabProjectionMinIP PROPERTIES TIMEOUT 60)
 set_tests_properties(ThinSlabSliceXZGaussian PROPERTIES TIMEOUT 120)
 set_tests_properties(ThinSlabProjectMIPMedian PROPERTIES TIMEOUT 120)
-
+set_tests_properties(PyramidProjectionMIP PROPERTIES TIMEOUT 60)
+set_tests_properties(PyramidSliceXZ PROPERTIES TIMEOUT 60)
+set_tests_properties(SlabStackMIP PROPERTIES TIMEOUT 60)
+set_tests_properties(SlabStackMeanAIP PROPERTIES TIMEOUT 60)
+set_tests_properties(RenderMIPOblique PROPERTIES TIMEOUT 60)
+set_tests_properties(RenderOrbitMeanAIP PROPERTIES TIMEOUT 60)
+set_tests_properties(SliceOblique PROPERTIES TIMEOUT 60)
+set_tests_properties(SliceCurved PROPERTIES TIMEOUT 60)
+set_tests_properties(SixteenBitProjectionMIP PROPERTIES TIMEOUT 60)
+set_tests_properties(SixteenBitSliceXZGaussian PROPERTIES TIMEOUT 60)
+set_tests_properties(BenchmarkSmoke PROPERTIES TIMEOUT 60)
+set_tests_properties(ProfileProjectionMIP PROPERTIES TIMEOUT 60)
+set_tests_properties(SlabStackStoredPng PROPERTIES TIMEOUT 60)
+set_tests_properties(BlurGaussianTwoThreads PROPERTIES TIMEOUT 60)
+set_tests_properties(SixteenBitProjectionMIPWindow PROPERTIES TIMEOUT 60)
+set_tests_properties(ProjectionMeanPercentile PROPERTIES TIMEOUT 60)
+set_tests_properties(CompressedProjectionMIP PROPERTIES TIMEOUT 60)
+set_tests_properties(CompressedSixteenBitSliceYZ PROPERTIES TIMEOUT 60)
+set_tests_properties(ThresholdProjectionMIP PROPERTIES TIMEOUT 60)
+set_tests_properties(ComponentsCsv PROPERTIES TIMEOUT 60)
+set_tests_properties(DistanceProjectionMIP PROPERTIES TIMEOUT 60)
+set_tests_properties(DistanceImage PROPERTIES TIMEOUT 60)
+set_tests_properties(MorphologyImage PROPERTIES TIMEOUT 60)
+set_tests_properties(MorphologyProjectionMIP PROPERTIES TIMEOUT 60)
+set_tests_properties(ConvolveImage PROPERTIES TIMEOUT 60)
+set_tests_properties(ConvolveDiscImage PROPERTIES TIMEOUT 60)
+set_tests_properties(ConvolveProjectionMIP PROPERTIES TIMEOUT 60)
+set_tests_properties(ConvolveMissingKernel PROPERTIES TIMEOUT 60 WILL_FAIL TRUE)
@@ -0,0 +1,83 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the background encoder stage: a bounded job queue served by a fixed
+ * set of worker threads. Failures are remembered until the next wait(), since the caller
+ * has usually moved on by the time a write fails.
+ */
+#include "AsyncImageWriter.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+AsyncImageWriter::AsyncImageWriter(int workers, size_t maxQueued)
+    : maxQueued_(std::max<size_t>(1, maxQueued)) {
+    const int count = std::max(1, workers);
+    workers_.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+AsyncImageWriter::~AsyncImageWriter() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    hasWork_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+void AsyncImageWriter::submit(std::function<bool()> job) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    hasSpace_.wait(lock, [this]() { return queue_.size() < maxQueued_; });
+    queue_.push_back(std::move(job));
+    lock.unlock();
+    hasWork_.notify_one();
+}
+
+bool AsyncImageWriter::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return queue_.empty() && active_ == 0; });
+    const bool ok = !failed_;
+    failed_ = false;
+    return ok;
+}
+
+void AsyncImageWriter::workerLoop() {
+    for (;;) {
+        std::function<bool()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            hasWork_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return; // stopping
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            ++active_;
+        }
+        hasSpace_.notify_one();
+
+        bool ok = false;
+        try {
+            ok = job();
+        } catch (const std::exception& e) {
+            std::cerr << "[Writer] " << e.what() << "\n";
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --active_;
+        if (!ok) failed_ = true;
+        if (queue_.empty() && active_ == 0) idle_.notify_all();
+    }
+}
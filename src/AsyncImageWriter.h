@@ -0,0 +1,74 @@
+#ifndef ASYNC_IMAGE_WRITER_H
+#define ASYNC_IMAGE_WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Image.h"
+
+/**
+ * @class AsyncImageWriter
+ * @brief Encodes and writes images on background threads.
+ *
+ * The producer hands over finished images and carries on with the next one, so filtering
+ * of item n+1 overlaps the encoding of item n. At most `maxQueued` jobs wait at a time;
+ * submit() blocks beyond that, which bounds the memory held by pending images.
+ */
+class AsyncImageWriter {
+public:
+    /**
+     * @param workers Encoder threads (at least 1).
+     * @param maxQueued Jobs that may wait before submit() blocks (at least 1).
+     */
+    explicit AsyncImageWriter(int workers = 1, size_t maxQueued = 4);
+
+    /// Waits for all pending jobs.
+    ~AsyncImageWriter();
+
+    AsyncImageWriter(const AsyncImageWriter&) = delete;
+    AsyncImageWriter& operator=(const AsyncImageWriter&) = delete;
+
+    /**
+     * @brief Queues a job; it returns false on failure.
+     */
+    void submit(std::function<bool()> job);
+
+    /**
+     * @brief Takes ownership of `image` and saves it to `filename` in the background.
+     * @param pngLevel Deflate level for PNG files (-1 for the default).
+     */
+    template <typename T>
+    void submit(BasicImage<T> image, std::string filename, int pngLevel = -1) {
+        // std::function needs a copyable callable, and images are move-only.
+        auto owned = std::make_shared<BasicImage<T>>(std::move(image));
+        submit([owned, filename = std::move(filename), pngLevel]() { return owned->save(filename, pngLevel); });
+    }
+
+    /**
+     * @brief Blocks until every submitted job has finished.
+     * @return True if all jobs since the previous wait() succeeded.
+     */
+    bool wait();
+
+private:
+    void workerLoop();
+
+    std::mutex mutex_;
+    std::condition_variable hasWork_;
+    std::condition_variable hasSpace_;
+    std::condition_variable idle_;
+    std::deque<std::function<bool()>> queue_;
+    size_t maxQueued_;
+    int active_ = 0;
+    bool failed_ = false;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+#endif // ASYNC_IMAGE_WRITER_H
@@ -0,0 +1,340 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the bit-packed mask. Dilation by a radius r along an axis is an OR of
+ * the mask shifted by 0..r and by -r..0 steps. Both runs are built by doubling: once a row
+ * holds the OR of the rows [i, i + have], ORing in the row `step` further on (step <= have + 1)
+ * extends that to [i, i + have + step]. Along x the rows are word shifts; along y and z they
+ * are whole rows or slices. Erosion is the dilation of the complement.
+ */
+#include "BitMask.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+namespace {
+
+    constexpr int kWordsPerTask = 16; // words of a row dilated together along y and z
+
+    // The lowest T for which `v >= threshold` holds, or false in `any` if there is none.
+    template <typename T>
+    T typedCutoff(double threshold, bool& any) {
+        any = true;
+        if constexpr (std::is_floating_point_v<T>) {
+            T cutoff = static_cast<T>(threshold);
+            if (static_cast<double>(cutoff) < threshold) {
+                cutoff = std::nextafter(cutoff, std::numeric_limits<T>::infinity());
+            }
+            return cutoff;
+        } else {
+            if (threshold <= 0.0) return T(0);
+            if (threshold > static_cast<double>(std::numeric_limits<T>::max())) {
+                any = false;
+                return T(0);
+            }
+            return static_cast<T>(std::ceil(threshold));
+        }
+    }
+
+    // Packs the first channel of one row: bit b of word i is set if sample 64 * i + b >= cutoff.
+    template <typename T>
+    void packRow(const T* src, int channels, int width, T cutoff, bool any, std::uint64_t* dst) {
+        for (int x0 = 0; x0 < width; x0 += 64) {
+            const int n = std::min(64, width - x0);
+            const T* s = src + static_cast<std::size_t>(x0) * channels;
+            std::uint64_t word = 0;
+            for (int b = 0; b < n; ++b) {
+                word |= static_cast<std::uint64_t>(s[static_cast<std::size_t>(b) * channels] >= cutoff) << b;
+            }
+            *dst++ = any ? word : 0;
+        }
+    }
+
+    template <typename T>
+    void unpackRow(const std::uint64_t* src, int width, T on, T* dst) {
+        for (int x = 0; x < width; ++x) {
+            dst[x] = ((src[x >> 6] >> (x & 63)) & 1u) ? on : T(0);
+        }
+    }
+
+    // ORs every pixel of a row with the pixels up to `radius` before it (toward lower x).
+    void orBefore(std::uint64_t* row, int words, int radius) {
+        for (int have = 0; have < radius;) {
+            const int step = std::min(have + 1, radius - have);
+            const int q = step >> 6;
+            const int r = step & 63;
+            // Descending, so every word read still holds the previous pass.
+            for (int i = words - 1; i >= q; --i) {
+                std::uint64_t shifted = row[i - q] << r;
+                if (r != 0 && i - q - 1 >= 0) shifted |= row[i - q - 1] >> (64 - r);
+                row[i] |= shifted;
+            }
+            have += step;
+        }
+    }
+
+    // ORs every pixel of a row with the pixels up to `radius` after it (toward higher x).
+    void orAfter(std::uint64_t* row, int words, int radius) {
+        for (int have = 0; have < radius;) {
+            const int step = std::min(have + 1, radius - have);
+            const int q = step >> 6;
+            const int r = step & 63;
+            for (int i = 0; i + q < words; ++i) {
+                std::uint64_t shifted = row[i + q] >> r;
+                if (r != 0 && i + q + 1 < words) shifted |= row[i + q + 1] << (64 - r);
+                row[i] |= shifted;
+            }
+            have += step;
+        }
+    }
+
+    // ORs each of n rows of `words` words, `stride` words apart, with the rows up to `radius` away.
+    void orNeighbourRows(std::uint64_t* first, int n, std::size_t stride, int words, int radius) {
+        for (int have = 0; have < radius;) {
+            const int step = std::min(have + 1, radius - have);
+            for (int i = 0; i + step < n; ++i) {
+                std::uint64_t* a = first + i * stride;
+                const std::uint64_t* b = a + step * stride;
+                for (int w = 0; w < words; ++w) a[w] |= b[w];
+            }
+            have += step;
+        }
+        for (int have = 0; have < radius;) {
+            const int step = std::min(have + 1, radius - have);
+            for (int i = n - 1; i >= step; --i) {
+                std::uint64_t* a = first + i * stride;
+                const std::uint64_t* b = a - step * stride;
+                for (int w = 0; w < words; ++w) a[w] |= b[w];
+            }
+            have += step;
+        }
+    }
+
+    // Set bits in n words. The bit counts of up to 31 words are summed per byte before the bytes
+    // are added up, so the loop is shifts, masks and adds that vectorise without a POPCNT
+    // instruction (std::popcount is a longer scalar sequence on baseline x86-64).
+    std::size_t countBits(const std::uint64_t* w, std::size_t n) {
+        const std::uint64_t m1 = 0x5555555555555555ull;
+        const std::uint64_t m2 = 0x3333333333333333ull;
+        const std::uint64_t m4 = 0x0f0f0f0f0f0f0f0full;
+        const std::uint64_t m8 = 0x00ff00ff00ff00ffull;
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < n;) {
+            const std::size_t end = std::min(n, i + 31);
+            std::uint64_t bytes = 0;
+            for (; i < end; ++i) {
+                std::uint64_t x = w[i];
+                x -= (x >> 1) & m1;
+                x = (x & m2) + ((x >> 2) & m2);
+                bytes += (x + (x >> 4)) & m4;
+            }
+            const std::uint64_t shorts = (bytes & m8) + ((bytes >> 8) & m8);
+            total += (shorts * 0x0001000100010001ull) >> 48;
+        }
+        return total;
+    }
+
+    // Applies `op` to every word pair of two equally sized masks, in chunks across threads.
+    template <typename Op>
+    void combineWords(std::uint64_t* a, const std::uint64_t* b, std::size_t count, Op op) {
+        parallelForChunks(count, std::size_t(1) << 15, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) a[i] = op(a[i], b[i]);
+        });
+    }
+
+} // end anonymous namespace
+
+BitMask::BitMask(int width, int height, int depth)
+    : width(width), height(height), depth(depth), wordsPerRow((static_cast<std::size_t>(width) + 63) / 64),
+      words(wordsPerRow * height * depth, 0) {}
+
+template <typename T>
+BitMask BitMask::fromImage(const BasicImage<T>& img, double threshold) {
+    PROFILE_SCOPE_CAT("BitMask::fromImage", "mask");
+    BitMask mask(img.getWidth(), img.getHeight(), 1);
+    bool any = true;
+    const T cutoff = typedCutoff<T>(threshold, any);
+    const int channels = img.getChannels();
+    const std::size_t rowLength = static_cast<std::size_t>(mask.width) * channels;
+    parallelFor(0, mask.height, [&](int y) {
+        packRow(img.getData() + y * rowLength, channels, mask.width, cutoff, any, mask.row(y));
+    });
+    return mask;
+}
+
+template <typename T>
+BitMask BitMask::fromVolume(const BasicVolume<T>& vol, double threshold) {
+    PROFILE_SCOPE_CAT("BitMask::fromVolume", "mask");
+    BitMask mask(vol.getWidth(), vol.getHeight(), vol.getDepth());
+    bool any = true;
+    const T cutoff = typedCutoff<T>(threshold, any);
+    const int channels = vol.getChannels();
+    const std::size_t rowLength = static_cast<std::size_t>(mask.width) * channels;
+    parallelFor(0, mask.height * mask.depth, [&](int row) {
+        const int z = row / mask.height;
+        const int y = row % mask.height;
+        packRow(vol.getSlices()[z].getData() + y * rowLength, channels, mask.width, cutoff, any, mask.row(y, z));
+    });
+    return mask;
+}
+
+Image BitMask::toImage(int z) const {
+    unsigned char* data = static_cast<unsigned char*>(std::malloc(static_cast<std::size_t>(width) * height));
+    parallelFor(0, height, [&](int y) {
+        unpackRow<unsigned char>(row(y, z), width, 255, data + static_cast<std::size_t>(y) * width);
+    });
+    return Image(width, height, 1, data);
+}
+
+template <typename T>
+BasicVolume<T> BitMask::toVolume() const {
+    BasicVolume<T> vol(width, height, depth, 1);
+    T* data = vol.getVoxelData();
+    const T on = static_cast<T>(PixelTraits<T>::maxValue);
+    parallelFor(0, height * depth, [&](int r) {
+        unpackRow(words.data() + r * wordsPerRow, width, on, data + static_cast<std::size_t>(r) * width);
+    });
+    return vol;
+}
+
+bool BitMask::sameSize(const BitMask& other, const char* operation) const {
+    if (width == other.width && height == other.height && depth == other.depth) {
+        return true;
+    }
+    std::cerr << "[BitMask] Cannot " << operation << " a " << other.width << " x " << other.height << " x "
+              << other.depth << " mask with a " << width << " x " << height << " x " << depth << " one.\n";
+    return false;
+}
+
+std::uint64_t BitMask::lastWordMask() const {
+    const int used = width & 63;
+    return used == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << used) - 1;
+}
+
+BitMask& BitMask::operator&=(const BitMask& other) {
+    if (sameSize(other, "AND")) {
+        combineWords(words.data(), other.words.data(), words.size(),
+                     [](std::uint64_t a, std::uint64_t b) { return a & b; });
+    }
+    return *this;
+}
+
+BitMask& BitMask::operator|=(const BitMask& other) {
+    if (sameSize(other, "OR")) {
+        combineWords(words.data(), other.words.data(), words.size(),
+                     [](std::uint64_t a, std::uint64_t b) { return a | b; });
+    }
+    return *this;
+}
+
+BitMask& BitMask::operator^=(const BitMask& other) {
+    if (sameSize(other, "XOR")) {
+        combineWords(words.data(), other.words.data(), words.size(),
+                     [](std::uint64_t a, std::uint64_t b) { return a ^ b; });
+    }
+    return *this;
+}
+
+BitMask& BitMask::subtract(const BitMask& other) {
+    if (sameSize(other, "subtract")) {
+        combineWords(words.data(), other.words.data(), words.size(),
+                     [](std::uint64_t a, std::uint64_t b) { return a & ~b; });
+    }
+    return *this;
+}
+
+void BitMask::invert() {
+    const std::uint64_t last = lastWordMask();
+    const std::size_t perRow = wordsPerRow;
+    parallelForChunks(static_cast<std::size_t>(height) * depth, 4096, [&](std::size_t first, std::size_t end) {
+        for (std::size_t r = first; r < end; ++r) {
+            std::uint64_t* w = words.data() + r * perRow;
+            for (std::size_t i = 0; i < perRow; ++i) w[i] = ~w[i];
+            if (perRow > 0) w[perRow - 1] &= last;
+        }
+    });
+}
+
+std::size_t BitMask::count() const {
+    const std::size_t chunk = std::size_t(1) << 15;
+    std::vector<std::size_t> partial((words.size() + chunk - 1) / chunk, 0);
+    parallelForChunks(words.size(), chunk, [&](std::size_t first, std::size_t last) {
+        partial[first / chunk] = countBits(words.data() + first, last - first);
+    });
+    std::size_t total = 0;
+    for (std::size_t n : partial) total += n;
+    return total;
+}
+
+std::vector<std::size_t> BitMask::sliceCounts() const {
+    std::vector<std::size_t> counts(depth, 0);
+    const std::size_t sliceWords = wordsPerRow * height;
+    parallelFor(0, depth, [&](int z) {
+        counts[z] = countBits(words.data() + z * sliceWords, sliceWords);
+    });
+    return counts;
+}
+
+void BitMask::dilate(int rx, int ry, int rz) {
+    PROFILE_SCOPE_CAT("BitMask::dilate", "mask");
+    if (words.empty()) return;
+    const int perRow = static_cast<int>(wordsPerRow);
+    if (rx > 0) {
+        const std::uint64_t last = lastWordMask();
+        parallelFor(0, height * depth, [&](int r) {
+            std::uint64_t* w = words.data() + r * wordsPerRow;
+            orBefore(w, perRow, rx);
+            w[perRow - 1] &= last; // bits carried past the width
+            orAfter(w, perRow, rx);
+        });
+    }
+    // Along y and z, each task covers up to kWordsPerTask words of every row of a line.
+    const int columns = (perRow + kWordsPerTask - 1) / kWordsPerTask;
+    const auto columnWords = [&](int c) { return std::min(kWordsPerTask, perRow - c * kWordsPerTask); };
+    if (ry > 0 && height > 1) {
+        parallelFor(0, depth * columns, [&](int task) {
+            const int z = task / columns;
+            const int c = task % columns;
+            orNeighbourRows(row(0, z) + c * kWordsPerTask, height, wordsPerRow, columnWords(c), ry);
+        });
+    }
+    if (rz > 0 && depth > 1) {
+        parallelFor(0, height * columns, [&](int task) {
+            const int y = task / columns;
+            const int c = task % columns;
+            orNeighbourRows(row(y, 0) + c * kWordsPerTask, depth, wordsPerRow * height, columnWords(c), rz);
+        });
+    }
+}
+
+void BitMask::erode(int rx, int ry, int rz) {
+    PROFILE_SCOPE_CAT("BitMask::erode", "mask");
+    invert();
+    dilate(rx, ry, rz);
+    invert();
+}
+
+template BitMask BitMask::fromImage(const BasicImage<unsigned char>&, double);
+template BitMask BitMask::fromImage(const BasicImage<std::uint16_t>&, double);
+template BitMask BitMask::fromImage(const BasicImage<float>&, double);
+template BitMask BitMask::fromVolume(const BasicVolume<unsigned char>&, double);
+template BitMask BitMask::fromVolume(const BasicVolume<std::uint16_t>&, double);
+template BitMask BitMask::fromVolume(const BasicVolume<float>&, double);
+template BasicVolume<unsigned char> BitMask::toVolume() const;
+template BasicVolume<std::uint16_t> BitMask::toVolume() const;
+template BasicVolume<float> BitMask::toVolume() const;
@@ -0,0 +1,181 @@
+#ifndef BIT_MASK_H
+#define BIT_MASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Image.h"
+#include "Volume.h"
+
+/**
+ * @class BitMask
+ * @brief A binary image or volume stored as one bit per pixel in 64-bit words.
+ *
+ * After a threshold every sample is 0 or the maximum, yet it still takes a byte (or two, or
+ * four); a mask holds the same information in an eighth of a byte. Each row starts on a word
+ * boundary, and bit x % 64 of word x / 64 of a row is pixel x. The bits past the width in the
+ * last word of a row are always 0. Images are masks with a depth of 1.
+ *
+ * Boolean operations, counting and box dilation/erosion work on whole words, 64 pixels at a
+ * time, and are split across threads.
+ */
+class BitMask {
+public:
+    /**
+     * @brief Creates an empty mask.
+     */
+    BitMask() = default;
+
+    /**
+     * @brief Creates a mask with every pixel clear.
+     * @param width Width in pixels.
+     * @param height Height in pixels.
+     * @param depth Number of slices (1 for an image).
+     */
+    BitMask(int width, int height, int depth = 1);
+
+    /**
+     * @brief Sets the pixels of an image whose first channel is at least `threshold`.
+     *
+     * The default threshold of 1 keeps every nonzero pixel, which is the foreground of a
+     * thresholded image.
+     *
+     * @param img The image.
+     * @param threshold Lowest value of a set pixel.
+     * @return The mask, as wide and high as the image.
+     */
+    template <typename T>
+    static BitMask fromImage(const BasicImage<T>& img, double threshold = 1.0);
+
+    /**
+     * @brief Sets the voxels of a volume whose first channel is at least `threshold`.
+     * @param vol The volume, e.g. the output of a 3D threshold.
+     * @param threshold Lowest value of a set voxel (1 keeps every nonzero voxel).
+     * @return The mask, the size of the volume.
+     */
+    template <typename T>
+    static BitMask fromVolume(const BasicVolume<T>& vol, double threshold = 1.0);
+
+    /**
+     * @brief Expands slice z into a one-channel image of 0 and 255.
+     * @param z Slice index (0-based).
+     */
+    Image toImage(int z = 0) const;
+
+    /**
+     * @brief Expands the mask into a one-channel volume of 0 and the maximum voxel value.
+     */
+    template <typename T>
+    BasicVolume<T> toVolume() const;
+
+    int getWidth() const { return width; }   ///< Width in pixels.
+    int getHeight() const { return height; } ///< Height in pixels.
+    int getDepth() const { return depth; }   ///< Number of slices.
+    std::size_t getWordsPerRow() const { return wordsPerRow; } ///< 64-bit words per row.
+
+    /**
+     * @brief Whether pixel (x, y, z) is set.
+     */
+    bool get(int x, int y, int z = 0) const {
+        return (row(y, z)[x >> 6] >> (x & 63)) & 1u;
+    }
+
+    /**
+     * @brief Sets or clears pixel (x, y, z).
+     */
+    void set(int x, int y, int z, bool value) {
+        std::uint64_t& word = row(y, z)[x >> 6];
+        const std::uint64_t bit = std::uint64_t(1) << (x & 63);
+        word = value ? (word | bit) : (word & ~bit);
+    }
+
+    /**
+     * @brief Words of row y of slice z.
+     */
+    std::uint64_t* row(int y, int z = 0) {
+        return words.data() + (static_cast<std::size_t>(z) * height + y) * wordsPerRow;
+    }
+
+    /**
+     * @brief Words of row y of slice z.
+     */
+    const std::uint64_t* row(int y, int z = 0) const {
+        return words.data() + (static_cast<std::size_t>(z) * height + y) * wordsPerRow;
+    }
+
+    /**
+     * @brief Keeps the pixels set in both masks. Masks of different sizes are left unchanged.
+     */
+    BitMask& operator&=(const BitMask& other);
+
+    /**
+     * @brief Sets the pixels set in either mask. Masks of different sizes are left unchanged.
+     */
+    BitMask& operator|=(const BitMask& other);
+
+    /**
+     * @brief Keeps the pixels set in exactly one mask. Masks of different sizes are left unchanged.
+     */
+    BitMask& operator^=(const BitMask& other);
+
+    /**
+     * @brief Clears the pixels set in `other`. Masks of different sizes are left unchanged.
+     */
+    BitMask& subtract(const BitMask& other);
+
+    /**
+     * @brief Sets every clear pixel and clears every set one.
+     */
+    void invert();
+
+    /**
+     * @brief Number of set pixels.
+     */
+    std::size_t count() const;
+
+    /**
+     * @brief Number of set pixels in every slice.
+     */
+    std::vector<std::size_t> sliceCounts() const;
+
+    /**
+     * @brief Sets every pixel within a (2rx+1) x (2ry+1) x (2rz+1) box of a set pixel.
+     *
+     * Each axis takes about log2(r) + 1 passes of word shifts and ORs, whatever the radius.
+     * Pixels outside the mask count as clear.
+     *
+     * @param rx Radius along x, in pixels.
+     * @param ry Radius along y, in pixels.
+     * @param rz Radius along z, in slices.
+     */
+    void dilate(int rx, int ry, int rz = 0);
+
+    /**
+     * @brief Keeps the pixels whose (2rx+1) x (2ry+1) x (2rz+1) box lies inside the mask.
+     *
+     * The dual of dilate(). Pixels outside the mask are left out, so the border of the mask
+     * does not erode on its own.
+     *
+     * @param rx Radius along x, in pixels.
+     * @param ry Radius along y, in pixels.
+     * @param rz Radius along z, in slices.
+     */
+    void erode(int rx, int ry, int rz = 0);
+
+    /**
+     * @brief Bytes held by the words.
+     */
+    std::size_t memoryBytes() const { return words.size() * sizeof(std::uint64_t); }
+
+private:
+    bool sameSize(const BitMask& other, const char* operation) const;
+    std::uint64_t lastWordMask() const;
+
+    int width = 0;               ///< Width in pixels.
+    int height = 0;              ///< Height in pixels.
+    int depth = 0;               ///< Number of slices.
+    std::size_t wordsPerRow = 0; ///< 64-bit words per row.
+    std::vector<std::uint64_t> words; ///< Rows, slice by slice.
+};
+
+#endif // BIT_MASK_H
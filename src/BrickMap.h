@@ -0,0 +1,113 @@
+#ifndef BRICK_MAP_H
+#define BRICK_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class BrickMap
+ * @brief Minimum and maximum sample of every kTileSize x kTileSize tile of every slice.
+ *
+ * Kernels use the ranges to leave out tiles that cannot change their result: a MIP skips
+ * the tiles of a slice whose maximum is no higher than every running maximum they would be
+ * compared with, and a threshold fills tiles that lie entirely on one side of the threshold
+ * without reading them. The ranges cover all channels of a tile together.
+ *
+ * Ranges are kept per slice rather than per z-brick of several slices. The voxel store is
+ * contiguous but slice-major, so a tile row of a z-brick would still be one separate span per
+ * slice. A brick range would bound those spans more loosely without making any read
+ * contiguous, and per-slice ranges let a MIP skip a tile in exactly the slices that cannot
+ * change it.
+ */
+template <typename T>
+class BrickMap {
+public:
+    static constexpr int kTileSize = 32; ///< Tile width and height in pixels.
+
+    /**
+     * @brief Creates an empty map.
+     */
+    BrickMap() = default;
+
+    /**
+     * @brief Creates a map for the given volume size; every range must then be set.
+     * @param width Width of each slice.
+     * @param height Height of each slice.
+     * @param depth Number of slices.
+     */
+    BrickMap(int width, int height, int depth)
+        : width_(width), height_(height), depth_(depth),
+          tilesX_((width + kTileSize - 1) / kTileSize), tilesY_((height + kTileSize - 1) / kTileSize),
+          min_(static_cast<std::size_t>(tilesX_) * tilesY_ * depth), max_(min_.size()) {}
+
+    /**
+     * @brief Computes the ranges of every tile of slice z from its data.
+     * @param z Slice index (0-based).
+     * @param slice The slice, row-major with `channels` interleaved samples per pixel.
+     * @param channels Samples per pixel.
+     */
+    void summarize(int z, const T* slice, int channels) {
+        const std::size_t rowLength = static_cast<std::size_t>(width_) * channels;
+        for (int ty = 0; ty < tilesY_; ++ty) {
+            const int y1 = std::min(height_, (ty + 1) * kTileSize);
+            for (int tx = 0; tx < tilesX_; ++tx) {
+                const std::size_t x0 = static_cast<std::size_t>(tx) * kTileSize * channels;
+                const std::size_t x1 = static_cast<std::size_t>(std::min(width_, (tx + 1) * kTileSize)) * channels;
+                T lo = slice[ty * kTileSize * rowLength + x0];
+                T hi = lo;
+                for (int y = ty * kTileSize; y < y1; ++y) {
+                    const T* row = slice + y * rowLength;
+                    for (std::size_t i = x0; i < x1; ++i) {
+                        lo = std::min(lo, row[i]);
+                        hi = std::max(hi, row[i]);
+                    }
+                }
+                setRange(tx, ty, z, lo, hi);
+            }
+        }
+    }
+
+    /**
+     * @brief Whether the map holds no ranges.
+     */
+    bool empty() const { return depth_ == 0; }
+
+    int getTilesX() const { return tilesX_; } ///< Tiles across a slice.
+    int getTilesY() const { return tilesY_; } ///< Tiles down a slice.
+    int getDepth() const { return depth_; }   ///< Number of slices.
+
+    /**
+     * @brief Smallest sample of tile (tx, ty) of slice z.
+     */
+    T minimum(int tx, int ty, int z) const { return min_[index(tx, ty, z)]; }
+
+    /**
+     * @brief Largest sample of tile (tx, ty) of slice z.
+     */
+    T maximum(int tx, int ty, int z) const { return max_[index(tx, ty, z)]; }
+
+    /**
+     * @brief Sets the range of tile (tx, ty) of slice z.
+     */
+    void setRange(int tx, int ty, int z, T lo, T hi) {
+        const std::size_t i = index(tx, ty, z);
+        min_[i] = lo;
+        max_[i] = hi;
+    }
+
+private:
+    std::size_t index(int tx, int ty, int z) const {
+        return (static_cast<std::size_t>(z) * tilesY_ + ty) * tilesX_ + tx;
+    }
+
+    int width_ = 0;
+    int height_ = 0;
+    int depth_ = 0;
+    int tilesX_ = 0;
+    int tilesY_ = 0;
+    std::vector<T> min_; ///< Tile minima, slice by slice, row-major within a slice.
+    std::vector<T> max_; ///< Tile maxima, in the same order.
+};
+
+#endif // BRICK_MAP_H
@@ -0,0 +1,1306 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the command line front end: option parsing for 2D and 3D mode and the
+ * pipelines that run them. main() and the socket server both call into it; the server passes
+ * volumes from its cache to processLoadedVolume and asks for the result as encoded bytes
+ * instead of a file.
+ */
+#include "Cli.h"
+#include "Filter.h"
+#include "OutputMapping.h"
+#include "Profiler.h"
+#include "Projection.h"
+#include "Pyramid.h"
+#include "RayCaster.h"
+#include "Reduction.h"
+#include "Segmentation.h"
+#include "Slice.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// -------------------------------------------------------------------
+// Print usage info
+// -------------------------------------------------------------------
+void printUsage(const std::string& progName) {
+    std::cerr << "Usage:\n";
+    std::cerr << "  2D mode: " << progName
+              << " -i <input_image> [2D options] <output_image>\n\n";
+    std::cerr << "    2D Options:\n"
+              << "      --greyscale | -g\n"
+              << "      --brightness [val] | -b [val]        (if val is omitted, use auto mode)\n"
+              << "      --histogram <type> | -h <type>       (e.g., HSV, HSL)\n"
+              << "      --blur <type> <size> [<stdev>] | -r <type> <size> [<stdev>]\n"
+              << "               (type can be Box, Gaussian, or Median)\n"
+              << "      --convolve <file> [<edge>]           (kernel from a text file, one row per line; applied after --blur;\n"
+              << "         edge: Extend, Reflect, Constant, Wrap)\n"
+              << "      --edge <type> | -e <type>            (Sobel, Prewitt, Scharr, RobertsCross)\n"
+              << "      --sharpen | -p\n"
+              << "      --saltpepper <percent> | -n <pct>\n"
+              << "      --threshold <val> <mode> | -t <val> <mode>\n"
+              << "         (e.g. 128 HSV)\n"
+              << "      --morph <op> <size> [<edge>]         (op: Erode, Dilate, Open, Close over a size x size square;\n"
+              << "         edge: Extend, Reflect, Constant, Wrap; applied after --threshold)\n"
+              << "      --distance [<scale>]                 (Euclidean distance to the nearest 0 pixel, times scale;\n"
+              << "         applied last, e.g. after --threshold)\n"
+              << "      --level <n> [<reduce>]               (process pyramid level n; reduce: Box, Gaussian)\n"
+              << "      --profile <trace.json>               (time each stage, print a summary, write a Chrome trace)\n"
+              << "      --png-level <0-9>                    (PNG compression: 0 = stored/fastest, 9 = smallest; default 6)\n"
+              << "      --threads <n>                        (worker threads; default 0 = all hardware threads)\n\n";
+
+    std::cerr << "  3D mode: " << progName
+              << " -d <input_volume_directory> [3D options] <output_image>\n\n";
+    std::cerr << "    3D Options:\n"
+              << "      --blur3d <type> <size> [<stdev>]    (type: Gaussian, Median)\n"
+              << "      --convolve3d <file> [<edge>]        (kernel from a text file, slices separated by blank lines;\n"
+              << "         edge: Extend, Reflect, Constant, Wrap; applied after --blur3d)\n"
+              << "      --threshold3d <value>               (voxels below <value> become 0, others the maximum;\n"
+              << "         applied after --blur3d, in voxel units: 0-255, or 0-65535 for 16-bit scans)\n"
+              << "      --morph3d <op> <size> [<edge>]      (op: Erode, Dilate, Open, Close over a size^3 cube;\n"
+              << "         edge: Extend, Reflect, Constant, Wrap; applied after --threshold3d)\n"
+              << "      --distance3d [<scale>]              (Euclidean distance to the nearest 0 voxel, times scale;\n"
+              << "         applied after --threshold3d and --morph3d)\n"
+              << "      --projection <type> | -p <type>     (MIP, MinIP, MeanAIP, MedianAIP)\n"
+              << "      --slice <plane> <constant> | -s <plane> <const>\n"
+              << "         (plane: XZ or YZ, constant: coordinate in that plane)\n"
+              << "      --oblique <px> <py> <pz> <nx> <ny> <nz> [<interp>] (plane through point p with normal n;\n"
+              << "         interp: Nearest, Trilinear)\n"
+              << "      --curved \"x,y,z;x,y,z;...\" [<interp>] (curved slice along a polyline, extruded along z)\n"
+              << "      --slab <type> <thickness>            (MIP, MinIP or meanAIP over every run of <thickness> slices;\n"
+              << "         writes a numbered series <output_base>000.<ext>, ... that -d can read back)\n"
+              << "      --render <type> <azimuth> <elevation> (ray-cast MIP, MinIP or meanAIP from any direction, degrees)\n"
+              << "      --orbit <type> <views> [<elevation>] (360-degree turn of ray-cast views, numbered series)\n"
+              << "      --components <threshold> [<connectivity>] (label connected voxels >= threshold;\n"
+              << "         connectivity 6, 18 or 26 (default); writes one CSV row per component)\n"
+              << "      --zrange <start> <end>  (1-based z-slab for partial projection)\n"
+              << "      --channels <mode>       (auto (default): read RGB/RGBA slices with R=G=B as one channel;\n"
+              << "         keep: read every channel; collapse: always keep only the first channel)\n"
+              << "      --compressed            (keep the volume run-length encoded in memory; projections and\n"
+              << "         axis slices decode it row by row, other options decode it once)\n"
+              << "      --map <mapping>         (projection output: minmax (default), window <center> <width>,\n"
+              << "         gamma <g> or percentile <low> <high>; window values are voxel values)\n"
+              << "      --level <n> [<reduce>]  (process pyramid level n, 1/8^n of the voxels; reduce: Box, Gaussian)\n"
+              << "      --profile <trace.json>  (time each stage, print a summary, write a Chrome trace)\n"
+              << "      --png-level <0-9>       (PNG compression: 0 = stored/fastest, 9 = smallest; default 6)\n"
+              << "      --threads <n>           (worker threads; default 0 = all hardware threads)\n\n";
+
+    std::cerr << "  Server mode: " << progName
+              << " --serve <socket_path> [--cache-mb <n>] [--threads <n>]\n"
+              << "      (answers the options above over a Unix socket, keeping loaded volumes in memory)\n\n";
+}
+
+namespace {
+
+    // Stretches an image to the full range of its sample type (0-255 for 8-bit, 0-65535 for 16-bit)
+    template <typename T>
+    void normalizeMinMax(BasicImage<T>& img) {
+        PROFILE_SCOPE("normalizeMinMax");
+       std:: cout<<"Normalizing image to [0, " << PixelTraits<T>::maxValue << "] based on min/max values"<<std::endl;
+        int w = img.getWidth();
+        int h = img.getHeight();
+        int ch = img.getChannels();
+        T* data = img.getData();
+        if (!data) return;
+
+        // Find min and max over all channels in one parallel pass
+        const size_t pixels = static_cast<size_t>(w) * h;
+        const ChannelStats<T> stats = reduceChannels(data, pixels, ch);
+        double minVal = std::min<double>(PixelTraits<T>::maxValue, stats.overallMin());
+        double maxVal = std::max<double>(0, stats.overallMax());
+
+        double range = maxVal - minVal;
+        if (range <= 0) return; // everything’s the same or empty
+
+        // Scale each pixel so minVal -> 0, maxVal -> maxValue, all channels in one pass
+        remapChannels(data, pixels, ch, [&](int, T v) {
+            double val = v - minVal;
+            return pixelCast<T>((val * PixelTraits<T>::maxValue) / range);
+        });
+    }
+
+
+    // Parses "--level <n> [Box|Gaussian]" starting at argv[idx]; shared by 2D and 3D modes.
+    bool parsePyramidLevel(char* argv[], int& idx, int last, int& level, ReduceMode& mode) {
+        if (idx >= last) {
+            std::cerr << "[Error] Missing pyramid level after --level\n";
+            return false;
+        }
+        level = std::stoi(argv[idx++]);
+        if (level < 0) {
+            std::cerr << "[Error] Pyramid level must be non-negative\n";
+            return false;
+        }
+        if (idx < last) {
+            std::string nextArg = argv[idx];
+            if (nextArg == "Gaussian") {
+                mode = ReduceMode::Gaussian;
+                idx++;
+            } else if (nextArg == "Box") {
+                mode = ReduceMode::Box;
+                idx++;
+            }
+        }
+        return true;
+    }
+
+    // Parses "--profile <trace.json>" starting at argv[idx]; shared by 2D and 3D modes.
+    bool parseProfileFile(char* argv[], int& idx, int last, std::string& file) {
+        if (idx >= last) {
+            std::cerr << "[Error] Missing trace file after --profile\n";
+            return false;
+        }
+        file = argv[idx++];
+        return true;
+    }
+
+    // Parses "--png-level <0-9>" starting at argv[idx]; shared by 2D and 3D modes.
+    bool parsePngLevel(char* argv[], int& idx, int last, int& level) {
+        if (idx >= last) {
+            std::cerr << "[Error] Missing level after --png-level\n";
+            return false;
+        }
+        level = std::stoi(argv[idx++]);
+        if (level < 0 || level > 9) {
+            std::cerr << "[Error] PNG level must be between 0 and 9\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Consumes an optional numeric scale at argv[idx] (--distance, --distance3d).
+    void parseOptionalScale(char* argv[], int& idx, int last, double& scale) {
+        if (idx < last) {
+            try {
+                size_t used = 0;
+                const double value = std::stod(argv[idx], &used);
+                if (used == std::string(argv[idx]).size()) {
+                    scale = value;
+                    idx++;
+                }
+            } catch (...) {
+                // not a number; leave it for the next option
+            }
+        }
+    }
+
+    // Consumes an optional edge mode name at argv[idx] (--morph, --convolve and their 3D forms).
+    void parseOptionalEdgeMode(char* argv[], int& idx, int last, EdgeMode& edgeMode) {
+        if (idx < last) {
+            std::string nextArg = argv[idx];
+            if (nextArg == "Extend") {
+                edgeMode = EdgeMode::Extend;
+                idx++;
+            } else if (nextArg == "Reflect") {
+                edgeMode = EdgeMode::Reflect;
+                idx++;
+            } else if (nextArg == "Constant") {
+                edgeMode = EdgeMode::Constant;
+                idx++;
+            } else if (nextArg == "Wrap") {
+                edgeMode = EdgeMode::Wrap;
+                idx++;
+            }
+        }
+    }
+
+    // Parses "<op> <size> [<edge>]" after --morph or --morph3d.
+    bool parseMorphology(char* argv[], int& idx, int last, const std::string& opt,
+                         std::string& operation, int& size, EdgeMode& edgeMode) {
+        if (idx + 1 >= last) {
+            std::cerr << "[Error] Not enough parameters for " << opt << "\n";
+            return false;
+        }
+        operation = argv[idx++];
+        if (operation != "Erode" && operation != "Dilate" && operation != "Open" && operation != "Close") {
+            std::cerr << "[Error] Unknown morphology operation: " << operation << " (use Erode, Dilate, Open or Close)\n";
+            return false;
+        }
+        size = std::stoi(argv[idx++]);
+        if (size < 1) {
+            std::cerr << "[Error] Morphology size must be at least 1\n";
+            return false;
+        }
+        parseOptionalEdgeMode(argv, idx, last, edgeMode);
+        return true;
+    }
+
+    // Parses "<file> [<edge>]" after --convolve or --convolve3d and loads the kernel, so a bad
+    // file is rejected before any image is read.
+    bool parseConvolution(char* argv[], int& idx, int last, const std::string& opt,
+                          ConvolutionKernel& kernel, EdgeMode& edgeMode) {
+        if (idx >= last) {
+            std::cerr << "[Error] Missing kernel file after " << opt << "\n";
+            return false;
+        }
+        const std::string kernelFile = argv[idx++];
+        if (!ConvolutionKernel::load(kernelFile, kernel)) {
+            std::cerr << "[Error] Could not load the kernel for " << opt << ": " << kernelFile << "\n";
+            return false;
+        }
+        if (opt == "--convolve" && kernel.depth > 1) {
+            std::cerr << "[Error] Kernel " << kernelFile << " has " << kernel.depth
+                      << " slices; use --convolve3d for 3D kernels\n";
+            return false;
+        }
+        parseOptionalEdgeMode(argv, idx, last, edgeMode);
+        return true;
+    }
+
+    // Parses "--threads <n>" starting at argv[idx]; shared by 2D and 3D modes.
+    bool parseThreads(char* argv[], int& idx, int last, int& threads) {
+        if (idx >= last) {
+            std::cerr << "[Error] Missing count after --threads\n";
+            return false;
+        }
+        threads = std::stoi(argv[idx++]);
+        if (threads < 0) {
+            std::cerr << "[Error] Thread count must be non-negative\n";
+            return false;
+        }
+        return true;
+    }
+ 
+    // Consumes an optional trailing "Nearest" or "Trilinear" at argv[idx].
+    bool parseInterpolation(char* argv[], int& idx, int last, Interpolation& interp) {
+        if (idx < last) {
+            std::string nextArg = argv[idx];
+            if (nextArg == "Nearest") {
+                interp = Interpolation::Nearest;
+                idx++;
+            } else if (nextArg == "Trilinear") {
+                interp = Interpolation::Trilinear;
+                idx++;
+            }
+        }
+        return true;
+    }
+
+    // Parses "x,y,z;x,y,z;..." into a list of points (still 1-based, as typed).
+    bool parsePolyline(const std::string& text, std::vector<Vec3>& points) {
+        points.clear();
+        std::size_t start = 0;
+        while (start < text.size()) {
+            std::size_t end = text.find(';', start);
+            if (end == std::string::npos) end = text.size();
+            std::string point = text.substr(start, end - start);
+            start = end + 1;
+            if (point.empty()) continue;
+
+            float xyz[3];
+            std::size_t pos = 0;
+            for (int k = 0; k < 3; k++) {
+                std::size_t comma = (k < 2) ? point.find(',', pos) : point.size();
+                if (comma == std::string::npos) {
+                    std::cerr << "[Error] Curve points must be x,y,z: " << point << "\n";
+                    return false;
+                }
+                xyz[k] = std::stof(point.substr(pos, comma - pos));
+                pos = comma + 1;
+            }
+            points.push_back(Vec3{ xyz[0], xyz[1], xyz[2] });
+        }
+        if (points.size() < 2) {
+            std::cerr << "[Error] --curved needs at least two points\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Saves the result, or encodes it as PNG into `encoded` when the caller wants the bytes back.
+    template <typename T>
+    bool writeResult(const BasicImage<T>& img, const std::string& outputFile, std::vector<unsigned char>* encoded,
+                     int pngLevel) {
+        if (encoded) {
+            return img.encode("png", *encoded, pngLevel);
+        }
+        return img.save(outputFile, pngLevel);
+    }
+
+} // end anonymous namespace
+
+// -------------------------------------------------------------------
+// 2D Command line
+// -------------------------------------------------------------------
+bool parseCommandLine2D(int argc, char* argv[], ProgramOptions2D &opts) {
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return false;
+    }
+
+    // e.g.  ./prog -i input.jpg --greyscale --brightness 50 out.jpg
+    // argv[1] = "-i", argv[2] = "input.jpg", 
+    // then parse 2D options, last is "out.jpg"
+    opts.inputFile = argv[2];
+    int idx = 3;
+    int last = argc - 1;
+    opts.outputFile = argv[last];
+
+    while (idx < last) {
+        std::string opt = argv[idx++];
+        if (opt == "--greyscale" || opt == "-g") {
+            opts.greyscale = true;
+        }
+        else if (opt == "--brightness" || opt == "-b") {
+            opts.brightnessFlag = true;
+            if (idx < last) {
+                // Peek next token
+                std::string nextArg = argv[idx];
+                try {
+                    int val = std::stoi(nextArg);
+                    opts.brightnessValue = val;
+                    opts.autoBrightness = false;
+                    idx++;
+                }
+                catch (...) {
+                    // no numeric => auto
+                    opts.autoBrightness = true;
+                }
+            } else {
+                opts.autoBrightness = true;
+            }
+        }
+        else if (opt == "--histogram" || opt == "-h") {
+            if (idx < last) {
+                opts.histogramFlag = true;
+                opts.histogramType = argv[idx++];
+            } else {
+                std::cerr << "[Error] Missing histogram type after " << opt << "\n";
+                return false;
+            }
+        }
+        else if (opt == "--blur" || opt == "-r") {
+            if (idx + 1 < last) {
+                opts.blurFlag     = true;
+                opts.blurType     = argv[idx++];
+                opts.blurKernelSize = std::stoi(argv[idx++]);
+                if (opts.blurType == "Gaussian" && idx < last) {
+                    // optional stdev
+                    try {
+                        double possibleStdev = std::stod(argv[idx]);
+                        opts.blurStdev = possibleStdev;
+                        idx++;
+                    } catch (...) {
+                        // ignore, use default
+                    }
+                }
+            } else {
+                std::cerr << "[Error] Not enough parameters after " << opt << "\n";
+                return false;
+            }
+        }
+        else if (opt == "--convolve") {
+            opts.convolveFlag = true;
+            if (!parseConvolution(argv, idx, last, opt, opts.convolveKernel, opts.convolveEdgeMode)) {
+                return false;
+            }
+        }
+        else if (opt == "--edge" || opt == "-e") {
+            if (idx < last) {
+                opts.edgeFlag = true;
+                opts.edgeType = argv[idx++];
+            } else {
+                std::cerr << "[Error] Missing edge detection type after " << opt << "\n";
+                return false;
+            }
+        }
+        else if (opt == "--sharpen" || opt == "-p") {
+            opts.sharpen = true;
+        }
+        else if (opt == "--saltpepper" || opt == "-n") {
+            if (idx < last) {
+                opts.saltPepperFlag = true;
+                opts.saltPepperPercent = std::stof(argv[idx++]);
+            } else {
+                std::cerr << "[Error] Missing salt/pepper percentage after " << opt << "\n";
+                return false;
+            }
+        }
+        else if (opt == "--threshold" || opt == "-t") {
+            if (idx + 1 < last) {
+                opts.thresholdFlag = true;
+                opts.thresholdValue = std::stoi(argv[idx++]);
+                opts.thresholdMode  = argv[idx++];
+            } else {
+                std::cerr << "[Error] Missing threshold parameters after " << opt << "\n";
+                return false;
+            }
+        }
+        else if (opt == "--morph") {
+            opts.morphFlag = true;
+            if (!parseMorphology(argv, idx, last, opt, opts.morphOperation, opts.morphSize, opts.morphEdgeMode)) {
+                return false;
+            }
+        }
+        else if (opt == "--distance") {
+            opts.distanceFlag = true;
+            parseOptionalScale(argv, idx, last, opts.distanceScale);
+        }
+        else if (opt == "--level") {
+            if (!parsePyramidLevel(argv, idx, last, opts.pyramidLevel, opts.pyramidMode)) {
+                return false;
+            }
+        }
+        else if (opt == "--profile") {
+            if (!parseProfileFile(argv, idx, last, opts.profileFile)) {
+                return false;
+            }
+        }
+        else if (opt == "--png-level") {
+            if (!parsePngLevel(argv, idx, last, opts.pngLevel)) {
+                return false;
+            }
+        }
+        else if (opt == "--threads") {
+            if (!parseThreads(argv, idx, last, opts.threads)) {
+                return false;
+            }
+        }
+        else {
+            std::cerr << "[Warning] Unknown 2D option: " << opt << "\n";
+        }
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------
+// 3D Command line
+// -------------------------------------------------------------------
+bool parseCommandLine3D(int argc, char* argv[], ProgramOptions3D &opts) {
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return false;
+    }
+
+    opts.inputDir = argv[2];
+    int idx = 3;
+    int last = argc - 1;
+    opts.outputFile = argv[last];
+
+    while (idx < last) {
+        std::string opt = argv[idx++];
+        if (opt == "--blur3d") {
+            if (idx + 1 < last) {
+                opts.blur3DFlag     = true;
+                opts.blur3DType     = argv[idx++];
+                opts.blur3DKernelSize = std::stoi(argv[idx++]);
+                if (opts.blur3DType == "Gaussian" && idx < last) {
+                    try {
+                        double possibleStdev = std::stod(argv[idx]);
+                        opts.blur3DStdev = possibleStdev;
+                        idx++;
+                    } catch (...) {
+                        // ignore
+                    }
+                }
+            } else {
+                std::cerr << "[Error] Not enough parameters for --blur3d\n";
+                return false;
+            }
+        }
+        else if (opt == "--convolve3d") {
+            opts.convolve3DFlag = true;
+            if (!parseConvolution(argv, idx, last, opt, opts.convolve3DKernel, opts.convolve3DEdgeMode)) {
+                return false;
+            }
+        }
+        else if (opt == "--threshold3d") {
+            if (idx < last) {
+                opts.threshold3DFlag = true;
+                opts.threshold3DValue = std::stod(argv[idx++]);
+            } else {
+                std::cerr << "[Error] Missing threshold value after --threshold3d\n";
+                return false;
+            }
+        }
+        else if (opt == "--projection" || opt == "-p") {
+            if (idx < last) {
+                opts.projectionFlag = true;
+                opts.projectionType = argv[idx++];
+            } else {
+                std::cerr << "[Error] Missing projection type after " << opt << "\n";
+                return false;
+            }
+        }
+        else if (opt == "--slice" || opt == "-s") {
+            if (idx + 1 < last) {
+                opts.sliceFlag = true;
+                opts.slicePlane  = argv[idx++];
+                opts.sliceConstant = std::stoi(argv[idx++]);
+            } else {
+                std::cerr << "[Error] Not enough parameters for " << opt << "\n";
+                return false;
+            }
+        }
+        else if (opt == "--oblique") {
+            if (idx + 5 < last) {
+                opts.obliqueFlag = true;
+                opts.obliquePoint = Vec3{ std::stof(argv[idx]), std::stof(argv[idx + 1]), std::stof(argv[idx + 2]) };
+                opts.obliqueNormal = Vec3{ std::stof(argv[idx + 3]), std::stof(argv[idx + 4]), std::stof(argv[idx + 5]) };
+                idx += 6;
+                if (!parseInterpolation(argv, idx, last, opts.sliceInterp)) {
+                    return false;
+                }
+            } else {
+                std::cerr << "[Error] Not enough parameters for --oblique\n";
+                return false;
+            }
+        }
+        else if (opt == "--curved") {
+            if (idx < last) {
+                opts.curvedFlag = true;
+                if (!parsePolyline(argv[idx++], opts.curvedPoints)) {
+                    return false;
+                }
+                if (!parseInterpolation(argv, idx, last, opts.sliceInterp)) {
+                    return false;
+                }
+            } else {
+                std::cerr << "[Error] Missing polyline after --curved\n";
+                return false;
+            }
+        }
+        else if (opt == "--slab") {
+            if (idx + 1 < last) {
+                opts.slabStackFlag = true;
+                opts.slabStackType = argv[idx++];
+                opts.slabThickness = std::stoi(argv[idx++]);
+            } else {
+                std::cerr << "[Error] Not enough parameters for --slab\n";
+                return false;
+            }
+        }
+        else if (opt == "--morph3d") {
+            opts.morph3DFlag = true;
+            if (!parseMorphology(argv, idx, last, opt, opts.morph3DOperation, opts.morph3DSize, opts.morph3DEdgeMode)) {
+                return false;
+            }
+        }
+        else if (opt == "--distance3d") {
+            opts.distance3DFlag = true;
+            parseOptionalScale(argv, idx, last, opts.distance3DScale);
+        }
+        else if (opt == "--components") {
+            if (idx < last) {
+                opts.componentsFlag = true;
+                opts.componentsThreshold = std::stod(argv[idx++]);
+                if (idx < last) {
+                    try {
+                        size_t used = 0;
+                        const int connectivity = std::stoi(argv[idx], &used);
+                        if (used == std::string(argv[idx]).size()) {
+                            opts.componentsConnectivity = connectivity;
+                            idx++;
+                        }
+                    } catch (...) {
+                        // not a connectivity; leave it for the next option
+                    }
+                }
+            } else {
+                std::cerr << "[Error] Missing threshold after --components\n";
+                return false;
+            }
+        }
+        else if (opt == "--render") {
+            if (idx + 2 < last) {
+                opts.renderFlag = true;
+                opts.renderType = argv[idx++];
+                opts.renderAzimuth = std::stof(argv[idx++]);
+                opts.renderElevation = std::stof(argv[idx++]);
+            } else {
+                std::cerr << "[Error] Not enough parameters for --render\n";
+                return false;
+            }
+        }
+        else if (opt == "--orbit") {
+            if (idx + 1 < last) {
+                opts.orbitFlag = true;
+                opts.renderType = argv[idx++];
+                opts.orbitViews = std::stoi(argv[idx++]);
+                if (idx < last) {
+                    // optional elevation
+                    try {
+                        opts.renderElevation = std::stof(argv[idx]);
+                        idx++;
+                    } catch (...) {
+                        // ignore, keep 0
+                    }
+                }
+            } else {
+                std::cerr << "[Error] Not enough parameters for --orbit\n";
+                return false;
+            }
+        }
+        else if (opt == "--zrange") {
+            // user typed e.g. --zrange 10 20
+            if (idx + 1 < last) {
+                opts.slabRangeFlag = true;
+                opts.slabZMin      = std::stoi(argv[idx++]); // user is 1-based
+                opts.slabZMax      = std::stoi(argv[idx++]);
+            } else {
+                std::cerr << "[Error] Not enough parameters for --zrange\n";
+                return false;
+            }
+        }
+        else if (opt == "--compressed") {
+            opts.compressedFlag = true;
+        }
+        else if (opt == "--channels") {
+            const std::string mode = idx < last ? argv[idx++] : "";
+            if (mode == "auto") opts.channelMode = ChannelMode::Auto;
+            else if (mode == "keep") opts.channelMode = ChannelMode::Keep;
+            else if (mode == "collapse") opts.channelMode = ChannelMode::Collapse;
+            else {
+                std::cerr << "[Error] Unknown channel mode: " << mode << " (use auto, keep or collapse)\n";
+                return false;
+            }
+        }
+        else if (opt == "--map") {
+            // e.g. --map window 1040 400
+            const int count = idx < last ? outputMappingArgCount(argv[idx]) : 0;
+            if (idx + std::max(count, 0) >= last) {
+                std::cerr << "[Error] Not enough parameters for --map\n";
+                return false;
+            }
+            std::vector<std::string> args(argv + idx, argv + idx + std::max(count, 0) + 1);
+            idx += static_cast<int>(args.size());
+            if (!parseOutputMapping(args, opts.outputMapping)) {
+                return false;
+            }
+        }
+        else if (opt == "--level") {
+            if (!parsePyramidLevel(argv, idx, last, opts.pyramidLevel, opts.pyramidMode)) {
+                return false;
+            }
+        }
+        else if (opt == "--profile") {
+            if (!parseProfileFile(argv, idx, last, opts.profileFile)) {
+                return false;
+            }
+        }
+        else if (opt == "--png-level") {
+            if (!parsePngLevel(argv, idx, last, opts.pngLevel)) {
+                return false;
+            }
+        }
+        else if (opt == "--threads") {
+            if (!parseThreads(argv, idx, last, opts.threads)) {
+                return false;
+            }
+        }
+        else {
+            std::cerr << "[Warning] Unknown 3D option: " << opt << "\n";
+        }
+    }
+
+    return true;
+}
+
+// -------------------------------------------------------------------
+// process2DImage
+// -------------------------------------------------------------------
+bool process2DImage(const ProgramOptions2D &opts, std::vector<unsigned char>* encoded) {
+    // Load
+    Image img;
+    if (!img.load(opts.inputFile)) {
+        std::cerr << "Failed to load image: " << opts.inputFile << std::endl;
+        return false;
+    }
+    if (opts.pyramidLevel > 0) {
+        img = Pyramid::atLevel(img, opts.pyramidLevel, opts.pyramidMode);
+        std::cout << "Using pyramid level " << opts.pyramidLevel << ": "
+                  << img.getWidth() << " x " << img.getHeight() << "\n";
+    }
+
+    // Build a pipeline of Filter2D*
+    std::vector<Filter2D*> filters2D;
+
+    if (opts.greyscale) {
+        filters2D.push_back(createGreyscaleFilter());
+    }
+    if (opts.brightnessFlag) {
+        if (opts.autoBrightness) {
+            filters2D.push_back(createBrightnessFilter()); // no-arg => auto
+        } else {
+            filters2D.push_back(createBrightnessFilter(opts.brightnessValue));
+        }
+    }
+    if (opts.histogramFlag) {
+        filters2D.push_back(createHistogramEqualisationFilter(opts.histogramType));
+    }
+    if (opts.blurFlag) {
+        if (opts.blurType == "Box") {
+            filters2D.push_back(createBoxBlurFilter(opts.blurKernelSize));
+        }
+        else if (opts.blurType == "Gaussian") {
+            filters2D.push_back(createGaussianBlurFilter(opts.blurKernelSize, opts.blurStdev));
+        }
+        else if (opts.blurType == "Median") {
+            filters2D.push_back(createMedianBlurFilter(opts.blurKernelSize));
+        }
+        else {
+            std::cerr << "[Error] Unknown blur type: " << opts.blurType << "\n";
+        }
+    }
+    if (opts.convolveFlag) {
+        filters2D.push_back(createConvolutionFilter(opts.convolveKernel, opts.convolveEdgeMode));
+    }
+    if (opts.edgeFlag) {
+        filters2D.push_back(createEdgeDetectionFilter(opts.edgeType));
+    }
+    if (opts.sharpen) {
+        filters2D.push_back(createSharpenFilter());
+    }
+    if (opts.saltPepperFlag) {
+        filters2D.push_back(createSaltPepperFilter(opts.saltPepperPercent));
+    }
+    if (opts.thresholdFlag) {
+        filters2D.push_back(createThresholdFilter(opts.thresholdValue, opts.thresholdMode));
+    }
+    if (opts.morphFlag) {
+        filters2D.push_back(createMorphologyFilter(opts.morphOperation, opts.morphSize, opts.morphSize,
+                                                   opts.morphEdgeMode));
+    }
+    if (opts.distanceFlag) {
+        filters2D.push_back(createDistanceTransformFilter(opts.distanceScale));
+    }
+
+    // Apply filters
+    for (auto* f : filters2D) {
+        f->apply(img);
+    }
+
+    // Save result
+    if (!writeResult(img, opts.outputFile, encoded, opts.pngLevel)) {
+        std::cerr << "Failed to save image: " << opts.outputFile << std::endl;
+        for (auto* f : filters2D) delete f;
+        return false;
+    }
+
+    // Cleanup
+    for (auto* f : filters2D) {
+        delete f;
+    }
+    filters2D.clear();
+
+    return true;
+}
+
+namespace {
+
+    // -------------------------------------------------------------------
+    // Helpers for the projection types that run incrementally or along rays
+    // -------------------------------------------------------------------
+    bool parseProjectionMode(const std::string& type, ProjectionMode& mode) {
+        if (type == "MIP") {
+            mode = ProjectionMode::MIP;
+        }
+        else if (type == "MinIP") {
+            mode = ProjectionMode::MinIP;
+        }
+        else if (type == "meanAIP") {
+            mode = ProjectionMode::Mean;
+        }
+        else {
+            std::cerr << "[Error] Unknown projection type: " << type << " (use MIP, MinIP or meanAIP)\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Saves a volume as a numbered series: "out/slab.png" => out/slab000.png, out/slab001.png, ...
+    bool saveSeries(const Volume& series, const std::string& outputFile, int pngLevel) {
+        std::string base = outputFile;
+        std::string ext = "png";
+        std::size_t dot = base.find_last_of('.');
+        if (dot != std::string::npos && base.find_first_of("/\\", dot) == std::string::npos) {
+            ext = base.substr(dot + 1);
+            base = base.substr(0, dot);
+        }
+        if (!series.save(base, ext, pngLevel)) {
+            std::cerr << "[Error] Failed to save image series: " << outputFile << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // -------------------------------------------------------------------
+    // processSlabStack: thick-slab movie written as a numbered image series
+    // -------------------------------------------------------------------
+    bool processSlabStack(const Volume& vol, const ProgramOptions3D &opts) {
+        ProjectionMode mode;
+        if (!parseProjectionMode(opts.slabStackType, mode)) {
+            return false;
+        }
+        Volume stack = Projection::slabStack(vol, mode, opts.slabThickness);
+        if (stack.getDepth() == 0) {
+            return false;
+        }
+        return saveSeries(stack, opts.outputFile, opts.pngLevel);
+    }
+
+    // -------------------------------------------------------------------
+    // processComponents: connected components written as a CSV table
+    // -------------------------------------------------------------------
+    template <typename T>
+    bool processComponents(const BasicVolume<T>& vol, const ProgramOptions3D &opts) {
+        ComponentLabels result = Segmentation::labelComponents(vol, opts.componentsThreshold, opts.componentsConnectivity);
+        if (result.depth == 0) {
+            return false;
+        }
+        std::ofstream out(opts.outputFile);
+        if (!out) {
+            std::cerr << "[Error] Failed to write component table: " << opts.outputFile << "\n";
+            return false;
+        }
+        // Coordinates are 1-based, like the other volume options.
+        out << "label,voxels,min_x,min_y,min_z,max_x,max_y,max_z\n";
+        size_t largest = 0;
+        for (const Component& c : result.components) {
+            out << c.label << ',' << c.voxels << ','
+                << c.minX + 1 << ',' << c.minY + 1 << ',' << c.minZ + 1 << ','
+                << c.maxX + 1 << ',' << c.maxY + 1 << ',' << c.maxZ + 1 << '\n';
+            largest = std::max(largest, c.voxels);
+        }
+        std::cout << "Found " << result.components.size() << " component(s) at threshold " << opts.componentsThreshold
+                  << " with " << opts.componentsConnectivity << "-connectivity; the largest has " << largest << " voxels.\n";
+        return static_cast<bool>(out);
+    }
+
+    // -------------------------------------------------------------------
+    // processRender: ray-cast view, or a full orbit written as a numbered series
+    // -------------------------------------------------------------------
+    bool processRender(const Volume& vol, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+        ProjectionMode mode;
+        if (!parseProjectionMode(opts.renderType, mode)) {
+            return false;
+        }
+        RenderSettings settings;
+        settings.azimuthDeg = opts.renderAzimuth;
+        settings.elevationDeg = opts.renderElevation;
+
+        if (opts.orbitFlag) {
+            Volume views = RayCaster::renderOrbit(vol, mode, opts.orbitViews, settings);
+            if (views.getDepth() == 0) {
+                return false;
+            }
+            return saveSeries(views, opts.outputFile, opts.pngLevel);
+        }
+
+        Image result = RayCaster::render(vol, mode, settings);
+        if (!writeResult(result, opts.outputFile, encoded, opts.pngLevel)) {
+            std::cerr << "[Error] Failed to save rendered view: " << opts.outputFile << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // -------------------------------------------------------------------
+    // processVoxels: 3D filters, then a projection, slice or reformat.
+    // Runs on 8-bit volumes and on 16-bit scans (projection/slice only).
+    // -------------------------------------------------------------------
+    // Applies the --blur3d filter.
+    template <typename T>
+    bool applyBlur3D(BasicVolume<T>& vol, const ProgramOptions3D &opts) {
+        Filter3D* filter = nullptr;
+        if (opts.blur3DType == "Gaussian") {
+            filter = createGaussianBlur3DFilter(opts.blur3DKernelSize, opts.blur3DStdev);
+        }
+        else if (opts.blur3DType == "Median") {
+            filter = createMedianBlur3DFilter(opts.blur3DKernelSize);
+        }
+        else {
+            std::cerr << "[Error] Unknown 3D blur type: " << opts.blur3DType << "\n";
+            return false;
+        }
+        filter->apply(vol);
+        delete filter;
+        return true;
+    }
+
+    // Whether --blur3d, --convolve3d, --threshold3d, --morph3d or --distance3d changes the voxels.
+    bool filtersVolume(const ProgramOptions3D &opts) {
+        return opts.blur3DFlag || opts.convolve3DFlag || opts.threshold3DFlag || opts.morph3DFlag ||
+               opts.distance3DFlag;
+    }
+
+    // Applies --blur3d, --convolve3d, --threshold3d, --morph3d and --distance3d, in that order, if they were requested.
+    template <typename T>
+    bool applyVolumeFilters(BasicVolume<T>& vol, const ProgramOptions3D &opts) {
+        if (opts.blur3DFlag && !applyBlur3D(vol, opts)) {
+            return false;
+        }
+        if (opts.convolve3DFlag) {
+            Filter3D* filter = createConvolution3DFilter(opts.convolve3DKernel, opts.convolve3DEdgeMode);
+            filter->apply(vol);
+            delete filter;
+        }
+        if (opts.threshold3DFlag) {
+            Filter3D* filter = createThreshold3DFilter(opts.threshold3DValue);
+            filter->apply(vol);
+            delete filter;
+        }
+        if (opts.morph3DFlag) {
+            Filter3D* filter = createMorphology3DFilter(opts.morph3DOperation, opts.morph3DSize, opts.morph3DSize,
+                                                        opts.morph3DSize, opts.morph3DEdgeMode);
+            filter->apply(vol);
+            delete filter;
+        }
+        if (opts.distance3DFlag) {
+            Filter3D* filter = createDistanceTransform3DFilter(opts.distance3DScale);
+            filter->apply(vol);
+            delete filter;
+        }
+        return true;
+    }
+
+    // Writes a 2D result of volume processing.
+    template <typename T>
+    bool writeVolumeImage(const BasicImage<T>& result, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+        if (!writeResult(result, opts.outputFile, encoded, opts.pngLevel)) {
+            std::cerr << "[Error] Failed to save processed volume image: " << opts.outputFile << "\n";
+            return false;
+        }
+        if (!encoded) {
+            std::cout << "Processed volume image saved as " << opts.outputFile << "\n";
+        }
+        return true;
+    }
+
+    // Normalises and writes a slice or reformat.
+    template <typename T>
+    bool saveVolumeResult(BasicImage<T>& result, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+        normalizeMinMax(result);
+        return writeVolumeImage(result, opts, encoded);
+    }
+
+    // Maps a raw projection of T voxels to 8 bits with --map and writes it.
+    template <typename T>
+    bool saveProjection(const BasicImage<float>& raw, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+        // --map window takes voxel values; raw projections are scaled to [0, 1].
+        OutputMapping mapping = opts.outputMapping;
+        mapping.center /= PixelTraits<T>::maxValue;
+        mapping.width /= PixelTraits<T>::maxValue;
+        return writeVolumeImage(mapToImage(raw, mapping), opts, encoded);
+    }
+
+    // Produces the requested projection, slice, reformat, slab stack, render or component table. Only reads the volume.
+    template <typename T>
+    bool writeVolumeOutput(const BasicVolume<T>& vol, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+        // Must do either projection, slice, reformat, slab stack, a ray-cast render or components
+        if (!opts.projectionFlag && !opts.sliceFlag && !opts.obliqueFlag && !opts.curvedFlag &&
+            !opts.slabStackFlag && !opts.renderFlag && !opts.orbitFlag && !opts.componentsFlag) {
+            std::cerr << "[Error] No volume processing option specified. "
+                      << "Use --projection, --slice, --oblique, --curved, --slab, --render, --orbit or --components.\n";
+            return false;
+        }
+
+        if (opts.componentsFlag) {
+            if (encoded) {
+                std::cerr << "[Error] --components writes a CSV table and needs an output path.\n";
+                return false;
+            }
+            return processComponents(vol, opts);
+        }
+
+        if constexpr (std::is_same_v<T, unsigned char>) {
+            if (encoded && (opts.slabStackFlag || opts.orbitFlag)) {
+                std::cerr << "[Error] --slab and --orbit write an image series and need an output path.\n";
+                return false;
+            }
+            if (opts.slabStackFlag) {
+                return processSlabStack(vol, opts);
+            }
+            if (opts.renderFlag || opts.orbitFlag) {
+                return processRender(vol, opts, encoded);
+            }
+        }
+
+        if (opts.projectionFlag) {
+            // If user gave partial slab range => convert from 1-based to 0-based
+            int zMin = 0;
+            int zMax = vol.getDepth() - 1;
+            if (opts.slabRangeFlag) {
+                zMin = opts.slabZMin - 1;
+                zMax = opts.slabZMax - 1;
+                // clamp
+                if (zMin < 0) zMin = 0;
+                if (zMax >= vol.getDepth()) zMax = vol.getDepth()-1;
+                if (zMin > zMax) {
+                    std::cerr << "[Error] slab z-range is invalid.\n";
+                    return false;
+                }
+            }
+
+            BasicImage<float> raw;
+            if (opts.projectionType == "MIP") {
+                raw = Projection::rawProjection(vol, ProjectionMode::MIP, zMin, zMax);
+            }
+            else if (opts.projectionType == "MinIP") {
+                raw = Projection::rawProjection(vol, ProjectionMode::MinIP, zMin, zMax);
+            }
+            else if (opts.projectionType == "meanAIP") {
+                raw = Projection::rawProjection(vol, ProjectionMode::Mean, zMin, zMax);
+            }
+            else if (opts.projectionType == "medianAIP") {
+                raw = Projection::rawMedianProjection(vol, zMin, zMax);
+            }
+            else {
+                //- Projection: `--projection <type>` or `-p <type>` (e.g., MIP, MinIP, meanAIP, medianAIP)
+                std::cerr << "[Error] Unknown projection type: " << opts.projectionType << "\n";
+                return false;
+            }
+            return saveProjection<T>(raw, opts, encoded);
+        }
+
+        BasicImage<T> result;
+        if (opts.sliceFlag) {
+            // Do a slice
+            int planeCoord = opts.sliceConstant - 1;
+            result = Slice::sliceVolume(vol, opts.slicePlane, planeCoord);
+        }
+        else if constexpr (std::is_same_v<T, unsigned char>) {
+            if (opts.obliqueFlag) {
+                // 1-based point => 0-based voxel coordinates
+                Vec3 point = opts.obliquePoint - Vec3{ 1.0f, 1.0f, 1.0f };
+                result = Slice::obliqueSlice(vol, point, opts.obliqueNormal, opts.sliceInterp);
+            }
+            else if (opts.curvedFlag) {
+                std::vector<Vec3> curve;
+                for (const Vec3& p : opts.curvedPoints) {
+                    curve.push_back(p - Vec3{ 1.0f, 1.0f, 1.0f });
+                }
+                result = Slice::curvedSlice(vol, curve, opts.sliceInterp);
+            }
+        }
+
+        return saveVolumeResult(result, opts, encoded);
+    }
+
+    template <typename T>
+    bool processVoxels(BasicVolume<T>& vol, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+        return applyVolumeFilters(vol, opts) && writeVolumeOutput(vol, opts, encoded);
+    }
+
+    // Deep copy, so filters can run without changing a volume that other requests share.
+    template <typename T>
+    BasicVolume<T> copyVolume(const BasicVolume<T>& vol) {
+        BasicVolume<T> copy(vol.getWidth(), vol.getHeight(), vol.getDepth(), vol.getChannels());
+        const size_t sliceSamples = static_cast<size_t>(vol.getWidth()) * vol.getHeight() * vol.getChannels();
+        for (int z = 0; z < vol.getDepth(); ++z) {
+            std::memcpy(copy.getSlices()[z].getData(), vol.getSlices()[z].getData(), sliceSamples * sizeof(T));
+        }
+        return copy;
+    }
+
+    template <typename T>
+    bool processSharedVolume(const BasicVolume<T>& vol, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+        if constexpr (std::is_same_v<T, unsigned char>) {
+            if (opts.pyramidLevel > 0) {
+                Volume reduced = Pyramid::atLevel(vol, opts.pyramidLevel, opts.pyramidMode);
+                return processVoxels(reduced, opts, encoded);
+            }
+        }
+        if (filtersVolume(opts)) {
+            BasicVolume<T> filtered = copyVolume(vol);
+            return processVoxels(filtered, opts, encoded);
+        }
+        return writeVolumeOutput(vol, opts, encoded);
+    }
+
+    // MIP, MinIP and mean projections of an unfiltered, full-resolution volume are folded
+    // slice by slice from disk, so the volume is never held in memory.
+    bool streamsProjection(const ProgramOptions3D &opts) {
+        return opts.projectionFlag && !opts.slabStackFlag && !opts.renderFlag && !opts.orbitFlag &&
+               !filtersVolume(opts) && opts.pyramidLevel == 0 &&
+               (opts.projectionType == "MIP" || opts.projectionType == "MinIP" || opts.projectionType == "meanAIP");
+    }
+
+    template <typename T>
+    bool processStreamedProjection(const SliceSeries& series, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+        // Same z range as writeVolumeOutput.
+        int zMin = 0;
+        int zMax = series.getDepth() - 1;
+        if (opts.slabRangeFlag) {
+            zMin = std::max(0, opts.slabZMin - 1);
+            zMax = std::min(series.getDepth() - 1, opts.slabZMax - 1);
+            if (zMin > zMax) {
+                std::cerr << "[Error] slab z-range is invalid.\n";
+                return false;
+            }
+        }
+
+        ProjectionMode mode = ProjectionMode::Mean;
+        if (opts.projectionType == "MIP") {
+            mode = ProjectionMode::MIP;
+        }
+        else if (opts.projectionType == "MinIP") {
+            mode = ProjectionMode::MinIP;
+        }
+        return saveProjection<T>(Projection::streamRawProjection<T>(series, mode, zMin, zMax), opts, encoded);
+    }
+
+    // MIP, MinIP, mean and axis slices of an unfiltered, full-resolution volume are read
+    // straight from the compressed rows; everything else needs the decoded volume.
+    bool readsCompressed(const ProgramOptions3D &opts) {
+        if (filtersVolume(opts) || opts.pyramidLevel > 0 || opts.slabStackFlag || opts.renderFlag || opts.orbitFlag) {
+            return false;
+        }
+        if (opts.projectionFlag) {
+            return opts.projectionType == "MIP" || opts.projectionType == "MinIP" || opts.projectionType == "meanAIP";
+        }
+        return opts.sliceFlag;
+    }
+
+    template <typename T>
+    bool processCompressedVolume(const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+        BasicCompressedVolume<T> vol;
+        if (!vol.load(opts.inputDir, opts.channelMode)) {
+            std::cerr << "Failed to load volume: " << opts.inputDir << std::endl;
+            return false;
+        }
+        const double rawMB = vol.rawBytes() / (1024.0 * 1024.0);
+        const double storedMB = vol.compressedBytes() / (1024.0 * 1024.0);
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Compressed " << (sizeof(T) > 1 ? "16-bit " : "") << "volume: "
+                  << vol.getWidth() << " x " << vol.getHeight() << " x " << vol.getDepth()
+                  << " with " << vol.getChannels() << " channel(s), " << rawMB << " MB raw, "
+                  << storedMB << " MB stored (" << rawMB / std::max(storedMB, 1e-9) << "x).\n"
+                  << std::defaultfloat;
+
+        if (!readsCompressed(opts)) {
+            const auto start = std::chrono::steady_clock::now();
+            BasicVolume<T> full = vol.decompress();
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            vol = BasicCompressedVolume<T>();
+            std::cout << std::fixed << std::setprecision(2) << "Decompressed the volume for this option in "
+                      << seconds * 1000.0 << " ms (" << rawMB / 1024.0 / std::max(seconds, 1e-9) << " GB/s).\n"
+                      << std::defaultfloat;
+            if constexpr (std::is_same_v<T, unsigned char>) {
+                if (opts.pyramidLevel > 0) {
+                    full = Pyramid::atLevel(full, opts.pyramidLevel, opts.pyramidMode);
+                    std::cout << "Using pyramid level " << opts.pyramidLevel << "\n";
+                }
+            }
+            return processVoxels(full, opts, encoded);
+        }
+
+        if (opts.sliceFlag) {
+            BasicImage<T> result = Slice::sliceVolume(vol, opts.slicePlane, opts.sliceConstant - 1);
+            return saveVolumeResult(result, opts, encoded);
+        }
+        // Same z range as writeVolumeOutput.
+        int zMin = 0;
+        int zMax = vol.getDepth() - 1;
+        if (opts.slabRangeFlag) {
+            zMin = std::max(0, opts.slabZMin - 1);
+            zMax = std::min(vol.getDepth() - 1, opts.slabZMax - 1);
+            if (zMin > zMax) {
+                std::cerr << "[Error] slab z-range is invalid.\n";
+                return false;
+            }
+        }
+        ProjectionMode mode = ProjectionMode::Mean;
+        if (opts.projectionType == "MIP") {
+            mode = ProjectionMode::MIP;
+        }
+        else if (opts.projectionType == "MinIP") {
+            mode = ProjectionMode::MinIP;
+        }
+        return saveProjection<T>(Projection::rawProjection(vol, mode, zMin, zMax), opts, encoded);
+    }
+
+} // end anonymous namespace
+
+// -------------------------------------------------------------------
+// process3DVolume
+// -------------------------------------------------------------------
+bool loadsAsSixteenBit(const ProgramOptions3D &opts) {
+    // 16-bit scans keep their full range for projections, axis slices and components;
+    // every other option works on 8-bit data.
+    std::vector<std::string> files = Volume::listSliceFiles(opts.inputDir);
+    bool sixteenBit = !files.empty() && isSixteenBitFile(files.front());
+    if (!sixteenBit) {
+        return false;
+    }
+    if ((opts.projectionFlag || opts.sliceFlag || opts.componentsFlag) && opts.pyramidLevel == 0) {
+        return true;
+    }
+    std::cout << "[Info] 16-bit slices are reduced to 8 bits for this option.\n";
+    return false;
+}
+
+bool process3DVolume(const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+    if (opts.compressedFlag) {
+        return loadsAsSixteenBit(opts) ? processCompressedVolume<std::uint16_t>(opts, encoded)
+                                       : processCompressedVolume<unsigned char>(opts, encoded);
+    }
+    if (streamsProjection(opts)) {
+        SliceSeries series;
+        if (!series.open(opts.inputDir, opts.channelMode)) {
+            std::cerr << "Failed to load volume: " << opts.inputDir << std::endl;
+            return false;
+        }
+        const bool sixteenBit = loadsAsSixteenBit(opts);
+        std::cout << "Streaming " << (sixteenBit ? "16-bit " : "") << "volume: "
+                  << series.width << " x " << series.height
+                  << " x " << series.getDepth()
+                  << " with " << series.channels << " channel(s).\n";
+        return sixteenBit ? processStreamedProjection<std::uint16_t>(series, opts, encoded)
+                          : processStreamedProjection<unsigned char>(series, opts, encoded);
+    }
+    if (loadsAsSixteenBit(opts)) {
+        Volume16 vol;
+        if (!vol.load(opts.inputDir, opts.channelMode)) {
+            std::cerr << "Failed to load volume: " << opts.inputDir << std::endl;
+            return false;
+        }
+        std::cout << "Loaded 16-bit volume: "
+                  << vol.getWidth() << " x " << vol.getHeight()
+                  << " x " << vol.getDepth()
+                  << " with " << vol.getChannels() << " channel(s).\n";
+        return processVoxels(vol, opts, encoded);
+    }
+
+    // Load
+    Volume vol;
+    if (!vol.load(opts.inputDir, opts.channelMode)) {
+        std::cerr << "Failed to load volume: " << opts.inputDir << std::endl;
+        return false;
+    }
+    if (opts.pyramidLevel > 0) {
+        vol = Pyramid::atLevel(vol, opts.pyramidLevel, opts.pyramidMode);
+        std::cout << "Using pyramid level " << opts.pyramidLevel << "\n";
+    }
+    std::cout << "Loaded volume: "
+              << vol.getWidth() << " x " << vol.getHeight()
+              << " x " << vol.getDepth()
+              << " with " << vol.getChannels() << " channel(s).\n";
+    return processVoxels(vol, opts, encoded);
+}
+
+bool processLoadedVolume(const Volume& vol, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+    return processSharedVolume(vol, opts, encoded);
+}
+
+bool processLoadedVolume(const Volume16& vol, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded) {
+    return processSharedVolume(vol, opts, encoded);
+}
@@ -0,0 +1,224 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <string>
+#include <vector>
+#include "Convolution.h"
+#include "Filter.h"
+#include "Image.h"
+#include "OutputMapping.h"
+#include "Pyramid.h"
+#include "Volume.h"
+#include "VolumeSampler.h"
+
+// -------------------------------------------------------------------
+// Structures to hold options for 2D and 3D modes
+// -------------------------------------------------------------------
+struct ProgramOptions2D {
+    std::string inputFile;
+    std::string outputFile;
+
+    bool greyscale        = false;
+    bool sharpen          = false;
+
+    bool brightnessFlag   = false;
+    bool autoBrightness   = false;  // true => no numeric offset => auto
+    int brightnessValue   = 0;
+
+    bool histogramFlag    = false;
+    std::string histogramType;  // e.g., "HSV","HSL"
+
+    bool thresholdFlag    = false;
+    int thresholdValue    = 128;
+    std::string thresholdMode;
+
+    bool saltPepperFlag   = false;
+    float saltPepperPercent = 0.0f;
+
+    bool blurFlag         = false;
+    std::string blurType;
+    int blurKernelSize    = 3;
+    double blurStdev      = 2.0;
+
+    bool edgeFlag         = false;
+    std::string edgeType;
+
+    // Kernel loaded from a text file while parsing, applied after the blur
+    bool convolveFlag     = false;
+    ConvolutionKernel convolveKernel;
+    EdgeMode convolveEdgeMode = EdgeMode::Extend;
+
+    // Erode, Dilate, Open or Close over a square, applied after the threshold
+    bool morphFlag        = false;
+    std::string morphOperation;
+    int morphSize         = 3;
+    EdgeMode morphEdgeMode = EdgeMode::Extend;
+
+    // Euclidean distance to the nearest 0 pixel, applied after the other filters
+    bool distanceFlag     = false;
+    double distanceScale  = 1.0;
+
+    // Pyramid level to process (0 = native resolution)
+    int pyramidLevel      = 0;
+    ReduceMode pyramidMode = ReduceMode::Box;
+
+    // Chrome trace written by --profile (empty = profiling off)
+    std::string profileFile;
+
+    // Deflate level for PNG output, 0-9 (-1 = encoder default)
+    int pngLevel = -1;
+
+    // Threads for the parallel kernels (0 = all hardware threads)
+    int threads = 0;
+};
+
+struct ProgramOptions3D {
+    std::string inputDir;
+    std::string outputFile;
+
+    // Grey slices stored as RGB/RGBA are read as one channel unless --channels keep
+    ChannelMode channelMode = ChannelMode::Auto;
+
+    // Keep the volume run-length encoded in memory (--compressed)
+    bool compressedFlag    = false;
+
+    bool blur3DFlag        = false;
+    std::string blur3DType;
+    int blur3DKernelSize   = 3;
+    double blur3DStdev     = 2.0;
+
+    // Kernel loaded from a text file while parsing, applied after the blur
+    bool convolve3DFlag    = false;
+    ConvolutionKernel convolve3DKernel;
+    EdgeMode convolve3DEdgeMode = EdgeMode::Extend;
+
+    // Binary threshold of the volume after any blur (voxel units)
+    bool threshold3DFlag   = false;
+    double threshold3DValue = 128.0;
+
+    // Erode, Dilate, Open or Close over a cube, applied after the threshold
+    bool morph3DFlag       = false;
+    std::string morph3DOperation;
+    int morph3DSize        = 3;
+    EdgeMode morph3DEdgeMode = EdgeMode::Extend;
+
+    // Euclidean distance to the nearest 0 voxel, applied after the threshold and morphology
+    bool distance3DFlag    = false;
+    double distance3DScale = 1.0;
+
+    bool projectionFlag    = false;
+    std::string projectionType;
+
+    bool sliceFlag         = false;
+    std::string slicePlane;
+    int sliceConstant      = 0;
+
+    // Oblique plane (point + normal) or curved (polyline) reformat, 1-based voxel coordinates
+    bool obliqueFlag       = false;
+    Vec3 obliquePoint;
+    Vec3 obliqueNormal{ 0.0f, 0.0f, 1.0f };
+    bool curvedFlag        = false;
+    std::vector<Vec3> curvedPoints;
+    Interpolation sliceInterp = Interpolation::Trilinear;
+
+    // Sliding thick-slab projection stack
+    bool slabStackFlag     = false;
+    std::string slabStackType;
+    int slabThickness      = 1;
+
+    // Ray-cast projection from an arbitrary direction, or a full turn of views
+    bool renderFlag        = false;
+    std::string renderType;
+    float renderAzimuth    = 0.0f;
+    float renderElevation  = 0.0f;
+    bool orbitFlag         = false;
+    int orbitViews         = 36;
+
+    // Connected components of the voxels at or above a threshold, written as a CSV table
+    bool componentsFlag    = false;
+    double componentsThreshold = 128.0;
+    int componentsConnectivity = 26;
+
+    // For partial slab:
+    bool slabRangeFlag     = false; // if user provided --zrange
+    int slabZMin           = 0;     // 1-based
+    int slabZMax           = 0;     // 1-based
+
+    // Mapping of projections to 8-bit output (--map); window values are voxel values
+    OutputMapping outputMapping;
+
+    // Pyramid level to process (0 = native resolution)
+    int pyramidLevel       = 0;
+    ReduceMode pyramidMode = ReduceMode::Box;
+
+    // Chrome trace written by --profile (empty = profiling off)
+    std::string profileFile;
+
+    // Deflate level for PNG output, 0-9 (-1 = encoder default)
+    int pngLevel = -1;
+
+    // Threads for the parallel kernels (0 = all hardware threads)
+    int threads = 0;
+};
+
+/**
+ * @brief Prints the command line help to stderr.
+ * @param progName Program name shown in the examples.
+ */
+void printUsage(const std::string& progName);
+
+/**
+ * @brief Parses `-i <input> [options] <output>`.
+ * @return False if an option is malformed (an error has been printed).
+ */
+bool parseCommandLine2D(int argc, char* argv[], ProgramOptions2D &opts);
+
+/**
+ * @brief Parses `-d <volume> [options] <output>`.
+ * @return False if an option is malformed (an error has been printed).
+ */
+bool parseCommandLine3D(int argc, char* argv[], ProgramOptions3D &opts);
+
+/**
+ * @brief Loads the input image, runs the filter chain and writes the result.
+ * @param opts Parsed 2D options.
+ * @param encoded If not null, receives the result as PNG bytes instead of writing opts.outputFile.
+ * @return True on success.
+ */
+bool process2DImage(const ProgramOptions2D &opts, std::vector<unsigned char>* encoded = nullptr);
+
+/**
+ * @brief Whether the volume in opts.inputDir is processed at 16 bits.
+ *
+ * True for 16-bit slices when only a projection or axis slice at level 0 is requested;
+ * every other option runs on 8-bit data.
+ */
+bool loadsAsSixteenBit(const ProgramOptions3D &opts);
+
+/**
+ * @brief Loads the input volume, runs the 3D filter and the requested output, and writes the result.
+ * @param opts Parsed 3D options.
+ * @param encoded If not null, receives the result as PNG bytes instead of writing opts.outputFile.
+ * @return True on success.
+ */
+bool process3DVolume(const ProgramOptions3D &opts, std::vector<unsigned char>* encoded = nullptr);
+
+/**
+ * @brief Runs the 3D options on a volume that is already in memory.
+ *
+ * The volume is left unchanged: filters and pyramid levels work on a copy, so one loaded
+ * volume can serve many requests. opts.inputDir is ignored.
+ *
+ * @param vol The loaded volume.
+ * @param opts Parsed 3D options.
+ * @param encoded If not null, receives the result as PNG bytes instead of writing opts.outputFile.
+ * @return True on success.
+ */
+bool processLoadedVolume(const Volume& vol, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded = nullptr);
+
+/**
+ * @brief 16-bit overload of processLoadedVolume (projection and axis slices only).
+ */
+bool processLoadedVolume(const Volume16& vol, const ProgramOptions3D &opts, std::vector<unsigned char>* encoded = nullptr);
+
+#endif // CLI_H
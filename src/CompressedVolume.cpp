@@ -0,0 +1,219 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the run-length encoded volume store. A row is a list of 16-bit tokens:
+ * the low 15 bits hold a length minus one and the top bit marks a run. A run stores one pixel
+ * for all of its length; a literal stores its pixels as they are. Runs shorter than kMinRun
+ * pixels stay inside literals, where they cost nothing extra. Rows are independent, so any
+ * row can be decoded without touching the rest of its slice.
+ */
+#include "CompressedVolume.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "Projection.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+    constexpr int kMinRun = 8;
+    constexpr int kMaxTokenLength = 1 << 15;
+    constexpr std::uint16_t kRunFlag = 0x8000;
+
+    // Bitwise, so float pixels that compare equal but differ in their bits (-0.0 and +0.0) stay apart.
+    template <typename T>
+    inline bool samePixel(const T* a, const T* b, int channels) {
+        return std::memcmp(a, b, sizeof(T) * channels) == 0;
+    }
+
+    template <typename T>
+    void encodeRow(const T* row, int width, int channels, std::vector<std::uint16_t>& tokens, std::vector<T>& samples) {
+        // Emits `count` pixels from `start` as one or more tokens of at most kMaxTokenLength.
+        auto emit = [&](bool run, int start, int count) {
+            while (count > 0) {
+                const int n = std::min(count, kMaxTokenLength);
+                tokens.push_back(static_cast<std::uint16_t>((run ? kRunFlag : 0) | (n - 1)));
+                const T* first = row + static_cast<std::size_t>(start) * channels;
+                samples.insert(samples.end(), first, first + static_cast<std::size_t>(run ? 1 : n) * channels);
+                start += n;
+                count -= n;
+            }
+        };
+        int literal = 0;
+        for (int x = 0; x < width;) {
+            int end = x + 1;
+            while (end < width && samePixel(row + static_cast<std::size_t>(end) * channels,
+                                            row + static_cast<std::size_t>(x) * channels, channels)) {
+                ++end;
+            }
+            if (end - x >= kMinRun) {
+                emit(false, literal, x - literal);
+                emit(true, x, end - x);
+                literal = end;
+            }
+            x = end;
+        }
+        emit(false, literal, width - literal);
+    }
+
+    template <typename T>
+    void decodeRow(const std::uint16_t* tokens, const T* samples, int width, int channels, T* dest) {
+        for (int x = 0; x < width;) {
+            const std::uint16_t token = *tokens++;
+            const int n = (token & (kRunFlag - 1)) + 1;
+            const std::size_t count = static_cast<std::size_t>(n) * channels;
+            if (token & kRunFlag) {
+                if (channels == 1) {
+                    std::fill_n(dest, n, samples[0]);
+                } else {
+                    for (int i = 0; i < n; ++i) std::memcpy(dest + static_cast<std::size_t>(i) * channels, samples, sizeof(T) * channels);
+                }
+                samples += channels;
+            } else {
+                std::memcpy(dest, samples, sizeof(T) * count);
+                samples += count;
+            }
+            dest += count;
+            x += n;
+        }
+    }
+
+} // end anonymous namespace
+
+template <typename T>
+BasicCompressedVolume<T>::BasicCompressedVolume(const BasicVolume<T>& vol)
+    : width(vol.getWidth()), height(vol.getHeight()), depth(vol.getDepth()), channels(vol.getChannels()),
+      slices(vol.getDepth()) {
+    PROFILE_SCOPE_CAT("CompressedVolume::compress", "volume");
+    parallelForDynamic(0, depth, [&](int z) {
+        slices[z] = encodeSlice(vol.getSlices()[z].getData());
+    });
+}
+
+template <typename T>
+typename BasicCompressedVolume<T>::EncodedSlice BasicCompressedVolume<T>::encodeSlice(const T* data) const {
+    // Rows are encoded into per-thread buffers and copied out at their final size.
+    thread_local std::vector<std::uint16_t> tokens;
+    thread_local std::vector<T> samples;
+    tokens.clear();
+    samples.clear();
+    EncodedSlice slice;
+    slice.rowTokens.resize(height);
+    slice.rowSamples.resize(height);
+    const std::size_t rowLength = static_cast<std::size_t>(width) * channels;
+    for (int y = 0; y < height; ++y) {
+        slice.rowTokens[y] = tokens.size();
+        slice.rowSamples[y] = samples.size();
+        encodeRow(data + y * rowLength, width, channels, tokens, samples);
+    }
+    slice.tokens.assign(tokens.begin(), tokens.end());
+    slice.samples.assign(samples.begin(), samples.end());
+    return slice;
+}
+
+template <typename T>
+bool BasicCompressedVolume<T>::load(const std::string& directoryWithBasename, ChannelMode mode) {
+    PROFILE_SCOPE_CAT("CompressedVolume::load", "io");
+    slices.clear();
+    width = height = depth = channels = 0;
+
+    SliceSeries series;
+    if (!series.open(directoryWithBasename, mode)) {
+        return false;
+    }
+    width = series.width;
+    height = series.height;
+    channels = series.channels;
+    const bool collapse = series.channels != series.sourceChannels;
+    const int count = series.getDepth();
+    std::vector<EncodedSlice> encoded(count);
+    std::vector<char> loaded(count, 0);
+    std::vector<char> grey(count, 1);
+    parallelForDynamic(0, count, [&](int i) {
+        thread_local std::vector<T> raw;
+        raw.resize(static_cast<std::size_t>(width) * height * channels);
+        bool sliceGrey = true;
+        loaded[i] = BasicVolume<T>::loadSliceInto(series.files[i], raw.data(), width, height, series.sourceChannels,
+                                                  collapse, &sliceGrey);
+        grey[i] = sliceGrey;
+        if (loaded[i]) encoded[i] = encodeSlice(raw.data());
+    });
+    if (collapse && mode == ChannelMode::Auto) {
+        for (int i = 0; i < count; ++i) {
+            if (loaded[i] && !grey[i]) {
+                std::cout << "Slice " << series.files[i] << " is not grey; loading every channel.\n";
+                return load(directoryWithBasename, ChannelMode::Keep);
+            }
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (!loaded[i]) {
+            std::cerr << "Failed to load slice: " << series.files[i] << std::endl;
+            continue;
+        }
+        slices.push_back(std::move(encoded[i]));
+    }
+    depth = static_cast<int>(slices.size());
+    if (depth == 0) {
+        std::cerr << "No valid slices loaded from: " << directoryWithBasename << std::endl;
+        return false;
+    }
+    std::cout << "Loaded compressed volume from '" << directoryWithBasename << "' with " << width << " x " << height
+              << " x " << depth << ", channels = " << channels << std::endl;
+    return true;
+}
+
+template <typename T>
+void BasicCompressedVolume<T>::decompressRow(int y, int z, T* dest) const {
+    const EncodedSlice& slice = slices[z];
+    decodeRow(slice.tokens.data() + slice.rowTokens[y], slice.samples.data() + slice.rowSamples[y], width, channels, dest);
+}
+
+template <typename T>
+void BasicCompressedVolume<T>::decompressSlice(int z, T* dest) const {
+    const std::size_t rowLength = static_cast<std::size_t>(width) * channels;
+    for (int y = 0; y < height; ++y) {
+        decompressRow(y, z, dest + y * rowLength);
+    }
+}
+
+template <typename T>
+BasicVolume<T> BasicCompressedVolume<T>::decompress() const {
+    PROFILE_SCOPE_CAT("CompressedVolume::decompress", "volume");
+    BasicVolume<T> vol(width, height, depth, channels);
+    parallelForDynamic(0, depth, [&](int z) {
+        decompressSlice(z, vol.getSlices()[z].getData());
+    });
+    return vol;
+}
+
+template <typename T>
+std::size_t BasicCompressedVolume<T>::rawBytes() const {
+    return static_cast<std::size_t>(width) * height * depth * channels * sizeof(T);
+}
+
+template <typename T>
+std::size_t BasicCompressedVolume<T>::compressedBytes() const {
+    std::size_t bytes = 0;
+    for (const EncodedSlice& slice : slices) {
+        bytes += slice.tokens.size() * sizeof(std::uint16_t) + slice.samples.size() * sizeof(T) +
+                 (slice.rowTokens.size() + slice.rowSamples.size()) * sizeof(std::size_t);
+    }
+    return bytes;
+}
+
+template class BasicCompressedVolume<unsigned char>;
+template class BasicCompressedVolume<std::uint16_t>;
+template class BasicCompressedVolume<float>;
@@ -0,0 +1,113 @@
+#ifndef COMPRESSED_VOLUME_H
+#define COMPRESSED_VOLUME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Volume.h"
+
+/**
+ * @class BasicCompressedVolume
+ * @brief A volume kept in memory as run-length encoded rows, for scans too large to hold raw.
+ *
+ * Every row of every slice is stored as a sequence of runs (at least eight identical pixels,
+ * kept once) and literal spans (kept as they are). Air and other constant background then
+ * costs a few bytes per row, while a row with no runs grows by one 2-byte token per 32768
+ * pixels. The encoding is lossless.
+ *
+ * Rows are decoded on demand into buffers owned by the caller, so Projection::rawProjection
+ * and Slice::sliceVolume hold one decoded row (or slice) per thread, never the whole volume.
+ * Other operations call decompress() for an ordinary BasicVolume.
+ */
+template <typename T>
+class BasicCompressedVolume {
+public:
+    using value_type = T; ///< Type of one channel sample.
+
+    /**
+     * @brief Creates an empty compressed volume.
+     */
+    BasicCompressedVolume() = default;
+
+    /**
+     * @brief Compresses every slice of a volume, several slices at once.
+     * @param vol The volume to compress; it is not changed.
+     */
+    explicit BasicCompressedVolume(const BasicVolume<T>& vol);
+
+    /**
+     * @brief Reads a slice series like BasicVolume::load, compressing each slice as it is decoded.
+     *
+     * Only one decoded slice per thread exists at any time, so the peak memory is the
+     * compressed volume plus a few raw slices. Slices that fail to decode or do not match
+     * the first one are skipped; ChannelMode works as in BasicVolume::load.
+     *
+     * @param directoryWithBasename Directory path followed by the slice basename.
+     * @param mode How multi-channel slices are treated.
+     * @return True if at least one slice was loaded.
+     */
+    bool load(const std::string& directoryWithBasename, ChannelMode mode = ChannelMode::Keep);
+
+    /**
+     * @brief Decodes row y of slice z.
+     * @param y Row index (0-based).
+     * @param z Slice index (0-based).
+     * @param dest Receives width * channels samples.
+     */
+    void decompressRow(int y, int z, T* dest) const;
+
+    /**
+     * @brief Decodes slice z.
+     * @param z Slice index (0-based).
+     * @param dest Receives width * height * channels samples.
+     */
+    void decompressSlice(int z, T* dest) const;
+
+    /**
+     * @brief Decodes every slice into a new volume, several slices at once.
+     * @return The uncompressed volume.
+     */
+    BasicVolume<T> decompress() const;
+
+    int getWidth() const { return width; }       ///< Width of each slice.
+    int getHeight() const { return height; }     ///< Height of each slice.
+    int getDepth() const { return depth; }       ///< Number of slices.
+    int getChannels() const { return channels; } ///< Channels per voxel.
+
+    /**
+     * @brief Bytes the same volume takes uncompressed.
+     */
+    std::size_t rawBytes() const;
+
+    /**
+     * @brief Bytes held by the encoded rows, including their tokens and row offsets.
+     */
+    std::size_t compressedBytes() const;
+
+private:
+    /// Encoded rows of one slice. Row y starts at tokens[rowTokens[y]] and samples[rowSamples[y]].
+    struct EncodedSlice {
+        std::vector<std::uint16_t> tokens; ///< Run or literal length, with the run flag in the top bit.
+        std::vector<T> samples;            ///< One pixel per run, every pixel of a literal.
+        std::vector<std::size_t> rowTokens;
+        std::vector<std::size_t> rowSamples;
+    };
+
+    EncodedSlice encodeSlice(const T* data) const;
+
+    int width = 0;    ///< Width of each slice.
+    int height = 0;   ///< Height of each slice.
+    int depth = 0;    ///< Number of slices.
+    int channels = 0; ///< Number of channels per pixel.
+    std::vector<EncodedSlice> slices;
+};
+
+using CompressedVolume = BasicCompressedVolume<unsigned char>;   ///< 8 bits per voxel channel.
+using CompressedVolume16 = BasicCompressedVolume<std::uint16_t>; ///< 16 bits per voxel channel.
+
+extern template class BasicCompressedVolume<unsigned char>;
+extern template class BasicCompressedVolume<std::uint16_t>;
+extern template class BasicCompressedVolume<float>;
+
+#endif // COMPRESSED_VOLUME_H
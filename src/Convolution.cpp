@@ -0,0 +1,534 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements convolution with arbitrary kernels. Each channel is first copied into
+ * a float buffer padded by the edge mode, so that output sample (x, y, z) reads padded samples
+ * (x + i, y + j, z + k) with no bounds checks. The direct method then adds one weighted row
+ * per nonzero tap to a row of accumulators. The separable method does the same with one 1D
+ * factor per axis. The FFT method cuts the output into tiles; the padded samples each tile
+ * needs are transformed, multiplied by the kernel's spectrum and transformed back, and the
+ * outputs that do not wrap around are kept (overlap-save). Two tiles share one complex
+ * transform, one as the real part and one as the imaginary part: the kernel is real, so
+ * their results come back in the real and imaginary parts.
+ */
+#include "Convolution.h"
+#include "FFT.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+    // Largest FFT tile, in samples; each thread holds four planes of doubles this size.
+    constexpr std::size_t kMaxTileSamples = std::size_t(1) << 18;
+
+    // Cost of one FFT butterfly stage per sample, and of the per-sample work around the
+    // transforms (packing, transposes, spectrum product, stores), in units of one direct tap.
+    constexpr double kFftStageCost = 12.0;
+    constexpr double kFftSampleCost = 60.0;
+
+    // Samples of the padded copy along an axis of `size` samples for `taps` taps.
+    inline int paddedLength(int size, int taps) {
+        return size + taps - 1;
+    }
+
+    // One channel of the data, padded by the edge mode (Constant pads with 0).
+    template <typename T>
+    std::vector<float> padChannel(const T* data, int w, int h, int d, int ch, int c, const ConvolutionKernel& k,
+                                  EdgeMode mode) {
+        const int pw = paddedLength(w, k.width);
+        const int ph = paddedLength(h, k.height);
+        const int pd = paddedLength(d, k.depth);
+        std::vector<int> xs(pw), ys(ph), zs(pd);
+        for (int i = 0; i < pw; ++i) xs[i] = edgeCoordinate(mode, i - k.width / 2, w);
+        for (int i = 0; i < ph; ++i) ys[i] = edgeCoordinate(mode, i - k.height / 2, h);
+        for (int i = 0; i < pd; ++i) zs[i] = edgeCoordinate(mode, i - k.depth / 2, d);
+        std::vector<float> pad(static_cast<std::size_t>(pw) * ph * pd);
+        parallelFor(0, ph * pd, [&](int r) {
+            float* dst = pad.data() + static_cast<std::size_t>(r) * pw;
+            const int y = ys[r % ph];
+            const int z = zs[r / ph];
+            if (y < 0 || z < 0) {
+                std::fill(dst, dst + pw, 0.0f);
+                return;
+            }
+            const T* src = data + (static_cast<std::size_t>(z) * h + y) * w * ch + c;
+            for (int i = 0; i < pw; ++i) {
+                dst[i] = xs[i] < 0 ? 0.0f : static_cast<float>(src[static_cast<std::size_t>(xs[i]) * ch]);
+            }
+        });
+        return pad;
+    }
+
+    // Rounds a row of results into channel c of output row r.
+    template <typename T>
+    void storeRow(const float* acc, T* data, int w, int ch, int c, int r) {
+        T* out = data + static_cast<std::size_t>(r) * w * ch + c;
+        for (int x = 0; x < w; ++x) out[static_cast<std::size_t>(x) * ch] = pixelCast<T>(acc[x]);
+    }
+
+    // acc[x] += weight * src[x] for x < n.
+    inline void addScaledRow(float* acc, const float* src, float weight, int n) {
+        for (int x = 0; x < n; ++x) acc[x] += weight * src[x];
+    }
+
+    template <typename T>
+    void convolveDirect(const std::vector<float>& pad, T* data, int w, int h, int d, int ch, int c,
+                        const ConvolutionKernel& k) {
+        const int pw = paddedLength(w, k.width);
+        const int ph = paddedLength(h, k.height);
+        struct Tap {
+            std::size_t offset; // from an output row's first sample in the padded copy
+            float weight;
+        };
+        std::vector<Tap> taps;
+        for (int kz = 0; kz < k.depth; ++kz) {
+            for (int ky = 0; ky < k.height; ++ky) {
+                for (int kx = 0; kx < k.width; ++kx) {
+                    const double weight = k.at(kx, ky, kz);
+                    if (weight != 0.0) {
+                        taps.push_back({(static_cast<std::size_t>(kz) * ph + ky) * pw + kx, static_cast<float>(weight)});
+                    }
+                }
+            }
+        }
+        parallelFor(0, h * d, [&](int r) {
+            thread_local std::vector<float> acc;
+            const int width = w;
+            acc.assign(width, 0.0f);
+            const float* base = pad.data() + (static_cast<std::size_t>(r / h) * ph + r % h) * pw;
+            for (const Tap& tap : taps) addScaledRow(acc.data(), base + tap.offset, tap.weight, width);
+            storeRow(acc.data(), data, width, ch, c, r);
+        });
+    }
+
+    // One 1D pass per axis; the y pass writes over the padded copy, which is no longer needed.
+    template <typename T>
+    void convolveSeparable(std::vector<float>& pad, T* data, int w, int h, int d, int ch, int c,
+                           const ConvolutionKernel& k, const std::vector<double>& fx, const std::vector<double>& fy,
+                           const std::vector<double>& fz) {
+        const int pw = paddedLength(w, k.width);
+        const int ph = paddedLength(h, k.height);
+        const int pd = paddedLength(d, k.depth);
+        const std::size_t rowLength = static_cast<std::size_t>(w);
+        std::vector<float> alongX(rowLength * ph * pd);
+        parallelFor(0, ph * pd, [&](int r) {
+            const int width = w;
+            float* acc = alongX.data() + r * rowLength;
+            const float* src = pad.data() + static_cast<std::size_t>(r) * pw;
+            for (int i = 0; i < k.width; ++i) addScaledRow(acc, src + i, static_cast<float>(fx[i]), width);
+        });
+        float* alongY = pad.data();
+        parallelFor(0, h * pd, [&](int r) {
+            const int width = w;
+            float* acc = alongY + r * rowLength;
+            std::fill(acc, acc + width, 0.0f);
+            const float* src = alongX.data() + (static_cast<std::size_t>(r / h) * ph + r % h) * rowLength;
+            for (int j = 0; j < k.height; ++j) addScaledRow(acc, src + j * rowLength, static_cast<float>(fy[j]), width);
+        });
+        parallelFor(0, h * d, [&](int r) {
+            thread_local std::vector<float> acc;
+            const int width = w;
+            acc.assign(width, 0.0f);
+            const float* src = alongY + r * rowLength;
+            const std::size_t sliceLength = rowLength * h;
+            for (int kz = 0; kz < k.depth; ++kz) {
+                addScaledRow(acc.data(), src + kz * sliceLength, static_cast<float>(fz[kz]), width);
+            }
+            storeRow(acc.data(), data, width, ch, c, r);
+        });
+    }
+
+    /*
+     * Tile lengths, valid outputs and tile counts for overlap-save FFT convolution of a w x h x d
+     * volume. Choosing them needs no transforms, so chooseMethod can price the FFT path
+     * without building the kernel spectrum.
+     */
+    class TileLayout {
+    public:
+        TileLayout(const ConvolutionKernel& k, int w, int h, int d)
+            : taps_{k.width, k.height, k.depth}, dims_{w, h, d} {
+            chooseLengths();
+        }
+
+        // Estimated cost per output sample, in units of one direct tap (see chooseMethod).
+        double cost() const { return costOf(n_); }
+
+    protected:
+        std::size_t blockSize() const { return static_cast<std::size_t>(n_[0]) * n_[1] * n_[2]; }
+
+        std::size_t index(int x, int y, int z) const {
+            return (static_cast<std::size_t>(z) * n_[1] + y) * n_[0] + x;
+        }
+
+        // Padded samples transformed per output sample, times the work per transformed sample.
+        double costOf(const int n[3]) const {
+            double ratio = 1.0, stages = 0.0;
+            for (int a = 0; a < 3; ++a) {
+                const int valid = n[a] - taps_[a] + 1;
+                const int tiles = (dims_[a] + valid - 1) / valid;
+                ratio *= static_cast<double>(tiles) * n[a] / dims_[a];
+                stages += std::log2(static_cast<double>(n[a]));
+            }
+            // Two tiles share each transform.
+            return ratio * (kFftStageCost * stages + kFftSampleCost) / 2.0;
+        }
+
+        // The cheapest power-of-two lengths by costOf, from the kernel's size up to the whole
+        // padded axis, within kMaxTileSamples (the smallest lengths if even they exceed it).
+        void chooseLengths() {
+            int lowest[3], highest[3];
+            for (int a = 0; a < 3; ++a) {
+                lowest[a] = taps_[a] == 1 ? 1 : FFT::nextPowerOfTwo(taps_[a]);
+                highest[a] = taps_[a] == 1 ? 1 : std::max(lowest[a], FFT::nextPowerOfTwo(paddedLength(dims_[a], taps_[a])));
+                n_[a] = lowest[a];
+            }
+            double best = -1.0;
+            int n[3];
+            for (n[2] = lowest[2]; n[2] <= highest[2]; n[2] *= 2) {
+                for (n[1] = lowest[1]; n[1] <= highest[1]; n[1] *= 2) {
+                    for (n[0] = lowest[0]; n[0] <= highest[0]; n[0] *= 2) {
+                        if (static_cast<std::size_t>(n[0]) * n[1] * n[2] > kMaxTileSamples) break;
+                        const double cost = costOf(n);
+                        if (best < 0.0 || cost < best) {
+                            best = cost;
+                            std::copy(n, n + 3, n_);
+                        }
+                    }
+                }
+            }
+            for (int a = 0; a < 3; ++a) {
+                valid_[a] = n_[a] - taps_[a] + 1;
+                tiles_[a] = (dims_[a] + valid_[a] - 1) / valid_[a];
+            }
+        }
+
+        // First padded sample (and first output) of tile t along each axis.
+        void tileOrigin(int t, int origin[3]) const {
+            origin[0] = (t % tiles_[0]) * valid_[0];
+            origin[1] = (t / tiles_[0] % tiles_[1]) * valid_[1];
+            origin[2] = (t / tiles_[0] / tiles_[1]) * valid_[2];
+        }
+
+        int taps_[3];
+        int dims_[3];
+        int n_[3];
+        int valid_[3];
+        int tiles_[3];
+    };
+
+    /*
+     * Overlap-save tiling: a tile of n[0] x n[1] x n[2] padded samples gives valid[a] =
+     * n[a] - taps[a] + 1 outputs along each axis, which need no samples from beyond the tile.
+     * Along an axis where the kernel has one tap the tile is one sample long, so that axis is
+     * not transformed at all. Blocks are held as real and imaginary planes; each xy slice is
+     * transposed before the x pass, so every pass is a batched FFT over whole rows.
+     */
+    class FftTiles : public TileLayout {
+    public:
+        FftTiles(const ConvolutionKernel& k, const TileLayout& layout) : TileLayout(layout) {
+            fx_ = FFT(n_[0]);
+            fy_ = FFT(n_[1]);
+            fz_ = FFT(n_[2]);
+            // conj(FFT(kernel)): the product with a tile's transform is a correlation.
+            std::vector<double> re(blockSize(), 0.0), im(blockSize(), 0.0);
+            for (int kz = 0; kz < k.depth; ++kz) {
+                for (int ky = 0; ky < k.height; ++ky) {
+                    for (int kx = 0; kx < k.width; ++kx) re[index(kx, ky, kz)] = k.at(kx, ky, kz);
+                }
+            }
+            spectrumRe_.resize(blockSize());
+            spectrumIm_.resize(blockSize());
+            forward(re.data(), im.data(), spectrumRe_.data(), spectrumIm_.data());
+            for (double& v : spectrumIm_) v = -v;
+        }
+
+        template <typename T>
+        void run(const std::vector<float>& pad, T* data, int ch, int c) const {
+            const int w = dims_[0], h = dims_[1], d = dims_[2];
+            const int pw = paddedLength(w, taps_[0]);
+            const int ph = paddedLength(h, taps_[1]);
+            const int pd = paddedLength(d, taps_[2]);
+            const int count = tiles_[0] * tiles_[1] * tiles_[2];
+            parallelForDynamic(0, (count + 1) / 2, [&](int pair) {
+                thread_local std::vector<double> re, im, tre, tim;
+                re.assign(blockSize(), 0.0);
+                im.assign(blockSize(), 0.0);
+                tre.resize(blockSize());
+                tim.resize(blockSize());
+                const int first = 2 * pair;
+                const int parts = first + 1 < count ? 2 : 1;
+                // Tile t's padded samples go to the real plane, tile t + 1's to the imaginary one;
+                // the kernel is real, so their results come back the same way.
+                for (int part = 0; part < parts; ++part) {
+                    double* plane = part == 0 ? re.data() : im.data();
+                    int origin[3];
+                    tileOrigin(first + part, origin);
+                    const int xs = std::min(n_[0], pw - origin[0]);
+                    for (int z = 0; z < n_[2] && origin[2] + z < pd; ++z) {
+                        for (int y = 0; y < n_[1] && origin[1] + y < ph; ++y) {
+                            const float* src = pad.data() + (static_cast<std::size_t>(origin[2] + z) * ph + origin[1] + y) * pw + origin[0];
+                            std::copy(src, src + xs, plane + index(0, y, z));
+                        }
+                    }
+                }
+                forward(re.data(), im.data(), tre.data(), tim.data());
+                const double* sr = spectrumRe_.data();
+                const double* si = spectrumIm_.data();
+                double* br = tre.data();
+                double* bi = tim.data();
+                const std::size_t samples = blockSize();
+                for (std::size_t i = 0; i < samples; ++i) {
+                    const double r = br[i] * sr[i] - bi[i] * si[i];
+                    bi[i] = br[i] * si[i] + bi[i] * sr[i];
+                    br[i] = r;
+                }
+                inverse(re.data(), im.data(), tre.data(), tim.data());
+                for (int part = 0; part < parts; ++part) {
+                    const double* plane = part == 0 ? re.data() : im.data();
+                    int origin[3];
+                    tileOrigin(first + part, origin);
+                    const int xs = std::min(valid_[0], w - origin[0]);
+                    for (int z = 0; z < valid_[2] && origin[2] + z < d; ++z) {
+                        for (int y = 0; y < valid_[1] && origin[1] + y < h; ++y) {
+                            const double* src = plane + index(0, y, z);
+                            T* out = data + ((static_cast<std::size_t>(origin[2] + z) * h + origin[1] + y) * w + origin[0]) * ch + c;
+                            for (int x = 0; x < xs; ++x) out[static_cast<std::size_t>(x) * ch] = pixelCast<T>(src[x]);
+                        }
+                    }
+                }
+            });
+        }
+
+    private:
+        // dst[c * rows + r] = src[r * cols + c], in cache-sized squares.
+        static void transpose(const double* src, double* dst, int rows, int cols) {
+            constexpr int kSquare = 32;
+            for (int r0 = 0; r0 < rows; r0 += kSquare) {
+                for (int c0 = 0; c0 < cols; c0 += kSquare) {
+                    const int r1 = std::min(rows, r0 + kSquare);
+                    const int c1 = std::min(cols, c0 + kSquare);
+                    for (int r = r0; r < r1; ++r) {
+                        for (int c = c0; c < c1; ++c) {
+                            dst[static_cast<std::size_t>(c) * rows + r] = src[static_cast<std::size_t>(r) * cols + c];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Block (re, im) in [z][y][x] order to its transform (tre, tim) in [z][x][y] order:
+        // along z and y in place, then each slice transposed and transformed along x.
+        void forward(double* re, double* im, double* tre, double* tim) const {
+            const std::size_t slice = static_cast<std::size_t>(n_[0]) * n_[1];
+            if (n_[2] > 1) fz_.forward(re, im, static_cast<int>(slice));
+            for (int z = 0; z < n_[2]; ++z) {
+                const std::size_t at = z * slice;
+                if (n_[1] > 1) fy_.forward(re + at, im + at, n_[0]);
+                transpose(re + at, tre + at, n_[1], n_[0]);
+                transpose(im + at, tim + at, n_[1], n_[0]);
+                if (n_[0] > 1) fx_.forward(tre + at, tim + at, n_[1]);
+            }
+        }
+
+        // Inverse of forward(): (tre, tim) back to (re, im).
+        void inverse(double* re, double* im, double* tre, double* tim) const {
+            const std::size_t slice = static_cast<std::size_t>(n_[0]) * n_[1];
+            for (int z = 0; z < n_[2]; ++z) {
+                const std::size_t at = z * slice;
+                if (n_[0] > 1) fx_.inverse(tre + at, tim + at, n_[1]);
+                transpose(tre + at, re + at, n_[0], n_[1]);
+                transpose(tim + at, im + at, n_[0], n_[1]);
+                if (n_[1] > 1) fy_.inverse(re + at, im + at, n_[0]);
+            }
+            if (n_[2] > 1) fz_.inverse(re, im, static_cast<int>(slice));
+        }
+
+        FFT fx_{1}, fy_{1}, fz_{1};
+        std::vector<double> spectrumRe_, spectrumIm_;
+    };
+
+} // end anonymous namespace
+
+bool ConvolutionKernel::load(const std::string& path, ConvolutionKernel& kernel) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "[Convolution] Cannot open kernel file: " << path << "\n";
+        return false;
+    }
+    return parse(file, path, kernel);
+}
+
+bool ConvolutionKernel::parse(std::istream& in, const std::string& name, ConvolutionKernel& kernel) {
+    kernel = ConvolutionKernel();
+    std::vector<double> weights;
+    int width = 0, height = 0, depth = 0, rows = 0, lineNumber = 0;
+    bool normalize = false;
+    // A blank line (or the end of the text) closes the slice being read, if any.
+    const auto endSlice = [&]() {
+        if (rows == 0) return true;
+        if (depth > 0 && rows != height) {
+            std::cerr << "[Convolution] " << name << ":" << lineNumber << ": slice has " << rows
+                      << " rows, the first has " << height << "\n";
+            return false;
+        }
+        height = rows;
+        rows = 0;
+        ++depth;
+        return true;
+    };
+    std::string line;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+        std::string token;
+        if (!(fields >> token)) {
+            if (!endSlice()) return false;
+            continue;
+        }
+        if (token[0] == '#') continue;
+        if (token == "normalize") {
+            normalize = true;
+            continue;
+        }
+        int count = 0;
+        do {
+            char* end = nullptr;
+            const double weight = std::strtod(token.c_str(), &end);
+            if (end == token.c_str() || *end != '\0') {
+                std::cerr << "[Convolution] " << name << ":" << lineNumber << ": not a number: " << token << "\n";
+                return false;
+            }
+            weights.push_back(weight);
+            ++count;
+        } while (fields >> token);
+        if (width == 0) {
+            width = count;
+        } else if (count != width) {
+            std::cerr << "[Convolution] " << name << ":" << lineNumber << ": row has " << count
+                      << " weights, the first has " << width << "\n";
+            return false;
+        }
+        ++rows;
+    }
+    if (!endSlice()) return false;
+    if (depth == 0) {
+        std::cerr << "[Convolution] " << name << ": no weights\n";
+        return false;
+    }
+    if (normalize) {
+        double sum = 0.0;
+        for (double weight : weights) sum += weight;
+        if (std::abs(sum) < 1e-12) {
+            std::cerr << "[Convolution] " << name << ": cannot normalize weights that sum to 0\n";
+            return false;
+        }
+        for (double& weight : weights) weight /= sum;
+    }
+    kernel.width = width;
+    kernel.height = height;
+    kernel.depth = depth;
+    kernel.weights = std::move(weights);
+    return true;
+}
+
+bool Convolution::separate(const ConvolutionKernel& kernel, std::vector<double>& x, std::vector<double>& y,
+                           std::vector<double>& z) {
+    if (kernel.empty()) return false;
+    // The largest weight fixes the scale of the factors: x takes its row, y and z are
+    // divided by it, so x[i] * y[j] * z[k] reproduces every weight of a rank-1 kernel.
+    int px = 0, py = 0, pz = 0;
+    double largest = 0.0;
+    for (int k = 0; k < kernel.depth; ++k) {
+        for (int j = 0; j < kernel.height; ++j) {
+            for (int i = 0; i < kernel.width; ++i) {
+                if (std::abs(kernel.at(i, j, k)) > largest) {
+                    largest = std::abs(kernel.at(i, j, k));
+                    px = i;
+                    py = j;
+                    pz = k;
+                }
+            }
+        }
+    }
+    x.assign(kernel.width, 0.0);
+    y.assign(kernel.height, 1.0);
+    z.assign(kernel.depth, 1.0);
+    if (largest == 0.0) return true;
+    const double pivot = kernel.at(px, py, pz);
+    for (int i = 0; i < kernel.width; ++i) x[i] = kernel.at(i, py, pz);
+    for (int j = 0; j < kernel.height; ++j) y[j] = kernel.at(px, j, pz) / pivot;
+    for (int k = 0; k < kernel.depth; ++k) z[k] = kernel.at(px, py, k) / pivot;
+    const double tolerance = 1e-9 * largest;
+    for (int k = 0; k < kernel.depth; ++k) {
+        for (int j = 0; j < kernel.height; ++j) {
+            for (int i = 0; i < kernel.width; ++i) {
+                if (std::abs(kernel.at(i, j, k) - x[i] * y[j] * z[k]) > tolerance) return false;
+            }
+        }
+    }
+    return true;
+}
+
+ConvolutionMethod Convolution::chooseMethod(const ConvolutionKernel& kernel, int width, int height, int depth) {
+    double direct = 0.0;
+    for (double weight : kernel.weights) direct += weight != 0.0;
+    std::vector<double> fx, fy, fz;
+    const double separable = separate(kernel, fx, fy, fz) ? kernel.width + kernel.height + kernel.depth
+                                                          : direct + 1.0;
+    const double fft = TileLayout(kernel, width, height, depth).cost();
+    if (direct <= separable && direct <= fft) return ConvolutionMethod::Direct;
+    return separable <= fft ? ConvolutionMethod::Separable : ConvolutionMethod::FFT;
+}
+
+template <typename T>
+void Convolution::apply(T* data, int width, int height, int depth, int channels, const ConvolutionKernel& kernel,
+                        EdgeMode edgeMode, ConvolutionMethod method) {
+    PROFILE_SCOPE_CAT("Convolution", "filter");
+    if (kernel.empty() || width <= 0 || height <= 0 || depth <= 0 || channels <= 0) return;
+    std::vector<double> fx, fy, fz;
+    if (method == ConvolutionMethod::Separable && !separate(kernel, fx, fy, fz)) {
+        method = ConvolutionMethod::Auto;
+    }
+    if (method == ConvolutionMethod::Auto) {
+        method = chooseMethod(kernel, width, height, depth);
+        if (method == ConvolutionMethod::Separable) separate(kernel, fx, fy, fz);
+    }
+    if (method == ConvolutionMethod::FFT) {
+        const FftTiles tiles(kernel, TileLayout(kernel, width, height, depth));
+        for (int c = 0; c < channels; ++c) {
+            const std::vector<float> pad = padChannel(data, width, height, depth, channels, c, kernel, edgeMode);
+            tiles.run(pad, data, channels, c);
+        }
+        return;
+    }
+    for (int c = 0; c < channels; ++c) {
+        std::vector<float> pad = padChannel(data, width, height, depth, channels, c, kernel, edgeMode);
+        if (method == ConvolutionMethod::Separable) {
+            convolveSeparable(pad, data, width, height, depth, channels, c, kernel, fx, fy, fz);
+        } else {
+            convolveDirect(pad, data, width, height, depth, channels, c, kernel);
+        }
+    }
+}
+
+template void Convolution::apply(unsigned char*, int, int, int, int, const ConvolutionKernel&, EdgeMode, ConvolutionMethod);
+template void Convolution::apply(std::uint16_t*, int, int, int, int, const ConvolutionKernel&, EdgeMode, ConvolutionMethod);
+template void Convolution::apply(float*, int, int, int, int, const ConvolutionKernel&, EdgeMode, ConvolutionMethod);
@@ -0,0 +1,119 @@
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+#include "Filter.h"
+
+/**
+ * @struct ConvolutionKernel
+ * @brief Weights of a 2D or 3D kernel, slice by slice and row-major within a slice.
+ */
+struct ConvolutionKernel {
+    int width = 0;               ///< Taps along x.
+    int height = 0;              ///< Taps along y.
+    int depth = 0;               ///< Taps along z (1 for a 2D kernel).
+    std::vector<double> weights; ///< width * height * depth weights.
+
+    /**
+     * @brief Weight of tap (x, y, z).
+     */
+    double at(int x, int y, int z = 0) const {
+        return weights[(static_cast<std::size_t>(z) * height + y) * width + x];
+    }
+
+    /**
+     * @brief Whether the kernel has no taps.
+     */
+    bool empty() const { return weights.empty(); }
+
+    /**
+     * @brief Reads a kernel from a text file.
+     *
+     * Each line is one row of weights, separated by spaces or commas. A blank line ends a
+     * slice, so a 3D kernel is its slices one after another. Every row must have the same
+     * number of weights and every slice the same number of rows. Lines starting with `#` are
+     * comments, and a line `normalize` divides the weights by their sum.
+     *
+     * @param path The kernel file.
+     * @param kernel Receives the kernel.
+     * @return False (with a message) if the file cannot be read or is malformed.
+     */
+    static bool load(const std::string& path, ConvolutionKernel& kernel);
+
+    /**
+     * @brief Reads a kernel in the format of load() from a stream.
+     * @param in The stream.
+     * @param name Name used in error messages.
+     * @param kernel Receives the kernel.
+     * @return False (with a message) if the text is malformed.
+     */
+    static bool parse(std::istream& in, const std::string& name, ConvolutionKernel& kernel);
+};
+
+/**
+ * @brief How Convolution::apply computes a result.
+ */
+enum class ConvolutionMethod {
+    Auto,      ///< The cheapest of the three for the kernel and data size.
+    Direct,    ///< Every tap of every sample; skips zero weights.
+    Separable, ///< One 1D pass per axis; only for kernels that are an outer product.
+    FFT        ///< Tiles transformed with the FFT, multiplied and transformed back (overlap-save).
+};
+
+/**
+ * @class Convolution
+ * @brief Applies arbitrary 2D and 3D kernels, by direct, separable or FFT execution.
+ *
+ * The kernel is applied as written, like the built-in blur, sharpen and edge kernels: output
+ * sample (x, y, z) is the sum of weight (i, j, k) times input sample (x + i - width / 2,
+ * y + j - height / 2, z + k - depth / 2). (Flip the kernel for a convolution in the strict
+ * sense.) Samples outside the data are read through the edge mode; with EdgeMode::Constant
+ * they count as 0. Results are rounded and clamped to the sample type.
+ *
+ * All three methods give the same result up to floating-point rounding. The direct method costs
+ * one multiply-add per nonzero tap and sample; the separable one width + height + depth; the
+ * FFT one about log2 of the tile size, whatever the kernel's size.
+ */
+class Convolution {
+public:
+    /**
+     * @brief Splits a kernel into per-axis factors if it is an outer product (rank 1).
+     * @param kernel The kernel.
+     * @param x Receives the width weights along x.
+     * @param y Receives the height weights along y.
+     * @param z Receives the depth weights along z.
+     * @return True if the kernel equals the product of the factors to within rounding.
+     */
+    static bool separate(const ConvolutionKernel& kernel, std::vector<double>& x, std::vector<double>& y,
+                         std::vector<double>& z);
+
+    /**
+     * @brief The method ConvolutionMethod::Auto picks for a kernel and data size.
+     * @param kernel The kernel.
+     * @param width Width of the data.
+     * @param height Height of the data.
+     * @param depth Depth of the data (1 for an image).
+     * @return Direct, Separable or FFT.
+     */
+    static ConvolutionMethod chooseMethod(const ConvolutionKernel& kernel, int width, int height, int depth);
+
+    /**
+     * @brief Applies a kernel to interleaved samples in place, each channel on its own.
+     * @param data width * height * depth * channels samples.
+     * @param width Width of the data.
+     * @param height Height of the data.
+     * @param depth Depth of the data (1 for an image).
+     * @param channels Samples per pixel.
+     * @param kernel The kernel; a 3D kernel on data of depth 1 reads the slice through the edge mode.
+     * @param edgeMode How samples outside the data are read.
+     * @param method How to compute the result; Separable falls back to Auto for other kernels.
+     */
+    template <typename T>
+    static void apply(T* data, int width, int height, int depth, int channels, const ConvolutionKernel& kernel,
+                      EdgeMode edgeMode = EdgeMode::Extend, ConvolutionMethod method = ConvolutionMethod::Auto);
+};
+
+#endif // CONVOLUTION_H
@@ -0,0 +1,495 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements a deflate compressor (RFC 1951) for the PNG encoder. Matches are found
+ * with a 3-byte hash and chains over a 32 KB window. Every 32K tokens form one block, which is
+ * written with its own dynamic Huffman codes (length-limited by halving frequencies until the
+ * tree fits) or as stored bytes if those are smaller. Also here: the CRC-32 and Adler-32
+ * checksums that PNG and zlib wrap around the data.
+ */
+#include "Deflate.h"
+#include <algorithm>
+#include <array>
+#include <queue>
+#include <utility>
+
+namespace {
+
+    constexpr int kWindowSize = 1 << 15;
+    constexpr int kWindowMask = kWindowSize - 1;
+    constexpr int kHashBits = 15;
+    constexpr int kHashMask = (1 << kHashBits) - 1;
+    constexpr int kMinMatch = 3;
+    constexpr int kMaxMatch = 258;
+    constexpr size_t kBlockTokens = 1 << 15;
+    constexpr size_t kMaxStored = 65535;
+
+    constexpr int kNumLitLen = 286;
+    constexpr int kNumDist = 30;
+    constexpr int kNumCodeLen = 19;
+
+    const int kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const int kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                   3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const int kDistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                8193, 12289, 16385, 24577 };
+    const int kDistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    const int kCodeLengthOrder[kNumCodeLen] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    struct LevelSettings {
+        int maxChain;    // candidates examined per position
+        int niceLength;  // stop searching once a match is this long
+        bool lazy;       // try the next position before taking a match
+    };
+    const LevelSettings kLevels[10] = {
+        { 0, 0, false },     { 4, 8, false },     { 8, 16, false },    { 16, 32, false },
+        { 32, 64, false },   { 64, 128, false },  { 128, 128, true },  { 256, 258, true },
+        { 1024, 258, true }, { 4096, 258, true }
+    };
+
+    // Length (3..258) and distance (1..32768) to deflate symbol, precomputed once.
+    struct SymbolTables {
+        std::array<unsigned char, kMaxMatch + 1> lengthCode{};
+        std::array<unsigned char, kWindowSize + 1> distCode{};
+
+        SymbolTables() {
+            for (int c = 0; c < 29; ++c) {
+                const int end = (c == 28) ? 259 : kLengthBase[c] + (1 << kLengthExtra[c]);
+                for (int len = kLengthBase[c]; len < end && len <= kMaxMatch; ++len) lengthCode[len] = c;
+            }
+            lengthCode[258] = 28;
+            for (int c = 0; c < 30; ++c) {
+                const int end = std::min(kDistBase[c] + (1 << kDistExtra[c]), kWindowSize + 1);
+                for (int d = kDistBase[c]; d < end; ++d) distCode[d] = c;
+            }
+        }
+    };
+
+    const SymbolTables& tables() {
+        static const SymbolTables instance;
+        return instance;
+    }
+
+    // Writes bits least-significant first, as deflate requires.
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<unsigned char>& out) : out_(out) {}
+
+        void put(std::uint32_t bits, int count) {
+            buffer_ |= static_cast<std::uint64_t>(bits) << filled_;
+            filled_ += count;
+            while (filled_ >= 8) {
+                out_.push_back(static_cast<unsigned char>(buffer_));
+                buffer_ >>= 8;
+                filled_ -= 8;
+            }
+        }
+
+        void alignToByte() {
+            if (filled_ > 0) put(0, 8 - filled_);
+        }
+
+        void putBytes(const unsigned char* data, size_t size) {
+            out_.insert(out_.end(), data, data + size);
+        }
+
+    private:
+        std::vector<unsigned char>& out_;
+        std::uint64_t buffer_ = 0;
+        int filled_ = 0;
+    };
+
+    struct Token {
+        std::uint16_t length;    // literal byte when dist == 0
+        std::uint16_t dist;
+    };
+
+    /*
+     * Huffman code lengths for `freq`, no longer than maxBits. If the optimal tree is too deep,
+     * the frequencies are flattened (halved, keeping every used symbol) and the tree rebuilt.
+     */
+    void buildLengths(const std::uint32_t* freq, int n, int maxBits, unsigned char* lengths) {
+        std::vector<std::uint32_t> f(freq, freq + n);
+        for (;;) {
+            std::fill(lengths, lengths + n, 0);
+            std::vector<int> used;
+            for (int i = 0; i < n; ++i) if (f[i] > 0) used.push_back(i);
+            if (used.empty()) return;
+            if (used.size() == 1) {
+                lengths[used[0]] = 1;
+                return;
+            }
+
+            // Nodes 0..n-1 are leaves; internal nodes are appended.
+            std::vector<int> parent(n, -1);
+            using Item = std::pair<std::uint64_t, int>;
+            std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+            for (int s : used) heap.push({ f[s], s });
+            while (heap.size() > 1) {
+                Item a = heap.top(); heap.pop();
+                Item b = heap.top(); heap.pop();
+                const int node = static_cast<int>(parent.size());
+                parent.push_back(-1);
+                parent[a.second] = node;
+                parent[b.second] = node;
+                heap.push({ a.first + b.first, node });
+            }
+
+            int deepest = 0;
+            for (int s : used) {
+                int depth = 0;
+                for (int p = parent[s]; p != -1; p = parent[p]) ++depth;
+                lengths[s] = static_cast<unsigned char>(std::min(depth, 255));
+                deepest = std::max(deepest, depth);
+            }
+            if (deepest <= maxBits) return;
+            for (int s : used) f[s] = (f[s] >> 1) | 1;
+        }
+    }
+
+    // Canonical codes from code lengths, bit-reversed so BitWriter can emit them LSB first.
+    void buildCodes(const unsigned char* lengths, int n, std::uint16_t* codes) {
+        int count[16] = { 0 };
+        for (int i = 0; i < n; ++i) count[lengths[i]]++;
+        count[0] = 0;
+        int next[16] = { 0 };
+        int code = 0;
+        for (int bits = 1; bits < 16; ++bits) {
+            code = (code + count[bits - 1]) << 1;
+            next[bits] = code;
+        }
+        for (int i = 0; i < n; ++i) {
+            const int len = lengths[i];
+            if (len == 0) { codes[i] = 0; continue; }
+            int c = next[len]++;
+            int reversed = 0;
+            for (int b = 0; b < len; ++b) {
+                reversed = (reversed << 1) | (c & 1);
+                c >>= 1;
+            }
+            codes[i] = static_cast<std::uint16_t>(reversed);
+        }
+    }
+
+    void writeStored(BitWriter& bw, const unsigned char* data, size_t size, bool final) {
+        size_t offset = 0;
+        do {
+            const size_t chunk = std::min(kMaxStored, size - offset);
+            const bool last = final && offset + chunk == size;
+            bw.put(last ? 1 : 0, 1);
+            bw.put(0, 2);
+            bw.alignToByte();
+            bw.put(static_cast<std::uint32_t>(chunk), 16);
+            bw.put(static_cast<std::uint32_t>(~chunk & 0xFFFF), 16);
+            bw.putBytes(data + offset, chunk);
+            offset += chunk;
+        } while (offset < size);
+    }
+
+    // One run-length coded entry of the code length sequence (symbols 0-18 plus extra bits).
+    struct CodeLengthSymbol {
+        int symbol;
+        int extra;
+    };
+
+    std::vector<CodeLengthSymbol> runLengthEncode(const unsigned char* lengths, int total) {
+        std::vector<CodeLengthSymbol> out;
+        int i = 0;
+        while (i < total) {
+            const int value = lengths[i];
+            int run = 1;
+            while (i + run < total && lengths[i + run] == value) ++run;
+            i += run;
+            if (value == 0) {
+                while (run >= 11) {
+                    const int r = std::min(run, 138);
+                    out.push_back({ 18, r - 11 });
+                    run -= r;
+                }
+                if (run >= 3) {
+                    out.push_back({ 17, run - 3 });
+                    run = 0;
+                }
+                while (run-- > 0) out.push_back({ 0, 0 });
+            } else {
+                out.push_back({ value, 0 });
+                --run;
+                while (run >= 3) {
+                    const int r = std::min(run, 6);
+                    out.push_back({ 16, r - 3 });
+                    run -= r;
+                }
+                while (run-- > 0) out.push_back({ value, 0 });
+            }
+        }
+        return out;
+    }
+
+    /*
+     * Writes the tokens of one block with dynamic Huffman codes, or `raw` as stored blocks if
+     * that is smaller (e.g. for noise, which LZ77 cannot shorten).
+     */
+    void writeBlock(BitWriter& bw, const std::vector<Token>& tokens,
+                    const unsigned char* raw, size_t rawSize, bool final) {
+        if (rawSize == 0) {
+            writeStored(bw, raw, 0, final);
+            return;
+        }
+        const SymbolTables& t = tables();
+
+        std::uint32_t litFreq[kNumLitLen] = { 0 };
+        std::uint32_t distFreq[kNumDist] = { 0 };
+        for (const Token& tok : tokens) {
+            if (tok.dist == 0) {
+                litFreq[tok.length]++;
+            } else {
+                litFreq[257 + t.lengthCode[tok.length]]++;
+                distFreq[t.distCode[tok.dist]]++;
+            }
+        }
+        litFreq[256] = 1;
+        // Keep both codes complete (at least two symbols), which every inflater accepts.
+        if (std::count_if(litFreq, litFreq + 256, [](std::uint32_t f) { return f > 0; }) == 0) litFreq[0] = 1;
+        int usedDist = static_cast<int>(std::count_if(distFreq, distFreq + kNumDist, [](std::uint32_t f) { return f > 0; }));
+        if (usedDist < 2) {
+            distFreq[0] |= 1;
+            distFreq[1] |= 1;
+        }
+
+        unsigned char litLen[kNumLitLen];
+        unsigned char distLen[kNumDist];
+        buildLengths(litFreq, kNumLitLen, 15, litLen);
+        buildLengths(distFreq, kNumDist, 15, distLen);
+
+        int numLit = kNumLitLen;
+        while (numLit > 257 && litLen[numLit - 1] == 0) --numLit;
+        int numDist = kNumDist;
+        while (numDist > 1 && distLen[numDist - 1] == 0) --numDist;
+
+        unsigned char combined[kNumLitLen + kNumDist];
+        std::copy(litLen, litLen + numLit, combined);
+        std::copy(distLen, distLen + numDist, combined + numLit);
+        std::vector<CodeLengthSymbol> clSymbols = runLengthEncode(combined, numLit + numDist);
+
+        std::uint32_t clFreq[kNumCodeLen] = { 0 };
+        for (const CodeLengthSymbol& s : clSymbols) clFreq[s.symbol]++;
+        unsigned char clLen[kNumCodeLen];
+        buildLengths(clFreq, kNumCodeLen, 7, clLen);
+        int numCl = kNumCodeLen;
+        while (numCl > 4 && clLen[kCodeLengthOrder[numCl - 1]] == 0) --numCl;
+
+        // Cost of the dynamic block in bits, to compare against storing the bytes.
+        static const int clExtraBits[3] = { 2, 3, 7 };
+        std::uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * numCl;
+        for (const CodeLengthSymbol& s : clSymbols) {
+            dynamicBits += clLen[s.symbol] + (s.symbol >= 16 ? clExtraBits[s.symbol - 16] : 0);
+        }
+        for (int i = 0; i < kNumLitLen; ++i) {
+            dynamicBits += static_cast<std::uint64_t>(litFreq[i]) * litLen[i];
+            if (i >= 257) dynamicBits += static_cast<std::uint64_t>(litFreq[i]) * kLengthExtra[i - 257];
+        }
+        for (int i = 0; i < kNumDist; ++i) {
+            dynamicBits += static_cast<std::uint64_t>(distFreq[i]) * (distLen[i] + kDistExtra[i]);
+        }
+        const std::uint64_t storedBits = (rawSize + 5 * ((rawSize + kMaxStored - 1) / kMaxStored)) * 8 + 7;
+        if (storedBits <= dynamicBits) {
+            writeStored(bw, raw, rawSize, final);
+            return;
+        }
+
+        std::uint16_t litCode[kNumLitLen], distCode[kNumDist], clCode[kNumCodeLen];
+        buildCodes(litLen, kNumLitLen, litCode);
+        buildCodes(distLen, kNumDist, distCode);
+        buildCodes(clLen, kNumCodeLen, clCode);
+
+        bw.put(final ? 1 : 0, 1);
+        bw.put(2, 2); // dynamic Huffman
+        bw.put(numLit - 257, 5);
+        bw.put(numDist - 1, 5);
+        bw.put(numCl - 4, 4);
+        for (int i = 0; i < numCl; ++i) bw.put(clLen[kCodeLengthOrder[i]], 3);
+        for (const CodeLengthSymbol& s : clSymbols) {
+            bw.put(clCode[s.symbol], clLen[s.symbol]);
+            if (s.symbol >= 16) bw.put(s.extra, clExtraBits[s.symbol - 16]);
+        }
+
+        for (const Token& tok : tokens) {
+            if (tok.dist == 0) {
+                bw.put(litCode[tok.length], litLen[tok.length]);
+                continue;
+            }
+            const int lc = t.lengthCode[tok.length];
+            bw.put(litCode[257 + lc], litLen[257 + lc]);
+            if (kLengthExtra[lc]) bw.put(tok.length - kLengthBase[lc], kLengthExtra[lc]);
+            const int dc = t.distCode[tok.dist];
+            bw.put(distCode[dc], distLen[dc]);
+            if (kDistExtra[dc]) bw.put(tok.dist - kDistBase[dc], kDistExtra[dc]);
+        }
+        bw.put(litCode[256], litLen[256]);
+    }
+
+    // LZ77 match finder over a 32 KB window with hash chains.
+    class MatchFinder {
+    public:
+        MatchFinder(const unsigned char* data, size_t size, const LevelSettings& settings)
+            : data_(data), size_(size), settings_(settings), head_(kHashMask + 1, -1), prev_(kWindowSize, -1) {}
+
+        // Adds every position before `pos` to the hash chains.
+        void insertUpTo(size_t pos) {
+            for (; next_ < pos; ++next_) {
+                if (next_ + 2 >= size_) continue;
+                const int h = hash(next_);
+                prev_[next_ & kWindowMask] = head_[h];
+                head_[h] = static_cast<std::int64_t>(next_);
+            }
+        }
+
+        // Longest match for `pos` among positions already inserted; length 0 if none.
+        int find(size_t pos, int& dist) const {
+            dist = 0;
+            if (pos + kMinMatch > size_) return 0;
+            const int maxLen = static_cast<int>(std::min<size_t>(kMaxMatch, size_ - pos));
+            const std::int64_t limit = static_cast<std::int64_t>(pos) - kWindowSize;
+            const unsigned char* cur = data_ + pos;
+            int best = kMinMatch - 1;
+            int chain = settings_.maxChain;
+            for (std::int64_t cand = head_[hash(pos)]; cand >= 0 && cand > limit && chain-- > 0;) {
+                const unsigned char* m = data_ + cand;
+                if (m[best] == cur[best] && m[0] == cur[0] && m[1] == cur[1]) {
+                    int len = 2;
+                    while (len < maxLen && m[len] == cur[len]) ++len;
+                    if (len > best) {
+                        best = len;
+                        dist = static_cast<int>(pos - cand);
+                        if (len >= settings_.niceLength || len == maxLen) break;
+                    }
+                }
+                const std::int64_t next = prev_[cand & kWindowMask];
+                if (next >= cand) break; // slot reused by a newer position
+                cand = next;
+            }
+            return best >= kMinMatch ? best : 0;
+        }
+
+    private:
+        int hash(size_t p) const {
+            return ((data_[p] << 10) ^ (data_[p + 1] << 5) ^ data_[p + 2]) & kHashMask;
+        }
+
+        const unsigned char* data_;
+        size_t size_;
+        LevelSettings settings_;
+        std::vector<std::int64_t> head_;
+        std::vector<std::int64_t> prev_;
+        size_t next_ = 0;
+    };
+
+} // end anonymous namespace
+
+void deflateCompress(const unsigned char* data, size_t size, int level, bool final,
+                     std::vector<unsigned char>& out) {
+    level = std::clamp(level, 0, 9);
+    BitWriter bw(out);
+
+    if (level == 0) {
+        writeStored(bw, data, size, final);
+    } else {
+        const LevelSettings& settings = kLevels[level];
+        MatchFinder finder(data, size, settings);
+        std::vector<Token> tokens;
+        tokens.reserve(kBlockTokens + 1);
+        size_t blockStart = 0;
+        size_t pos = 0;
+        while (pos < size) {
+            finder.insertUpTo(pos);
+            int dist = 0;
+            int len = finder.find(pos, dist);
+            if (len > 0 && settings.lazy && len < settings.niceLength && pos + 1 < size) {
+                finder.insertUpTo(pos + 1);
+                int nextDist = 0;
+                const int nextLen = finder.find(pos + 1, nextDist);
+                if (nextLen > len) len = 0; // emit a literal now, take the longer match next time
+            }
+            if (len > 0) {
+                tokens.push_back({ static_cast<std::uint16_t>(len), static_cast<std::uint16_t>(dist) });
+                pos += len;
+            } else {
+                tokens.push_back({ data[pos], 0 });
+                ++pos;
+            }
+            if (tokens.size() >= kBlockTokens && pos < size) {
+                writeBlock(bw, tokens, data + blockStart, pos - blockStart, false);
+                tokens.clear();
+                blockStart = pos;
+            }
+        }
+        writeBlock(bw, tokens, data + blockStart, size - blockStart, final);
+    }
+
+    if (!final) {
+        // Sync flush: an empty stored block leaves the stream byte-aligned and open.
+        writeStored(bw, data, 0, false);
+    }
+    bw.alignToByte();
+}
+
+std::uint32_t crc32Update(std::uint32_t crc, const unsigned char* data, size_t size) {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+std::uint32_t adler32Update(std::uint32_t adler, const unsigned char* data, size_t size) {
+    constexpr std::uint32_t kMod = 65521;
+    constexpr size_t kMaxRun = 5552; // largest run before the 32-bit sums can overflow
+    std::uint32_t a = adler & 0xFFFF;
+    std::uint32_t b = adler >> 16;
+    while (size > 0) {
+        const size_t run = std::min(size, kMaxRun);
+        for (size_t i = 0; i < run; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= kMod;
+        b %= kMod;
+        data += run;
+        size -= run;
+    }
+    return (b << 16) | a;
+}
+
+std::uint32_t adler32Combine(std::uint32_t adler1, std::uint32_t adler2, size_t size2) {
+    constexpr std::uint32_t kMod = 65521;
+    const std::uint32_t rem = static_cast<std::uint32_t>(size2 % kMod);
+    std::uint32_t a = adler1 & 0xFFFF;
+    std::uint32_t b = static_cast<std::uint32_t>((static_cast<std::uint64_t>(rem) * a) % kMod);
+    a += (adler2 & 0xFFFF) + kMod - 1;
+    b += (adler1 >> 16) + (adler2 >> 16) + kMod - rem;
+    if (a >= kMod) a -= kMod;
+    if (a >= kMod) a -= kMod;
+    if (b >= 2 * kMod) b -= 2 * kMod;
+    if (b >= kMod) b -= kMod;
+    return (b << 16) | a;
+}
@@ -0,0 +1,44 @@
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Compresses `size` bytes as raw deflate (RFC 1951) and appends them to `out`.
+ *
+ * Level 0 writes stored blocks. Levels 1-9 use LZ77 with hash chains that grow with the
+ * level (lazy matching from level 6) and dynamic Huffman blocks, falling back to a stored
+ * block whenever that would be smaller.
+ *
+ * The output always ends on a byte boundary. If `final` is false, the last block is not
+ * marked final and an empty stored block (a zlib "sync flush") is appended. Streams
+ * compressed independently can therefore be concatenated, as long as only the last one
+ * is final. This is how PNG row strips are compressed in parallel.
+ *
+ * @param data Input bytes.
+ * @param size Number of input bytes.
+ * @param level 0 (stored) to 9 (smallest).
+ * @param final True for the last piece of the stream.
+ * @param out Receives the compressed bytes (appended).
+ */
+void deflateCompress(const unsigned char* data, size_t size, int level, bool final,
+                     std::vector<unsigned char>& out);
+
+/**
+ * @brief CRC-32 (as used by PNG chunks), continuing from `crc` (start with 0).
+ */
+std::uint32_t crc32Update(std::uint32_t crc, const unsigned char* data, size_t size);
+
+/**
+ * @brief Adler-32 (as used by zlib streams), continuing from `adler` (start with 1).
+ */
+std::uint32_t adler32Update(std::uint32_t adler, const unsigned char* data, size_t size);
+
+/**
+ * @brief Adler-32 of two concatenated pieces, from the checksum of each and the second's length.
+ */
+std::uint32_t adler32Combine(std::uint32_t adler1, std::uint32_t adler2, size_t size2);
+
+#endif // DEFLATE_H
@@ -0,0 +1,128 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements an iterative radix-2 Cooley-Tukey FFT: the samples are put in
+ * bit-reversed order, then log2(n) stages of butterflies combine transforms of length 1, 2,
+ * 4, ... into one of length n. The inverse uses the conjugate twiddles and scales by 1/n.
+ * The batched form runs the same stages on rows of interleaved sequences held as separate
+ * real and imaginary planes, so the loop over a row has no shuffles and vectorises.
+ */
+#include "FFT.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+FFT::FFT(int size) : n(size), reversed(size), twiddles(size / 2) {
+    int bits = 0;
+    while ((1 << bits) < n) ++bits;
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        reversed[i] = r;
+    }
+    for (int k = 0; k < n / 2; ++k) {
+        const double angle = -2.0 * M_PI * k / n;
+        twiddles[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+}
+
+int FFT::nextPowerOfTwo(int value) {
+    int power = 1;
+    while (power < value) power <<= 1;
+    return power;
+}
+
+void FFT::forward(std::complex<double>* data) const {
+    transform(data, false);
+}
+
+void FFT::inverse(std::complex<double>* data) const {
+    transform(data, true);
+    const double scale = 1.0 / n;
+    for (int i = 0; i < n; ++i) data[i] *= scale;
+}
+
+void FFT::forward(double* re, double* im, int count) const {
+    transform(re, im, count, false);
+}
+
+void FFT::inverse(double* re, double* im, int count) const {
+    transform(re, im, count, true);
+    const double scale = 1.0 / n;
+    const std::size_t total = static_cast<std::size_t>(n) * count;
+    for (std::size_t i = 0; i < total; ++i) {
+        re[i] *= scale;
+        im[i] *= scale;
+    }
+}
+
+void FFT::transform(std::complex<double>* data, bool inverse) const {
+    for (int i = 0; i < n; ++i) {
+        if (i < reversed[i]) std::swap(data[i], data[reversed[i]]);
+    }
+    for (int length = 2; length <= n; length <<= 1) {
+        const int half = length / 2;
+        const int step = n / length;
+        for (int start = 0; start < n; start += length) {
+            std::complex<double>* a = data + start;
+            std::complex<double>* b = a + half;
+            for (int j = 0; j < half; ++j) {
+                const std::complex<double> w = inverse ? std::conj(twiddles[j * step]) : twiddles[j * step];
+                // Written out: std::complex multiplication checks for NaN/infinity results.
+                const double re = b[j].real() * w.real() - b[j].imag() * w.imag();
+                const double im = b[j].real() * w.imag() + b[j].imag() * w.real();
+                const std::complex<double> t(re, im);
+                b[j] = a[j] - t;
+                a[j] += t;
+            }
+        }
+    }
+}
+
+void FFT::transform(double* re, double* im, int count, bool inverse) const {
+    const std::size_t row = static_cast<std::size_t>(count);
+    for (int i = 0; i < n; ++i) {
+        if (i < reversed[i]) {
+            std::swap_ranges(re + i * row, re + (i + 1) * row, re + reversed[i] * row);
+            std::swap_ranges(im + i * row, im + (i + 1) * row, im + reversed[i] * row);
+        }
+    }
+    for (int length = 2; length <= n; length <<= 1) {
+        const int half = length / 2;
+        const int step = n / length;
+        for (int start = 0; start < n; start += length) {
+            for (int j = 0; j < half; ++j) {
+                const double wr = twiddles[j * step].real();
+                const double wi = inverse ? -twiddles[j * step].imag() : twiddles[j * step].imag();
+                double* ar = re + (start + j) * row;
+                double* ai = im + (start + j) * row;
+                double* br = ar + half * row;
+                double* bi = ai + half * row;
+                for (std::size_t i = 0; i < row; ++i) {
+                    const double tr = br[i] * wr - bi[i] * wi;
+                    const double ti = br[i] * wi + bi[i] * wr;
+                    br[i] = ar[i] - tr;
+                    bi[i] = ai[i] - ti;
+                    ar[i] += tr;
+                    ai[i] += ti;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+
+/**
+ * @class FFT
+ * @brief Radix-2 complex fast Fourier transform of one power-of-two length.
+ *
+ * The bit-reversal permutation and the twiddle factors are computed once, so one FFT object
+ * transforms any number of sequences of its length, from several threads at once.
+ */
+class FFT {
+public:
+    /**
+     * @brief Prepares transforms of `size` samples.
+     * @param size Sequence length; must be a power of two (1 is allowed).
+     */
+    explicit FFT(int size);
+
+    /**
+     * @brief Number of samples per transform.
+     */
+    int size() const { return n; }
+
+    /**
+     * @brief Replaces `data` by its discrete Fourier transform, X[k] = sum x[j] e^(-2 pi i jk / n).
+     * @param data size() samples, transformed in place.
+     */
+    void forward(std::complex<double>* data) const;
+
+    /**
+     * @brief Inverse of forward(), including the 1/n scale.
+     * @param data size() samples, transformed in place.
+     */
+    void inverse(std::complex<double>* data) const;
+
+    /**
+     * @brief Transforms `count` interleaved sequences at once, stored as separate real and
+     * imaginary planes: sample j of sequence i is (re[j * count + i], im[j * count + i]).
+     *
+     * Each butterfly then combines two whole rows of `count` samples, so the loops vectorise and
+     * the columns of a row-major block (or the lines through the slices of a volume) transform
+     * without being copied out.
+     *
+     * @param re Real parts of size() * count samples, transformed in place.
+     * @param im Imaginary parts of size() * count samples, transformed in place.
+     * @param count Number of sequences.
+     */
+    void forward(double* re, double* im, int count) const;
+
+    /**
+     * @brief Inverse of forward(re, im, count), including the 1/n scale.
+     * @param re Real parts of size() * count samples, transformed in place.
+     * @param im Imaginary parts of size() * count samples, transformed in place.
+     * @param count Number of sequences.
+     */
+    void inverse(double* re, double* im, int count) const;
+
+    /**
+     * @brief Smallest power of two that is at least `value` (1 for values below 2).
+     */
+    static int nextPowerOfTwo(int value);
+
+private:
+    void transform(std::complex<double>* data, bool inverse) const;
+    void transform(double* re, double* im, int count, bool inverse) const;
+
+    int n;                                    ///< Transform length.
+    std::vector<int> reversed;                ///< Bit-reversed index of every sample.
+    std::vector<std::complex<double>> twiddles; ///< e^(-2 pi i k / n) for k < n / 2.
+};
+
+#endif // FFT_H
@@ -5,6 +5,30 @@
 #include "Image.h"
 #include "Volume.h"
 
+/**
+ * @brief How filters treat neighbours that fall outside the image or volume.
+ *
+ * Used by the blur and morphology filters. We included multiple modes to support different
+ * edge handling strategies, as specified in the project requirements.
+ */
+enum class EdgeMode {
+    Extend,   ///< Repeat the nearest edge sample.
+    Reflect,  ///< Mirror the samples about the edge (the edge sample is repeated once).
+    Constant, ///< Leave outside neighbours out of the window.
+    Wrap      ///< Continue from the opposite edge.
+};
+
+/**
+ * @brief Maps a coordinate to the sample it reads under an edge mode.
+ * @param mode The edge mode.
+ * @param coord Coordinate along one axis, possibly outside [0, size).
+ * @param size Number of samples along the axis.
+ * @return A coordinate in [0, size), or -1 if the tap reads nothing (Constant, outside).
+ */
+int edgeCoordinate(EdgeMode mode, int coord, int size);
+
+struct ConvolutionKernel; // Convolution.h
+
 /**
  * @class Filter2D
  * @brief Abstract base class for 2D image filters.
@@ -30,6 +54,8 @@ public:
  * @brief Abstract base class for 3D volume filters.
  *
  * Derived classes must implement the `apply` method to apply specific filtering techniques.
+ * Filters that also have 16-bit or float kernels override the matching `apply` overloads;
+ * the defaults report that the voxel type is not supported and leave the volume unchanged.
  */
 class Filter3D {
 public:
@@ -43,6 +69,18 @@ public:
      * @param vol The volume to apply the filter to.
      */
     virtual void apply(Volume& vol) = 0;
+
+    /**
+     * @brief Applies the filter to a 16-bit volume.
+     * @param vol The volume to apply the filter to.
+     */
+    virtual void apply(Volume16& vol);
+
+    /**
+     * @brief Applies the filter to a float volume.
+     * @param vol The volume to apply the filter to.
+     */
+    virtual void apply(VolumeF& vol);
 };
 
 // -----------------------------------------------------------------------
@@ -93,24 +131,27 @@ Filter2D* createSaltPepperFilter(float noiseAmount);
 /**
  * @brief Creates a box blur filter for 2D images.
  * @param kernelSize The size of the blur kernel (must be odd and positive).
+ * @param edgeMode How neighbours outside the image are read.
  * @return Pointer to the box blur filter instance.
  */
-Filter2D* createBoxBlurFilter(int kernelSize);
+Filter2D* createBoxBlurFilter(int kernelSize, EdgeMode edgeMode = EdgeMode::Extend);
 
 /**
  * @brief Creates a Gaussian blur filter for 2D images.
  * @param kernelSize The size of the blur kernel (must be odd and positive).
  * @param stdev The standard deviation for the Gaussian distribution.
+ * @param edgeMode How neighbours outside the image are read.
  * @return Pointer to the Gaussian blur filter instance.
  */
-Filter2D* createGaussianBlurFilter(int kernelSize, double stdev = 2.0);
+Filter2D* createGaussianBlurFilter(int kernelSize, double stdev = 2.0, EdgeMode edgeMode = EdgeMode::Extend);
 
 /**
  * @brief Creates a median blur filter for 2D images.
  * @param kernelSize The size of the median filter kernel (must be odd and positive).
+ * @param edgeMode How neighbours outside the image are read.
  * @return Pointer to the median blur filter instance.
  */
-Filter2D* createMedianBlurFilter(int kernelSize);
+Filter2D* createMedianBlurFilter(int kernelSize, EdgeMode edgeMode = EdgeMode::Extend);
 
 /**
  * @brief Creates a sharpening filter for 2D images.
@@ -125,6 +166,59 @@ Filter2D* createSharpenFilter();
  */
 Filter2D* createEdgeDetectionFilter(const std::string& edgeType);
 
+/**
+ * @brief Creates an exact Euclidean distance transform for 2D images.
+ *
+ * Each sample becomes `scale` times the distance, in pixels, from its pixel to the nearest
+ * pixel that is 0 in the same channel, rounded and clamped to 255. Separable, so the cost
+ * is linear in the pixel count whatever the distances are.
+ *
+ * @param scale Output units per pixel of distance.
+ * @return Pointer to the distance transform filter instance.
+ */
+Filter2D* createDistanceTransformFilter(double scale = 1.0);
+
+/**
+ * @brief Creates a grey-scale morphology filter for 2D images.
+ *
+ * "Erode" replaces each sample by the minimum of its channel over a width x height rectangle
+ * centred on the pixel (for even sizes, one more pixel before than after), "Dilate" by the
+ * maximum; "Open" erodes then dilates and "Close" dilates then erodes. On a thresholded image
+ * this is binary morphology. Uses the van Herk/Gil-Werman method, so the cost per pixel is
+ * about three comparisons per axis whatever the rectangle's size.
+ *
+ * @param operation "Erode", "Dilate", "Open" or "Close".
+ * @param width Rectangle width in pixels (at least 1).
+ * @param height Rectangle height in pixels (at least 1).
+ * @param edgeMode How neighbours outside the image are treated.
+ * @return Pointer to the morphology filter instance.
+ */
+Filter2D* createMorphologyFilter(const std::string& operation, int width, int height,
+                                 EdgeMode edgeMode = EdgeMode::Extend);
+
+/**
+ * @brief Creates a filter that applies a kernel read from a text file to 2D images.
+ *
+ * The file holds one row of weights per line (see ConvolutionKernel::load). Each channel is
+ * filtered on its own and the results are rounded and clamped to 0-255. Small kernels are
+ * applied directly, outer-product kernels one axis at a time and large ones with the FFT
+ * (see Convolution::chooseMethod). If the file cannot be read, the filter reports it and
+ * leaves images unchanged.
+ *
+ * @param kernelFile Path of the kernel file; it must have a single slice.
+ * @param edgeMode How neighbours outside the image are treated (Constant reads them as 0).
+ * @return Pointer to the convolution filter instance.
+ */
+Filter2D* createConvolutionFilter(const std::string& kernelFile, EdgeMode edgeMode = EdgeMode::Extend);
+
+/**
+ * @brief Creates a filter that applies an already loaded kernel to 2D images.
+ * @param kernel The kernel; it must have a single slice.
+ * @param edgeMode How neighbours outside the image are treated (Constant reads them as 0).
+ * @return Pointer to the convolution filter instance.
+ */
+Filter2D* createConvolutionFilter(const ConvolutionKernel& kernel, EdgeMode edgeMode = EdgeMode::Extend);
+
 // -----------------------------------------------------------------------
 // 3D Filter Factory functions
 // -----------------------------------------------------------------------
@@ -144,4 +238,65 @@ Filter3D* createGaussianBlur3DFilter(int kernelSize, double stdev = 2.0);
  */
 Filter3D* createMedianBlur3DFilter(int kernelSize);
 
+/**
+ * @brief Creates a grey-scale morphology filter for 3D volumes.
+ *
+ * The 3D form of createMorphologyFilter, over a width x height x depth box; the cost per
+ * voxel does not depend on the box size.
+ *
+ * @param operation "Erode", "Dilate", "Open" or "Close".
+ * @param width Box width in voxels (at least 1).
+ * @param height Box height in voxels (at least 1).
+ * @param depth Box depth in slices (at least 1).
+ * @param edgeMode How neighbours outside the volume are treated.
+ * @return Pointer to the morphology filter instance.
+ */
+Filter3D* createMorphology3DFilter(const std::string& operation, int width, int height, int depth,
+                                   EdgeMode edgeMode = EdgeMode::Extend);
+
+/**
+ * @brief Creates a filter that applies a kernel read from a text file to 3D volumes.
+ *
+ * The 3D form of createConvolutionFilter; a kernel file with several slices (separated by
+ * blank lines) also mixes neighbouring slices. Results are rounded and clamped for 8- and
+ * 16-bit volumes and stored as is for float ones.
+ *
+ * @param kernelFile Path of the kernel file.
+ * @param edgeMode How neighbours outside the volume are treated (Constant reads them as 0).
+ * @return Pointer to the convolution filter instance.
+ */
+Filter3D* createConvolution3DFilter(const std::string& kernelFile, EdgeMode edgeMode = EdgeMode::Extend);
+
+/**
+ * @brief Creates a filter that applies an already loaded kernel to 3D volumes.
+ * @param kernel The kernel.
+ * @param edgeMode How neighbours outside the volume are treated (Constant reads them as 0).
+ * @return Pointer to the convolution filter instance.
+ */
+Filter3D* createConvolution3DFilter(const ConvolutionKernel& kernel, EdgeMode edgeMode = EdgeMode::Extend);
+
+/**
+ * @brief Creates a binary threshold filter for 3D volumes.
+ *
+ * Samples below the threshold become 0 and all others the maximum of the voxel type.
+ * Tiles whose range (see BasicVolume::ensureBrickMap) lies on one side of the threshold are
+ * filled or skipped without being read, and the updated ranges are kept for a later projection.
+ *
+ * @param threshold The threshold in voxel units (0-255, 0-65535 for 16-bit, 0-1 for float).
+ * @return Pointer to the threshold filter instance.
+ */
+Filter3D* createThreshold3DFilter(double threshold);
+
+/**
+ * @brief Creates an exact Euclidean distance transform for 3D volumes.
+ *
+ * Each sample becomes `scale` times the distance, in voxels, from its voxel to the nearest
+ * voxel that is 0 in the same channel: rounded and clamped to the voxel type for 8- and
+ * 16-bit volumes, stored as is for float ones (infinite if a channel has no 0).
+ *
+ * @param scale Output units per voxel of distance.
+ * @return Pointer to the distance transform filter instance.
+ */
+Filter3D* createDistanceTransform3DFilter(double scale = 1.0);
+
 #endif // FILTER_H
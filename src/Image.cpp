@@ -20,38 +20,169 @@
  * The Image class manages the image's width, height, number of channels, and pixel data, ensuring
  * proper memory management through its constructor, destructor, and move semantics. It also includes
  * a verbose mode to provide feedback about operations like loading and saving.
+ *
+ * The class is a template over the sample type. Only load() and save() depend on it (they pick
+ * the stb_image entry point and convert to 8 bits for writing); everything else is shared, and the
+ * three supported types are instantiated at the bottom of this file.
  */
 #include "Image.h"
+#include "PngDecoder.h"
+#include "PngEncoder.h"
+#include "Profiler.h"
 #include "stb_image.h"
 #include "stb_image_write.h"
+#include <cstdio>
 #include <iostream>
 #include <cstring>
 #include <algorithm>
 #include <stdexcept>
+#include <vector>
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image.h"
 #include "stb_image_write.h"
 
 
-Image::Image()
+bool isSixteenBitFile(const std::string& filename) {
+    return stbi_is_16_bit(filename.c_str()) != 0;
+}
+
+bool readImageInfo(const std::string& filename, int& width, int& height, int& channels) {
+    return stbi_info(filename.c_str(), &width, &height, &channels) != 0;
+}
+
+namespace {
+
+    // Whole file contents, or nothing if it cannot be read.
+    std::vector<unsigned char> readFile(const std::string& filename) {
+        std::vector<unsigned char> bytes;
+        if (std::FILE* file = std::fopen(filename.c_str(), "rb")) {
+            if (std::fseek(file, 0, SEEK_END) == 0) {
+                const long size = std::ftell(file);
+                if (size > 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+                    bytes.resize(static_cast<size_t>(size));
+                    bytes.resize(std::fread(bytes.data(), 1, bytes.size(), file));
+                }
+            }
+            std::fclose(file);
+        }
+        return bytes;
+    }
+
+    /*
+     * Reads a file as 8-bit (sampleBits 8) or 16-bit samples. PNGs go to decodePng() unless the
+     * stb backend is selected; files it declines, and every other format, are read by stb_image.
+     */
+    void* loadRaw(const std::string& filename, int sampleBits, int& w, int& h, int& ch, int desiredChannels) {
+        if (pngDecodeBackend().load(std::memory_order_relaxed) == PngBackend::Fast) {
+            const std::vector<unsigned char> bytes = readFile(filename);
+            if (bytes.empty()) return nullptr;
+            if (void* decoded = decodePng(bytes.data(), bytes.size(), sampleBits, desiredChannels, w, h, ch)) {
+                return decoded;
+            }
+            const int size = static_cast<int>(bytes.size());
+            return sampleBits == 16 ? static_cast<void*>(stbi_load_16_from_memory(bytes.data(), size, &w, &h, &ch, desiredChannels))
+                                    : static_cast<void*>(stbi_load_from_memory(bytes.data(), size, &w, &h, &ch, desiredChannels));
+        }
+        return sampleBits == 16 ? static_cast<void*>(stbi_load_16(filename.c_str(), &w, &h, &ch, desiredChannels))
+                                : static_cast<void*>(stbi_load(filename.c_str(), &w, &h, &ch, desiredChannels));
+    }
+
+    // Reads a file into T samples.
+    template <typename T>
+    T* loadSamples(const std::string& filename, int& w, int& h, int& ch, int desiredChannels) {
+        if constexpr (std::is_same_v<T, unsigned char>) {
+            return static_cast<T*>(loadRaw(filename, 8, w, h, ch, desiredChannels));
+        } else if constexpr (std::is_same_v<T, std::uint16_t>) {
+            return static_cast<T*>(loadRaw(filename, 16, w, h, ch, desiredChannels));
+        } else {
+            // Float: read at the file's own depth and scale to [0, 1].
+            const bool wide = isSixteenBitFile(filename);
+            void* raw = loadRaw(filename, wide ? 16 : 8, w, h, ch, desiredChannels);
+            if (!raw) return nullptr;
+            const size_t count = static_cast<size_t>(w) * h * (desiredChannels > 0 ? desiredChannels : ch);
+            T* out = static_cast<T*>(std::malloc(count * sizeof(T)));
+            if (out) {
+                if (wide) {
+                    const auto* src = static_cast<const std::uint16_t*>(raw);
+                    for (size_t i = 0; i < count; ++i) out[i] = src[i] / 65535.0f;
+                } else {
+                    const auto* src = static_cast<const unsigned char*>(raw);
+                    for (size_t i = 0; i < count; ++i) out[i] = src[i] / 255.0f;
+                }
+            }
+            stbi_image_free(raw);
+            return out;
+        }
+    }
+
+    // The writers only take 8-bit samples, so wider types are scaled down into `converted`.
+    template <typename T>
+    const unsigned char* samplesAs8Bit(const T* data, size_t count, std::vector<unsigned char>& converted) {
+        if constexpr (std::is_same_v<T, unsigned char>) {
+            return data;
+        } else {
+            const float scale = 255.0f / PixelTraits<T>::maxValue;
+            converted.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                converted[i] = pixelCast<unsigned char>(data[i] * scale);
+            }
+            return converted.data();
+        }
+    }
+
+    // stbi_write_*_to_func callback that appends the encoded bytes to a std::vector.
+    void appendToVector(void* context, void* bytes, int size) {
+        auto* out = static_cast<std::vector<unsigned char>*>(context);
+        const auto* begin = static_cast<const unsigned char*>(bytes);
+        out->insert(out->end(), begin, begin + size);
+    }
+
+    // -1 selects the encoder's default level.
+    PngOptions pngOptionsFor(int pngLevel) {
+        PngOptions options;
+        if (pngLevel >= 0) options.level = pngLevel;
+        return options;
+    }
+
+} // end anonymous namespace
+
+template <typename T>
+BasicImage<T>::BasicImage()
     : width(0), height(0), channels(0), data(nullptr), verbose(true)
 {
 }
 
-Image::Image(int width, int height, int channels, unsigned char* data)
+template <typename T>
+BasicImage<T>::BasicImage(int width, int height, int channels, T* data)
     : width(width), height(height), channels(channels), data(data), verbose(true)
 {
+    if (data) Profiler::noteAllocated(byteSize());
 }
-Image::~Image() {
+
+template <typename T>
+BasicImage<T> BasicImage<T>::view(int width, int height, int channels, T* data) {
+    BasicImage img;
+    img.width = width;
+    img.height = height;
+    img.channels = channels;
+    img.data = data;
+    img.owner = false;
+    return img;
+}
+
+template <typename T>
+BasicImage<T>::~BasicImage() {
     clear();
 }
 
-Image::Image(Image&& other) noexcept
+template <typename T>
+BasicImage<T>::BasicImage(BasicImage&& other) noexcept
     : width(other.width),
       height(other.height),
       channels(other.channels),
       data(other.data),
+      owner(other.owner),
       verbose(other.verbose)
 {
     // Reset the other object's members to a safe state.
@@ -59,10 +190,12 @@ Image::Image(Image&& other) noexcept
     other.height   = 0;
     other.channels = 0;
     other.data     = nullptr;
+    other.owner    = true;
     other.verbose  = true;
 }
 
-Image& Image::operator=(Image&& other) noexcept {
+template <typename T>
+BasicImage<T>& BasicImage<T>::operator=(BasicImage&& other) noexcept {
     // Check for self-assignment to avoid unnecessary work.
     if (this != &other) {
         // Free any existing data in this object.
@@ -73,6 +206,7 @@ Image& Image::operator=(Image&& other) noexcept {
         height   = other.height;
         channels = other.channels;
         data     = other.data;
+        owner    = other.owner;
         verbose  = other.verbose;
 
         // Reset the other object's members to a safe state.
@@ -80,6 +214,7 @@ Image& Image::operator=(Image&& other) noexcept {
         other.height   = 0;
         other.channels = 0;
         other.data     = nullptr;
+        other.owner    = true;
         other.verbose  = true;
     }
     return *this;
@@ -98,12 +233,14 @@ Image& Image::operator=(Image&& other) noexcept {
  *   desiredChannels: The desired number of channels (0 to use the image's native channels, or 1-4 to force a specific number).
  * Returns: True if the image was loaded successfully, false otherwise.
  */
-bool Image::load(const std::string& filename, int desiredChannels) {
+template <typename T>
+bool BasicImage<T>::load(const std::string& filename, int desiredChannels) {
+    PROFILE_SCOPE_CAT("Image::load", "io");
     // Free any previously loaded data to prevent memory leaks.
     clear();
 
     // Use stb_image to load the image data from the file.
-    data = stbi_load(filename.c_str(), &width, &height, &channels, desiredChannels);
+    data = loadSamples<T>(filename, width, height, channels, desiredChannels);
     if (!data) {
         // If loading fails, print an error message and return false.
         std::cerr << "[Error] Failed to load image: " << filename << std::endl;
@@ -114,6 +251,7 @@ bool Image::load(const std::string& filename, int desiredChannels) {
     if (desiredChannels > 0) {
         channels = desiredChannels;
     }
+    Profiler::noteAllocated(byteSize());
 
     // If verbose mode is enabled, print information about the loaded image.
     if (verbose) {
@@ -124,19 +262,67 @@ bool Image::load(const std::string& filename, int desiredChannels) {
     return true;
 }
 
+/*
+ * Decodes an image file into memory owned by the caller, e.g. a slice of a volume's voxel store.
+ * PNGs taken by the built-in decoder are unfiltered straight into `dest`; anything it declines
+ * (other formats, palettes, float samples) goes through loadSamples() and is copied row by row.
+ * Parameters:
+ *   filename: The path to the image file to load.
+ *   dest: Where the first row goes.
+ *   width, height, channels: The size the file must have.
+ *   rowStride: Samples from one row to the next (0 for tightly packed rows).
+ * Returns: True if `dest` now holds the image, false otherwise.
+ */
+template <typename T>
+bool BasicImage<T>::loadInto(const std::string& filename, T* dest, int width, int height, int channels,
+                             size_t rowStride) {
+    PROFILE_SCOPE_CAT("Image::loadInto", "io");
+    const size_t rowSamples = static_cast<size_t>(width) * channels;
+    if (rowStride == 0) rowStride = rowSamples;
+    if (!dest || width <= 0 || height <= 0 || channels <= 0 || rowStride < rowSamples) {
+        std::cerr << "[Error] Invalid destination for image: " << filename << std::endl;
+        return false;
+    }
+
+    if constexpr (!std::is_floating_point_v<T>) {
+        if (pngDecodeBackend().load(std::memory_order_relaxed) == PngBackend::Fast) {
+            const std::vector<unsigned char> bytes = readFile(filename);
+            if (decodePngInto(bytes.data(), bytes.size(), 8 * sizeof(T), width, height, channels,
+                              dest, rowStride * sizeof(T))) {
+                return true;
+            }
+        }
+    }
+
+    int w = 0, h = 0, ch = 0;
+    T* samples = loadSamples<T>(filename, w, h, ch, 0);
+    const bool fits = samples && w == width && h == height && ch == channels;
+    if (fits) {
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(dest + y * rowStride, samples + y * rowSamples, rowSamples * sizeof(T));
+        }
+    }
+    stbi_image_free(samples);
+    return fits;
+}
+
 // ----------------------------------------------------------------------------
 // Save
 // ----------------------------------------------------------------------------
 
 /*
  * Saves the image to a file.
- * This method uses the stb_image_write library to save the image in various formats (PNG, JPG, BMP, TGA),
- * determined by the file extension. It checks for valid data and supported extensions before saving.
+ * This method saves the image in various formats (PNG, JPG, BMP, TGA), determined by the file
+ * extension: PNG through encodePng(), the others through stb_image_write. It checks for valid
+ * data and supported extensions before saving.
  * Parameters:
  *   filename: The path to save the image to.
+ *   pngLevel: Deflate level for PNG files (-1 for the default).
  * Returns: True if the image was saved successfully, false otherwise.
  */
-bool Image::save(const std::string& filename) {
+template <typename T>
+bool BasicImage<T>::save(const std::string& filename, int pngLevel) const {
+    PROFILE_SCOPE_CAT("Image::save", "io");
     // Check if there is any image data to save.
     if (!data) {
         std::cerr << "[Error] No image data to save.\n";
@@ -155,20 +341,23 @@ bool Image::save(const std::string& filename) {
     // Convert the extension to lowercase for case-insensitive comparison.
     std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
 
+    std::vector<unsigned char> converted;
+    const unsigned char* bytes = samplesAs8Bit(data, static_cast<size_t>(width) * height * channels, converted);
+
     int success = 0;
     // Save the image based on the file extension.
     if (ext == "png") {
-        // Save as PNG with the specified dimensions and stride (width * channels).
-        success = stbi_write_png(filename.c_str(), width, height, channels, data, width * channels);
+        // Save as PNG with the requested compression level.
+        success = writePng(filename, bytes, width, height, channels, pngOptionsFor(pngLevel));
     } else if (ext == "jpg" || ext == "jpeg") {
         // Save as JPG with a quality of 90 (out of 100).
-        success = stbi_write_jpg(filename.c_str(), width, height, channels, data, 90);
+        success = stbi_write_jpg(filename.c_str(), width, height, channels, bytes, 90);
     } else if (ext == "bmp") {
         // Save as BMP.
-        success = stbi_write_bmp(filename.c_str(), width, height, channels, data);
+        success = stbi_write_bmp(filename.c_str(), width, height, channels, bytes);
     } else if (ext == "tga") {
         // Save as TGA.
-        success = stbi_write_tga(filename.c_str(), width, height, channels, data);
+        success = stbi_write_tga(filename.c_str(), width, height, channels, bytes);
     } else {
         // If the extension is not supported, print an error and return false.
         std::cerr << "[Error] Unsupported file extension: " << ext << std::endl;
@@ -188,6 +377,49 @@ bool Image::save(const std::string& filename) {
     return true;
 }
 
+/*
+ * Encodes the image in memory instead of writing a file, e.g. to send it over a socket.
+ * Parameters:
+ *   format: "png", "jpg"/"jpeg", "bmp" or "tga".
+ *   out: Receives the encoded file contents (replaced, not appended to).
+ *   pngLevel: Deflate level for PNG (-1 for the default).
+ * Returns: True if the image was encoded successfully, false otherwise.
+ */
+template <typename T>
+bool BasicImage<T>::encode(const std::string& format, std::vector<unsigned char>& out, int pngLevel) const {
+    PROFILE_SCOPE_CAT("Image::encode", "io");
+    out.clear();
+    if (!data) {
+        std::cerr << "[Error] No image data to encode.\n";
+        return false;
+    }
+    std::string ext = format;
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+    std::vector<unsigned char> converted;
+    const unsigned char* bytes = samplesAs8Bit(data, static_cast<size_t>(width) * height * channels, converted);
+
+    int success = 0;
+    if (ext == "png") {
+        success = encodePng(bytes, width, height, channels, pngOptionsFor(pngLevel), out);
+    } else if (ext == "jpg" || ext == "jpeg") {
+        success = stbi_write_jpg_to_func(appendToVector, &out, width, height, channels, bytes, 90);
+    } else if (ext == "bmp") {
+        success = stbi_write_bmp_to_func(appendToVector, &out, width, height, channels, bytes);
+    } else if (ext == "tga") {
+        success = stbi_write_tga_to_func(appendToVector, &out, width, height, channels, bytes);
+    } else {
+        std::cerr << "[Error] Unsupported image format: " << format << std::endl;
+        return false;
+    }
+    if (!success) {
+        std::cerr << "[Error] Failed to encode image as " << format << std::endl;
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
 /*
  * Retrieves a pointer to the pixel data at the specified coordinates.
  * This method allows modifying the pixel data directly and performs bounds checking to ensure
@@ -197,7 +429,8 @@ bool Image::save(const std::string& filename) {
  *   y: The y-coordinate of the pixel.
  * Returns: A pointer to the pixel data, or nullptr if the coordinates are out of bounds.
  */
-unsigned char* Image::getPixel(int x, int y) {
+template <typename T>
+T* BasicImage<T>::getPixel(int x, int y) {
     // Check if the coordinates are within the image bounds.
     if (x < 0 || x >= width || y < 0 || y >= height) {
         return nullptr;
@@ -214,7 +447,8 @@ unsigned char* Image::getPixel(int x, int y) {
  *   y: The y-coordinate of the pixel.
  * Returns: A const pointer to the pixel data, or nullptr if the coordinates are out of bounds.
  */
-const unsigned char* Image::getPixel(int x, int y) const {
+template <typename T>
+const T* BasicImage<T>::getPixel(int x, int y) const {
     // Check if the coordinates are within the image bounds.
     if (x < 0 || x >= width || y < 0 || y >= height) {
         return nullptr;
@@ -223,12 +457,13 @@ const unsigned char* Image::getPixel(int x, int y) const {
     return data + (y * width + x) * channels;
 }
 
-void Image::setPixel(int x, int y, const unsigned char* pixel) {
+template <typename T>
+void BasicImage<T>::setPixel(int x, int y, const T* pixel) {
     // Get the memory address of the pixel.
-    unsigned char* dest = getPixel(x, y);
+    T* dest = getPixel(x, y);
     if (dest) {
         // Copy the pixel data into the image.
-        std::memcpy(dest, pixel, static_cast<size_t>(channels));
+        std::memcpy(dest, pixel, static_cast<size_t>(channels) * sizeof(T));
     }
 }
 
@@ -237,20 +472,24 @@ void Image::setPixel(int x, int y, const unsigned char* pixel) {
  * This method frees the allocated memory for the image data (if any) and resets the width, height,
  * and channels to 0, ensuring the object is in a clean state.
  */
-void Image::clear() {
-    // Check if there is any data to free.
-    if (data) {
+template <typename T>
+void BasicImage<T>::clear() {
+    // Check if there is any data to free; a view leaves it to its owner.
+    if (data && owner) {
+        Profiler::noteFreed(byteSize());
         // Use stb_image_free to free the memory, as it was allocated by stbi_load.
         stbi_image_free(data);
-        data = nullptr;
     }
+    data = nullptr;
+    owner = true;
     // Reset the metadata.
     width    = 0;
     height   = 0;
     channels = 0;
 }
 
-void Image::setData(const unsigned char* newData, int newWidth, int newHeight, int newChannels) {
+template <typename T>
+void BasicImage<T>::setData(const T* newData, int newWidth, int newHeight, int newChannels) {
     // Clear existing data to prevent memory leaks.
     clear();
  
@@ -261,9 +500,9 @@ void Image::setData(const unsigned char* newData, int newWidth, int newHeight, i
     }
  
     // Calculate the total size of the new data.
-    const size_t dataSize = static_cast<size_t>(newWidth) * newHeight * newChannels;
+    const size_t dataSize = static_cast<size_t>(newWidth) * newHeight * newChannels * sizeof(T);
     // Allocate new memory for the image data.
-    data = static_cast<unsigned char*>(std::malloc(dataSize));
+    data = static_cast<T*>(std::malloc(dataSize));
  
     // Check if memory allocation was successful.
     if (!data) {
@@ -278,10 +517,15 @@ void Image::setData(const unsigned char* newData, int newWidth, int newHeight, i
     width = newWidth;
     height = newHeight;
     channels = newChannels;
+    Profiler::noteAllocated(byteSize());
  
     // If verbose mode is enabled, print information about the updated image.
     if (verbose) {
         std::cout << "[Info] Image data updated: " << width << " x " << height
                   << " with " << channels << " channel(s)." << std::endl;
     }
-}
\ No newline at end of file
+}
+
+template class BasicImage<unsigned char>;
+template class BasicImage<std::uint16_t>;
+template class BasicImage<float>;
@@ -1,21 +1,75 @@
 #ifndef IMAGE_H
 #define IMAGE_H
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Value range of each supported sample type.
+ *
+ * Integer samples span [0, maxValue]. Float samples are normalised to [0, 1], so an
+ * 8-bit or 16-bit file loaded as float keeps its relative intensities.
+ */
+template <typename T> struct PixelTraits;
+template <> struct PixelTraits<unsigned char> { static constexpr float maxValue = 255.0f; };
+template <> struct PixelTraits<std::uint16_t> { static constexpr float maxValue = 65535.0f; };
+template <> struct PixelTraits<float> { static constexpr float maxValue = 1.0f; };
+
+/**
+ * @brief Converts a filter result back to the sample type.
+ *
+ * Integer types are rounded and clamped to [0, maxValue]; floats are stored unchanged.
+ */
+template <typename T>
+inline T pixelCast(double v) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<T>(v);
+    } else {
+        return static_cast<T>(std::clamp(std::round(v), 0.0, static_cast<double>(PixelTraits<T>::maxValue)));
+    }
+}
+
+/**
+ * @brief Checks whether an image file stores 16 bits per channel.
+ * @param filename Path to the image file.
+ * @return True for 16-bit PNG/PNM files, false otherwise (or if the file cannot be read).
+ */
+bool isSixteenBitFile(const std::string& filename);
+
+/**
+ * @brief Reads an image file's size and channel count from its header, without decoding it.
+ * @param filename Path to the image file.
+ * @param width Receives the width in pixels.
+ * @param height Receives the height in pixels.
+ * @param channels Receives the file's own channel count.
+ * @return False if the file cannot be read or is not a supported format.
+ */
+bool readImageInfo(const std::string& filename, int& width, int& height, int& channels);
+
 // doxygen comments formatted with ChatGPT
 /**
- * @class Image
- * @brief The Image class represents a 2D image with pixel data and basic manipulation features.
+ * @class BasicImage
+ * @brief The BasicImage class represents a 2D image with pixel data and basic manipulation features.
  *
  * This class supports loading, saving, and accessing image pixel data. It also provides
  * functionality for clearing data and managing verbosity for debugging purposes.
+ * The sample type T is unsigned char (Image), std::uint16_t (Image16) or float (ImageF);
+ * the 8-bit instantiation is what the 2D filters work on.
  */
-class Image {
+template <typename T>
+class BasicImage {
 public:
+    using value_type = T; ///< Type of one channel sample.
+
     /**
      * @brief Default constructor. Initializes an empty image object.
      */
-    Image();
+    BasicImage();
 
     /**
      * @brief Parameterized constructor to create an image with specific dimensions and data.
@@ -24,50 +78,107 @@ public:
      * @param channels Number of color channels (e.g., 3 for RGB, 4 for RGBA).
      * @param data Pointer to the raw image data.
      */
-    Image(int width, int height, int channels, unsigned char* data);
+    BasicImage(int width, int height, int channels, T* data);
+
+    /**
+     * @brief Creates an image over memory it does not own, e.g. one slice of a volume.
+     *
+     * The data is never freed by the view. Loading or setting new data replaces the view
+     * with an ordinary, owning image.
+     *
+     * @param width Image width in pixels.
+     * @param height Image height in pixels.
+     * @param channels Number of color channels.
+     * @param data Tightly packed samples that outlive the view.
+     * @return The view.
+     */
+    static BasicImage view(int width, int height, int channels, T* data);
 
     /**
      * @brief Destructor to release allocated resources.
      */
-    ~Image();
+    ~BasicImage();
 
     /**
      * @brief Deleted copy constructor to prevent copying.
      */
-    Image(const Image&) = delete;
+    BasicImage(const BasicImage&) = delete;
 
     /**
      * @brief Deleted copy assignment operator to prevent copying.
      */
-    Image& operator=(const Image&) = delete;
+    BasicImage& operator=(const BasicImage&) = delete;
 
     /**
      * @brief Move constructor to transfer ownership of resources.
      * @param other Image object to move from.
      */
-    Image(Image&& other) noexcept;
+    BasicImage(BasicImage&& other) noexcept;
 
     /**
      * @brief Move assignment operator to transfer ownership of resources.
      * @param other Image object to move from.
      * @return Reference to the current object.
      */
-    Image& operator=(Image&& other) noexcept;
+    BasicImage& operator=(BasicImage&& other) noexcept;
 
     /**
      * @brief Loads an image from a file.
+     *
+     * 8-bit images are read with stbi_load. Image16 uses stbi_load_16, so 16-bit PNG slices
+     * keep their full range (8-bit files are widened by 257). ImageF reads either depth and
+     * scales it to [0, 1].
+     *
      * @param filename Path to the image file.
      * @param desiredChannels Number of channels to load (0 to keep original).
      * @return True if loading succeeds, false otherwise.
      */
     bool load(const std::string& filename, int desiredChannels = 0);
 
+    /**
+     * @brief Decodes an image file straight into caller-owned memory.
+     *
+     * PNG files decoded by the built-in decoder are written in place with no allocation
+     * or copy; other files are decoded into a temporary and copied. Either way the file
+     * must have exactly the given size and channel count, so one buffer can be reused for
+     * a series of same-sized files.
+     *
+     * @param filename Path to the image file.
+     * @param dest Destination of the first row.
+     * @param width Expected width in pixels.
+     * @param height Expected height in pixels.
+     * @param channels Expected channel count (no conversion is done).
+     * @param rowStride Samples between the starts of consecutive rows, or 0 for width * channels.
+     * @return True if the file was decoded into `dest`, false if it could not be read or
+     *         has a different size.
+     */
+    static bool loadInto(const std::string& filename, T* dest, int width, int height, int channels,
+                         size_t rowStride = 0);
+
     /**
      * @brief Saves the current image to a file.
+     *
+     * Files are always written with 8 bits per channel; other sample types are scaled
+     * from [0, maxValue] to [0, 255] first. PNG files go through encodePng(), so
+     * `pngLevel` trades speed for size (0 stores the rows uncompressed).
+     *
      * @param filename Path to save the image file.
+     * @param pngLevel Deflate level 0-9 for PNG files, or -1 for the default (6).
      * @return True if saving succeeds, false otherwise.
      */
-    bool save(const std::string& filename);
+    bool save(const std::string& filename, int pngLevel = -1) const;
+
+    /**
+     * @brief Encodes the image into a memory buffer instead of a file.
+     *
+     * Uses the same 8-bit conversion and writers as save().
+     *
+     * @param format "png", "jpg", "bmp" or "tga".
+     * @param out Receives the encoded bytes.
+     * @param pngLevel Deflate level 0-9 for PNG, or -1 for the default (6).
+     * @return True if encoding succeeds, false otherwise.
+     */
+    bool encode(const std::string& format, std::vector<unsigned char>& out, int pngLevel = -1) const;
 
     /**
      * @brief Gets the width of the image in pixels.
@@ -91,13 +202,19 @@ public:
      * @brief Gets the pointer to the image's raw data.
      * @return Pointer to mutable image data.
      */
-    unsigned char* getData() { return data; }
+    T* getData() { return data; }
 
     /**
      * @brief Gets a constant pointer to the image's raw data.
      * @return Constant pointer to image data.
      */
-    const unsigned char* getData() const { return data; }
+    const T* getData() const { return data; }
+
+    /**
+     * @brief Checks whether the image frees its data, i.e. it is not a view().
+     * @return True for an owning image.
+     */
+    bool ownsData() const { return owner; }
 
     /**
      * @brief Retrieves a pointer to the pixel at the specified (x, y) coordinates.
@@ -105,7 +222,7 @@ public:
      * @param y Y-coordinate of the pixel.
      * @return Pointer to the pixel data or nullptr if out of bounds.
      */
-    unsigned char* getPixel(int x, int y);
+    T* getPixel(int x, int y);
 
     /**
      * @brief Retrieves a constant pointer to the pixel at the specified (x, y) coordinates.
@@ -113,7 +230,7 @@ public:
      * @param y Y-coordinate of the pixel.
      * @return Constant pointer to the pixel data or nullptr if out of bounds.
      */
-    const unsigned char* getPixel(int x, int y) const;
+    const T* getPixel(int x, int y) const;
 
     /**
      * @brief Sets the pixel data at the specified (x, y) coordinates.
@@ -121,12 +238,12 @@ public:
      * @param y Y-coordinate of the pixel.
      * @param pixel Pointer to the new pixel data.
      */
-    void setPixel(int x, int y, const unsigned char* pixel);
+    void setPixel(int x, int y, const T* pixel);
 
     /**
      * @brief Clears the image data by resetting all pixels to zero.
      */
-    void setData(const unsigned char* newData, int newWidth, int newHeight, int newChannels);
+    void setData(const T* newData, int newWidth, int newHeight, int newChannels);
   
     void clear();
 
@@ -137,11 +254,23 @@ public:
     void setVerbose(bool v) { verbose = v; }
 
 private:
+    // Size of the pixel buffer, as reported to the Profiler when it is taken or freed.
+    std::size_t byteSize() const { return static_cast<std::size_t>(width) * height * channels * sizeof(T); }
+
     int width;      ///< Image width in pixels.
     int height;     ///< Image height in pixels.
     int channels;   ///< Number of color channels.
-    unsigned char* data; ///< Pointer to the image data.
+    T* data;        ///< Pointer to the image data.
+    bool owner = true; ///< False for a view(), whose data is freed by someone else.
     bool verbose = false; ///< Flag for enabling/disabling verbose mode.
 };
 
+using Image = BasicImage<unsigned char>;    ///< 8 bits per channel.
+using Image16 = BasicImage<std::uint16_t>;  ///< 16 bits per channel (e.g. CT slices).
+using ImageF = BasicImage<float>;           ///< Float samples in [0, 1].
+
+extern template class BasicImage<unsigned char>;
+extern template class BasicImage<std::uint16_t>;
+extern template class BasicImage<float>;
+
 #endif // IMAGE_H
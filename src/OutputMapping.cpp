@@ -0,0 +1,253 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the output stage that turns a high-precision result into 8-bit pixels.
+ * Every mapping reduces to a per-channel offset and scale (plus an optional gamma table), so
+ * the mapping, clamping and quantisation share one pass over the data. For 1, 2 and 4
+ * channels, 4 is a multiple of the channel count, so one SSE2 vector of offsets and scales
+ * lines up with every group of 4 samples.
+ */
+#include "OutputMapping.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "Reduction.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define APIF_MAPPING_SSE2 1
+#endif
+
+namespace {
+
+    constexpr std::size_t kChunkPixels = std::size_t(1) << 16;
+    constexpr int kGammaEntries = 65536;
+
+    // Output sample for v: (v - offset) * scale, clamped to [0, 255] and rounded.
+    // The comparisons send NaN to 0, like the SSE2 max/min below.
+    inline float mapSample(float v, float offset, float scale) {
+        float x = (v - offset) * scale;
+        x = x > 0.0f ? x : 0.0f;
+        x = x < 255.0f ? x : 255.0f;
+        return x;
+    }
+
+    // Channels = 0 reads the channel count at run time.
+    template <int Channels>
+    void mapScalar(const float* src, unsigned char* dst, std::size_t pixels, int channels,
+                   const float* offset, const float* scale, const unsigned char* gammaTable) {
+        const int ch = Channels > 0 ? Channels : channels;
+        for (std::size_t i = 0; i < pixels; ++i, src += ch, dst += ch) {
+            for (int c = 0; c < ch; ++c) {
+                const float x = mapSample(src[c], offset[c], scale[c]);
+                dst[c] = gammaTable ? gammaTable[static_cast<int>(x * 257.0f + 0.5f)]
+                                    : static_cast<unsigned char>(x + 0.5f);
+            }
+        }
+    }
+
+#ifdef APIF_MAPPING_SSE2
+    // 16 samples per step; lane j of every vector holds channel j % Channels.
+    template <int Channels>
+    void mapVector(const float* src, unsigned char* dst, std::size_t pixels,
+                   const float* offset, const float* scale) {
+        const std::size_t samples = pixels * Channels;
+        const std::size_t vectorSamples = samples - samples % 16;
+        alignas(16) float lo[4], sc[4];
+        for (int j = 0; j < 4; ++j) {
+            lo[j] = offset[j % Channels];
+            sc[j] = scale[j % Channels];
+        }
+        const __m128 vlo = _mm_load_ps(lo);
+        const __m128 vsc = _mm_load_ps(sc);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 top = _mm_set1_ps(255.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        auto quantise = [&](const float* p) {
+            __m128 x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(p), vlo), vsc);
+            x = _mm_min_ps(_mm_max_ps(x, zero), top);
+            return _mm_cvttps_epi32(_mm_add_ps(x, half));
+        };
+        for (std::size_t i = 0; i < vectorSamples; i += 16) {
+            const __m128i a = _mm_packs_epi32(quantise(src + i), quantise(src + i + 4));
+            const __m128i b = _mm_packs_epi32(quantise(src + i + 8), quantise(src + i + 12));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(a, b));
+        }
+        // The tail is a whole number of pixels, since 16 is a multiple of Channels.
+        mapScalar<Channels>(src + vectorSamples, dst + vectorSamples, (samples - vectorSamples) / Channels,
+                            Channels, offset, scale, nullptr);
+    }
+#endif
+
+    void mapRange(const float* src, unsigned char* dst, std::size_t pixels, int channels,
+                  const float* offset, const float* scale, const unsigned char* gammaTable) {
+#ifdef APIF_MAPPING_SSE2
+        if (!gammaTable) {
+            switch (channels) {
+            case 1: mapVector<1>(src, dst, pixels, offset, scale); return;
+            case 2: mapVector<2>(src, dst, pixels, offset, scale); return;
+            case 4: mapVector<4>(src, dst, pixels, offset, scale); return;
+            default: break;
+            }
+        }
+#endif
+        switch (channels) {
+        case 1: mapScalar<1>(src, dst, pixels, channels, offset, scale, gammaTable); return;
+        case 3: mapScalar<3>(src, dst, pixels, channels, offset, scale, gammaTable); return;
+        case 4: mapScalar<4>(src, dst, pixels, channels, offset, scale, gammaTable); return;
+        default: mapScalar<0>(src, dst, pixels, channels, offset, scale, gammaTable); return;
+        }
+    }
+
+    // Sets each channel's [lo, hi] to its low and high percentile (nearest rank), found
+    // by selection on a copy of the channel so a few outliers cannot hide the rest of the range.
+    void percentileRange(const float* data, std::size_t pixels, int channels, float lowPercent, float highPercent,
+                         std::vector<float>& lo, std::vector<float>& hi) {
+        const auto rank = [&](float percent) {
+            return std::min(pixels - 1, static_cast<std::size_t>(percent / 100.0 * (pixels - 1) + 0.5));
+        };
+        const std::size_t lowRank = rank(lowPercent);
+        const std::size_t highRank = rank(highPercent);
+        std::vector<float> values(pixels);
+        for (int c = 0; c < channels; ++c) {
+            for (std::size_t i = 0; i < pixels; ++i) values[i] = data[i * channels + c];
+            std::nth_element(values.begin(), values.begin() + lowRank, values.end());
+            lo[c] = values[lowRank];
+            std::nth_element(values.begin() + lowRank, values.begin() + highRank, values.end());
+            hi[c] = values[highRank];
+        }
+    }
+
+} // end anonymous namespace
+
+int outputMappingArgCount(const std::string& name) {
+    if (name == "minmax") return 0;
+    if (name == "gamma") return 1;
+    if (name == "window" || name == "percentile") return 2;
+    return -1;
+}
+
+bool parseOutputMapping(const std::vector<std::string>& args, OutputMapping& mapping) {
+    if (args.empty() || outputMappingArgCount(args[0]) < 0) {
+        std::cerr << "[Error] Unknown output mapping: " << (args.empty() ? "" : args[0])
+                  << " (use minmax, window, gamma or percentile)\n";
+        return false;
+    }
+    const std::string& name = args[0];
+    if (static_cast<int>(args.size()) != outputMappingArgCount(name) + 1) {
+        std::cerr << "[Error] Wrong number of parameters for output mapping " << name << "\n";
+        return false;
+    }
+    std::vector<float> values;
+    try {
+        for (std::size_t i = 1; i < args.size(); ++i) values.push_back(std::stof(args[i]));
+    } catch (...) {
+        std::cerr << "[Error] Output mapping " << name << " needs numeric parameters\n";
+        return false;
+    }
+
+    OutputMapping parsed;
+    if (name == "minmax") {
+        parsed.type = MappingType::MinMax;
+    }
+    else if (name == "window") {
+        parsed.type = MappingType::Window;
+        parsed.center = values[0];
+        parsed.width = values[1];
+        if (!(parsed.width > 0.0f)) {
+            std::cerr << "[Error] Window width must be positive\n";
+            return false;
+        }
+    }
+    else if (name == "gamma") {
+        parsed.type = MappingType::Gamma;
+        parsed.gamma = values[0];
+        if (!(parsed.gamma > 0.0f)) {
+            std::cerr << "[Error] Gamma must be positive\n";
+            return false;
+        }
+    }
+    else {
+        parsed.type = MappingType::Percentile;
+        parsed.lowPercent = values[0];
+        parsed.highPercent = values[1];
+        if (!(parsed.lowPercent >= 0.0f && parsed.lowPercent < parsed.highPercent && parsed.highPercent <= 100.0f)) {
+            std::cerr << "[Error] Percentiles must satisfy 0 <= low < high <= 100\n";
+            return false;
+        }
+    }
+    mapping = parsed;
+    return true;
+}
+
+Image mapToImage(const BasicImage<float>& raw, const OutputMapping& mapping) {
+    PROFILE_SCOPE("mapToImage");
+    const int w = raw.getWidth();
+    const int h = raw.getHeight();
+    const int ch = raw.getChannels();
+    const float* src = raw.getData();
+    const std::size_t pixels = static_cast<std::size_t>(w) * h;
+    if (!src || pixels == 0 || ch <= 0) {
+        return Image();
+    }
+
+    // Every mapping becomes an input range [lo, hi] per channel.
+    std::vector<float> lo(ch), hi(ch);
+    if (mapping.type == MappingType::Window) {
+        std::fill(lo.begin(), lo.end(), mapping.center - mapping.width / 2);
+        std::fill(hi.begin(), hi.end(), mapping.center + mapping.width / 2);
+    }
+    else if (mapping.type == MappingType::Percentile) {
+        percentileRange(src, pixels, ch, mapping.lowPercent, mapping.highPercent, lo, hi);
+    }
+    else {
+        const ChannelStats<float> stats = reduceChannels(src, pixels, ch);
+        lo = stats.min;
+        hi = stats.max;
+    }
+    std::vector<float> offset(ch), scale(ch);
+    for (int c = 0; c < ch; ++c) {
+        if (hi[c] > lo[c]) {
+            offset[c] = lo[c];
+            scale[c] = 255.0f / (hi[c] - lo[c]);
+        }
+        else {
+            offset[c] = 0.0f; // no range: keep the value
+            scale[c] = 255.0f;
+        }
+    }
+
+    std::vector<unsigned char> gammaTable;
+    if (mapping.type == MappingType::Gamma && mapping.gamma != 1.0f) {
+        gammaTable.resize(kGammaEntries);
+        const double exponent = 1.0 / mapping.gamma;
+        for (int i = 0; i < kGammaEntries; ++i) {
+            gammaTable[i] = static_cast<unsigned char>(255.0 * std::pow(i / double(kGammaEntries - 1), exponent) + 0.5);
+        }
+    }
+    const unsigned char* table = gammaTable.empty() ? nullptr : gammaTable.data();
+
+    unsigned char* out = static_cast<unsigned char*>(std::malloc(pixels * ch));
+    if (!out) {
+        std::cerr << "[Error] Failed to allocate the mapped image.\n";
+        return Image();
+    }
+    const std::size_t stride = static_cast<std::size_t>(ch);
+    parallelForChunks(pixels, kChunkPixels, [&](std::size_t first, std::size_t last) {
+        mapRange(src + first * stride, out + first * stride, last - first, ch, offset.data(), scale.data(), table);
+    });
+    return Image(w, h, ch, out);
+}
@@ -0,0 +1,64 @@
+#ifndef OUTPUT_MAPPING_H
+#define OUTPUT_MAPPING_H
+
+#include <string>
+#include <vector>
+#include "Image.h"
+
+/**
+ * @brief How a high-precision result is mapped to 8-bit output.
+ */
+enum class MappingType {
+    MinMax,     ///< Stretch each channel's [min, max] to [0, 255].
+    Window,     ///< CT-style window: [center - width/2, center + width/2] to [0, 255], all channels.
+    Gamma,      ///< MinMax, then raise to the power 1/gamma.
+    Percentile  ///< Stretch each channel's [low, high] percentiles to [0, 255], clipping the tails.
+};
+
+/**
+ * @struct OutputMapping
+ * @brief Parameters of the output stage applied by mapToImage.
+ *
+ * Window values are in the units of the image being mapped, e.g. [0, 1] for the raw
+ * projections, which scale voxel values by the maximum of their voxel type.
+ */
+struct OutputMapping {
+    MappingType type = MappingType::MinMax;
+    float center = 0.5f;        ///< Window centre (Window).
+    float width = 1.0f;         ///< Window width (Window).
+    float gamma = 1.0f;         ///< Gamma; values above 1 brighten the mid-tones (Gamma).
+    float lowPercent = 1.0f;    ///< Lower percentile clipped to 0 (Percentile).
+    float highPercent = 99.0f;  ///< Upper percentile clipped to 255 (Percentile).
+};
+
+/**
+ * @brief Parses a mapping written as "minmax", "window <center> <width>", "gamma <g>"
+ *        or "percentile <low> <high>".
+ *
+ * @param args The mapping name followed by its parameters.
+ * @param mapping Receives the parsed mapping.
+ * @return False if the name is unknown or a parameter is missing or out of range
+ *         (an error has been printed).
+ */
+bool parseOutputMapping(const std::vector<std::string>& args, OutputMapping& mapping);
+
+/**
+ * @brief Number of parameters that follow a mapping name, or -1 for an unknown name.
+ */
+int outputMappingArgCount(const std::string& name);
+
+/**
+ * @brief Maps a float image to 8 bits in one pass.
+ *
+ * The statistics a mapping needs (per-channel min/max, or percentiles found by selection)
+ * are gathered first; the mapping, clamping and rounding to 8 bits then happen together in
+ * a single parallel pass, with SSE2 for 1, 2 and 4 channels. A channel with no range (max not
+ * above min) under MinMax, Gamma or Percentile keeps its value, scaled from [0, 1] to [0, 255].
+ *
+ * @param raw The image to map.
+ * @param mapping The mapping to apply.
+ * @return An 8-bit image of the same size and channel count, or an empty image if `raw` is empty.
+ */
+Image mapToImage(const BasicImage<float>& raw, const OutputMapping& mapping);
+
+#endif // OUTPUT_MAPPING_H
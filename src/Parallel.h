@@ -0,0 +1,136 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include "ThreadPool.h"
+
+/**
+ * @brief Upper bound on the worker count of parallelFor/parallelForDynamic (0 = no cap).
+ *
+ * Set from the `--threads` option; the benchmarks lower it to measure thread scaling.
+ */
+inline std::atomic<int>& parallelThreadLimit() {
+    static std::atomic<int> limit{ 0 };
+    return limit;
+}
+
+/**
+ * @brief Number of workers the parallel helpers will use: all hardware threads unless capped.
+ */
+inline int parallelThreadCount() {
+    const int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int limit = parallelThreadLimit().load();
+    return limit > 0 ? limit : hardware;
+}
+
+/**
+ * @brief Runs `fn(i)` for every index in [begin, end) on the shared ThreadPool.
+ *
+ * The range is split into one contiguous chunk per thread, so each worker touches
+ * neighbouring rows/slices; a worker that finishes early steals from the end of the
+ * others. Small ranges and calls made from inside another range run on the calling thread.
+ *
+ * @param begin First index (inclusive).
+ * @param end Last index (exclusive).
+ * @param fn Callable taking an int index.
+ */
+template <typename Func>
+void parallelFor(int begin, int end, Func&& fn) {
+    const int count = end - begin;
+    if (count <= 0) return;
+    ThreadPool::shared().run(count, parallelThreadCount(), [&fn, begin](int i) { fn(begin + i); });
+}
+
+/**
+ * @brief Runs `fn(i)` for every index in [begin, end), balancing items of uneven cost.
+ *
+ * Work stealing hands the indices of slow workers to idle ones, which suits work items
+ * of very different cost (e.g. ray-cast tiles in the middle of a volume versus tiles
+ * that miss it entirely). It shares parallelFor's pool and scheduling.
+ *
+ * @param begin First index (inclusive).
+ * @param end Last index (exclusive).
+ * @param fn Callable taking an int index.
+ */
+template <typename Func>
+void parallelForDynamic(int begin, int end, Func&& fn) {
+    parallelFor(begin, end, std::forward<Func>(fn));
+}
+
+/**
+ * @brief Runs `fn(first, last)` on consecutive pieces of [0, count), `chunk` elements each, in parallel.
+ *
+ * The pieces depend only on `count` and `chunk`, so per-piece partial results combined in
+ * piece order (piece = first / chunk) come out the same for any thread count.
+ *
+ * @param count Number of elements.
+ * @param chunk Elements per piece (the last piece may be shorter).
+ * @param fn Callable taking the std::size_t bounds [first, last) of one piece.
+ */
+template <typename Func>
+void parallelForChunks(std::size_t count, std::size_t chunk, Func&& fn) {
+    if (count == 0) return;
+    chunk = std::max<std::size_t>(1, chunk);
+    const int pieces = static_cast<int>((count + chunk - 1) / chunk);
+    parallelFor(0, pieces, [&](int i) {
+        const std::size_t first = static_cast<std::size_t>(i) * chunk;
+        fn(first, std::min(count, first + chunk));
+    });
+}
+
+/**
+ * @brief One band of rows handed out by parallelRowBands.
+ *
+ * The band writes rows [y0, y1) and may read rows [inY0, inY1): the band widened by
+ * the halo and clamped to the image.
+ */
+struct RowBand {
+    int y0;   ///< First output row (inclusive).
+    int y1;   ///< Last output row (exclusive).
+    int inY0; ///< First input row the band reads.
+    int inY1; ///< One past the last input row the band reads.
+};
+
+/**
+ * @brief Rows per band for an image whose rows are `rowBytes` long.
+ *
+ * A band and its halo rows are sized to stay within a typical per-core L2 cache
+ * (256 KB), with at least one row per band. The result depends only on the image,
+ * so the bands are the same for any thread count.
+ */
+inline int rowBandHeight(std::size_t rowBytes, int halo) {
+    constexpr std::size_t kBandBytes = 256 * 1024;
+    const std::size_t rows = kBandBytes / std::max<std::size_t>(1, rowBytes);
+    const std::size_t haloRows = 2 * static_cast<std::size_t>(std::max(0, halo));
+    return rows > haloRows + 1 ? static_cast<int>(rows - haloRows) : 1;
+}
+
+/**
+ * @brief Splits the rows [0, height) into cache-sized bands and runs `fn(band)` on each in parallel.
+ *
+ * Bands never overlap in their output rows, so a filter that reads from one buffer and
+ * writes another only needs `band.inY0`/`band.inY1` to know which input rows it may touch.
+ *
+ * @param height Number of rows in the image.
+ * @param rowBytes Bytes in one row (width * channels * sizeof(sample)).
+ * @param halo Rows above and below a band that the filter reads (e.g. the kernel radius).
+ * @param fn Callable taking a const RowBand&.
+ */
+template <typename Func>
+void parallelRowBands(int height, std::size_t rowBytes, int halo, Func&& fn) {
+    if (height <= 0) return;
+    const int bandHeight = std::min(height, rowBandHeight(rowBytes, halo));
+    const int bands = (height + bandHeight - 1) / bandHeight;
+    parallelFor(0, bands, [&](int b) {
+        const int y0 = b * bandHeight;
+        const int y1 = std::min(height, y0 + bandHeight);
+        const RowBand band{ y0, y1, std::max(0, y0 - halo), std::min(height, y1 + halo) };
+        fn(band);
+    });
+}
+
+#endif // PARALLEL_H
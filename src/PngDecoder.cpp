@@ -0,0 +1,658 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the fast PNG decode path behind Image::load. Compared with stb_image:
+ *  - inflate keeps 64 bits of input in a register and refills it with one unaligned load,
+ *    decodes codes of up to 11 bits with one table lookup, and copies matches 8 bytes at a time
+ *    into an output buffer sized exactly from IHDR;
+ *  - the Sub, Up, Average and Paeth unfilters work on whole 3- or 4-byte pixels in SSE2
+ *    registers (Up on 16 bytes at a time for every format), and unfilter straight into the
+ *    returned (or caller's) buffer instead of a separate scratch image.
+ * Anything unusual is declined and left to stb_image, so results never differ between the two.
+ */
+#include "PngDecoder.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define APIF_PNG_SSE2 1
+#endif
+
+namespace {
+
+    // ---------------------------------------------------------------------------------------
+    // Inflate (RFC 1950/1951)
+    // ---------------------------------------------------------------------------------------
+
+    constexpr int kFastBits = 11;
+    constexpr int kFastMask = (1 << kFastBits) - 1;
+
+    const int kLengthBase[31] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258, 0, 0 };
+    const int kLengthExtra[31] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                   3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0, 0, 0 };
+    const int kDistBase[32] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                8193, 12289, 16385, 24577, 0, 0 };
+    const int kDistExtra[32] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 0, 0 };
+    const int kCodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    int reverseBits(int code, int bits) {
+        unsigned v = static_cast<unsigned>(code);
+        v = ((v & 0x5555u) << 1) | ((v >> 1) & 0x5555u);
+        v = ((v & 0x3333u) << 2) | ((v >> 2) & 0x3333u);
+        v = ((v & 0x0F0Fu) << 4) | ((v >> 4) & 0x0F0Fu);
+        v = ((v & 0x00FFu) << 8) | ((v >> 8) & 0x00FFu);
+        return static_cast<int>(v >> (16 - bits));
+    }
+
+    /*
+     * Canonical Huffman decoder. Codes up to kFastBits long resolve with one lookup (entry =
+     * length << 9 | symbol); longer ones walk the per-length code ranges, as in zlib's puff.
+     */
+    struct HuffmanTable {
+        std::uint16_t fast[1 << kFastBits];
+        int firstCode[17];
+        int firstIndex[17];
+        int count[17];
+        std::uint16_t symbols[320];
+
+        bool build(const unsigned char* lengths, int n) {
+            std::fill(count, count + 17, 0);
+            for (int i = 0; i < n; ++i) count[lengths[i]]++;
+            count[0] = 0;
+            int code = 0;
+            int index = 0;
+            int nextCode[16];
+            for (int len = 1; len <= 15; ++len) {
+                firstCode[len] = code;
+                firstIndex[len] = index;
+                nextCode[len] = code;
+                code += count[len];
+                index += count[len];
+                if (code > (1 << len)) return false; // over-subscribed
+                code <<= 1;
+            }
+            for (int s = 0; s < n; ++s) {
+                const int len = lengths[s];
+                if (len == 0) continue;
+                const int c = nextCode[len]++;
+                symbols[firstIndex[len] + c - firstCode[len]] = static_cast<std::uint16_t>(s);
+            }
+            // Fill the lookup table a length at a time, doubling it before each longer length:
+            // a code of length len repeats every 2^len entries, so the copy places its repeats.
+            fast[0] = fast[1] = 0;
+            for (int len = 1, size = 2; len <= kFastBits; ++len, size *= 2) {
+                if (len > 1) std::memcpy(fast + size / 2, fast, size / 2 * sizeof(fast[0]));
+                for (int k = 0; k < count[len]; ++k) {
+                    const int s = symbols[firstIndex[len] + k];
+                    fast[reverseBits(firstCode[len] + k, len)] = static_cast<std::uint16_t>((len << 9) | s);
+                }
+            }
+            return true;
+        }
+    };
+
+    class Inflater {
+    public:
+        Inflater(const unsigned char* in, size_t inSize, unsigned char* out, size_t outSize)
+            : in_(in), inEnd_(in + inSize), out_(out), op_(out), outEnd_(out + outSize) {}
+
+        // Inflates the whole stream; true if it ended cleanly and filled the output exactly.
+        bool run() {
+            bool last = false;
+            while (!last) {
+                refill();
+                last = take(1) != 0;
+                const int type = static_cast<int>(take(2));
+                bool ok = false;
+                if (type == 0) ok = stored();
+                else if (type == 1) ok = fixedTables() && codes();
+                else if (type == 2) ok = dynamicTables() && codes();
+                if (!ok || overrun()) return false;
+            }
+            return op_ == outEnd_;
+        }
+
+    private:
+        // Tops the bit buffer up to at least 56 bits; past the input it shifts in zeros.
+        void refill() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            if (inEnd_ - in_ >= 8) {
+                std::uint64_t word;
+                std::memcpy(&word, in_, 8);
+                bits_ |= word << count_;
+                in_ += (63 - count_) >> 3;
+                count_ |= 56;
+                return;
+            }
+#endif
+            while (count_ <= 56) {
+                if (in_ < inEnd_) {
+                    bits_ |= static_cast<std::uint64_t>(*in_++) << count_;
+                } else {
+                    ++padding_;
+                }
+                count_ += 8;
+            }
+        }
+
+        std::uint32_t take(int n) {
+            const std::uint32_t v = static_cast<std::uint32_t>(bits_ & ((std::uint64_t(1) << n) - 1));
+            bits_ >>= n;
+            count_ -= n;
+            return v;
+        }
+
+        // More zero bytes consumed than the final refill could have added: truncated input.
+        bool overrun() const { return padding_ * 8 > count_; }
+
+        int decode(const HuffmanTable& t) {
+            const std::uint16_t entry = t.fast[bits_ & kFastMask];
+            if (entry) {
+                const int len = entry >> 9;
+                bits_ >>= len;
+                count_ -= len;
+                return entry & 511;
+            }
+            int code = 0;
+            for (int len = 1; len <= 15; ++len) {
+                code |= static_cast<int>((bits_ >> (len - 1)) & 1);
+                const int offset = code - t.firstCode[len];
+                if (offset >= 0 && offset < t.count[len]) {
+                    bits_ >>= len;
+                    count_ -= len;
+                    return t.symbols[t.firstIndex[len] + offset];
+                }
+                code <<= 1;
+            }
+            return -1;
+        }
+
+        bool stored() {
+            // Drop to a byte boundary, then hand back whole bytes still in the bit buffer.
+            take(count_ & 7);
+            for (; count_ >= 8 && padding_ > 0; --padding_) count_ -= 8; // zeros added past the end
+            if (padding_ > 0) return false;
+            for (; count_ >= 8; count_ -= 8) --in_;
+            bits_ = 0;
+            count_ = 0;
+            if (inEnd_ - in_ < 4) return false;
+            const size_t len = in_[0] | (in_[1] << 8);
+            const size_t nlen = in_[2] | (in_[3] << 8);
+            in_ += 4;
+            if ((len ^ 0xFFFF) != nlen) return false;
+            if (static_cast<size_t>(inEnd_ - in_) < len || static_cast<size_t>(outEnd_ - op_) < len) return false;
+            std::memcpy(op_, in_, len);
+            in_ += len;
+            op_ += len;
+            return true;
+        }
+
+        // The fixed codes never change, so they are built once and shared.
+        bool fixedTables() {
+            struct FixedTables {
+                HuffmanTable litLen;
+                HuffmanTable dist;
+                FixedTables() {
+                    unsigned char lengths[288 + 32];
+                    std::fill(lengths, lengths + 144, 8);
+                    std::fill(lengths + 144, lengths + 256, 9);
+                    std::fill(lengths + 256, lengths + 280, 7);
+                    std::fill(lengths + 280, lengths + 288, 8);
+                    std::fill(lengths + 288, lengths + 320, 5);
+                    litLen.build(lengths, 288);
+                    dist.build(lengths + 288, 32);
+                }
+            };
+            static const FixedTables fixed;
+            litLen_ = &fixed.litLen;
+            dist_ = &fixed.dist;
+            return true;
+        }
+
+        bool dynamicTables() {
+            refill();
+            const int numLit = static_cast<int>(take(5)) + 257;
+            const int numDist = static_cast<int>(take(5)) + 1;
+            const int numCl = static_cast<int>(take(4)) + 4;
+            unsigned char clLengths[19] = { 0 };
+            for (int i = 0; i < numCl; ++i) {
+                if (count_ < 3) refill();
+                clLengths[kCodeLengthOrder[i]] = static_cast<unsigned char>(take(3));
+            }
+            HuffmanTable cl;
+            if (!cl.build(clLengths, 19)) return false;
+
+            unsigned char lengths[288 + 32] = { 0 };
+            int n = 0;
+            while (n < numLit + numDist) {
+                refill();
+                const int sym = decode(cl);
+                if (sym < 0) return false;
+                if (sym < 16) {
+                    lengths[n++] = static_cast<unsigned char>(sym);
+                    continue;
+                }
+                int repeat = 0;
+                unsigned char value = 0;
+                if (sym == 16) {
+                    if (n == 0) return false;
+                    value = lengths[n - 1];
+                    repeat = 3 + static_cast<int>(take(2));
+                } else if (sym == 17) {
+                    repeat = 3 + static_cast<int>(take(3));
+                } else {
+                    repeat = 11 + static_cast<int>(take(7));
+                }
+                if (n + repeat > numLit + numDist) return false;
+                std::fill(lengths + n, lengths + n + repeat, value);
+                n += repeat;
+            }
+            if (lengths[256] == 0 || overrun()) return false;
+            litLen_ = &dynamicLitLen_;
+            dist_ = &dynamicDist_;
+            return dynamicLitLen_.build(lengths, numLit) && dynamicDist_.build(lengths + numLit, numDist);
+        }
+
+        bool codes() {
+            for (;;) {
+                refill();
+                int sym = decode(*litLen_);
+                if (sym < 256) {
+                    if (sym < 0 || op_ == outEnd_) return false;
+                    *op_++ = static_cast<unsigned char>(sym);
+                    continue;
+                }
+                if (sym == 256) return true;
+                sym -= 257;
+                if (sym >= 29) return false;
+                const size_t len = kLengthBase[sym] + take(kLengthExtra[sym]);
+                const int dsym = decode(*dist_);
+                if (dsym < 0 || dsym >= 30) return false;
+                const size_t dist = kDistBase[dsym] + take(kDistExtra[dsym]);
+                if (dist > static_cast<size_t>(op_ - out_) || len > static_cast<size_t>(outEnd_ - op_)) return false;
+
+                const unsigned char* src = op_ - dist;
+                if (dist == 1) {
+                    std::memset(op_, *src, len);
+                } else if (dist >= 8 && len + 8 <= static_cast<size_t>(outEnd_ - op_)) {
+                    // Chunks never overlap the bytes they read; the last one may spill past len.
+                    for (size_t i = 0; i < len; i += 8) std::memcpy(op_ + i, src + i, 8);
+                } else {
+                    for (size_t i = 0; i < len; ++i) op_[i] = src[i];
+                }
+                op_ += len;
+                if (overrun()) return false;
+            }
+        }
+
+        const unsigned char* in_;
+        const unsigned char* inEnd_;
+        unsigned char* out_;
+        unsigned char* op_;
+        unsigned char* outEnd_;
+        std::uint64_t bits_ = 0;
+        int count_ = 0;
+        int padding_ = 0;
+        HuffmanTable dynamicLitLen_;
+        HuffmanTable dynamicDist_;
+        const HuffmanTable* litLen_ = nullptr;
+        const HuffmanTable* dist_ = nullptr;
+    };
+
+    // ---------------------------------------------------------------------------------------
+    // Unfilter
+    // ---------------------------------------------------------------------------------------
+
+    // Branch-free: on noisy rows the comparisons are unpredictable.
+    int paeth(int a, int b, int c) {
+        const int pa = std::abs(b - c);
+        const int pb = std::abs(a - c);
+        const int pc = std::abs(a + b - 2 * c);
+        const int bc = c ^ ((b ^ c) & -static_cast<int>(pb <= pc));
+        return bc ^ ((a ^ bc) & -static_cast<int>((pa <= pb) & (pa <= pc)));
+    }
+
+    void unfilterUp(unsigned char* dst, const unsigned char* src, const unsigned char* prev, int n) {
+        int i = 0;
+#ifdef APIF_PNG_SSE2
+        for (; i + 16 <= n; i += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi8(x, b));
+        }
+#endif
+        for (; i < n; ++i) dst[i] = static_cast<unsigned char>(src[i] + prev[i]);
+    }
+
+    // Grey rows: the left neighbour stays in a register instead of being re-read from dst.
+    void unfilterGrey(int type, unsigned char* dst, const unsigned char* src, const unsigned char* prev, int n) {
+        int a = 0;
+        int c = 0;
+        switch (type) {
+            case 1:
+                for (int i = 0; i < n; ++i) dst[i] = static_cast<unsigned char>(a = (src[i] + a) & 255);
+                break;
+            case 3:
+                for (int i = 0; i < n; ++i) dst[i] = static_cast<unsigned char>(a = (src[i] + ((a + prev[i]) >> 1)) & 255);
+                break;
+            case 4:
+                for (int i = 0; i < n; ++i) {
+                    const int b = prev[i];
+                    dst[i] = static_cast<unsigned char>(a = (src[i] + paeth(a, b, c)) & 255);
+                    c = b;
+                }
+                break;
+        }
+    }
+
+    // Scalar unfilter for every filter type and pixel size.
+    void unfilterScalar(int type, unsigned char* dst, const unsigned char* src, const unsigned char* prev,
+                        int n, int bpp) {
+        const int lead = std::min(bpp, n);
+        switch (type) {
+            case 0:
+                if (dst != src) std::memcpy(dst, src, n);
+                break;
+            case 1:
+                if (dst != src) std::memcpy(dst, src, lead);
+                for (int i = lead; i < n; ++i) dst[i] = static_cast<unsigned char>(src[i] + dst[i - bpp]);
+                break;
+            case 2:
+                unfilterUp(dst, src, prev, n);
+                break;
+            case 3:
+                for (int i = 0; i < lead; ++i) dst[i] = static_cast<unsigned char>(src[i] + (prev[i] >> 1));
+                for (int i = lead; i < n; ++i) dst[i] = static_cast<unsigned char>(src[i] + ((dst[i - bpp] + prev[i]) >> 1));
+                break;
+            case 4:
+                for (int i = 0; i < lead; ++i) dst[i] = static_cast<unsigned char>(src[i] + prev[i]);
+                for (int i = lead; i < n; ++i) {
+                    dst[i] = static_cast<unsigned char>(src[i] + paeth(dst[i - bpp], prev[i], prev[i - bpp]));
+                }
+                break;
+        }
+    }
+
+#ifdef APIF_PNG_SSE2
+    // One 3- or 4-byte pixel in the low lane of a register.
+    // 3-byte pixels are assembled with shifts: a 3-byte memcpy through the stack stalls store forwarding.
+    template <int Bpp>
+    __m128i loadPixel(const unsigned char* p) {
+        if constexpr (Bpp == 4) {
+            std::int32_t v;
+            std::memcpy(&v, p, 4);
+            return _mm_cvtsi32_si128(v);
+        } else {
+            return _mm_cvtsi32_si128(p[0] | (p[1] << 8) | (p[2] << 16));
+        }
+    }
+
+    template <int Bpp>
+    void storePixel(unsigned char* p, __m128i v) {
+        const std::int32_t w = _mm_cvtsi128_si32(v);
+        if constexpr (Bpp == 4) {
+            std::memcpy(p, &w, 4);
+        } else {
+            p[0] = static_cast<unsigned char>(w);
+            p[1] = static_cast<unsigned char>(w >> 8);
+            p[2] = static_cast<unsigned char>(w >> 16);
+        }
+    }
+
+    __m128i select(__m128i mask, __m128i yes, __m128i no) {
+        return _mm_or_si128(_mm_and_si128(mask, yes), _mm_andnot_si128(mask, no));
+    }
+
+    __m128i abs16(__m128i x) {
+        return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+    }
+
+    // Sub, Average and Paeth on whole RGB or RGBA pixels.
+    template <int Bpp>
+    void unfilterPixels(int type, unsigned char* dst, const unsigned char* src, const unsigned char* prev, int n) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i a = zero;
+        if (type == 1) {
+            for (int i = 0; i < n; i += Bpp) {
+                a = _mm_add_epi8(a, loadPixel<Bpp>(src + i));
+                storePixel<Bpp>(dst + i, a);
+            }
+        } else if (type == 3) {
+            const __m128i one = _mm_set1_epi8(1);
+            for (int i = 0; i < n; i += Bpp) {
+                const __m128i b = loadPixel<Bpp>(prev + i);
+                // avg_epu8 rounds up; PNG's average rounds down.
+                __m128i avg = _mm_avg_epu8(a, b);
+                avg = _mm_sub_epi8(avg, _mm_and_si128(_mm_xor_si128(a, b), one));
+                a = _mm_add_epi8(avg, loadPixel<Bpp>(src + i));
+                storePixel<Bpp>(dst + i, a);
+            }
+        } else {
+            // Paeth in 16-bit lanes, so a + b - 2c cannot overflow.
+            __m128i c = zero;
+            __m128i b = zero;
+            for (int i = 0; i < n; i += Bpp) {
+                c = b;
+                b = _mm_unpacklo_epi8(loadPixel<Bpp>(prev + i), zero);
+                const __m128i pa = abs16(_mm_sub_epi16(b, c));
+                const __m128i pb = abs16(_mm_sub_epi16(a, c));
+                const __m128i pc = abs16(_mm_add_epi16(_mm_sub_epi16(b, c), _mm_sub_epi16(a, c)));
+                const __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+                const __m128i predictor = select(_mm_cmpeq_epi16(smallest, pa), a,
+                                                 select(_mm_cmpeq_epi16(smallest, pb), b, c));
+                const __m128i x = _mm_unpacklo_epi8(loadPixel<Bpp>(src + i), zero);
+                // Byte-wise add keeps each lane's high byte at zero, i.e. the sum mod 256.
+                a = _mm_add_epi8(x, predictor);
+                storePixel<Bpp>(dst + i, _mm_packus_epi16(a, a));
+            }
+        }
+    }
+#endif
+
+    void unfilterRow(int type, unsigned char* dst, const unsigned char* src, const unsigned char* prev,
+                     int n, int bpp) {
+#ifdef APIF_PNG_SSE2
+        if (type == 1 || type == 3 || type == 4) {
+            if (bpp == 4) {
+                unfilterPixels<4>(type, dst, src, prev, n);
+                return;
+            }
+            if (bpp == 3) {
+                unfilterPixels<3>(type, dst, src, prev, n);
+                return;
+            }
+        }
+#endif
+        if (bpp == 1 && type != 0 && type != 2) {
+            unfilterGrey(type, dst, src, prev, n);
+            return;
+        }
+        unfilterScalar(type, dst, src, prev, n, bpp);
+    }
+
+    std::uint32_t readU32(const unsigned char* p) {
+        return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | p[3];
+    }
+
+    // What decodeRows() needs from the chunk walk; `zlib` points into the file or into `joined`.
+    struct PngStream {
+        int width = 0;
+        int height = 0;
+        int depth = 0;
+        int channels = 0;
+        const unsigned char* zlib = nullptr;
+        size_t zlibSize = 0;
+        std::vector<unsigned char> joined;
+    };
+
+    // Walks the chunks: IHDR first, IDAT gathered, anything that needs stb's handling declines.
+    bool readStream(const unsigned char* data, size_t size, PngStream& png) {
+        static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        if (size < 8 + 25 || std::memcmp(data, signature, 8) != 0) return false;
+
+        int colourType = 0;
+        std::vector<std::pair<const unsigned char*, size_t>> idat;
+        size_t pos = 8;
+        bool seenHeader = false;
+        bool seenEnd = false;
+        while (pos + 12 <= size && !seenEnd) {
+            const size_t length = readU32(data + pos);
+            const unsigned char* type = data + pos + 4;
+            const unsigned char* body = data + pos + 8;
+            if (length > size - pos - 12) return false;
+            if (std::memcmp(type, "IHDR", 4) == 0) {
+                if (length != 13) return false;
+                png.width = static_cast<int>(readU32(body));
+                png.height = static_cast<int>(readU32(body + 4));
+                png.depth = body[8];
+                colourType = body[9];
+                if (body[10] != 0 || body[11] != 0 || body[12] != 0) return false; // interlaced etc.
+                seenHeader = true;
+            } else if (std::memcmp(type, "IDAT", 4) == 0) {
+                idat.push_back({ body, length });
+                png.zlibSize += length;
+            } else if (std::memcmp(type, "IEND", 4) == 0) {
+                seenEnd = true;
+            } else if (std::memcmp(type, "tRNS", 4) == 0 || std::memcmp(type, "PLTE", 4) == 0 ||
+                       std::memcmp(type, "CgBI", 4) == 0) {
+                return false;
+            }
+            pos += length + 12;
+        }
+        if (!seenHeader || png.width <= 0 || png.height <= 0 || png.zlibSize < 6) return false;
+        if (png.depth != 8 && png.depth != 16) return false;
+        switch (colourType) {
+            case 0: png.channels = 1; break;
+            case 4: png.channels = 2; break;
+            case 2: png.channels = 3; break;
+            case 6: png.channels = 4; break;
+            default: return false;
+        }
+        if (static_cast<std::uint64_t>(png.width) * png.height * png.channels > (std::uint64_t(1) << 31)) return false;
+
+        // A single IDAT (the usual case) is inflated in place; several are joined first.
+        png.zlib = idat[0].first;
+        if (idat.size() > 1) {
+            png.joined.reserve(png.zlibSize);
+            for (const auto& chunk : idat) png.joined.insert(png.joined.end(), chunk.first, chunk.first + chunk.second);
+            png.zlib = png.joined.data();
+        }
+        const int cmf = png.zlib[0];
+        const int flg = png.zlib[1];
+        return (cmf & 15) == 8 && (cmf * 256 + flg) % 31 == 0 && !(flg & 32);
+    }
+
+    /*
+     * Inflates and unfilters into `out`, whose rows are `rowStride` bytes apart, as samples of
+     * `sampleBits` bits. False if the stream is corrupt; `out` may then be partly written.
+     */
+    bool decodeRows(const PngStream& png, int sampleBits, unsigned char* out, size_t rowStride) {
+        const int w = png.width;
+        const int h = png.height;
+        const int bpp = png.channels * png.depth / 8;
+        const size_t rowBytes = static_cast<size_t>(w) * bpp;
+        const size_t stride = rowBytes + 1;
+        std::unique_ptr<unsigned char[]> filtered(new unsigned char[stride * h]); // fully overwritten
+        Inflater inflater(png.zlib + 2, png.zlibSize - 2, filtered.get(), stride * h);
+        if (!inflater.run()) return false;
+
+        // Unfilter straight into the result when the layout matches; otherwise in place first.
+        const bool direct = png.depth == sampleBits;
+        const std::vector<unsigned char> zeroRow(rowBytes, 0);
+        for (int y = 0; y < h; ++y) {
+            const unsigned char* src = filtered.get() + y * stride;
+            const int filter = src[0];
+            if (filter > 4) return false;
+            unsigned char* dst = direct ? out + y * rowStride : filtered.get() + y * stride + 1;
+            const unsigned char* prev = y == 0 ? zeroRow.data()
+                                      : direct ? out + (y - 1) * rowStride
+                                               : filtered.get() + (y - 1) * stride + 1;
+            unfilterRow(filter, dst, src + 1, prev, static_cast<int>(rowBytes), bpp);
+        }
+
+        const size_t rowSamples = static_cast<size_t>(w) * png.channels;
+        for (int y = 0; y < h && sampleBits == 16; ++y) {
+            auto* samples = reinterpret_cast<std::uint16_t*>(out + y * rowStride);
+            if (png.depth == 16) {
+                // PNG stores 16-bit samples big-endian.
+                const unsigned char* bytes = out + y * rowStride;
+                for (size_t i = 0; i < rowSamples; ++i) {
+                    samples[i] = static_cast<std::uint16_t>((bytes[2 * i] << 8) | bytes[2 * i + 1]);
+                }
+            } else {
+                const unsigned char* row = filtered.get() + y * stride + 1;
+                for (size_t i = 0; i < rowSamples; ++i) samples[i] = static_cast<std::uint16_t>(row[i] * 257);
+            }
+        }
+        return true;
+    }
+
+    PngBackend initialBackend() {
+        if (const char* env = std::getenv("APIF_PNG_DECODER")) {
+            const std::string value = env;
+            if (value == "stb") return PngBackend::Stb;
+            if (value == "fast") return PngBackend::Fast;
+        }
+#ifdef APIF_NO_FAST_PNG
+        return PngBackend::Stb;
+#else
+        return PngBackend::Fast;
+#endif
+    }
+
+} // end anonymous namespace
+
+std::atomic<PngBackend>& pngDecodeBackend() {
+    static std::atomic<PngBackend> backend{ initialBackend() };
+    return backend;
+}
+
+void* decodePng(const unsigned char* data, size_t size, int sampleBits, int desiredChannels,
+                int& width, int& height, int& channels) {
+    PngStream png;
+    if ((sampleBits != 8 && sampleBits != 16) || !readStream(data, size, png)) return nullptr;
+    if (desiredChannels != 0 && desiredChannels != png.channels) return nullptr;
+    if (png.depth == 16 && sampleBits == 8) return nullptr;
+
+    const size_t rowStride = static_cast<size_t>(png.width) * png.channels * (sampleBits / 8);
+    auto* out = static_cast<unsigned char*>(std::malloc(rowStride * png.height));
+    if (!out) return nullptr;
+    if (!decodeRows(png, sampleBits, out, rowStride)) {
+        std::free(out);
+        return nullptr;
+    }
+    width = png.width;
+    height = png.height;
+    channels = png.channels;
+    return out;
+}
+
+bool decodePngInto(const unsigned char* data, size_t size, int sampleBits, int width, int height,
+                   int channels, void* dest, size_t rowStride) {
+    PngStream png;
+    if ((sampleBits != 8 && sampleBits != 16) || !readStream(data, size, png)) return false;
+    if (png.width != width || png.height != height || png.channels != channels) return false;
+    if (png.depth == 16 && sampleBits == 8) return false;
+    if (rowStride < static_cast<size_t>(width) * channels * (sampleBits / 8)) return false;
+    return decodeRows(png, sampleBits, static_cast<unsigned char*>(dest), rowStride);
+}
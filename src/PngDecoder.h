@@ -0,0 +1,69 @@
+#ifndef PNG_DECODER_H
+#define PNG_DECODER_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Which decoder Image::load uses for PNG files.
+ */
+enum class PngBackend {
+    Fast, ///< decodePng(), falling back to stb_image for files it does not handle.
+    Stb   ///< stb_image only.
+};
+
+/**
+ * @brief Process-wide PNG decoder choice.
+ *
+ * Defaults to Fast, or to Stb when built with APIF_NO_FAST_PNG (CMake option
+ * APIF_FAST_PNG=OFF). Setting the environment variable APIF_PNG_DECODER to "stb" or "fast"
+ * overrides the default at startup; the benchmarks switch it at runtime.
+ */
+std::atomic<PngBackend>& pngDecodeBackend();
+
+/**
+ * @brief Decodes a PNG held in memory with the built-in inflate and SSE2 unfilter.
+ *
+ * Handles non-interlaced 8-bit and 16-bit grey, grey + alpha, RGB and RGBA images, which
+ * covers the images and scans this project reads. Palette, interlaced, tRNS and sub-byte
+ * images, and any channel count conversion, are declined so the caller can use stb_image,
+ * which gives the same results for them.
+ *
+ * @param data PNG file contents.
+ * @param size Number of bytes in `data`.
+ * @param sampleBits 8 or 16: width of the returned samples. An 8-bit file decoded to 16
+ *                   bits is widened by 257, like stbi_load_16.
+ * @param desiredChannels 0, or the file's own channel count.
+ * @param width Receives the image width.
+ * @param height Receives the image height.
+ * @param channels Receives the file's channel count.
+ * @return Samples allocated with malloc (release with free/stbi_image_free), or nullptr if
+ *         the file is declined or corrupt.
+ */
+void* decodePng(const unsigned char* data, size_t size, int sampleBits, int desiredChannels,
+                int& width, int& height, int& channels);
+
+/**
+ * @brief Decodes a PNG held in memory into caller-owned memory.
+ *
+ * Same decoder and coverage as decodePng(), but nothing is allocated for the result: rows
+ * are written `rowStride` bytes apart starting at `dest`, e.g. straight into one slice of a
+ * volume or into a buffer reused across files. The file must have exactly the given size
+ * and channel count.
+ *
+ * @param data PNG file contents.
+ * @param size Number of bytes in `data`.
+ * @param sampleBits 8 or 16: width of the written samples.
+ * @param width Expected image width.
+ * @param height Expected image height.
+ * @param channels Expected channel count.
+ * @param dest Destination of the first row.
+ * @param rowStride Bytes between the starts of consecutive rows, at least one row's size.
+ * @return False if the file is declined, corrupt or of a different size; `dest` may then
+ *         have been partly written.
+ */
+bool decodePngInto(const unsigned char* data, size_t size, int sampleBits, int width, int height,
+                   int channels, void* dest, size_t rowStride);
+
+#endif // PNG_DECODER_H
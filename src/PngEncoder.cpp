@@ -0,0 +1,207 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the PNG writer used for all PNG output. It replaces stbi_write_png,
+ * whose single deflate call can neither be tuned nor split. Rows are filtered in parallel,
+ * then the filtered data is cut into strips at row boundaries. Each strip becomes its own
+ * deflate stream ending in a sync flush, and the streams are concatenated into one zlib
+ * stream whose Adler-32 is combined from the per-strip checksums.
+ */
+#include "PngEncoder.h"
+#include "Deflate.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+    // Below this much filtered data per strip, the lost matches outweigh the parallel speed-up.
+    constexpr size_t kMinStripBytes = 256 * 1024;
+    constexpr size_t kMaxIdatBytes = 1 << 20;
+
+    void putU32(std::vector<unsigned char>& out, std::uint32_t v) {
+        out.push_back(static_cast<unsigned char>(v >> 24));
+        out.push_back(static_cast<unsigned char>(v >> 16));
+        out.push_back(static_cast<unsigned char>(v >> 8));
+        out.push_back(static_cast<unsigned char>(v));
+    }
+
+    void writeChunk(std::vector<unsigned char>& out, const char type[4], const unsigned char* data, size_t size) {
+        putU32(out, static_cast<std::uint32_t>(size));
+        const size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data, data + size);
+        putU32(out, crc32Update(0, out.data() + start, size + 4));
+    }
+
+    int paeth(int a, int b, int c) {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+        if (pa <= pb && pa <= pc) return a;
+        return pb <= pc ? b : c;
+    }
+
+    template <int Type>
+    int predict(int a, int b, int c) {
+        if constexpr (Type == 1) return a;
+        else if constexpr (Type == 2) return b;
+        else if constexpr (Type == 3) return (a + b) / 2;
+        else if constexpr (Type == 4) return paeth(a, b, c);
+        else return 0;
+    }
+
+    /*
+     * Writes PNG filter `Type` applied to `row` into dst (without the type byte) and returns
+     * the sum of the filtered bytes read as signed values, the usual estimate of how well the
+     * row will compress. `prev` is the previous raw row (all zeros for the first row).
+     */
+    template <int Type>
+    long filterRow(const unsigned char* row, const unsigned char* prev, int rowBytes, int bpp, unsigned char* dst) {
+        long cost = 0;
+        const int lead = std::min(bpp, rowBytes);
+        for (int i = 0; i < lead; ++i) {
+            const unsigned char v = static_cast<unsigned char>(row[i] - predict<Type>(0, prev[i], 0));
+            dst[i] = v;
+            cost += std::abs(static_cast<signed char>(v));
+        }
+        for (int i = lead; i < rowBytes; ++i) {
+            const unsigned char v = static_cast<unsigned char>(row[i] - predict<Type>(row[i - bpp], prev[i], prev[i - bpp]));
+            dst[i] = v;
+            cost += std::abs(static_cast<signed char>(v));
+        }
+        return cost;
+    }
+
+    using FilterFn = long (*)(const unsigned char*, const unsigned char*, int, int, unsigned char*);
+    const FilterFn kFilters[5] = { filterRow<0>, filterRow<1>, filterRow<2>, filterRow<3>, filterRow<4> };
+
+} // end anonymous namespace
+
+bool encodePng(const unsigned char* pixels, int width, int height, int channels,
+               const PngOptions& options, std::vector<unsigned char>& out) {
+    PROFILE_SCOPE_CAT("encodePng", "io");
+    out.clear();
+    if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        std::cerr << "[PNG] Invalid image: " << width << "x" << height << "x" << channels << "\n";
+        return false;
+    }
+    const int level = std::clamp(options.level, 0, 9);
+    const int rowBytes = width * channels;
+    const size_t stride = static_cast<size_t>(rowBytes) + 1;
+    const size_t total = stride * height;
+
+    // Filter every row, keeping the cheapest of the five PNG filters.
+    std::vector<unsigned char> filtered(total);
+    const std::vector<unsigned char> zeroRow(rowBytes, 0);
+    auto filterOne = [&](int y) {
+        const unsigned char* row = pixels + static_cast<size_t>(y) * rowBytes;
+        const unsigned char* prev = y > 0 ? row - rowBytes : zeroRow.data();
+        unsigned char* dst = filtered.data() + static_cast<size_t>(y) * stride;
+        dst[0] = 0;
+        if (level == 0) {
+            std::copy(row, row + rowBytes, dst + 1);
+            return;
+        }
+        std::vector<unsigned char> trial(rowBytes);
+        long best = kFilters[0](row, prev, rowBytes, channels, dst + 1);
+        for (int type = 1; type <= 4; ++type) {
+            const long cost = kFilters[type](row, prev, rowBytes, channels, trial.data());
+            if (cost < best) {
+                best = cost;
+                dst[0] = static_cast<unsigned char>(type);
+                std::copy(trial.begin(), trial.end(), dst + 1);
+            }
+        }
+    };
+    // Small images (e.g. volume slices, already saved concurrently) are not worth the threads.
+    if (total >= kMinStripBytes) {
+        parallelFor(0, height, filterOne);
+    } else {
+        for (int y = 0; y < height; ++y) filterOne(y);
+    }
+
+    // Split at row boundaries and deflate the strips independently.
+    int strips = options.strips;
+    if (strips <= 0) {
+        strips = static_cast<int>(std::min<size_t>(parallelThreadCount(), std::max<size_t>(1, total / kMinStripBytes)));
+    }
+    strips = std::clamp(strips, 1, height);
+    const int rowsPerStrip = (height + strips - 1) / strips;
+    strips = (height + rowsPerStrip - 1) / rowsPerStrip;
+
+    std::vector<std::vector<unsigned char>> streams(strips);
+    std::vector<std::uint32_t> adlers(strips);
+    std::vector<size_t> sizes(strips);
+    parallelForDynamic(0, strips, [&](int s) {
+        const int y0 = s * rowsPerStrip;
+        const int y1 = std::min(height, y0 + rowsPerStrip);
+        const unsigned char* begin = filtered.data() + static_cast<size_t>(y0) * stride;
+        sizes[s] = static_cast<size_t>(y1 - y0) * stride;
+        adlers[s] = adler32Update(1, begin, sizes[s]);
+        deflateCompress(begin, sizes[s], level, s == strips - 1, streams[s]);
+    });
+
+    std::vector<unsigned char> zlib;
+    size_t compressedSize = 6;
+    for (const auto& stream : streams) compressedSize += stream.size();
+    zlib.reserve(compressedSize);
+    const int cmf = 0x78; // deflate, 32 KB window
+    const int levelFlag = level <= 1 ? 0 : level <= 5 ? 1 : level == 6 ? 2 : 3;
+    int flg = levelFlag << 6;
+    flg += (31 - (cmf * 256 + flg) % 31) % 31;
+    zlib.push_back(static_cast<unsigned char>(cmf));
+    zlib.push_back(static_cast<unsigned char>(flg));
+    std::uint32_t adler = adlers[0];
+    for (int s = 0; s < strips; ++s) {
+        zlib.insert(zlib.end(), streams[s].begin(), streams[s].end());
+        if (s > 0) adler = adler32Combine(adler, adlers[s], sizes[s]);
+    }
+    putU32(zlib, adler);
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    static const unsigned char colourTypes[5] = { 0, 0, 4, 2, 6 };
+    out.reserve(zlib.size() + 64 + 12 * (zlib.size() / kMaxIdatBytes));
+    out.insert(out.end(), signature, signature + 8);
+
+    std::vector<unsigned char> header;
+    putU32(header, static_cast<std::uint32_t>(width));
+    putU32(header, static_cast<std::uint32_t>(height));
+    header.push_back(8);                     // bit depth
+    header.push_back(colourTypes[channels]);
+    header.push_back(0);                     // deflate
+    header.push_back(0);                     // adaptive filtering
+    header.push_back(0);                     // no interlace
+    writeChunk(out, "IHDR", header.data(), header.size());
+    for (size_t offset = 0; offset < zlib.size(); offset += kMaxIdatBytes) {
+        writeChunk(out, "IDAT", zlib.data() + offset, std::min(kMaxIdatBytes, zlib.size() - offset));
+    }
+    writeChunk(out, "IEND", nullptr, 0);
+    return true;
+}
+
+bool writePng(const std::string& filename, const unsigned char* pixels, int width, int height,
+              int channels, const PngOptions& options) {
+    std::vector<unsigned char> encoded;
+    if (!encodePng(pixels, width, height, channels, options, encoded)) {
+        return false;
+    }
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,43 @@
+#ifndef PNG_ENCODER_H
+#define PNG_ENCODER_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Settings for encodePng().
+ */
+struct PngOptions {
+    /// Deflate level: 0 stores the rows uncompressed (fastest, for intermediates), 9 is smallest.
+    int level = 6;
+    /// Row strips compressed in parallel; 0 picks one per worker thread for large images.
+    int strips = 0;
+};
+
+/**
+ * @brief Encodes 8-bit pixels as a PNG file in memory.
+ *
+ * Each row gets the PNG filter (None, Sub, Up, Average or Paeth) with the smallest sum of
+ * absolute differences; level 0 always uses None. The filtered rows are split into strips
+ * that are deflated independently on the parallelFor workers and joined with sync flushes,
+ * so large images compress on all cores at a small cost in size.
+ *
+ * @param pixels Row-major interleaved samples, width * channels bytes per row.
+ * @param width Image width in pixels.
+ * @param height Image height in pixels.
+ * @param channels 1 (grey), 2 (grey + alpha), 3 (RGB) or 4 (RGBA).
+ * @param options Compression level and strip count.
+ * @param out Receives the PNG file contents (replaced).
+ * @return False if the dimensions or channel count are invalid.
+ */
+bool encodePng(const unsigned char* pixels, int width, int height, int channels,
+               const PngOptions& options, std::vector<unsigned char>& out);
+
+/**
+ * @brief Encodes with encodePng() and writes the result to `filename`.
+ * @return True if the file was written.
+ */
+bool writePng(const std::string& filename, const unsigned char* pixels, int width, int height,
+              int channels, const PngOptions& options);
+
+#endif // PNG_ENCODER_H
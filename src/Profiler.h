@@ -0,0 +1,160 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief One timed region recorded by the Profiler.
+ */
+struct ProfileEvent {
+    std::string name;         ///< Stage name, e.g. "Volume::load".
+    std::string category;     ///< Grouping in the trace viewer: "io", "filter", "volume" or "stage".
+    long long startUs;        ///< Start, in microseconds since Profiler::enable().
+    long long durationUs;     ///< Wall time spent in the region, in microseconds.
+    std::thread::id thread;   ///< Thread that ran the region.
+    long long allocPeakKB;    ///< Most heap memory in use during the region, above what was in use when it began.
+    long long allocNetKB;     ///< Heap memory allocated in the region and still in use when it ended.
+    long long heapKB;         ///< Heap memory in use when the region ended.
+};
+
+/**
+ * @class Profiler
+ * @brief Collects per-stage timings and memory use, and exports them as a Chrome trace.
+ *
+ * Recording is off until enable() is called. While it is off, a ProfileScope does one
+ * relaxed atomic load and nothing else. Building with APIF_NO_PROFILING removes the
+ * PROFILE_SCOPE macros entirely.
+ *
+ * Memory is counted, not sampled: operator new is replaced by a version that counts the
+ * bytes it hands out, and BasicImage reports the malloc'd pixel buffers it owns through
+ * noteAllocated() and noteFreed(). Each scope records the high-water mark of that count
+ * while it is open, so a stage that allocates and frees a large temporary still reports it.
+ * Nested scopes on one thread each get their own mark; scopes that overlap on other
+ * threads see each other's allocations. The process peak resident set size from the OS is
+ * printed once in the summary.
+ */
+class Profiler {
+public:
+    /**
+     * @brief Starts recording, discarding any earlier events.
+     */
+    static void enable();
+
+    /**
+     * @brief Stops recording. Events recorded so far are kept.
+     */
+    static void disable();
+
+    /**
+     * @brief True while events are being recorded.
+     */
+    static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Adds a finished region. Thread-safe.
+     */
+    static void record(ProfileEvent event);
+
+    /**
+     * @brief Copy of every event recorded since enable().
+     */
+    static std::vector<ProfileEvent> events();
+
+    /**
+     * @brief Microseconds since enable().
+     */
+    static long long nowMicros();
+
+    /**
+     * @brief Peak resident set size of the process in KB (0 where the platform does not report it).
+     */
+    static long long peakRssKB();
+
+    /**
+     * @brief Counts a heap block that operator new does not see, such as a malloc'd pixel buffer.
+     * @param bytes Size of the block.
+     */
+    static void noteAllocated(std::size_t bytes);
+
+    /**
+     * @brief Counts the release of a block passed to noteAllocated().
+     * @param bytes Size of the block.
+     */
+    static void noteFreed(std::size_t bytes);
+
+    /**
+     * @brief Heap bytes currently in use, from operator new and noteAllocated().
+     */
+    static long long heapBytes();
+
+    /**
+     * @brief Writes the events in Chrome trace-event format (chrome://tracing, Perfetto).
+     * @param filename Output JSON file.
+     * @return True on success.
+     */
+    static bool writeTrace(const std::string& filename);
+
+    /**
+     * @brief Prints calls, total and mean time, share of the run and heap use per stage.
+     * @param out Stream to print the table to.
+     */
+    static void printSummary(std::ostream& out);
+
+private:
+    static inline std::atomic<bool> enabled_{ false };
+};
+
+/**
+ * @class ProfileScope
+ * @brief Records the region between its construction and destruction as one event.
+ *
+ * Use through PROFILE_SCOPE so it disappears from builds without profiling.
+ */
+class ProfileScope {
+public:
+    /**
+     * @param name Stage name; must outlive the scope (a string literal).
+     * @param category Trace category; must outlive the scope.
+     */
+    explicit ProfileScope(const char* name, const char* category = "stage")
+        : name_(name), category_(category), active_(Profiler::isEnabled()) {
+        if (active_) begin();
+    }
+
+    ~ProfileScope() {
+        if (active_) end();
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    void begin();
+    void end();
+
+    const char* name_;
+    const char* category_;
+    bool active_;
+    long long startUs_ = 0;
+    long long startHeapBytes_ = 0;
+    long long outerHighWater_ = 0; ///< High-water mark of the enclosing scope, restored by end().
+};
+
+#ifdef APIF_NO_PROFILING
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_SCOPE_CAT(name, category) ((void)0)
+#else
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+/// Times the rest of the enclosing block as stage `name`.
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+/// Same as PROFILE_SCOPE, with a trace category ("io", "filter", "volume", ...).
+#define PROFILE_SCOPE_CAT(name, category) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name, category)
+#endif
+
+#endif // PROFILER_H
@@ -10,11 +10,16 @@
  *   - Azam Sazina (GitHub: esemsc-as1224)
  */
 #include "Projection.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "Reduction.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
 // Clamp to [0, 255]
@@ -22,156 +27,277 @@ inline unsigned char clamp255(float v) {
     return (v < 0) ? 0 : (v > 255) ? 255 : static_cast<unsigned char>(v + 0.5f);
 }
 
-// Normalize an image to [0, 255] per channel
-void normalizeImage(Image& img) {
+// Normalize an image to [0, maxValue] per channel (255 for 8-bit, 65535 for 16-bit, 1 for float).
+// One reduction finds every channel's range and one pass remaps all channels together.
+template <typename T>
+void normalizeImage(BasicImage<T>& img) {
     int w = img.getWidth();
     int h = img.getHeight();
     int ch = img.getChannels();
-    unsigned char* data = img.getData();
+    T* data = img.getData();
+    const size_t pixels = static_cast<size_t>(w) * h;
+    if (!data || pixels == 0 || ch <= 0) return;
 
+    const ChannelStats<T> stats = reduceChannels(data, pixels, ch);
+    std::vector<float> minVal(ch), scale(ch, 0.0f);
     for (int c = 0; c < ch; ++c) {
-        float minVal = 255.0f, maxVal = 0.0f;
-        for (int i = c; i < w * h * ch; i += ch) {
-            minVal = std::min(minVal, static_cast<float>(data[i]));
-            maxVal = std::max(maxVal, static_cast<float>(data[i]));
+        minVal[c] = static_cast<float>(stats.min[c]);
+        const float maxVal = static_cast<float>(stats.max[c]);
+        if (maxVal > minVal[c]) scale[c] = PixelTraits<T>::maxValue / (maxVal - minVal[c]);
+    }
+    // A flat channel (scale 0) is left as it is, which also avoids dividing by zero.
+    remapChannels(data, pixels, ch, [&](int c, T v) {
+        return scale[c] > 0.0f ? pixelCast<T>((v - minVal[c]) * scale[c]) : v;
+    });
+}
+
+// Stores a projected value as an output sample. Raw (float) output keeps the value unrounded,
+// scaled by the voxel type's maximum so it lies in [0, 1] like other float images.
+template <typename U, typename T, typename V>
+inline U storeSample(V v) {
+    if constexpr (std::is_same_v<U, float> && !std::is_same_v<T, float>) {
+        return static_cast<float>(static_cast<double>(v) / PixelTraits<T>::maxValue);
+    } else {
+        return pixelCast<U>(v);
+    }
+}
+
+// The running extreme of MIP/MinIP: the output itself when it has the voxel type, else `scratch`.
+template <typename T, typename U>
+inline T* extremeBuffer(U* outData, std::vector<T>& scratch, size_t samples) {
+    if constexpr (std::is_same_v<U, T>) {
+        return outData;
+    } else {
+        scratch.resize(samples);
+        return scratch.data();
+    }
+}
+
+// Converts a finished extreme buffer into the output, unless it already is the output.
+template <typename U, typename T>
+inline void storeExtreme(U* outData, const T* extreme, size_t samples) {
+    if constexpr (!std::is_same_v<U, T>) {
+        for (size_t i = 0; i < samples; ++i) outData[i] = storeSample<U, T>(extreme[i]);
+    }
+}
+
+// Clamps a 0-based z range to the volume; false (with a message) if nothing is left.
+inline bool clampRange(const char* tag, int depth, int& zMin, int& zMax) {
+    zMin = std::max(0, zMin);
+    zMax = std::min(depth - 1, zMax);
+    if (zMin > zMax) {
+        std::cerr << tag << " Invalid z range: " << zMin << " to " << zMax << "\n";
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Running maximum (Max = true) or minimum of slices [zMin, zMax] using the volume's tile ranges.
+ * For each tile, `bound` is the highest tile minimum over the range (lowest tile maximum for
+ * MinIP), so the result is at least `bound` everywhere in the tile once the slice `boundSlice`
+ * holding it has been folded. Any other slice whose tile maximum is no higher than `bound`
+ * cannot change the result there and is skipped. A band of tiles is folded slice by slice over
+ * runs of adjacent tiles that are not skipped, so rows are still read in order. The result is
+ * the same as folding every slice.
+ */
+template <bool Max, typename T>
+static void tiledExtreme(const BasicVolume<T>& vol, const BrickMap<T>& bricks, int zMin, int zMax, T* extreme) {
+    const int w = vol.getWidth();
+    const int h = vol.getHeight();
+    const int ch = vol.getChannels();
+    const int tile = BrickMap<T>::kTileSize;
+    const int tilesX = bricks.getTilesX();
+    const size_t rowLength = static_cast<size_t>(w) * ch;
+    const T start = Max ? std::numeric_limits<T>::lowest() : std::numeric_limits<T>::max();
+
+    parallelForDynamic(0, bricks.getTilesY(), [&](int ty) {
+        const int y0 = ty * tile;
+        const int y1 = std::min(h, y0 + tile);
+        std::vector<T> bound(tilesX);
+        std::vector<int> boundSlice(tilesX, zMin);
+        for (int tx = 0; tx < tilesX; ++tx) {
+            bound[tx] = Max ? bricks.minimum(tx, ty, zMin) : bricks.maximum(tx, ty, zMin);
+            for (int z = zMin + 1; z <= zMax; ++z) {
+                const T v = Max ? bricks.minimum(tx, ty, z) : bricks.maximum(tx, ty, z);
+                if (Max ? v > bound[tx] : v < bound[tx]) {
+                    bound[tx] = v;
+                    boundSlice[tx] = z;
+                }
+            }
         }
-        if (maxVal <= minVal) continue; // Avoid division by zero
-        float scale = 255.0f / (maxVal - minVal);
-        for (int i = c; i < w * h * ch; i += ch) {
-            data[i] = clamp255((data[i] - minVal) * scale);
+        for (int y = y0; y < y1; ++y) {
+            std::fill_n(extreme + y * rowLength, rowLength, start);
         }
-    }
+
+        std::vector<std::pair<size_t, size_t>> spans;
+        for (int z = zMin; z <= zMax; ++z) {
+            spans.clear();
+            for (int tx = 0; tx < tilesX; ++tx) {
+                const bool skip = z != boundSlice[tx] &&
+                    (Max ? bricks.maximum(tx, ty, z) <= bound[tx] : bricks.minimum(tx, ty, z) >= bound[tx]);
+                if (skip) continue;
+                const size_t x0 = static_cast<size_t>(tx) * tile * ch;
+                const size_t x1 = static_cast<size_t>(std::min(w, (tx + 1) * tile)) * ch;
+                if (!spans.empty() && spans.back().second == x0) {
+                    spans.back().second = x1;
+                } else {
+                    spans.emplace_back(x0, x1);
+                }
+            }
+            for (int y = y0; y < y1; ++y) {
+                const T* src = vol.getSlices()[z].getData() + y * rowLength;
+                T* dst = extreme + y * rowLength;
+                for (const auto& span : spans) {
+                    // Local bounds: stores through an 8-bit `dst` may alias the span itself.
+                    const size_t x0 = span.first;
+                    const size_t x1 = span.second;
+                    for (size_t i = x0; i < x1; ++i) {
+                        dst[i] = Max ? std::max(dst[i], src[i]) : std::min(dst[i], src[i]);
+                    }
+                }
+            }
+        }
+    });
 }
 
 /*
  * Performs a Maximum Intensity Projection (MIP) on a 3D volume over a specified Z-range.
  * MIP selects the maximum value along the Z-axis for each (x, y) position, producing a 2D image
  * that highlights the brightest structures in the volume (e.g., bones in a CT scan).
+ * The kernels below are templated on the voxel type T, so 16-bit CT data is projected at full
+ * precision, and on the output sample type U: U = T for the normalised projections and
+ * U = float for the raw ones, which leave the mapping to the output stage.
  * Parameters:
  *   vol: The 3D volume to project.
  *   zMin: The starting Z-index (inclusive).
  *   zMax: The ending Z-index (inclusive).
- * Returns: A 2D image containing the MIP result.
+ * Returns: A 2D image containing the unnormalised MIP result.
  */
-static Image mipCore(const Volume& vol, int zMin, int zMax) {
+template <typename U, typename T>
+static BasicImage<U> mipCore(const BasicVolume<T>& vol, int zMin, int zMax) {
+    PROFILE_SCOPE_CAT("Projection::MIP", "volume");
     int w = vol.getWidth();
     int h = vol.getHeight();
     int ch = vol.getChannels();
-
-    zMin = std::max(0, zMin);
-    zMax = std::min(vol.getDepth() - 1, zMax);
-    if (zMin > zMax) {
-        std::cerr << "[MIP] Invalid z range: " << zMin << " to " << zMax << "\n";
-        return Image();
+    if (!clampRange("[MIP]", vol.getDepth(), zMin, zMax)) {
+        return BasicImage<U>();
     }
 
-    unsigned char* outData = (unsigned char*)std::malloc(w * h * ch);
+    U* outData = (U*)std::malloc(sizeof(U) * w * h * ch);
     if (!outData) {
         std::cerr << "[MIP] Failed to allocate memory.\n";
-        return Image();
+        return BasicImage<U>();
     }
-    std::memcpy(outData, vol.getSlices()[zMin].getData(), w * h * ch);
-
-    Image result(w, h, ch, outData);
+    std::vector<T> scratch;
+    BasicImage<U> result(w, h, ch, outData);
+    T* extreme = extremeBuffer<T>(outData, scratch, w * h * ch);
+    if (const BrickMap<T>* bricks = vol.ensureBrickMap()) {
+        tiledExtreme<true>(vol, *bricks, zMin, zMax, extreme);
+        storeExtreme<U, T>(outData, extreme, w * h * ch);
+        return result;
+    }
+    std::memcpy(extreme, vol.getSlices()[zMin].getData(), sizeof(T) * w * h * ch);
     for (int z = zMin + 1; z <= zMax; ++z) {
-        const unsigned char* sliceData = vol.getSlices()[z].getData();
+        const T* sliceData = vol.getSlices()[z].getData();
         for (int i = 0; i < w * h * ch; ++i) {
-            outData[i] = std::max(outData[i], sliceData[i]);
+            extreme[i] = std::max(extreme[i], sliceData[i]);
         }
     }
-    normalizeImage(result); // Always normalize for visibility
+    storeExtreme<U, T>(outData, extreme, w * h * ch);
     return result;
 }
 
-static Image minipCore(const Volume& vol, int zMin, int zMax) {
+template <typename U, typename T>
+static BasicImage<U> minipCore(const BasicVolume<T>& vol, int zMin, int zMax) {
+    PROFILE_SCOPE_CAT("Projection::MinIP", "volume");
     int w = vol.getWidth();
     int h = vol.getHeight();
     int ch = vol.getChannels();
-
-    zMin = std::max(0, zMin);
-    zMax = std::min(vol.getDepth() - 1, zMax);
-    if (zMin > zMax) {
-        std::cerr << "[MinIP] Invalid z range: " << zMin << " to " << zMax << "\n";
-        return Image();
+    if (!clampRange("[MinIP]", vol.getDepth(), zMin, zMax)) {
+        return BasicImage<U>();
     }
 
-    unsigned char* outData = (unsigned char*)std::malloc(w * h * ch);
+    U* outData = (U*)std::malloc(sizeof(U) * w * h * ch);
     if (!outData) {
         std::cerr << "[MinIP] Failed to allocate memory.\n";
-        return Image();
+        return BasicImage<U>();
     }
-    std::memcpy(outData, vol.getSlices()[zMin].getData(), w * h * ch);
-
-    Image result(w, h, ch, outData);
+    std::vector<T> scratch;
+    BasicImage<U> result(w, h, ch, outData);
+    T* extreme = extremeBuffer<T>(outData, scratch, w * h * ch);
+    if (const BrickMap<T>* bricks = vol.ensureBrickMap()) {
+        tiledExtreme<false>(vol, *bricks, zMin, zMax, extreme);
+        storeExtreme<U, T>(outData, extreme, w * h * ch);
+        return result;
+    }
+    std::memcpy(extreme, vol.getSlices()[zMin].getData(), sizeof(T) * w * h * ch);
     for (int z = zMin + 1; z <= zMax; ++z) {
-        const unsigned char* sliceData = vol.getSlices()[z].getData();
+        const T* sliceData = vol.getSlices()[z].getData();
         for (int i = 0; i < w * h * ch; ++i) {
-            outData[i] = std::min(outData[i], sliceData[i]);
+            extreme[i] = std::min(extreme[i], sliceData[i]);
         }
     }
-    normalizeImage(result);
+    storeExtreme<U, T>(outData, extreme, w * h * ch);
     return result;
 }
 
-static Image meanCore(const Volume& vol, int zMin, int zMax) {
+template <typename U, typename T>
+static BasicImage<U> meanCore(const BasicVolume<T>& vol, int zMin, int zMax) {
+    PROFILE_SCOPE_CAT("Projection::meanAIP", "volume");
     int w = vol.getWidth();
     int h = vol.getHeight();
     int ch = vol.getChannels();
-
-    zMin = std::max(0, zMin);
-    zMax = std::min(vol.getDepth() - 1, zMax);
-    if (zMin > zMax) {
-        std::cerr << "[MeanIP] Invalid z range: " << zMin << " to " << zMax << "\n";
-        return Image();
+    if (!clampRange("[MeanIP]", vol.getDepth(), zMin, zMax)) {
+        return BasicImage<U>();
     }
 
-    unsigned char* outData = (unsigned char*)std::malloc(w * h * ch);
+    U* outData = (U*)std::malloc(sizeof(U) * w * h * ch);
     if (!outData) {
         std::cerr << "[MeanIP] Failed to allocate memory.\n";
-        return Image();
+        return BasicImage<U>();
     }
-    Image result(w, h, ch, outData);
-    std::vector<float> sums(w * h * ch, 0.0f);
+    BasicImage<U> result(w, h, ch, outData);
+    // float sums are exact for 8-bit stacks; wider samples need double to stay exact.
+    using Sum = std::conditional_t<std::is_same_v<T, unsigned char>, float, double>;
+    std::vector<Sum> sums(w * h * ch, Sum(0));
     int count = zMax - zMin + 1;
 
     for (int z = zMin; z <= zMax; ++z) {
-        const unsigned char* sliceData = vol.getSlices()[z].getData();
+        const T* sliceData = vol.getSlices()[z].getData();
         for (int i = 0; i < w * h * ch; ++i) {
             sums[i] += sliceData[i];
         }
     }
-    float minVal = 255.0f, maxVal = 0.0f;
+    Sum minVal = PixelTraits<T>::maxValue, maxVal = 0;
     for (int i = 0; i < w * h * ch; ++i) {
-        float mean = sums[i] / count;
-        outData[i] = clamp255(mean);
+        Sum mean = sums[i] / count;
+        outData[i] = storeSample<U, T>(mean);
         minVal = std::min(minVal, mean);
         maxVal = std::max(maxVal, mean);
     }
     std::cout << "[MeanIP] Raw range: min=" << minVal << ", max=" << maxVal << "\n";
-    normalizeImage(result); // Normalize to enhance contrast
     return result;
 }
 
-static Image medianCore(const Volume& vol, int zMin, int zMax) {
+template <typename U, typename T>
+static BasicImage<U> medianCore(const BasicVolume<T>& vol, int zMin, int zMax) {
+    PROFILE_SCOPE_CAT("Projection::medianAIP", "volume");
     int w = vol.getWidth();
     int h = vol.getHeight();
     int ch = vol.getChannels();
-   // Clamp the Z-range to valid indices.
-    zMin = std::max(0, zMin);
-    zMax = std::min(vol.getDepth() - 1, zMax);
-    if (zMin > zMax) {
-        std::cerr << "[MedianIP] Invalid z range: " << zMin << " to " << zMax << "\n";
-        return Image();
+    if (!clampRange("[MedianIP]", vol.getDepth(), zMin, zMax)) {
+        return BasicImage<U>();
     }
 
-    unsigned char* outData = (unsigned char*)std::malloc(w * h * ch);
+    U* outData = (U*)std::malloc(sizeof(U) * w * h * ch);
     if (!outData) {
         std::cerr << "[MedianIP] Failed to allocate memory.\n";
-        return Image();
+        return BasicImage<U>();
     }
-    Image result(w, h, ch, outData);
+    BasicImage<U> result(w, h, ch, outData);
     int count = zMax - zMin + 1;
-    std::vector<unsigned char> buffer(count);
+    std::vector<T> buffer(count);
 
     for (int y = 0; y < h; ++y) {
         for (int x = 0; x < w; ++x) {
@@ -180,38 +306,626 @@ static Image medianCore(const Volume& vol, int zMin, int zMax) {
                     buffer[z - zMin] = vol.getSlices()[z].getPixel(x, y)[c];
                 }
                 std::nth_element(buffer.begin(), buffer.begin() + count / 2, buffer.end());
-                outData[(y * w + x) * ch + c] = buffer[count / 2];
+                outData[(y * w + x) * ch + c] = storeSample<U, T>(buffer[count / 2]);
             }
         }
     }
-    normalizeImage(result);
     return result;
 }
 
+// The normalised projections stretch every channel to the full range of T.
+template <typename T>
+static BasicImage<T> normalized(BasicImage<T>&& img) {
+    normalizeImage(img);
+    return std::move(img);
+}
+
 // Public API
-// Public API (corrected)
-Image Projection::maximumIntensityProjection(const Volume& vol) {
-    return mipCore(vol, 0, vol.getDepth() - 1);
+template <typename T>
+BasicImage<T> Projection::maximumIntensityProjection(const BasicVolume<T>& vol) {
+    return normalized(mipCore<T>(vol, 0, vol.getDepth() - 1));
 }
-Image Projection::minimumIntensityProjection(const Volume& vol) {
-    return minipCore(vol, 0, vol.getDepth() - 1);
+template <typename T>
+BasicImage<T> Projection::minimumIntensityProjection(const BasicVolume<T>& vol) {
+    return normalized(minipCore<T>(vol, 0, vol.getDepth() - 1));
 }
-Image Projection::meanIntensityProjection(const Volume& vol) {
-    return meanCore(vol, 0, vol.getDepth() - 1);
+template <typename T>
+BasicImage<T> Projection::meanIntensityProjection(const BasicVolume<T>& vol) {
+    return normalized(meanCore<T>(vol, 0, vol.getDepth() - 1));
 }
-Image Projection::medianIntensityProjection(const Volume& vol) {
-    return medianCore(vol, 0, vol.getDepth() - 1);
+template <typename T>
+BasicImage<T> Projection::medianIntensityProjection(const BasicVolume<T>& vol) {
+    return normalized(medianCore<T>(vol, 0, vol.getDepth() - 1));
 }
 
-Image Projection::maximumIntensityProjection(const Volume& vol, int zMin, int zMax) {
-    return mipCore(vol, zMin - 1, zMax - 1); // Convert 1-based to 0-based
+template <typename T>
+BasicImage<T> Projection::maximumIntensityProjection(const BasicVolume<T>& vol, int zMin, int zMax) {
+    return normalized(mipCore<T>(vol, zMin - 1, zMax - 1)); // Convert 1-based to 0-based
+}
+template <typename T>
+BasicImage<T> Projection::minimumIntensityProjection(const BasicVolume<T>& vol, int zMin, int zMax) {
+    return normalized(minipCore<T>(vol, zMin - 1, zMax - 1));
+}
+template <typename T>
+BasicImage<T> Projection::meanIntensityProjection(const BasicVolume<T>& vol, int zMin, int zMax) {
+    return normalized(meanCore<T>(vol, zMin - 1, zMax - 1));
 }
-Image Projection::minimumIntensityProjection(const Volume& vol, int zMin, int zMax) {
-    return minipCore(vol, zMin - 1, zMax - 1);
+template <typename T>
+BasicImage<T> Projection::medianIntensityProjection(const BasicVolume<T>& vol, int zMin, int zMax) {
+    return normalized(medianCore<T>(vol, zMin - 1, zMax - 1));
 }
-Image Projection::meanIntensityProjection(const Volume& vol, int zMin, int zMax) {
-    return meanCore(vol, zMin - 1, zMax - 1);
+
+template <typename T>
+BasicImage<float> Projection::rawProjection(const BasicVolume<T>& vol, ProjectionMode mode, int zMin, int zMax) {
+    switch (mode) {
+    case ProjectionMode::MIP: return mipCore<float>(vol, zMin - 1, zMax - 1);
+    case ProjectionMode::MinIP: return minipCore<float>(vol, zMin - 1, zMax - 1);
+    default: return meanCore<float>(vol, zMin - 1, zMax - 1);
+    }
+}
+template <typename T>
+BasicImage<float> Projection::rawMedianProjection(const BasicVolume<T>& vol, int zMin, int zMax) {
+    return medianCore<float>(vol, zMin - 1, zMax - 1);
+}
+
+// ----------------------------------------------------------------------------
+// Streaming projections
+// ----------------------------------------------------------------------------
+
+bool SliceSeries::open(const std::string& directoryWithBasename, ChannelMode channelMode) {
+    files.clear();
+    width = height = channels = sourceChannels = 0;
+    mode = channelMode;
+    for (const std::string& file : Volume::listSliceFiles(directoryWithBasename)) {
+        int w = 0, h = 0, ch = 0;
+        if (!readImageInfo(file, w, h, ch)) {
+            std::cerr << "Failed to load slice: " << file << std::endl;
+            continue;
+        }
+        if (files.empty()) {
+            width = w;
+            height = h;
+            channels = ch;
+        }
+        else if (w != width || h != height || ch != channels) {
+            std::cerr << "Slice file " << file << " does not match volume dimensions/channels. Skipping.\n";
+            continue;
+        }
+        files.push_back(file);
+    }
+    if (files.empty()) {
+        std::cerr << "No readable slices found for: " << directoryWithBasename << std::endl;
+        return false;
+    }
+    // Probe the same three slices as Volume::load; 16-bit probes are exact for 8-bit files too.
+    sourceChannels = channels;
+    if (channels > 1 && (mode == ChannelMode::Collapse ||
+                         (mode == ChannelMode::Auto &&
+                          Volume16::greySlices(std::vector<std::string>(files.begin(), files.begin() + std::min<size_t>(files.size(), 3)),
+                                               width, height, channels)))) {
+        channels = 1;
+    }
+    return true;
 }
-Image Projection::medianIntensityProjection(const Volume& vol, int zMin, int zMax) {
-    return medianCore(vol, zMin - 1, zMax - 1);
+
+/*
+ * Projects a slice series straight from disk. The z range is cut into one contiguous run
+ * per thread; a lane decodes its run into a single reused slice buffer and folds each slice
+ * into its own extreme or sum buffer. Lanes are then combined in z order, so integer sums
+ * (float holds 8-bit sums exactly, like meanCore) and extremes match the in-memory cores.
+ */
+template <typename U, typename T>
+static BasicImage<U> streamCore(const SliceSeries& series, ProjectionMode mode, int zMin, int zMax) {
+    PROFILE_SCOPE_CAT("Projection::stream", "volume");
+    const char* tag = mode == ProjectionMode::MIP ? "[MIP]" : mode == ProjectionMode::MinIP ? "[MinIP]" : "[MeanIP]";
+    const int w = series.width;
+    const int h = series.height;
+    const int ch = series.channels;
+
+    if (!clampRange(tag, series.getDepth(), zMin, zMax)) {
+        return BasicImage<U>();
+    }
+
+    using Sum = std::conditional_t<std::is_same_v<T, unsigned char>, float, double>;
+    struct Lane {
+        std::vector<T> slice;
+        std::vector<T> extreme;
+        std::vector<Sum> sums;
+        int folded = 0;
+    };
+    const size_t samples = static_cast<size_t>(w) * h * ch;
+    const int count = zMax - zMin + 1;
+    const int lanes = std::clamp(parallelThreadCount(), 1, count);
+    const bool collapse = ch != series.sourceChannels;
+    std::vector<Lane> acc(lanes);
+    std::vector<char> failed(count, 0);
+    std::vector<char> colour(count, 0);
+
+    parallelFor(0, lanes, [&](int l) {
+        Lane& lane = acc[l];
+        lane.slice.resize(samples);
+        if (mode == ProjectionMode::Mean) lane.sums.assign(samples, Sum(0));
+        const int first = zMin + static_cast<int>(static_cast<long long>(count) * l / lanes);
+        const int last = zMin + static_cast<int>(static_cast<long long>(count) * (l + 1) / lanes);
+        for (int z = first; z < last; ++z) {
+            bool grey = true;
+            if (!BasicVolume<T>::loadSliceInto(series.files[z], lane.slice.data(), w, h, series.sourceChannels,
+                                               collapse, &grey)) {
+                failed[z - zMin] = 1;
+                continue;
+            }
+            colour[z - zMin] = collapse && !grey;
+            const T* s = lane.slice.data();
+            if (mode == ProjectionMode::Mean) {
+                for (size_t i = 0; i < samples; ++i) lane.sums[i] += s[i];
+            }
+            else if (lane.folded == 0) {
+                lane.extreme.swap(lane.slice);
+                lane.slice.resize(samples);
+            }
+            else if (mode == ProjectionMode::MIP) {
+                for (size_t i = 0; i < samples; ++i) lane.extreme[i] = std::max(lane.extreme[i], s[i]);
+            }
+            else {
+                for (size_t i = 0; i < samples; ++i) lane.extreme[i] = std::min(lane.extreme[i], s[i]);
+            }
+            ++lane.folded;
+        }
+        lane.slice = std::vector<T>();
+    });
+
+    for (int i = 0; i < count; ++i) {
+        if (failed[i]) std::cerr << "Failed to load slice: " << series.files[zMin + i] << std::endl;
+    }
+    // Auto collapsing guessed from the first slices; project every channel if one has colour.
+    if (series.mode == ChannelMode::Auto) {
+        const auto hasColour = std::find(colour.begin(), colour.end(), 1);
+        if (hasColour != colour.end()) {
+            std::cout << "Slice " << series.files[zMin + (hasColour - colour.begin())]
+                      << " is not grey; projecting every channel.\n";
+            SliceSeries full = series;
+            full.channels = full.sourceChannels;
+            full.mode = ChannelMode::Keep;
+            return streamCore<U, T>(full, mode, zMin, zMax);
+        }
+    }
+
+    // Combine the lanes in z order into the first lane that folded anything.
+    Lane* total = nullptr;
+    int folded = 0;
+    for (Lane& lane : acc) {
+        if (lane.folded == 0) continue;
+        folded += lane.folded;
+        if (!total) {
+            total = &lane;
+            continue;
+        }
+        if (mode == ProjectionMode::Mean) {
+            for (size_t i = 0; i < samples; ++i) total->sums[i] += lane.sums[i];
+        }
+        else if (mode == ProjectionMode::MIP) {
+            for (size_t i = 0; i < samples; ++i) total->extreme[i] = std::max(total->extreme[i], lane.extreme[i]);
+        }
+        else {
+            for (size_t i = 0; i < samples; ++i) total->extreme[i] = std::min(total->extreme[i], lane.extreme[i]);
+        }
+    }
+    if (!total) {
+        std::cerr << tag << " No slice in the z range could be decoded.\n";
+        return BasicImage<U>();
+    }
+
+    U* outData = (U*)std::malloc(sizeof(U) * samples);
+    if (!outData) {
+        std::cerr << tag << " Failed to allocate memory.\n";
+        return BasicImage<U>();
+    }
+    BasicImage<U> result(w, h, ch, outData);
+    if (mode == ProjectionMode::Mean) {
+        Sum minVal = PixelTraits<T>::maxValue, maxVal = 0;
+        for (size_t i = 0; i < samples; ++i) {
+            Sum mean = total->sums[i] / folded;
+            outData[i] = storeSample<U, T>(mean);
+            minVal = std::min(minVal, mean);
+            maxVal = std::max(maxVal, mean);
+        }
+        std::cout << "[MeanIP] Raw range: min=" << minVal << ", max=" << maxVal << "\n";
+    }
+    else if constexpr (std::is_same_v<U, T>) {
+        std::memcpy(outData, total->extreme.data(), sizeof(T) * samples);
+    }
+    else {
+        storeExtreme<U, T>(outData, total->extreme.data(), samples);
+    }
+    return result;
+}
+
+template <typename T>
+BasicImage<T> Projection::streamProjection(const SliceSeries& series, ProjectionMode mode, int zMin, int zMax) {
+    return normalized(streamCore<T, T>(series, mode, zMin - 1, zMax - 1));
+}
+
+template <typename T>
+BasicImage<float> Projection::streamRawProjection(const SliceSeries& series, ProjectionMode mode, int zMin, int zMax) {
+    return streamCore<float, T>(series, mode, zMin - 1, zMax - 1);
+}
+
+// ----------------------------------------------------------------------------
+// Compressed-volume projections
+// ----------------------------------------------------------------------------
+
+/*
+ * Projects a run-length encoded volume. Each band of rows keeps its own extreme or sum rows
+ * and walks z in order, decoding one row at a time, so sums are added in the same order as
+ * meanCore and the results match the uncompressed cores exactly.
+ */
+template <typename U, typename T>
+static BasicImage<U> compressedCore(const BasicCompressedVolume<T>& vol, ProjectionMode mode, int zMin, int zMax) {
+    PROFILE_SCOPE_CAT("Projection::compressed", "volume");
+    const char* tag = mode == ProjectionMode::MIP ? "[MIP]" : mode == ProjectionMode::MinIP ? "[MinIP]" : "[MeanIP]";
+    const int w = vol.getWidth();
+    const int h = vol.getHeight();
+    const int ch = vol.getChannels();
+    if (!clampRange(tag, vol.getDepth(), zMin, zMax)) {
+        return BasicImage<U>();
+    }
+
+    const size_t rowLength = static_cast<size_t>(w) * ch;
+    U* outData = (U*)std::malloc(sizeof(U) * rowLength * h);
+    if (!outData) {
+        std::cerr << tag << " Failed to allocate memory.\n";
+        return BasicImage<U>();
+    }
+    BasicImage<U> result(w, h, ch, outData);
+    using Sum = std::conditional_t<std::is_same_v<T, unsigned char>, float, double>;
+    const int count = zMax - zMin + 1;
+    std::vector<Sum> bandMin(h, PixelTraits<T>::maxValue), bandMax(h, 0);
+
+    parallelRowBands(h, rowLength * sizeof(Sum), 0, [&](const RowBand& band) {
+        const size_t bandSamples = rowLength * (band.y1 - band.y0);
+        std::vector<T> row(rowLength);
+        std::vector<T> extreme;
+        std::vector<Sum> sums;
+        if (mode == ProjectionMode::Mean) {
+            sums.assign(bandSamples, Sum(0));
+        } else {
+            extreme.resize(bandSamples);
+            for (int y = band.y0; y < band.y1; ++y) vol.decompressRow(y, zMin, &extreme[(y - band.y0) * rowLength]);
+        }
+        for (int z = mode == ProjectionMode::Mean ? zMin : zMin + 1; z <= zMax; ++z) {
+            for (int y = band.y0; y < band.y1; ++y) {
+                vol.decompressRow(y, z, row.data());
+                const size_t offset = (y - band.y0) * rowLength;
+                if (mode == ProjectionMode::Mean) {
+                    for (size_t i = 0; i < rowLength; ++i) sums[offset + i] += row[i];
+                }
+                else if (mode == ProjectionMode::MIP) {
+                    for (size_t i = 0; i < rowLength; ++i) extreme[offset + i] = std::max(extreme[offset + i], row[i]);
+                }
+                else {
+                    for (size_t i = 0; i < rowLength; ++i) extreme[offset + i] = std::min(extreme[offset + i], row[i]);
+                }
+            }
+        }
+        U* out = outData + band.y0 * rowLength;
+        if (mode == ProjectionMode::Mean) {
+            for (size_t i = 0; i < bandSamples; ++i) {
+                const Sum mean = sums[i] / count;
+                out[i] = storeSample<U, T>(mean);
+                bandMin[band.y0] = std::min(bandMin[band.y0], mean);
+                bandMax[band.y0] = std::max(bandMax[band.y0], mean);
+            }
+        }
+        else if constexpr (std::is_same_v<U, T>) {
+            std::memcpy(out, extreme.data(), sizeof(T) * bandSamples);
+        }
+        else {
+            storeExtreme<U, T>(out, extreme.data(), bandSamples);
+        }
+    });
+    if (mode == ProjectionMode::Mean) {
+        std::cout << "[MeanIP] Raw range: min=" << *std::min_element(bandMin.begin(), bandMin.end())
+                  << ", max=" << *std::max_element(bandMax.begin(), bandMax.end()) << "\n";
+    }
+    return result;
+}
+
+template <typename T>
+BasicImage<float> Projection::rawProjection(const BasicCompressedVolume<T>& vol, ProjectionMode mode, int zMin, int zMax) {
+    return compressedCore<float, T>(vol, mode, zMin - 1, zMax - 1);
+}
+
+// One instantiation of every projection per supported voxel type.
+#define INSTANTIATE_PROJECTIONS(T)                                                                               \
+    template BasicImage<T> Projection::maximumIntensityProjection(const BasicVolume<T>&);                        \
+    template BasicImage<T> Projection::minimumIntensityProjection(const BasicVolume<T>&);                        \
+    template BasicImage<T> Projection::meanIntensityProjection(const BasicVolume<T>&);                           \
+    template BasicImage<T> Projection::medianIntensityProjection(const BasicVolume<T>&);                         \
+    template BasicImage<T> Projection::maximumIntensityProjection(const BasicVolume<T>&, int, int);              \
+    template BasicImage<T> Projection::minimumIntensityProjection(const BasicVolume<T>&, int, int);              \
+    template BasicImage<T> Projection::meanIntensityProjection(const BasicVolume<T>&, int, int);                 \
+    template BasicImage<T> Projection::medianIntensityProjection(const BasicVolume<T>&, int, int);               \
+    template BasicImage<T> Projection::streamProjection<T>(const SliceSeries&, ProjectionMode, int, int);        \
+    template BasicImage<float> Projection::rawProjection(const BasicVolume<T>&, ProjectionMode, int, int);       \
+    template BasicImage<float> Projection::rawMedianProjection(const BasicVolume<T>&, int, int);                 \
+    template BasicImage<float> Projection::streamRawProjection<T>(const SliceSeries&, ProjectionMode, int, int); \
+    template BasicImage<float> Projection::rawProjection(const BasicCompressedVolume<T>&, ProjectionMode, int, int);
+
+INSTANTIATE_PROJECTIONS(unsigned char)
+INSTANTIATE_PROJECTIONS(std::uint16_t)
+INSTANTIATE_PROJECTIONS(float)
+#undef INSTANTIATE_PROJECTIONS
+
+// ----------------------------------------------------------------------------
+// Sliding-slab projections
+// ----------------------------------------------------------------------------
+
+/*
+ * Sliding maximum/minimum along z for one image row, using van Herk/Gil-Werman.
+ * The z axis is cut into blocks of `t` slices. For every block we keep the suffix extreme
+ * (from each slice to the end of the block), then sweep the next block with a running prefix
+ * extreme. The window starting at slice k then covers the suffix of its own block plus the
+ * prefix of the next one, so each output costs one comparison.
+ */
+template <typename Pick>
+static void slidingExtremeRow(const Volume& vol, Volume& out, int y, int t, Pick pick) {
+    const int d = vol.getDepth();
+    const size_t rowLen = static_cast<size_t>(vol.getWidth()) * vol.getChannels();
+    const size_t rowOffset = y * rowLen;
+    const int frames = d - t + 1;
+
+    std::vector<unsigned char> suffix(t * rowLen);
+    std::vector<unsigned char> prefix(rowLen);
+    auto row = [&](int z) { return vol.getSlices()[z].getData() + rowOffset; };
+    auto outRow = [&](int z) { return out.getSlices()[z].getData() + rowOffset; };
+
+    for (int start = 0; start < frames; start += t) {
+        const int blockEnd = std::min(start + t, d); // exclusive
+        // Suffix extremes of the current block.
+        std::memcpy(&suffix[(blockEnd - 1 - start) * rowLen], row(blockEnd - 1), rowLen);
+        for (int z = blockEnd - 2; z >= start; --z) {
+            const unsigned char* src = row(z);
+            const unsigned char* next = &suffix[(z + 1 - start) * rowLen];
+            unsigned char* dst = &suffix[(z - start) * rowLen];
+            for (size_t i = 0; i < rowLen; ++i) dst[i] = pick(src[i], next[i]);
+        }
+        // The window at `start` is exactly this block.
+        std::memcpy(outRow(start), &suffix[0], rowLen);
+
+        // Remaining windows combine this block's suffix with the next block's prefix.
+        for (int j = 1; j < t && start + j < frames; ++j) {
+            const unsigned char* src = row(start + t + j - 1);
+            if (j == 1) {
+                std::memcpy(prefix.data(), src, rowLen);
+            } else {
+                for (size_t i = 0; i < rowLen; ++i) prefix[i] = pick(prefix[i], src[i]);
+            }
+            const unsigned char* suf = &suffix[j * rowLen];
+            unsigned char* dst = outRow(start + j);
+            for (size_t i = 0; i < rowLen; ++i) dst[i] = pick(suf[i], prefix[i]);
+        }
+    }
+}
+
+// Running-sum mean along z for one image row: add the slice entering the slab, drop the one leaving.
+static void slidingMeanRow(const Volume& vol, Volume& out, int y, int t) {
+    const int d = vol.getDepth();
+    const size_t rowLen = static_cast<size_t>(vol.getWidth()) * vol.getChannels();
+    const size_t rowOffset = y * rowLen;
+    auto row = [&](int z) { return vol.getSlices()[z].getData() + rowOffset; };
+    auto outRow = [&](int z) { return out.getSlices()[z].getData() + rowOffset; };
+
+    std::vector<uint32_t> sums(rowLen, 0);
+    for (int z = 0; z < t; ++z) {
+        const unsigned char* src = row(z);
+        for (size_t i = 0; i < rowLen; ++i) sums[i] += src[i];
+    }
+    for (int k = 0; k + t <= d; ++k) {
+        if (k > 0) {
+            const unsigned char* leaving = row(k - 1);
+            const unsigned char* entering = row(k + t - 1);
+            for (size_t i = 0; i < rowLen; ++i) sums[i] += entering[i] - leaving[i];
+        }
+        unsigned char* dst = outRow(k);
+        for (size_t i = 0; i < rowLen; ++i) dst[i] = clamp255(static_cast<float>(sums[i]) / t);
+    }
+}
+
+Volume Projection::slabStack(const Volume& vol, ProjectionMode mode, int thickness) {
+    PROFILE_SCOPE_CAT("Projection::slabStack", "volume");
+    const int w = vol.getWidth();
+    const int h = vol.getHeight();
+    const int d = vol.getDepth();
+    const int ch = vol.getChannels();
+    if (w == 0 || h == 0 || d == 0) {
+        std::cerr << "[Slab] Volume is empty.\n";
+        return Volume();
+    }
+    const int t = std::clamp(thickness, 1, d);
+    const int frames = d - t + 1;
+    Volume out(w, h, frames, ch);
+
+    // Rows are independent, so each thread sweeps the whole z range for its own rows.
+    parallelFor(0, h, [&](int y) {
+        switch (mode) {
+        case ProjectionMode::MIP:
+            slidingExtremeRow(vol, out, y, t, [](unsigned char a, unsigned char b) { return std::max(a, b); });
+            break;
+        case ProjectionMode::MinIP:
+            slidingExtremeRow(vol, out, y, t, [](unsigned char a, unsigned char b) { return std::min(a, b); });
+            break;
+        case ProjectionMode::Mean:
+            slidingMeanRow(vol, out, y, t);
+            break;
+        }
+    });
+
+    // One min/max normalisation for the whole stack.
+    const size_t sliceSize = static_cast<size_t>(w) * h * ch;
+    unsigned char minVal = 255, maxVal = 0;
+    for (int k = 0; k < frames; ++k) {
+        const unsigned char* data = out.getSlices()[k].getData();
+        for (size_t i = 0; i < sliceSize; ++i) {
+            minVal = std::min(minVal, data[i]);
+            maxVal = std::max(maxVal, data[i]);
+        }
+    }
+    if (maxVal > minVal) {
+        const float scale = 255.0f / (maxVal - minVal);
+        parallelFor(0, frames, [&](int k) {
+            unsigned char* data = out.getSlices()[k].getData();
+            for (size_t i = 0; i < sliceSize; ++i) {
+                data[i] = clamp255((data[i] - minVal) * scale);
+            }
+        });
+    }
+    std::cout << "[Slab] " << frames << " slabs of " << t << " slice(s)\n";
+    return out;
+}
+
+// ----------------------------------------------------------------------------
+// ProjectionAccumulator
+// ----------------------------------------------------------------------------
+
+ProjectionAccumulator::ProjectionAccumulator(ProjectionMode mode)
+    : mode_(mode)
+{
+}
+
+bool ProjectionAccumulator::setSlice(int z, Image&& slice) {
+    if (z < 0 || !slice.getData()) {
+        std::cerr << "[ProjectionAccumulator] Invalid slice " << z << "\n";
+        return false;
+    }
+    if (count_ == 0) {
+        // The first slice fixes the projection geometry.
+        width_ = slice.getWidth();
+        height_ = slice.getHeight();
+        channels_ = slice.getChannels();
+        const size_t total = static_cast<size_t>(width_) * height_ * channels_;
+        extreme_.assign(total, 0);
+        if (mode_ == ProjectionMode::Mean) {
+            sums_.assign(total, 0);
+        } else {
+            counts_.assign(total * 256, 0);
+        }
+    }
+    else if (slice.getWidth() != width_ || slice.getHeight() != height_ ||
+             slice.getChannels() != channels_) {
+        std::cerr << "[ProjectionAccumulator] Slice " << z
+                  << " does not match the projection dimensions/channels.\n";
+        return false;
+    }
+
+    if (z >= static_cast<int>(slices_.size())) {
+        slices_.resize(z + 1);
+    }
+    if (slices_[z].getData()) {
+        foldReplacement(slices_[z].getData(), slice.getData());
+    } else {
+        if (count_ == std::numeric_limits<uint16_t>::max()) {
+            std::cerr << "[ProjectionAccumulator] At most " << count_ << " slices are supported.\n";
+            return false;
+        }
+        foldNew(slice.getData());
+        count_++;
+    }
+    slices_[z] = std::move(slice);
+    return true;
+}
+
+void ProjectionAccumulator::foldNew(const unsigned char* data) {
+    const size_t total = extreme_.size();
+    if (mode_ == ProjectionMode::Mean) {
+        for (size_t i = 0; i < total; ++i) {
+            sums_[i] += data[i];
+        }
+        return;
+    }
+    const bool isMax = (mode_ == ProjectionMode::MIP);
+    const bool first = (count_ == 0);
+    for (size_t i = 0; i < total; ++i) {
+        const unsigned char v = data[i];
+        counts_[i * 256 + v]++;
+        if (first || (isMax ? v > extreme_[i] : v < extreme_[i])) {
+            extreme_[i] = v;
+        }
+    }
+}
+
+void ProjectionAccumulator::foldReplacement(const unsigned char* oldData, const unsigned char* newData) {
+    const size_t total = extreme_.size();
+    if (mode_ == ProjectionMode::Mean) {
+        for (size_t i = 0; i < total; ++i) {
+            sums_[i] += newData[i];
+            sums_[i] -= oldData[i];
+        }
+        return;
+    }
+    const bool isMax = (mode_ == ProjectionMode::MIP);
+    for (size_t i = 0; i < total; ++i) {
+        const unsigned char oldV = oldData[i];
+        const unsigned char newV = newData[i];
+        if (oldV == newV) continue;
+        uint16_t* counts = &counts_[i * 256];
+        counts[oldV]--;
+        counts[newV]++;
+        if (isMax ? newV > extreme_[i] : newV < extreme_[i]) {
+            extreme_[i] = newV;
+        }
+        else if (oldV == extreme_[i] && counts[oldV] == 0) {
+            // The only slice at the extreme got weaker: step towards newV to the next value still held.
+            int v = oldV;
+            while (counts[v] == 0) v += isMax ? -1 : 1;
+            extreme_[i] = static_cast<unsigned char>(v);
+        }
+    }
+}
+
+int ProjectionAccumulator::sync(const std::string& directoryWithBasename) {
+    std::vector<std::string> files = Volume::listSliceFiles(directoryWithBasename);
+    int updated = 0;
+    for (int z = 0; z < static_cast<int>(files.size()); ++z) {
+        std::error_code ec;
+        auto stamp = std::filesystem::last_write_time(files[z], ec);
+        if (ec) continue;
+        if (z < static_cast<int>(stamps_.size()) && z < static_cast<int>(slices_.size()) &&
+            slices_[z].getData() && stamps_[z] == stamp) {
+            continue; // unchanged since the last sync
+        }
+        Image slice;
+        slice.setVerbose(false);
+        if (!slice.load(files[z], 0)) continue;
+        if (setSlice(z, std::move(slice))) {
+            if (z >= static_cast<int>(stamps_.size())) {
+                stamps_.resize(z + 1);
+            }
+            stamps_[z] = stamp;
+            updated++;
+        }
+    }
+    return updated;
+}
+
+Image ProjectionAccumulator::result() const {
+    if (count_ == 0) {
+        std::cerr << "[ProjectionAccumulator] No slices have been added.\n";
+        return Image();
+    }
+    const size_t total = extreme_.size();
+    unsigned char* outData = (unsigned char*)std::malloc(total);
+    if (!outData) {
+        std::cerr << "[ProjectionAccumulator] Failed to allocate memory.\n";
+        return Image();
+    }
+    Image result(width_, height_, channels_, outData);
+    if (mode_ == ProjectionMode::Mean) {
+        for (size_t i = 0; i < total; ++i) {
+            outData[i] = clamp255(static_cast<float>(sums_[i]) / count_);
+        }
+    } else {
+        std::memcpy(outData, extreme_.data(), total);
+    }
+    normalizeImage(result);
+    return result;
 }
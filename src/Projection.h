@@ -1,7 +1,56 @@
 #ifndef PROJECTION_H
 #define PROJECTION_H
 
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "CompressedVolume.h"
 #include "Volume.h"
+
+/**
+ * @brief Projections that can be maintained incrementally, one slice at a time.
+ */
+enum class ProjectionMode {
+    MIP,   ///< Maximum intensity projection.
+    MinIP, ///< Minimum intensity projection.
+    Mean   ///< Mean (average) intensity projection.
+};
+/**
+ * @struct SliceSeries
+ * @brief The slice files of a volume on disk, checked from their headers but not decoded.
+ *
+ * Used to project a volume without loading it: Projection::streamProjection decodes the
+ * slices itself, a few at a time.
+ */
+struct SliceSeries {
+    std::vector<std::string> files;       ///< Slice files in slice order.
+    int width = 0;                        ///< Width of every slice.
+    int height = 0;                       ///< Height of every slice.
+    int channels = 0;                     ///< Channels projected (1 if grey slices are collapsed).
+    int sourceChannels = 0;               ///< Channels of the files.
+    ChannelMode mode = ChannelMode::Keep; ///< How the series was opened.
+
+    /**
+     * @brief Lists the slices that Volume::load would read and checks their headers.
+     *
+     * Files whose header cannot be read, or whose size or channel count differ from the
+     * first readable file, are skipped with the same messages as Volume::load. Multi-channel
+     * slices are collapsed to one channel like Volume::load does for the same mode.
+     *
+     * @param directoryWithBasename Directory path followed by the slice basename.
+     * @param mode How multi-channel slices are treated.
+     * @return True if at least one slice was found.
+     */
+    bool open(const std::string& directoryWithBasename, ChannelMode mode = ChannelMode::Keep);
+
+    /**
+     * @brief Gets the number of slices in the series.
+     * @return The slice count.
+     */
+    int getDepth() const { return static_cast<int>(files.size()); }
+};
+
 // doxygen comments formatted with ChatGPT
 /**
  * @class Projection
@@ -10,6 +59,9 @@
  * This class offers multiple projection techniques such as maximum, minimum,
  * mean, and median intensity projections. Overloaded versions allow for
  * specifying a custom Z-range for focused projections.
+ *
+ * The projections are templated on the voxel type and instantiated for Volume, Volume16
+ * and VolumeF; results are normalised to the full range of that type.
  */
 class Projection {
 public:
@@ -18,28 +70,32 @@ public:
      * @param vol The input 3D volume data.
      * @return A 2D image representing the maximum intensity projection.
      */
-    static Image maximumIntensityProjection(const Volume& vol);
+    template <typename T>
+    static BasicImage<T> maximumIntensityProjection(const BasicVolume<T>& vol);
 
     /**
      * @brief Generates a Minimum Intensity Projection (MinIP) from the entire volume.
      * @param vol The input 3D volume data.
      * @return A 2D image representing the minimum intensity projection.
      */
-    static Image minimumIntensityProjection(const Volume& vol);
+    template <typename T>
+    static BasicImage<T> minimumIntensityProjection(const BasicVolume<T>& vol);
 
     /**
      * @brief Generates a Mean Intensity Projection from the entire volume.
      * @param vol The input 3D volume data.
      * @return A 2D image representing the mean intensity projection.
      */
-    static Image meanIntensityProjection(const Volume& vol);
+    template <typename T>
+    static BasicImage<T> meanIntensityProjection(const BasicVolume<T>& vol);
 
     /**
      * @brief Generates a Median Intensity Projection from the entire volume.
      * @param vol The input 3D volume data.
      * @return A 2D image representing the median intensity projection.
      */
-    static Image medianIntensityProjection(const Volume& vol);
+    template <typename T>
+    static BasicImage<T> medianIntensityProjection(const BasicVolume<T>& vol);
 
     // -----------------------------------------------------------------------
     // Overloaded versions for specified Z-range
@@ -52,7 +108,8 @@ public:
      * @param zMax The maximum Z index (inclusive).
      * @return A 2D image representing the maximum intensity projection for the given range.
      */
-    static Image maximumIntensityProjection(const Volume& vol, int zMin, int zMax);
+    template <typename T>
+    static BasicImage<T> maximumIntensityProjection(const BasicVolume<T>& vol, int zMin, int zMax);
 
     /**
      * @brief Generates a Minimum Intensity Projection (MinIP) within a specified Z-range.
@@ -61,7 +118,8 @@ public:
      * @param zMax The maximum Z index (inclusive).
      * @return A 2D image representing the minimum intensity projection for the given range.
      */
-    static Image minimumIntensityProjection(const Volume& vol, int zMin, int zMax);
+    template <typename T>
+    static BasicImage<T> minimumIntensityProjection(const BasicVolume<T>& vol, int zMin, int zMax);
 
     /**
      * @brief Generates a Mean Intensity Projection within a specified Z-range.
@@ -70,7 +128,8 @@ public:
      * @param zMax The maximum Z index (inclusive).
      * @return A 2D image representing the mean intensity projection for the given range.
      */
-    static Image meanIntensityProjection(const Volume& vol, int zMin, int zMax);
+    template <typename T>
+    static BasicImage<T> meanIntensityProjection(const BasicVolume<T>& vol, int zMin, int zMax);
 
     /**
      * @brief Generates a Median Intensity Projection within a specified Z-range.
@@ -79,7 +138,173 @@ public:
      * @param zMax The maximum Z index (inclusive).
      * @return A 2D image representing the median intensity projection for the given range.
      */
-    static Image medianIntensityProjection(const Volume& vol, int zMin, int zMax);
+    template <typename T>
+    static BasicImage<T> medianIntensityProjection(const BasicVolume<T>& vol, int zMin, int zMax);
+
+    /**
+     * @brief Projects slices [zMin, zMax] of a series on disk without loading the volume.
+     *
+     * Each thread takes a contiguous run of slices, decodes them one at a time into its
+     * own slice buffer and folds them into its own running extreme or sum, so memory is
+     * O(w*h*threads) rather than O(w*h*d). The partial results are combined in slice
+     * order; the result matches the Volume overloads exactly for 8- and 16-bit data.
+     * Slices that fail to decode are reported and left out.
+     *
+     * @param series The slice files to project.
+     * @param mode MIP, MinIP or Mean.
+     * @param zMin The minimum Z index (inclusive).
+     * @param zMax The maximum Z index (inclusive).
+     * @return The normalised projection, or an empty image if no slice could be used.
+     */
+    template <typename T>
+    static BasicImage<T> streamProjection(const SliceSeries& series, ProjectionMode mode, int zMin, int zMax);
+
+    // -----------------------------------------------------------------------
+    // Raw projections for the output stage (see OutputMapping.h)
+    // -----------------------------------------------------------------------
+
+    /**
+     * @brief Projects slices [zMin, zMax] without normalising or rounding the result.
+     *
+     * Values are the projected voxel values divided by the maximum of T, so they lie in
+     * [0, 1] for every voxel type; the mean keeps its fractional part. mapToImage then
+     * maps and quantises the result in a single pass.
+     *
+     * @param vol The input 3D volume data.
+     * @param mode MIP, MinIP or Mean.
+     * @param zMin The minimum Z index (inclusive).
+     * @param zMax The maximum Z index (inclusive).
+     * @return The raw projection, or an empty image for an empty range.
+     */
+    template <typename T>
+    static BasicImage<float> rawProjection(const BasicVolume<T>& vol, ProjectionMode mode, int zMin, int zMax);
+
+    /**
+     * @brief Median counterpart of rawProjection.
+     * @param vol The input 3D volume data.
+     * @param zMin The minimum Z index (inclusive).
+     * @param zMax The maximum Z index (inclusive).
+     * @return The raw median projection, or an empty image for an empty range.
+     */
+    template <typename T>
+    static BasicImage<float> rawMedianProjection(const BasicVolume<T>& vol, int zMin, int zMax);
+
+    /**
+     * @brief Streaming counterpart of rawProjection; see streamProjection.
+     * @param series The slice files to project.
+     * @param mode MIP, MinIP or Mean.
+     * @param zMin The minimum Z index (inclusive).
+     * @param zMax The maximum Z index (inclusive).
+     * @return The raw projection, or an empty image if no slice could be used.
+     */
+    template <typename T>
+    static BasicImage<float> streamRawProjection(const SliceSeries& series, ProjectionMode mode, int zMin, int zMax);
+
+    /**
+     * @brief Compressed-volume counterpart of rawProjection.
+     *
+     * The rows are cut into cache-sized bands; each band decodes its rows of one slice at a
+     * time into a row buffer and folds them into its running extreme or sum, so no slice is
+     * ever decoded in full. The result matches rawProjection on the uncompressed volume.
+     *
+     * @param vol The compressed volume.
+     * @param mode MIP, MinIP or Mean.
+     * @param zMin The minimum Z index (inclusive).
+     * @param zMax The maximum Z index (inclusive).
+     * @return The raw projection, or an empty image for an empty range.
+     */
+    template <typename T>
+    static BasicImage<float> rawProjection(const BasicCompressedVolume<T>& vol, ProjectionMode mode, int zMin, int zMax);
+
+    // -----------------------------------------------------------------------
+    // Sliding-slab (thick-slab) projections
+    // -----------------------------------------------------------------------
+
+    /**
+     * @brief Projects every slab of `thickness` consecutive slices.
+     *
+     * Frame k of the result is the projection over slices [k, k + thickness - 1] (0-based),
+     * so the result has depth - thickness + 1 frames. The whole stack costs O(w*h*d):
+     * the mean uses a running sum, and MIP/MinIP use the van Herk/Gil-Werman sliding
+     * extreme (about three comparisons per voxel, whatever the thickness).
+     * All frames share one min/max normalisation, so brightness is stable across a movie.
+     *
+     * @param vol The input 3D volume data.
+     * @param mode The projection applied to each slab.
+     * @param thickness Number of slices per slab (clamped to [1, depth]).
+     * @return A volume whose slices are the slab projections.
+     */
+    static Volume slabStack(const Volume& vol, ProjectionMode mode, int thickness);
+};
+
+/**
+ * @class ProjectionAccumulator
+ * @brief Keeps a MIP, MinIP or mean projection up to date while slices are added or replaced.
+ *
+ * Each update, append or replacement, costs O(w*h): the mean keeps running sums, and
+ * MIP/MinIP keep the running extreme together with how many slices hold each of the 256
+ * values at every sample. When a replacement weakens the only slice at the extreme, the new
+ * extreme is the next value with a non-zero count, found without reading the other slices.
+ * The accumulator owns the slices it has been given (replacements need the old values), so
+ * its memory is the equivalent Volume plus 512 bytes per sample for MIP/MinIP. At most
+ * 65535 slices are supported.
+ */
+class ProjectionAccumulator {
+public:
+    /**
+     * @brief Creates an empty accumulator for the given projection.
+     * @param mode The projection to maintain.
+     */
+    explicit ProjectionAccumulator(ProjectionMode mode);
+
+    /**
+     * @brief Adds slice z, or replaces it if it is already present.
+     *
+     * All slices must share the dimensions and channel count of the first one.
+     *
+     * @param z 0-based slice index.
+     * @param slice Slice data; ownership moves into the accumulator.
+     * @return True if the slice was accepted, false on a size mismatch or empty slice.
+     */
+    bool setSlice(int z, Image&& slice);
+
+    /**
+     * @brief Loads any new or modified slice files from a scan directory.
+     *
+     * Files are matched like Volume::load. Files whose modification time has not changed
+     * since the previous call are skipped, so polling a growing acquisition is cheap.
+     *
+     * @param directoryWithBasename Directory path followed by the slice basename.
+     * @return The number of slices that were added or replaced.
+     */
+    int sync(const std::string& directoryWithBasename);
+
+    /**
+     * @brief Gets the number of slices currently folded into the projection.
+     * @return The slice count.
+     */
+    int getSliceCount() const { return count_; }
+
+    /**
+     * @brief Produces the current projection, normalised like the Projection functions.
+     * @return A 2D image, or an empty image if no slice has been added.
+     */
+    Image result() const;
+
+private:
+    void foldNew(const unsigned char* data);
+    void foldReplacement(const unsigned char* oldData, const unsigned char* newData);
+
+    ProjectionMode mode_;
+    int width_ = 0;
+    int height_ = 0;
+    int channels_ = 0;
+    int count_ = 0;
+    std::vector<Image> slices_;          ///< Slices indexed by z; empty where none was given.
+    std::vector<unsigned char> extreme_; ///< Running max (MIP) or min (MinIP).
+    std::vector<uint16_t> counts_;       ///< Slices holding each value, 256 per sample (MIP/MinIP).
+    std::vector<uint32_t> sums_;         ///< Running sums (Mean).
+    std::vector<std::filesystem::file_time_type> stamps_; ///< File times seen by sync().
 };
 
 #endif // PROJECTION_H
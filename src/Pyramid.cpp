@@ -0,0 +1,226 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the Pyramid class, which produces 2x-downsampled copies of images and
+ * volumes for quick preview runs. Every reduction is separable: the data is converted to float
+ * once, each axis is low-pass filtered and decimated in turn, and the result is rounded back to
+ * 8 bits at the end. Each axis pass writes disjoint output rows, so it is split across threads.
+ */
+#include "Pyramid.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+    // Sample buffer laid out as [z][y][x][c], the same order as Volume slices.
+    struct Grid {
+        int nx = 0, ny = 0, nz = 0, ch = 0;
+        std::vector<float> data;
+    };
+
+    struct Taps {
+        int first;                 // offset of the first tap relative to 2*i
+        std::vector<float> weight; // one weight per tap
+    };
+
+    Taps tapsFor(ReduceMode mode) {
+        if (mode == ReduceMode::Gaussian) {
+            return { -2, { 1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16, 1.0f / 16 } };
+        }
+        return { 0, { 0.5f, 0.5f } };
+    }
+
+    /*
+     * Halves one axis of the grid. The data is viewed as [outer][n][inner], where n is the size
+     * of the reduced axis, so every output block of `inner` samples is a weighted sum of whole
+     * input blocks. That keeps the innermost loop contiguous for all three axes.
+     */
+    Grid reduceAxis(const Grid& in, int axis, const Taps& taps) {
+        int dims[3] = { in.nx, in.ny, in.nz };
+        const int n = dims[axis];
+        if (n <= 1) {
+            return in;
+        }
+        const int nOut = (n + 1) / 2;
+
+        size_t inner = in.ch;
+        for (int a = 0; a < axis; ++a) inner *= dims[a];
+        size_t outer = 1;
+        for (int a = axis + 1; a < 3; ++a) outer *= dims[a];
+
+        Grid out;
+        out.nx = in.nx; out.ny = in.ny; out.nz = in.nz; out.ch = in.ch;
+        (axis == 0 ? out.nx : axis == 1 ? out.ny : out.nz) = nOut;
+        out.data.assign(outer * nOut * inner, 0.0f);
+
+        const int jobs = static_cast<int>(outer) * nOut;
+        parallelFor(0, jobs, [&](int job) {
+            const size_t o = job / nOut;
+            const int i = job % nOut;
+            float* dst = out.data.data() + (o * nOut + i) * inner;
+            for (size_t t = 0; t < taps.weight.size(); ++t) {
+                const int src = std::clamp(2 * i + taps.first + static_cast<int>(t), 0, n - 1);
+                const float* row = in.data.data() + (o * n + src) * inner;
+                const float wgt = taps.weight[t];
+                for (size_t k = 0; k < inner; ++k) {
+                    dst[k] += wgt * row[k];
+                }
+            }
+        });
+        return out;
+    }
+
+    inline unsigned char toByte(float v) {
+        return static_cast<unsigned char>(std::clamp(v + 0.5f, 0.0f, 255.0f));
+    }
+
+    Image copyImage(const Image& img) {
+        Image copy;
+        copy.setVerbose(false);
+        if (img.getData()) {
+            copy.setData(img.getData(), img.getWidth(), img.getHeight(), img.getChannels());
+        }
+        return copy;
+    }
+
+    Volume copyVolume(const Volume& vol) {
+        Volume copy(vol.getWidth(), vol.getHeight(), vol.getDepth(), vol.getChannels());
+        const size_t sliceSize = static_cast<size_t>(vol.getWidth()) * vol.getHeight() * vol.getChannels();
+        for (int z = 0; z < vol.getDepth(); ++z) {
+            std::memcpy(copy.getSlices()[z].getData(), vol.getSlices()[z].getData(), sliceSize);
+        }
+        return copy;
+    }
+
+} // end anonymous namespace
+
+Image Pyramid::reduce(const Image& img, ReduceMode mode) {
+    if (!img.getData() || img.getWidth() == 0 || img.getHeight() == 0) {
+        std::cerr << "[Pyramid] Cannot reduce an empty image.\n";
+        return Image();
+    }
+
+    Grid grid;
+    grid.nx = img.getWidth();
+    grid.ny = img.getHeight();
+    grid.nz = 1;
+    grid.ch = img.getChannels();
+    const unsigned char* src = img.getData();
+    grid.data.assign(src, src + static_cast<size_t>(grid.nx) * grid.ny * grid.ch);
+
+    const Taps taps = tapsFor(mode);
+    grid = reduceAxis(grid, 0, taps);
+    grid = reduceAxis(grid, 1, taps);
+
+    const size_t total = grid.data.size();
+    auto* outData = static_cast<unsigned char*>(std::malloc(total));
+    if (!outData) {
+        std::cerr << "[Pyramid] Failed to allocate memory.\n";
+        return Image();
+    }
+    for (size_t i = 0; i < total; ++i) {
+        outData[i] = toByte(grid.data[i]);
+    }
+    Image result(grid.nx, grid.ny, grid.ch, outData);
+    result.setVerbose(false);
+    return result;
+}
+
+Volume Pyramid::reduce(const Volume& vol, ReduceMode mode) {
+    const int w = vol.getWidth();
+    const int h = vol.getHeight();
+    const int d = vol.getDepth();
+    const int ch = vol.getChannels();
+    if (w == 0 || h == 0 || d == 0) {
+        std::cerr << "[Pyramid] Cannot reduce an empty volume.\n";
+        return Volume();
+    }
+
+    Grid grid;
+    grid.nx = w; grid.ny = h; grid.nz = d; grid.ch = ch;
+    const size_t sliceSize = static_cast<size_t>(w) * h * ch;
+    grid.data.resize(sliceSize * d);
+    parallelFor(0, d, [&](int z) {
+        const unsigned char* src = vol.getSlices()[z].getData();
+        std::copy(src, src + sliceSize, grid.data.begin() + z * sliceSize);
+    });
+
+    const Taps taps = tapsFor(mode);
+    grid = reduceAxis(grid, 0, taps);
+    grid = reduceAxis(grid, 1, taps);
+    grid = reduceAxis(grid, 2, taps);
+
+    Volume result(grid.nx, grid.ny, grid.nz, grid.ch);
+    const size_t outSliceSize = static_cast<size_t>(grid.nx) * grid.ny * grid.ch;
+    parallelFor(0, grid.nz, [&](int z) {
+        unsigned char* dst = result.getSlices()[z].getData();
+        const float* src = grid.data.data() + z * outSliceSize;
+        for (size_t i = 0; i < outSliceSize; ++i) {
+            dst[i] = toByte(src[i]);
+        }
+    });
+    return result;
+}
+
+Image Pyramid::atLevel(const Image& img, int level, ReduceMode mode) {
+    PROFILE_SCOPE_CAT("Pyramid::atLevel", "stage");
+    if (level <= 0) {
+        return copyImage(img);
+    }
+    Image current = reduce(img, mode);
+    for (int l = 1; l < level; ++l) {
+        current = reduce(current, mode);
+    }
+    return current;
+}
+
+Volume Pyramid::atLevel(const Volume& vol, int level, ReduceMode mode) {
+    PROFILE_SCOPE_CAT("Pyramid::atLevel", "stage");
+    if (level <= 0) {
+        return copyVolume(vol);
+    }
+    Volume current = reduce(vol, mode);
+    for (int l = 1; l < level; ++l) {
+        current = reduce(current, mode);
+    }
+    return current;
+}
+
+std::vector<Image> Pyramid::build(const Image& img, int levels, ReduceMode mode) {
+    std::vector<Image> pyramid;
+    if (levels <= 0) return pyramid;
+    pyramid.push_back(copyImage(img));
+    while (static_cast<int>(pyramid.size()) < levels) {
+        const Image& last = pyramid.back();
+        if (last.getWidth() <= 1 && last.getHeight() <= 1) break;
+        pyramid.push_back(reduce(last, mode));
+    }
+    return pyramid;
+}
+
+std::vector<Volume> Pyramid::build(const Volume& vol, int levels, ReduceMode mode) {
+    std::vector<Volume> pyramid;
+    if (levels <= 0) return pyramid;
+    pyramid.push_back(copyVolume(vol));
+    while (static_cast<int>(pyramid.size()) < levels) {
+        const Volume& last = pyramid.back();
+        if (last.getWidth() <= 1 && last.getHeight() <= 1 && last.getDepth() <= 1) break;
+        pyramid.push_back(reduce(last, mode));
+    }
+    return pyramid;
+}
@@ -0,0 +1,85 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include <vector>
+#include "Image.h"
+#include "Volume.h"
+
+/**
+ * @brief Low-pass filter applied before each 2x decimation step.
+ */
+enum class ReduceMode {
+    Box,      ///< Average of each 2x2 (or 2x2x2) block.
+    Gaussian  ///< 5-tap binomial [1 4 6 4 1]/16 kernel, as in a Burt-Adelson pyramid.
+};
+
+/**
+ * @class Pyramid
+ * @brief Builds multi-resolution pyramids of images and volumes.
+ *
+ * Each level halves every spatial dimension (rounding up), so level n of a volume
+ * holds roughly 1/8^n of the voxels. The returned images and volumes are ordinary
+ * objects, so Projection, Slice and the 2D filters can run on any level unchanged.
+ */
+class Pyramid {
+public:
+    /**
+     * @brief Downsamples an image by a factor of two in x and y.
+     * @param img The input image.
+     * @param mode The low-pass filter to apply before decimation.
+     * @return The reduced image (empty if the input is empty).
+     */
+    static Image reduce(const Image& img, ReduceMode mode = ReduceMode::Box);
+
+    /**
+     * @brief Downsamples a volume by a factor of two in x, y and z.
+     * @param vol The input volume.
+     * @param mode The low-pass filter to apply before decimation.
+     * @return The reduced volume (empty if the input is empty).
+     */
+    static Volume reduce(const Volume& vol, ReduceMode mode = ReduceMode::Box);
+
+    /**
+     * @brief Returns the given pyramid level of an image without keeping the intermediate levels.
+     * @param img The full-resolution image (level 0).
+     * @param level Number of 2x reductions to apply (0 returns a copy).
+     * @param mode The low-pass filter used for each reduction.
+     * @return The image at the requested level.
+     */
+    static Image atLevel(const Image& img, int level, ReduceMode mode = ReduceMode::Box);
+
+    /**
+     * @brief Returns the given pyramid level of a volume without keeping the intermediate levels.
+     * @param vol The full-resolution volume (level 0).
+     * @param level Number of 2x reductions to apply (0 returns a copy).
+     * @param mode The low-pass filter used for each reduction.
+     * @return The volume at the requested level.
+     */
+    static Volume atLevel(const Volume& vol, int level, ReduceMode mode = ReduceMode::Box);
+
+    /**
+     * @brief Builds an image pyramid.
+     *
+     * Level 0 is a copy of the input. Building stops early once every dimension is 1.
+     *
+     * @param img The full-resolution image.
+     * @param levels Number of levels to produce, including level 0.
+     * @param mode The low-pass filter used for each reduction.
+     * @return The pyramid levels, finest first.
+     */
+    static std::vector<Image> build(const Image& img, int levels, ReduceMode mode = ReduceMode::Box);
+
+    /**
+     * @brief Builds a volume pyramid.
+     *
+     * Level 0 is a copy of the input. Building stops early once every dimension is 1.
+     *
+     * @param vol The full-resolution volume.
+     * @param levels Number of levels to produce, including level 0.
+     * @param mode The low-pass filter used for each reduction.
+     * @return The pyramid levels, finest first.
+     */
+    static std::vector<Volume> build(const Volume& vol, int levels, ReduceMode mode = ReduceMode::Box);
+};
+
+#endif // PYRAMID_H
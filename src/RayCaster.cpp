@@ -0,0 +1,251 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the RayCaster class, which renders projections of a volume along any
+ * view direction. Every output pixel casts one orthographic ray through the volume box, samples
+ * it with trilinear interpolation at a fixed step, and composites the samples with the chosen
+ * rule (max, min or mean). Work is handed out in 32x32 tiles so threads stay busy even though
+ * tiles in the middle of the volume cost far more than tiles that miss it.
+ */
+#include "RayCaster.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "VolumeSampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace {
+
+    constexpr int kTileSize = 32;
+
+    struct Camera {
+        Vec3 dir;    // ray direction
+        Vec3 right;  // image x axis
+        Vec3 up;     // image y axis
+        Vec3 origin; // position of pixel (0, 0) on the image plane
+    };
+
+    Camera makeCamera(const VolumeSampler& sampler, const RenderSettings& settings, int outW, int outH) {
+        const float az = settings.azimuthDeg * static_cast<float>(M_PI) / 180.0f;
+        const float el = std::clamp(settings.elevationDeg, -89.9f, 89.9f) * static_cast<float>(M_PI) / 180.0f;
+
+        Camera cam;
+        cam.dir = Vec3{ std::sin(az) * std::cos(el), std::sin(el), std::cos(az) * std::cos(el) }.normalized();
+        cam.right = Vec3{ 0.0f, 1.0f, 0.0f }.cross(cam.dir).normalized();
+        cam.up = cam.dir.cross(cam.right);
+
+        const Vec3 centre{ (sampler.getWidth() - 1) * 0.5f,
+                           (sampler.getHeight() - 1) * 0.5f,
+                           (sampler.getDepth() - 1) * 0.5f };
+        // Start every ray outside the volume, whatever the direction.
+        const float radius = Vec3{ static_cast<float>(sampler.getWidth()),
+                                   static_cast<float>(sampler.getHeight()),
+                                   static_cast<float>(sampler.getDepth()) }.length() * 0.5f + 1.0f;
+        cam.origin = centre - cam.right * ((outW - 1) * 0.5f) - cam.up * ((outH - 1) * 0.5f) - cam.dir * radius;
+        return cam;
+    }
+
+    // Slab test against the box [0, w-1] x [0, h-1] x [0, d-1]. Returns false if the ray misses.
+    bool intersectBox(const VolumeSampler& sampler, const Vec3& o, const Vec3& dir, float& tNear, float& tFar) {
+        const float lo[3] = { 0.0f, 0.0f, 0.0f };
+        const float hi[3] = { static_cast<float>(sampler.getWidth() - 1),
+                              static_cast<float>(sampler.getHeight() - 1),
+                              static_cast<float>(sampler.getDepth() - 1) };
+        const float orig[3] = { o.x, o.y, o.z };
+        const float d[3] = { dir.x, dir.y, dir.z };
+        tNear = -std::numeric_limits<float>::max();
+        tFar = std::numeric_limits<float>::max();
+        for (int a = 0; a < 3; ++a) {
+            if (std::fabs(d[a]) < 1e-7f) {
+                if (orig[a] < lo[a] - 1e-4f || orig[a] > hi[a] + 1e-4f) return false;
+                continue;
+            }
+            float t0 = (lo[a] - orig[a]) / d[a];
+            float t1 = (hi[a] - orig[a]) / d[a];
+            if (t0 > t1) std::swap(t0, t1);
+            tNear = std::max(tNear, t0);
+            tFar = std::min(tFar, t1);
+        }
+        return tNear <= tFar + 1e-4f;
+    }
+
+    // One rendered view before quantisation, with a flag per pixel for rays that hit the volume.
+    struct RawView {
+        std::vector<float> values; // outW * outH * ch
+        std::vector<unsigned char> hit; // outW * outH
+    };
+
+    /*
+     * Renders one view into a float buffer (outW * outH * ch). Pixels whose ray misses the
+     * volume get the value an empty ray would have (255 for MinIP, 0 otherwise) and are not
+     * flagged as hits, so they do not take part in the normalisation range.
+     */
+    RawView renderRaw(const VolumeSampler& sampler, ProjectionMode mode,
+                      const RenderSettings& settings, int outW, int outH) {
+        const int ch = sampler.getChannels();
+        const float init = (mode == ProjectionMode::MinIP) ? 255.0f : 0.0f;
+        RawView out;
+        out.values.assign(static_cast<size_t>(outW) * outH * ch, init);
+        out.hit.assign(static_cast<size_t>(outW) * outH, 0);
+        const Camera cam = makeCamera(sampler, settings, outW, outH);
+        const float step = settings.stepSize > 0.0f ? settings.stepSize : 1.0f;
+
+        const int tilesX = (outW + kTileSize - 1) / kTileSize;
+        const int tilesY = (outH + kTileSize - 1) / kTileSize;
+        parallelForDynamic(0, tilesX * tilesY, [&](int tile) {
+            const int x0 = (tile % tilesX) * kTileSize;
+            const int y0 = (tile / tilesX) * kTileSize;
+            const int x1 = std::min(x0 + kTileSize, outW);
+            const int y1 = std::min(y0 + kTileSize, outH);
+            float sample[4];
+            float acc[4];
+            for (int py = y0; py < y1; ++py) {
+                for (int px = x0; px < x1; ++px) {
+                    const Vec3 o = cam.origin + cam.right * static_cast<float>(px) + cam.up * static_cast<float>(py);
+                    float tNear, tFar;
+                    if (!intersectBox(sampler, o, cam.dir, tNear, tFar)) continue;
+
+                    std::fill(acc, acc + ch, init);
+                    int count = 0;
+                    for (float t = tNear; t <= tFar + 1e-4f; t += step) {
+                        const Vec3 p = o + cam.dir * t;
+                        sampler.trilinear(p.x, p.y, p.z, sample);
+                        ++count;
+                        if (mode == ProjectionMode::Mean) {
+                            for (int c = 0; c < ch; ++c) acc[c] += sample[c];
+                            continue;
+                        }
+                        bool saturated = true;
+                        for (int c = 0; c < ch; ++c) {
+                            if (mode == ProjectionMode::MIP) {
+                                acc[c] = std::max(acc[c], sample[c]);
+                                saturated = saturated && acc[c] >= 255.0f;
+                            } else {
+                                acc[c] = std::min(acc[c], sample[c]);
+                                saturated = saturated && acc[c] <= 0.0f;
+                            }
+                        }
+                        if (saturated) break; // early exit: no later sample can change the result
+                    }
+                    if (count == 0) continue;
+                    const size_t pixel = static_cast<size_t>(py) * outW + px;
+                    float* dst = &out.values[pixel * ch];
+                    for (int c = 0; c < ch; ++c) {
+                        dst[c] = (mode == ProjectionMode::Mean) ? acc[c] / count : acc[c];
+                    }
+                    out.hit[pixel] = 1;
+                }
+            }
+        });
+        return out;
+    }
+
+    void outputSize(const Volume& vol, const RenderSettings& settings, int& outW, int& outH) {
+        const int diagonal = static_cast<int>(std::ceil(std::sqrt(
+            static_cast<double>(vol.getWidth()) * vol.getWidth() +
+            static_cast<double>(vol.getHeight()) * vol.getHeight() +
+            static_cast<double>(vol.getDepth()) * vol.getDepth())));
+        outW = settings.outWidth > 0 ? settings.outWidth : diagonal;
+        outH = settings.outHeight > 0 ? settings.outHeight : diagonal;
+    }
+
+    // Widens [minVal, maxVal] to cover every pixel of the view whose ray hit the volume.
+    void extendRange(const RawView& view, int ch, float& minVal, float& maxVal) {
+        for (size_t p = 0; p < view.hit.size(); ++p) {
+            if (!view.hit[p]) continue;
+            for (int c = 0; c < ch; ++c) {
+                minVal = std::min(minVal, view.values[p * ch + c]);
+                maxVal = std::max(maxVal, view.values[p * ch + c]);
+            }
+        }
+    }
+
+    // Maps [minVal, maxVal] to [0, 255] and writes the result into dst.
+    void quantize(const std::vector<float>& src, float minVal, float maxVal, unsigned char* dst) {
+        if (minVal > maxVal) minVal = maxVal = 0.0f; // no ray hit the volume: keep the raw values
+        const float scale = (maxVal > minVal) ? 255.0f / (maxVal - minVal) : 1.0f;
+        for (size_t i = 0; i < src.size(); ++i) {
+            const float v = (src[i] - minVal) * scale;
+            dst[i] = static_cast<unsigned char>(std::clamp(v + 0.5f, 0.0f, 255.0f));
+        }
+    }
+
+} // end anonymous namespace
+
+Image RayCaster::render(const Volume& vol, ProjectionMode mode, const RenderSettings& settings) {
+    PROFILE_SCOPE_CAT("RayCaster::render", "volume");
+    if (vol.getWidth() == 0 || vol.getHeight() == 0 || vol.getDepth() == 0) {
+        std::cerr << "[RayCaster] Volume is empty.\n";
+        return Image();
+    }
+    if (vol.getChannels() > 4) {
+        std::cerr << "[RayCaster] At most 4 channels are supported.\n";
+        return Image();
+    }
+    int outW, outH;
+    outputSize(vol, settings, outW, outH);
+
+    VolumeSampler sampler(vol);
+    RawView raw = renderRaw(sampler, mode, settings, outW, outH);
+    float minVal = std::numeric_limits<float>::max();
+    float maxVal = std::numeric_limits<float>::lowest();
+    extendRange(raw, vol.getChannels(), minVal, maxVal);
+
+    unsigned char* outData = (unsigned char*)std::malloc(raw.values.size());
+    if (!outData) {
+        std::cerr << "[RayCaster] Failed to allocate memory.\n";
+        return Image();
+    }
+    quantize(raw.values, minVal, maxVal, outData);
+    return Image(outW, outH, vol.getChannels(), outData);
+}
+
+Volume RayCaster::renderOrbit(const Volume& vol, ProjectionMode mode, int views, const RenderSettings& settings) {
+    PROFILE_SCOPE_CAT("RayCaster::renderOrbit", "volume");
+    if (vol.getWidth() == 0 || vol.getHeight() == 0 || vol.getDepth() == 0 || views <= 0) {
+        std::cerr << "[RayCaster] Volume is empty or no views were requested.\n";
+        return Volume();
+    }
+    if (vol.getChannels() > 4) {
+        std::cerr << "[RayCaster] At most 4 channels are supported.\n";
+        return Volume();
+    }
+    int outW, outH;
+    outputSize(vol, settings, outW, outH);
+
+    // Views are kept as floats until every one is rendered, then quantised once with a shared range.
+    VolumeSampler sampler(vol);
+    std::vector<RawView> raw(views);
+    float minVal = std::numeric_limits<float>::max();
+    float maxVal = std::numeric_limits<float>::lowest();
+    for (int i = 0; i < views; ++i) {
+        RenderSettings view = settings;
+        view.azimuthDeg = settings.azimuthDeg + 360.0f * i / views;
+        raw[i] = renderRaw(sampler, mode, view, outW, outH);
+        extendRange(raw[i], vol.getChannels(), minVal, maxVal);
+    }
+
+    Volume result(outW, outH, views, vol.getChannels());
+    parallelFor(0, views, [&](int i) {
+        quantize(raw[i].values, minVal, maxVal, result.getSlices()[i].getData());
+    });
+    std::cout << "[RayCaster] Rendered " << views << " views of " << outW << " x " << outH << "\n";
+    return result;
+}
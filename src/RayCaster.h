@@ -0,0 +1,58 @@
+#ifndef RAYCASTER_H
+#define RAYCASTER_H
+
+#include <vector>
+#include "Projection.h"
+#include "Volume.h"
+
+/**
+ * @brief Camera and sampling settings for RayCaster.
+ *
+ * The default view (azimuth 0, elevation 0) looks along +z, matching Projection.
+ * Azimuth rotates the view direction about the image vertical (y) axis and
+ * elevation tilts it towards y.
+ */
+struct RenderSettings {
+    float azimuthDeg   = 0.0f; ///< Rotation about the y axis, in degrees.
+    float elevationDeg = 0.0f; ///< Tilt towards the y axis, in degrees.
+    int outWidth       = 0;    ///< Output width in pixels (0 = volume diagonal).
+    int outHeight      = 0;    ///< Output height in pixels (0 = volume diagonal).
+    float stepSize     = 1.0f; ///< Distance between samples along a ray, in voxels.
+};
+
+/**
+ * @class RayCaster
+ * @brief Renders MIP, MinIP and mean projections of a Volume from arbitrary directions.
+ *
+ * Rays are orthographic, sampled with trilinear interpolation, and distributed over
+ * threads in 32x32 pixel tiles. MIP rays stop as soon as every channel reaches 255, and
+ * MinIP rays as soon as every channel reaches 0, since no later sample can change them.
+ */
+class RayCaster {
+public:
+    /**
+     * @brief Renders one view of the volume.
+     * @param vol The input 3D volume data.
+     * @param mode The compositing rule along each ray.
+     * @param settings Camera direction, output size and step size.
+     * @return The normalised projection image (empty if the volume is empty).
+     */
+    static Image render(const Volume& vol, ProjectionMode mode, const RenderSettings& settings = RenderSettings());
+
+    /**
+     * @brief Renders a full 360-degree turn around the y axis.
+     *
+     * View i uses azimuth settings.azimuthDeg + 360 * i / views. The volume is sampled in
+     * place for every view, and all views share one normalisation so the sequence does not flicker.
+     *
+     * @param vol The input 3D volume data.
+     * @param mode The compositing rule along each ray.
+     * @param views Number of views in the turn.
+     * @param settings Starting azimuth, elevation, output size and step size.
+     * @return The rendered views, as the slices of a volume.
+     */
+    static Volume renderOrbit(const Volume& vol, ProjectionMode mode, int views,
+                              const RenderSettings& settings = RenderSettings());
+};
+
+#endif // RAYCASTER_H
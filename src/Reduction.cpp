@@ -0,0 +1,202 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the per-channel min/max/sum reduction behind auto brightness and the
+ * output normalisations. Each chunk of pixels is reduced on its own and the partial results
+ * are merged in chunk order. For 8-bit data with 1-4 channels, `ch` SSE2 vectors are read per
+ * step: lane j of vector k always holds channel (16k + j) % ch, so every vector keeps its own
+ * min/max and channel-masked SAD sums, and the lanes are folded back into channels at the end.
+ */
+#include "Reduction.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define APIF_REDUCE_SSE2 1
+#endif
+
+namespace {
+
+    // Pixels per chunk; fixed so the merge order never depends on the thread count.
+    constexpr std::size_t kChunkPixels = std::size_t(1) << 16;
+
+    // Integer sums are exact in 64 bits; float sums are accumulated in double.
+    template <typename T>
+    using SumType = std::conditional_t<std::is_floating_point_v<T>, double, std::uint64_t>;
+
+    template <typename T>
+    struct Partial {
+        std::vector<T> min, max;
+        std::vector<SumType<T>> sum;
+
+        explicit Partial(int channels = 0)
+            : min(channels, std::numeric_limits<T>::max()),
+              max(channels, std::numeric_limits<T>::lowest()),
+              sum(channels, 0) {}
+    };
+
+    // Plain per-channel loop; Channels = 0 reads the channel count at run time.
+    template <int Channels, typename T>
+    void reduceScalar(const T* p, std::size_t pixels, int channels, Partial<T>& out) {
+        const int ch = Channels > 0 ? Channels : channels;
+        for (std::size_t i = 0; i < pixels; ++i) {
+            for (int c = 0; c < ch; ++c) {
+                const T v = p[i * ch + c];
+                out.min[c] = std::min(out.min[c], v);
+                out.max[c] = std::max(out.max[c], v);
+                out.sum[c] += v;
+            }
+        }
+    }
+
+#ifdef APIF_REDUCE_SSE2
+    template <int Channels>
+    void reduceBytes(const unsigned char* p, std::size_t pixels, Partial<unsigned char>& out) {
+        constexpr int ch = Channels;
+        constexpr std::size_t step = 16 * ch;
+        const std::size_t samples = pixels * ch;
+        const std::size_t vectorSamples = samples - samples % step;
+
+        __m128i vmin[ch], vmax[ch], sums[ch], masks[ch][ch];
+        for (int k = 0; k < ch; ++k) {
+            vmin[k] = _mm_set1_epi8(static_cast<char>(0xFF));
+            vmax[k] = _mm_setzero_si128();
+            sums[k] = _mm_setzero_si128();
+            for (int c = 0; c < ch; ++c) {
+                alignas(16) unsigned char lanes[16];
+                for (int j = 0; j < 16; ++j) lanes[j] = (16 * k + j) % ch == c ? 0xFF : 0;
+                masks[k][c] = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+            }
+        }
+
+        const __m128i zero = _mm_setzero_si128();
+        for (std::size_t i = 0; i < vectorSamples; i += step) {
+            for (int k = 0; k < ch; ++k) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 16 * k));
+                vmin[k] = _mm_min_epu8(vmin[k], v);
+                vmax[k] = _mm_max_epu8(vmax[k], v);
+                if constexpr (ch == 1) {
+                    sums[0] = _mm_add_epi64(sums[0], _mm_sad_epu8(v, zero));
+                } else {
+                    for (int c = 0; c < ch; ++c) {
+                        sums[c] = _mm_add_epi64(sums[c], _mm_sad_epu8(_mm_and_si128(v, masks[k][c]), zero));
+                    }
+                }
+            }
+        }
+
+        for (int k = 0; k < ch; ++k) {
+            alignas(16) unsigned char lo[16], hi[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lo), vmin[k]);
+            _mm_store_si128(reinterpret_cast<__m128i*>(hi), vmax[k]);
+            for (int j = 0; j < 16; ++j) {
+                const int c = (16 * k + j) % ch;
+                out.min[c] = std::min(out.min[c], lo[j]);
+                out.max[c] = std::max(out.max[c], hi[j]);
+            }
+            alignas(16) std::uint64_t halves[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(halves), sums[k]);
+            out.sum[k] += halves[0] + halves[1];
+        }
+
+        // The tail is a whole number of pixels, since `step` is a multiple of ch.
+        reduceScalar<Channels>(p + vectorSamples, (samples - vectorSamples) / ch, ch, out);
+    }
+#endif
+
+    template <typename T>
+    void reduceRange(const T* p, std::size_t pixels, int channels, Partial<T>& out) {
+#ifdef APIF_REDUCE_SSE2
+        if constexpr (std::is_same_v<T, unsigned char>) {
+            switch (channels) {
+            case 1: reduceBytes<1>(p, pixels, out); return;
+            case 2: reduceBytes<2>(p, pixels, out); return;
+            case 3: reduceBytes<3>(p, pixels, out); return;
+            case 4: reduceBytes<4>(p, pixels, out); return;
+            default: break;
+            }
+        }
+#endif
+        switch (channels) {
+        case 1: reduceScalar<1>(p, pixels, channels, out); return;
+        case 3: reduceScalar<3>(p, pixels, channels, out); return;
+        case 4: reduceScalar<4>(p, pixels, channels, out); return;
+        default: reduceScalar<0>(p, pixels, channels, out); return;
+        }
+    }
+
+    // Channels = 0 reads the channel count at run time.
+    template <int Channels>
+    void applyTables(unsigned char* p, std::size_t pixels, int channels, const unsigned char* tables) {
+        const int ch = Channels > 0 ? Channels : channels;
+        for (std::size_t i = 0; i < pixels; ++i, p += ch) {
+            for (int c = 0; c < ch; ++c) p[c] = tables[c * 256 + p[c]];
+        }
+    }
+
+} // end anonymous namespace
+
+void applyChannelTables(unsigned char* data, std::size_t pixels, int channels, const unsigned char* tables) {
+    switch (channels) {
+    case 1: applyTables<1>(data, pixels, channels, tables); return;
+    case 2: applyTables<2>(data, pixels, channels, tables); return;
+    case 3: applyTables<3>(data, pixels, channels, tables); return;
+    case 4: applyTables<4>(data, pixels, channels, tables); return;
+    default: applyTables<0>(data, pixels, channels, tables); return;
+    }
+}
+
+template <typename T>
+T ChannelStats<T>::overallMin() const {
+    return min.empty() ? std::numeric_limits<T>::max() : *std::min_element(min.begin(), min.end());
+}
+
+template <typename T>
+T ChannelStats<T>::overallMax() const {
+    return max.empty() ? std::numeric_limits<T>::lowest() : *std::max_element(max.begin(), max.end());
+}
+
+template <typename T>
+ChannelStats<T> reduceChannels(const T* data, std::size_t pixels, int channels) {
+    ChannelStats<T> stats;
+    channels = std::max(1, channels);
+    Partial<T> total(channels);
+    if (data && pixels > 0) {
+        std::vector<Partial<T>> partials((pixels + kChunkPixels - 1) / kChunkPixels, Partial<T>(channels));
+        parallelForChunks(pixels, kChunkPixels, [&](std::size_t first, std::size_t last) {
+            reduceRange(data + first * channels, last - first, channels, partials[first / kChunkPixels]);
+        });
+        for (const Partial<T>& part : partials) {
+            for (int c = 0; c < channels; ++c) {
+                total.min[c] = std::min(total.min[c], part.min[c]);
+                total.max[c] = std::max(total.max[c], part.max[c]);
+                total.sum[c] += part.sum[c];
+            }
+        }
+        stats.pixels = pixels;
+    }
+    stats.min = std::move(total.min);
+    stats.max = std::move(total.max);
+    stats.sum.assign(total.sum.begin(), total.sum.end());
+    return stats;
+}
+
+template struct ChannelStats<unsigned char>;
+template struct ChannelStats<std::uint16_t>;
+template struct ChannelStats<float>;
+template ChannelStats<unsigned char> reduceChannels(const unsigned char*, std::size_t, int);
+template ChannelStats<std::uint16_t> reduceChannels(const std::uint16_t*, std::size_t, int);
+template ChannelStats<float> reduceChannels(const float*, std::size_t, int);
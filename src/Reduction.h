@@ -0,0 +1,93 @@
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "Parallel.h"
+
+/**
+ * @struct ChannelStats
+ * @brief Minimum, maximum and sum of every channel of an interleaved sample buffer.
+ */
+template <typename T>
+struct ChannelStats {
+    std::vector<T> min;      ///< Smallest sample of each channel.
+    std::vector<T> max;      ///< Largest sample of each channel.
+    std::vector<double> sum; ///< Sum of each channel (exact for 8- and 16-bit samples).
+    std::size_t pixels = 0;  ///< Samples reduced per channel.
+
+    /// Smallest sample over all channels.
+    T overallMin() const;
+
+    /// Largest sample over all channels.
+    T overallMax() const;
+};
+
+/**
+ * @brief Computes per-channel min, max and sum of `pixels` interleaved pixels in one pass.
+ *
+ * The buffer is cut into fixed chunks that are reduced in parallel (8-bit chunks with SSE2
+ * where available) and combined in chunk order, so the result, including float sums, is the
+ * same for any thread count.
+ *
+ * @param data First sample; channel c of pixel i is data[i * channels + c].
+ * @param pixels Number of pixels.
+ * @param channels Samples per pixel (at least 1).
+ * @return The statistics; for zero pixels min holds the largest and max the lowest T.
+ */
+template <typename T>
+ChannelStats<T> reduceChannels(const T* data, std::size_t pixels, int channels);
+
+/**
+ * @brief Replaces every 8-bit sample v of channel c with tables[c * 256 + v], on the calling thread.
+ *
+ * @param data First sample; channel c of pixel i is data[i * channels + c].
+ * @param pixels Number of pixels.
+ * @param channels Samples per pixel.
+ * @param tables One 256-entry table per channel, back to back.
+ */
+void applyChannelTables(unsigned char* data, std::size_t pixels, int channels, const unsigned char* tables);
+
+/**
+ * @brief Replaces every sample v of channel c with fn(c, v), all channels in one parallel pass.
+ *
+ * 8-bit data goes through one 256-entry table per channel, filled from `fn` up front, so the
+ * pass itself is a table lookup per sample. Other types call `fn` for every sample.
+ *
+ * @param data First sample; channel c of pixel i is data[i * channels + c].
+ * @param pixels Number of pixels.
+ * @param channels Samples per pixel.
+ * @param fn Callable (int channel, T value) returning the new T value.
+ */
+template <typename T, typename Func>
+void remapChannels(T* data, std::size_t pixels, int channels, Func&& fn) {
+    if (!data || pixels == 0 || channels <= 0) return;
+    constexpr std::size_t kChunkPixels = std::size_t(1) << 16;
+    const std::size_t ch = static_cast<std::size_t>(channels);
+    if constexpr (std::is_same_v<T, unsigned char>) {
+        std::vector<unsigned char> table(256 * ch);
+        for (std::size_t c = 0; c < ch; ++c) {
+            for (int v = 0; v < 256; ++v) table[c * 256 + v] = fn(static_cast<int>(c), static_cast<unsigned char>(v));
+        }
+        parallelForChunks(pixels, kChunkPixels, [&](std::size_t first, std::size_t last) {
+            applyChannelTables(data + first * ch, last - first, channels, table.data());
+        });
+    } else {
+        parallelForChunks(pixels, kChunkPixels, [&](std::size_t first, std::size_t last) {
+            for (std::size_t i = first * ch; i < last * ch; i += ch) {
+                for (std::size_t c = 0; c < ch; ++c) data[i + c] = fn(static_cast<int>(c), data[i + c]);
+            }
+        });
+    }
+}
+
+extern template struct ChannelStats<unsigned char>;
+extern template struct ChannelStats<std::uint16_t>;
+extern template struct ChannelStats<float>;
+extern template ChannelStats<unsigned char> reduceChannels(const unsigned char*, std::size_t, int);
+extern template ChannelStats<std::uint16_t> reduceChannels(const std::uint16_t*, std::size_t, int);
+extern template ChannelStats<float> reduceChannels(const float*, std::size_t, int);
+
+#endif // REDUCTION_H
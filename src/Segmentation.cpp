@@ -0,0 +1,347 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements 3D connected-component labelling. The volume is cut into z-slabs that
+ * are labelled at the same time: each slab is scanned in z, y, x order, every foreground voxel
+ * takes the label of a neighbour the scan has already passed (or a new provisional label), and
+ * labels that meet are joined in the slab's own union-find. The slab tables are then placed
+ * side by side in one global table, the labels that touch across each slab boundary are
+ * joined, and a second parallel pass writes the final, consecutive labels.
+ */
+#include "Segmentation.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+    struct Offset {
+        int dx, dy, dz;
+    };
+
+    // Neighbours that a z, y, x scan reaches before the voxel itself.
+    std::vector<Offset> earlierNeighbours(int connectivity) {
+        const int reach = connectivity == 6 ? 1 : connectivity == 18 ? 2 : 3;
+        std::vector<Offset> offsets;
+        for (int dz = -1; dz <= 0; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (dz == 0 && (dy > 0 || (dy == 0 && dx >= 0))) continue;
+                    if (std::abs(dx) + std::abs(dy) + std::abs(dz) > reach) continue;
+                    offsets.push_back({ dx, dy, dz });
+                }
+            }
+        }
+        return offsets;
+    }
+
+    // Union-find over provisional labels. The root of a set is its smallest label, so the
+    // first label the scan gave a component stays its representative.
+    std::uint32_t findRoot(std::vector<std::uint32_t>& parent, std::uint32_t a) {
+        while (parent[a] != a) {
+            parent[a] = parent[parent[a]];
+            a = parent[a];
+        }
+        return a;
+    }
+
+    void unite(std::vector<std::uint32_t>& parent, std::uint32_t a, std::uint32_t b) {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a < b) {
+            parent[b] = a;
+        } else if (b < a) {
+            parent[a] = b;
+        }
+    }
+
+    void include(Component& c, int x, int y, int z) {
+        ++c.voxels;
+        c.minX = std::min(c.minX, x);
+        c.minY = std::min(c.minY, y);
+        c.minZ = std::min(c.minZ, z);
+        c.maxX = std::max(c.maxX, x);
+        c.maxY = std::max(c.maxY, y);
+        c.maxZ = std::max(c.maxZ, z);
+    }
+
+    void merge(Component& into, const Component& part) {
+        into.voxels += part.voxels;
+        into.minX = std::min(into.minX, part.minX);
+        into.minY = std::min(into.minY, part.minY);
+        into.minZ = std::min(into.minZ, part.minZ);
+        into.maxX = std::max(into.maxX, part.maxX);
+        into.maxY = std::max(into.maxY, part.maxY);
+        into.maxZ = std::max(into.maxZ, part.maxZ);
+    }
+
+    // Slices [z0, z1) with the provisional labels found in them. Label l of the slab is
+    // label offset + l of the whole volume; index 0 of both tables is unused.
+    struct Slab {
+        int z0 = 0;
+        int z1 = 0;
+        std::uint32_t offset = 0;
+        std::vector<std::uint32_t> parent;
+        std::vector<Component> parts;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> seams; ///< Labels joined across z0.
+    };
+
+    // Smallest voxel value at or above the threshold, so the foreground test runs in the voxel
+    // type and the row masks below vectorise. `none` is set when no value reaches it.
+    template <typename T>
+    struct Cutoff {
+        T value = T(0);
+        bool none = false;
+
+        explicit Cutoff(double threshold) {
+            if constexpr (std::is_integral_v<T>) {
+                const double top = std::numeric_limits<T>::max();
+                none = threshold > top;
+                value = static_cast<T>(std::clamp(std::ceil(threshold), 0.0, top));
+            } else {
+                value = static_cast<T>(threshold);
+                if (value < threshold) value = std::nextafter(value, std::numeric_limits<T>::infinity());
+            }
+        }
+    };
+
+    template <typename T>
+    void labelSlab(const BasicVolume<T>& vol, const Cutoff<T>& cutoff, const std::vector<Offset>& offsets,
+                   Slab& slab, std::uint32_t* labels) {
+        const int w = vol.getWidth();
+        const int h = vol.getHeight();
+        const int ch = vol.getChannels();
+        const std::size_t sliceSize = static_cast<std::size_t>(w) * h;
+        std::vector<std::ptrdiff_t> delta;
+        for (const Offset& o : offsets) {
+            delta.push_back((static_cast<std::ptrdiff_t>(o.dz) * h + o.dy) * w + o.dx);
+        }
+        slab.parent.assign(1, 0);
+        slab.parts.assign(1, Component());
+        std::vector<unsigned char> fore(w);
+
+        for (int z = slab.z0; z < slab.z1; ++z) {
+            const T* data = vol.getSlices()[z].getData();
+            for (int y = 0; y < h; ++y) {
+                const std::size_t rowStart = static_cast<std::size_t>(z) * sliceSize + static_cast<std::size_t>(y) * w;
+                std::fill_n(labels + rowStart, w, 0u);
+                if (cutoff.none) continue;
+                const T* row = data + static_cast<std::size_t>(y) * w * ch;
+                for (int x = 0; x < w; ++x) {
+                    fore[x] = row[static_cast<std::size_t>(x) * ch] >= cutoff.value;
+                }
+                const bool inner = z > slab.z0 && y > 0 && y + 1 < h;
+                for (int x = 0; x < w;) {
+                    // Background is passed over eight voxels at a time.
+                    std::uint64_t eight = 0;
+                    if (x + 8 <= w && (std::memcpy(&eight, fore.data() + x, 8), eight == 0)) {
+                        x += 8;
+                        continue;
+                    }
+                    if (!fore[x]) {
+                        ++x;
+                        continue;
+                    }
+                    const std::size_t v = rowStart + x;
+                    std::uint32_t label = 0;
+                    const bool checked = !inner || x == 0 || x + 1 == w;
+                    for (std::size_t k = 0; k < offsets.size(); ++k) {
+                        if (checked) {
+                            const int nx = x + offsets[k].dx;
+                            const int ny = y + offsets[k].dy;
+                            if (z + offsets[k].dz < slab.z0 || ny < 0 || ny >= h || nx < 0 || nx >= w) continue;
+                        }
+                        const std::uint32_t neighbour = labels[v + delta[k]];
+                        if (neighbour == 0 || neighbour == label) continue;
+                        // `label` is kept a root, so each further neighbour costs one find.
+                        const std::uint32_t root = findRoot(slab.parent, neighbour);
+                        if (label == 0) {
+                            label = root;
+                        } else if (root < label) {
+                            slab.parent[label] = root;
+                            label = root;
+                        } else if (root > label) {
+                            slab.parent[root] = label;
+                        }
+                    }
+                    if (label == 0) {
+                        label = static_cast<std::uint32_t>(slab.parent.size());
+                        slab.parent.push_back(label);
+                        slab.parts.push_back(Component{ 0, 0, x, y, z, x, y, z });
+                    }
+                    labels[v] = label;
+                    include(slab.parts[label], x, y, z);
+                    ++x;
+                }
+            }
+        }
+    }
+
+    // Pairs of slab labels (this slab, previous slab) that touch across the slab's first slice.
+    void findSeams(int w, int h, const std::vector<Offset>& offsets, Slab& slab, const Slab& below,
+                   const std::uint32_t* labels) {
+        const std::size_t first = static_cast<std::size_t>(slab.z0) * w * h;
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                const std::size_t v = first + static_cast<std::size_t>(y) * w + x;
+                if (labels[v] == 0) continue;
+                const std::uint32_t a = slab.offset + labels[v];
+                for (const Offset& o : offsets) {
+                    if (o.dz == 0) continue;
+                    const int nx = x + o.dx;
+                    const int ny = y + o.dy;
+                    if (ny < 0 || ny >= h || nx < 0 || nx >= w) continue;
+                    const std::uint32_t b = labels[v - static_cast<std::size_t>(w) * h + static_cast<std::ptrdiff_t>(o.dy) * w + o.dx];
+                    if (b == 0) continue;
+                    const std::pair<std::uint32_t, std::uint32_t> seam(a, below.offset + b);
+                    if (slab.seams.empty() || slab.seams.back() != seam) {
+                        slab.seams.push_back(seam);
+                    }
+                }
+            }
+        }
+    }
+
+} // end anonymous namespace
+
+template <typename T>
+ComponentLabels Segmentation::labelComponents(const BasicVolume<T>& vol, double threshold, int connectivity) {
+    PROFILE_SCOPE_CAT("Segmentation::labelComponents", "volume");
+    ComponentLabels result;
+    if (connectivity != 6 && connectivity != 18 && connectivity != 26) {
+        std::cerr << "[Components] Connectivity must be 6, 18 or 26, not " << connectivity << ".\n";
+        return result;
+    }
+    const int w = vol.getWidth();
+    const int h = vol.getHeight();
+    const int d = vol.getDepth();
+    if (w == 0 || h == 0 || d == 0 || vol.getChannels() == 0) {
+        std::cerr << "[Components] Volume is empty or invalid.\n";
+        return result;
+    }
+    result.width = w;
+    result.height = h;
+    result.depth = d;
+    // Left uninitialised: the first pass writes every voxel, in parallel.
+    result.labels.reset(new std::uint32_t[static_cast<std::size_t>(w) * h * d]);
+    std::uint32_t* labels = result.labels.get();
+    const std::vector<Offset> offsets = earlierNeighbours(connectivity);
+    const Cutoff<T> cutoff(threshold);
+
+    const int slabCount = std::min(d, parallelThreadCount());
+    std::vector<Slab> slabs(slabCount);
+    for (int i = 0; i < slabCount; ++i) {
+        slabs[i].z0 = static_cast<int>(static_cast<long long>(d) * i / slabCount);
+        slabs[i].z1 = static_cast<int>(static_cast<long long>(d) * (i + 1) / slabCount);
+    }
+    parallelFor(0, slabCount, [&](int i) {
+        labelSlab(vol, cutoff, offsets, slabs[i], labels);
+    });
+
+    // One table for the whole volume, with each slab's sets already joined.
+    std::uint32_t total = 0;
+    for (Slab& slab : slabs) {
+        slab.offset = total;
+        total += static_cast<std::uint32_t>(slab.parent.size() - 1);
+    }
+    std::vector<std::uint32_t> parent(static_cast<std::size_t>(total) + 1, 0);
+    parallelFor(0, slabCount, [&](int i) {
+        Slab& slab = slabs[i];
+        for (std::uint32_t l = 1; l < slab.parent.size(); ++l) {
+            parent[slab.offset + l] = slab.offset + findRoot(slab.parent, l);
+        }
+        if (i > 0) {
+            findSeams(w, h, offsets, slab, slabs[i - 1], labels);
+        }
+    });
+    for (const Slab& slab : slabs) {
+        for (const auto& seam : slab.seams) {
+            unite(parent, seam.first, seam.second);
+        }
+    }
+
+    // Every set's root is its first label in scan order, so numbering the roots slab by slab
+    // gives consecutive labels. Roots are found without path compression, which keeps the
+    // table read-only while the slabs run at the same time.
+    std::vector<std::uint32_t> finalLabel(parent.size(), 0);
+    std::vector<std::uint32_t> rootCount(slabCount, 0);
+    parallelFor(0, slabCount, [&](int i) {
+        const Slab& slab = slabs[i];
+        for (std::uint32_t g = slab.offset + 1; g < slab.offset + slab.parent.size(); ++g) {
+            std::uint32_t root = g;
+            while (parent[root] != root) root = parent[root];
+            finalLabel[g] = root; // the root for now; replaced by the label below
+            rootCount[i] += root == g;
+        }
+    });
+    std::vector<std::uint32_t> firstLabel(slabCount, 1);
+    for (int i = 1; i < slabCount; ++i) {
+        firstLabel[i] = firstLabel[i - 1] + rootCount[i - 1];
+    }
+    const std::uint32_t count = firstLabel[slabCount - 1] + rootCount[slabCount - 1] - 1;
+    result.components.resize(count);
+
+    // Roots take their labels and start their components from their own part.
+    parallelFor(0, slabCount, [&](int i) {
+        const Slab& slab = slabs[i];
+        std::uint32_t next = firstLabel[i];
+        for (std::uint32_t l = 1; l < slab.parent.size(); ++l) {
+            const std::uint32_t g = slab.offset + l;
+            if (finalLabel[g] != g) continue;
+            finalLabel[g] = next;
+            Component& c = result.components[next - 1];
+            c = slab.parts[l];
+            c.label = next++;
+        }
+    });
+
+    // The other labels follow their roots. Parts whose root lies in an earlier slab are
+    // merged afterwards, so each slab only writes the components it started.
+    const std::size_t sliceSize = static_cast<std::size_t>(w) * h;
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> crossing(slabCount);
+    parallelFor(0, slabCount, [&](int i) {
+        const Slab& slab = slabs[i];
+        for (std::uint32_t l = 1; l < slab.parent.size(); ++l) {
+            const std::uint32_t g = slab.offset + l;
+            const std::uint32_t root = parent[g] == g ? g : finalLabel[g];
+            if (root == g) continue;
+            finalLabel[g] = finalLabel[root];
+            if (root > slab.offset) {
+                merge(result.components[finalLabel[g] - 1], slab.parts[l]);
+            } else {
+                crossing[i].emplace_back(finalLabel[g], l);
+            }
+        }
+        const std::uint32_t* remap = finalLabel.data() + slab.offset;
+        for (std::size_t v = slab.z0 * sliceSize; v < slab.z1 * sliceSize; ++v) {
+            if (labels[v] != 0) labels[v] = remap[labels[v]];
+        }
+    });
+    for (int i = 0; i < slabCount; ++i) {
+        for (const auto& [label, l] : crossing[i]) {
+            merge(result.components[label - 1], slabs[i].parts[l]);
+        }
+    }
+    return result;
+}
+
+template ComponentLabels Segmentation::labelComponents(const Volume&, double, int);
+template ComponentLabels Segmentation::labelComponents(const Volume16&, double, int);
+template ComponentLabels Segmentation::labelComponents(const VolumeF&, double, int);
@@ -0,0 +1,69 @@
+#ifndef SEGMENTATION_H
+#define SEGMENTATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Volume.h"
+
+/**
+ * @struct Component
+ * @brief Size and bounding box of one connected component.
+ */
+struct Component {
+    std::uint32_t label = 0;  ///< Label of the component's voxels (1-based).
+    std::size_t voxels = 0;   ///< Number of voxels.
+    int minX = 0, minY = 0, minZ = 0; ///< Lowest voxel coordinates (0-based, inclusive).
+    int maxX = 0, maxY = 0, maxZ = 0; ///< Highest voxel coordinates (0-based, inclusive).
+};
+
+/**
+ * @struct ComponentLabels
+ * @brief Result of Segmentation::labelComponents.
+ *
+ * `labels` holds one label per voxel, slice by slice and row-major within a slice, with
+ * 0 for the background. Labels run from 1 to components.size() in the order in which
+ * a z, y, x scan meets each component first, so they do not depend on the thread count.
+ */
+struct ComponentLabels {
+    int width = 0;
+    int height = 0;
+    int depth = 0;
+    std::unique_ptr<std::uint32_t[]> labels; ///< Label of every voxel (width * height * depth).
+    std::vector<Component> components;       ///< components[i] describes label i + 1.
+
+    /**
+     * @brief Label of voxel (x, y, z).
+     */
+    std::uint32_t at(int x, int y, int z) const {
+        return labels[(static_cast<std::size_t>(z) * height + y) * width + x];
+    }
+};
+
+/**
+ * @class Segmentation
+ * @brief Splits thresholded volumes into connected components.
+ */
+class Segmentation {
+public:
+    /**
+     * @brief Labels the connected components of the voxels at or above a threshold.
+     *
+     * A voxel is foreground when its first channel is at least `threshold`. Two foreground
+     * voxels are connected when they share a face (connectivity 6), a face or an edge (18),
+     * or a face, an edge or a corner (26). The volume is split into one z-slab per thread;
+     * each slab is labelled with its own union-find, and the labels that meet across slab
+     * boundaries are merged afterwards.
+     *
+     * @param vol The volume to segment.
+     * @param threshold Lowest foreground value, in voxel units.
+     * @param connectivity 6, 18 or 26.
+     * @return The labels and components, or an empty result (with a message) if the volume
+     *         is empty or the connectivity is not 6, 18 or 26.
+     */
+    template <typename T>
+    static ComponentLabels labelComponents(const BasicVolume<T>& vol, double threshold, int connectivity = 26);
+};
+
+#endif // SEGMENTATION_H
@@ -0,0 +1,281 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the --serve mode. Requests reuse the CLI parsers from Cli.cpp. Volume
+ * requests are served from a VolumeCache, so a warm request skips process startup and slice
+ * decoding and only pays for the projection or slice itself. The accept loop and every
+ * connection poll with a short timeout, so SHUTDOWN and stop() take effect without signals.
+ */
+#include "Server.h"
+#include "Cli.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <climits>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define APIF_HAVE_UNIX_SOCKETS 1
+#endif
+
+namespace {
+
+    constexpr int kPollMillis = 200;
+
+    ServerResponse okResponse(const std::string& text = "") {
+        ServerResponse response;
+        response.ok = true;
+        response.data.assign(text.begin(), text.end());
+        return response;
+    }
+
+    ServerResponse errorResponse(const std::string& message) {
+        ServerResponse response;
+        response.message = message;
+        return response;
+    }
+
+    // Parses the whole of `text` as a non-negative count for `opt`, printing an [Error] if it is not one.
+    bool parseCount(const std::string& text, const std::string& opt, unsigned long& value) {
+        try {
+            size_t used = 0;
+            value = std::stoul(text, &used);
+            if (used == text.size() && text.find('-') == std::string::npos) return true;
+        } catch (const std::exception&) {
+            // reported below
+        }
+        std::cerr << "[Error] " << opt << " needs a non-negative number, got '" << text << "'\n";
+        return false;
+    }
+
+    void printServerUsage(const char* prog) {
+        std::cerr << "Usage: " << prog << " --serve <socket_path> [--cache-mb <n>] [--threads <n>]\n"
+                  << "  Requests are CLI argument lists, one per line, e.g.\n"
+                  << "    -d Scans/TestVolume/vol -p MIP out.png    (writes out.png)\n"
+                  << "    -d Scans/TestVolume/vol -s XZ 16 -        (returns PNG bytes)\n"
+                  << "  plus PING, STATS and SHUTDOWN. See Tools/apif_client.cpp.\n";
+    }
+
+} // end anonymous namespace
+
+Server::Server(const ServerOptions& options)
+    : options_(options), cache_(options.cacheBytes) {}
+
+ServerResponse Server::handle(const std::string& line) {
+    ++requests_;
+    try {
+        return process(splitRequest(line));
+    } catch (const std::exception& e) {
+        // e.g. std::stoi on a malformed number
+        return errorResponse(std::string("invalid request: ") + e.what());
+    }
+}
+
+ServerResponse Server::process(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        return errorResponse("empty request");
+    }
+    const std::string& command = args[0];
+    if (command == "PING") {
+        return okResponse("pong");
+    }
+    if (command == "STATS") {
+        VolumeCache::Stats s = cache_.stats();
+        std::ostringstream text;
+        text << "requests " << requests_.load() << "\n"
+             << "cache_hits " << s.hits << "\n"
+             << "cache_misses " << s.misses << "\n"
+             << "cache_evictions " << s.evictions << "\n"
+             << "cache_entries " << s.entries << "\n"
+             << "cache_bytes " << s.bytes << "\n"
+             << "cache_capacity " << s.capacity << "\n";
+        return okResponse(text.str());
+    }
+    if (command == "SHUTDOWN") {
+        stop();
+        return okResponse();
+    }
+    if (command != "-i" && command != "-d") {
+        return errorResponse("unknown request: " + command);
+    }
+    if (args.size() < 3) {
+        return errorResponse("expected " + command + " <input> [options] <output>");
+    }
+
+    // Rebuild an argv so the CLI parsers can be reused unchanged.
+    std::vector<std::string> storage;
+    storage.reserve(args.size() + 1);
+    storage.push_back("APImageFilters");
+    storage.insert(storage.end(), args.begin(), args.end());
+    std::vector<char*> argv;
+    for (std::string& arg : storage) argv.push_back(arg.data());
+    const int argc = static_cast<int>(argv.size());
+
+    std::vector<unsigned char> encoded;
+    bool ok = false;
+    if (command == "-i") {
+        ProgramOptions2D opts;
+        if (!parseCommandLine2D(argc, argv.data(), opts)) {
+            return errorResponse("invalid 2D options");
+        }
+        ok = process2DImage(opts, opts.outputFile == "-" ? &encoded : nullptr);
+    } else {
+        ProgramOptions3D opts;
+        if (!parseCommandLine3D(argc, argv.data(), opts)) {
+            return errorResponse("invalid 3D options");
+        }
+        std::vector<unsigned char>* out = opts.outputFile == "-" ? &encoded : nullptr;
+        if (loadsAsSixteenBit(opts)) {
+            auto vol = cache_.getVolume16(opts.inputDir);
+            if (!vol) return errorResponse("cannot load volume " + opts.inputDir);
+            ok = processLoadedVolume(*vol, opts, out);
+        } else {
+            auto vol = cache_.getVolume(opts.inputDir);
+            if (!vol) return errorResponse("cannot load volume " + opts.inputDir);
+            ok = processLoadedVolume(*vol, opts, out);
+        }
+    }
+    if (!ok) {
+        return errorResponse("processing failed (see server log)");
+    }
+    ServerResponse response = okResponse();
+    response.data = std::move(encoded);
+    return response;
+}
+
+void Server::stop() {
+    running_ = false;
+}
+
+#ifdef APIF_HAVE_UNIX_SOCKETS
+
+bool Server::run() {
+    // A client that disconnects mid-response must not kill the server.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un addr{};
+    if (options_.socketPath.empty() || options_.socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[Server] Invalid socket path: " << options_.socketPath << "\n";
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, options_.socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "[Server] socket() failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    ::unlink(options_.socketPath.c_str()); // stale socket from an earlier run
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd, 64) != 0) {
+        std::cerr << "[Server] Cannot listen on " << options_.socketPath << ": " << std::strerror(errno) << "\n";
+        ::close(listenFd);
+        return false;
+    }
+
+    running_ = true;
+    std::cout << "[Server] Listening on " << options_.socketPath << " (cache "
+              << options_.cacheBytes / (1024 * 1024) << " MB)" << std::endl;
+    while (running_) {
+        pollfd pfd{ listenFd, POLLIN, 0 };
+        if (::poll(&pfd, 1, kPollMillis) <= 0) continue;
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            ++activeConnections_;
+        }
+        std::thread([this, fd]() { serveConnection(fd); }).detach();
+    }
+
+    ::close(listenFd);
+    ::unlink(options_.socketPath.c_str());
+    std::unique_lock<std::mutex> lock(connectionsMutex_);
+    connectionsDone_.wait(lock, [this]() { return activeConnections_ == 0; });
+    std::cout << "[Server] Stopped after " << requests_.load() << " requests" << std::endl;
+    return true;
+}
+
+void Server::serveConnection(int fd) {
+    std::string buffer;
+    std::string line;
+    while (running_) {
+        if (buffer.find('\n') == std::string::npos) {
+            pollfd pfd{ fd, POLLIN, 0 };
+            if (::poll(&pfd, 1, kPollMillis) <= 0) continue;
+        }
+        if (!readLine(fd, buffer, line)) break;
+
+        ServerResponse response = handle(line);
+        std::string header = response.ok ? "OK " + std::to_string(response.data.size()) + "\n"
+                                         : "ERR " + response.message + "\n";
+        if (!writeAll(fd, header.data(), header.size()) ||
+            !writeAll(fd, response.data.data(), response.data.size())) {
+            break;
+        }
+    }
+    ::close(fd);
+
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    --activeConnections_;
+    connectionsDone_.notify_all();
+}
+
+#else // no Unix domain sockets (e.g. MSVC builds)
+
+bool Server::run() {
+    std::cerr << "[Server] --serve needs Unix domain sockets, which this platform does not provide.\n";
+    return false;
+}
+
+void Server::serveConnection(int) {}
+
+#endif
+
+int runServer(int argc, char* argv[]) {
+    ServerOptions options;
+    int idx = 1;
+    if (idx < argc && std::string(argv[idx]) == "--serve") ++idx;
+    if (idx >= argc) {
+        printServerUsage(argv[0]);
+        return 1;
+    }
+    options.socketPath = argv[idx++];
+    while (idx < argc) {
+        std::string opt = argv[idx++];
+        unsigned long value = 0;
+        if (opt == "--cache-mb" && idx < argc) {
+            if (!parseCount(argv[idx++], opt, value)) return 1;
+            options.cacheBytes = static_cast<size_t>(value) * 1024 * 1024;
+        } else if (opt == "--threads" && idx < argc) {
+            if (!parseCount(argv[idx++], opt, value)) return 1;
+            parallelThreadLimit() = static_cast<int>(std::min<unsigned long>(value, INT_MAX));
+        } else {
+            printServerUsage(argv[0]);
+            return 1;
+        }
+    }
+    Server server(options);
+    return server.run() ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include "ServerProtocol.h"
+#include "VolumeCache.h"
+
+/**
+ * @brief Settings of `APImageFilters --serve`.
+ */
+struct ServerOptions {
+    std::string socketPath;                          ///< Unix domain socket to listen on.
+    size_t cacheBytes = size_t(2048) * 1024 * 1024;  ///< Volume cache budget (default 2 GB).
+};
+
+/**
+ * @class Server
+ * @brief Long-running request server that keeps decoded volumes resident.
+ *
+ * Each request is the same argument list as a CLI run (see ServerProtocol.h). `-d` requests
+ * take their volume from a VolumeCache instead of decoding the slices again; `-i` requests
+ * load their image each time. Connections are served on their own threads, and the volume
+ * kernels parallelise internally as they do in the CLI.
+ */
+class Server {
+public:
+    explicit Server(const ServerOptions& options);
+
+    /**
+     * @brief Listens on the socket and serves requests until SHUTDOWN or stop().
+     * @return False if the socket could not be created.
+     */
+    bool run();
+
+    /**
+     * @brief Asks run() to return; in-flight requests are finished first.
+     */
+    void stop();
+
+    /**
+     * @brief Executes one request line. Used by the connection threads; callable directly.
+     */
+    ServerResponse handle(const std::string& line);
+
+    /**
+     * @brief The server's volume cache.
+     */
+    const VolumeCache& cache() const { return cache_; }
+
+private:
+    ServerResponse process(const std::vector<std::string>& args);
+    void serveConnection(int fd);
+
+    ServerOptions options_;
+    VolumeCache cache_;
+    std::atomic<bool> running_{ false };
+    std::atomic<size_t> requests_{ 0 };
+    std::mutex connectionsMutex_;
+    std::condition_variable connectionsDone_;
+    int activeConnections_ = 0;
+};
+
+/**
+ * @brief Entry point for `APImageFilters --serve <socket> [--cache-mb <n>]`.
+ * @return Process exit code.
+ */
+int runServer(int argc, char* argv[]);
+
+#endif // SERVER_H
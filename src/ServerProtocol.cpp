@@ -0,0 +1,175 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the request framing shared by the server and its clients: splitting
+ * request lines into arguments, line and length-prefixed reads over a stream socket, and the
+ * ServerConnection client. It has no image dependencies, so the client stub links only this.
+ */
+#include "ServerProtocol.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define APIF_HAVE_UNIX_SOCKETS 1
+#endif
+
+std::vector<std::string> splitRequest(const std::string& line) {
+    std::vector<std::string> args;
+    std::string current;
+    bool inQuotes = false;
+    bool hasToken = false;
+    for (char c : line) {
+        if (c == '"') {
+            inQuotes = !inQuotes;
+            hasToken = true;
+        } else if (!inQuotes && std::isspace(static_cast<unsigned char>(c))) {
+            if (hasToken) args.push_back(current);
+            current.clear();
+            hasToken = false;
+        } else {
+            current += c;
+            hasToken = true;
+        }
+    }
+    if (hasToken) args.push_back(current);
+    return args;
+}
+
+std::string joinRequest(const std::vector<std::string>& args) {
+    std::string line;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (i > 0) line += ' ';
+        bool quote = args[i].empty() ||
+                     args[i].find_first_of(" \t") != std::string::npos;
+        line += quote ? "\"" + args[i] + "\"" : args[i];
+    }
+    return line;
+}
+
+#ifdef APIF_HAVE_UNIX_SOCKETS
+
+bool writeAll(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::send(fd, bytes, size, 0);
+        if (written <= 0) return false;
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool readLine(int fd, std::string& buffer, std::string& line) {
+    for (;;) {
+        std::size_t newline = buffer.find('\n');
+        if (newline != std::string::npos) {
+            line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            return true;
+        }
+        char chunk[4096];
+        ssize_t got = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (got <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(got));
+    }
+}
+
+bool readExact(int fd, std::string& buffer, size_t size, std::vector<unsigned char>& out) {
+    out.clear();
+    out.reserve(size);
+    const size_t fromBuffer = std::min(size, buffer.size());
+    out.insert(out.end(), buffer.begin(), buffer.begin() + fromBuffer);
+    buffer.erase(0, fromBuffer);
+    while (out.size() < size) {
+        char chunk[65536];
+        const size_t want = std::min(sizeof(chunk), size - out.size());
+        ssize_t got = ::recv(fd, chunk, want, 0);
+        if (got <= 0) return false;
+        out.insert(out.end(), chunk, chunk + got);
+    }
+    return true;
+}
+
+ServerConnection::~ServerConnection() {
+    close();
+}
+
+bool ServerConnection::connect(const std::string& socketPath) {
+    close();
+    sockaddr_un addr{};
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[Client] Socket path is too long: " << socketPath << "\n";
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "[Client] Cannot connect to " << socketPath << ": " << std::strerror(errno) << "\n";
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ServerConnection::request(const std::string& line, ServerResponse& response) {
+    response = ServerResponse();
+    if (fd_ < 0) return false;
+    const std::string framed = line + "\n";
+    if (!writeAll(fd_, framed.data(), framed.size())) return false;
+
+    std::string header;
+    if (!readLine(fd_, buffer_, header)) return false;
+    if (header.rfind("OK ", 0) == 0) {
+        response.ok = true;
+        const size_t size = std::stoull(header.substr(3));
+        return readExact(fd_, buffer_, size, response.data);
+    }
+    response.message = header.rfind("ERR ", 0) == 0 ? header.substr(4) : header;
+    return true;
+}
+
+void ServerConnection::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    buffer_.clear();
+}
+
+#else // no Unix domain sockets (e.g. MSVC builds)
+
+bool writeAll(int, const void*, size_t) { return false; }
+bool readLine(int, std::string&, std::string&) { return false; }
+bool readExact(int, std::string&, size_t, std::vector<unsigned char>&) { return false; }
+
+ServerConnection::~ServerConnection() = default;
+
+bool ServerConnection::connect(const std::string&) {
+    std::cerr << "[Client] Unix domain sockets are not available on this platform.\n";
+    return false;
+}
+
+bool ServerConnection::request(const std::string&, ServerResponse&) { return false; }
+
+void ServerConnection::close() {}
+
+#endif
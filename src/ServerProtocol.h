@@ -0,0 +1,91 @@
+#ifndef SERVER_PROTOCOL_H
+#define SERVER_PROTOCOL_H
+
+#include <string>
+#include <vector>
+
+/*
+ * Wire format of the --serve socket (a Unix domain stream socket):
+ *
+ *   request   one line of text, the CLI arguments without the program name, e.g.
+ *             -d Scans/TestVolume/vol -p MIP out.png
+ *             Arguments containing spaces are wrapped in double quotes. An output name of
+ *             "-" returns the image as PNG bytes instead of writing a file. PING, STATS and
+ *             SHUTDOWN are also accepted.
+ *   response  "OK <n>\n" followed by n payload bytes, or "ERR <message>\n".
+ *
+ * A connection may carry any number of requests; each gets exactly one response.
+ */
+
+/**
+ * @brief Reply to one server request.
+ */
+struct ServerResponse {
+    bool ok = false;                  ///< True for OK, false for ERR.
+    std::string message;              ///< Error text (ERR only).
+    std::vector<unsigned char> data;  ///< Payload: encoded image, stats text, or empty.
+};
+
+/**
+ * @brief Splits a request line into arguments at whitespace; double quotes group words.
+ */
+std::vector<std::string> splitRequest(const std::string& line);
+
+/**
+ * @brief Joins arguments into a request line, quoting those that contain whitespace.
+ */
+std::string joinRequest(const std::vector<std::string>& args);
+
+/**
+ * @brief Writes all of `size` bytes to a socket. Returns false on error.
+ */
+bool writeAll(int fd, const void* data, size_t size);
+
+/**
+ * @brief Reads one '\n'-terminated line (without the newline).
+ * @param fd Socket to read from.
+ * @param buffer Bytes already received but not yet consumed; kept between calls.
+ * @param line Receives the line.
+ * @return False on end of stream or error.
+ */
+bool readLine(int fd, std::string& buffer, std::string& line);
+
+/**
+ * @brief Reads exactly `size` bytes, taking any buffered bytes first.
+ */
+bool readExact(int fd, std::string& buffer, size_t size, std::vector<unsigned char>& out);
+
+/**
+ * @class ServerConnection
+ * @brief Client side of the protocol: one connection, any number of requests.
+ */
+class ServerConnection {
+public:
+    ServerConnection() = default;
+    ~ServerConnection();
+    ServerConnection(const ServerConnection&) = delete;
+    ServerConnection& operator=(const ServerConnection&) = delete;
+
+    /**
+     * @brief Connects to the server socket.
+     * @return False if the server is not reachable (an error has been printed).
+     */
+    bool connect(const std::string& socketPath);
+
+    /**
+     * @brief Sends one request line and waits for its response.
+     * @return False if the connection failed; a server-side error still returns true with response.ok false.
+     */
+    bool request(const std::string& line, ServerResponse& response);
+
+    /**
+     * @brief Closes the connection.
+     */
+    void close();
+
+private:
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+#endif // SERVER_PROTOCOL_H
@@ -11,11 +11,17 @@
  */
 
 #include "Slice.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <cstdlib>  // for malloc
 #include <cstring>  // for memset
 
-Image Slice::sliceVolume(const Volume& vol, const std::string& plane, int constant) {
+template <typename T>
+BasicImage<T> Slice::sliceVolume(const BasicVolume<T>& vol, const std::string& plane, int constant) {
+    PROFILE_SCOPE_CAT("Slice::sliceVolume", "volume");
     int w = vol.getWidth();
     int h = vol.getHeight();
     int d = vol.getDepth();
@@ -28,22 +34,22 @@ Image Slice::sliceVolume(const Volume& vol, const std::string& plane, int consta
         // we read from vol.getSlices()[z].getPixel(x, y)
         if (constant < 0 || constant >= d) {
             std::cerr << "[sliceVolume] 'constant' out of range for plane XY.\n";
-            return Image();
+            return BasicImage<T>();
         }
         // allocate w*h*ch
-        unsigned char* outData = (unsigned char*)std::malloc(w * h * ch);
+        T* outData = (T*)std::malloc(sizeof(T) * w * h * ch);
         if (!outData) {
             std::cerr << "[sliceVolume] malloc fail for XY.\n";
-            return Image();
+            return BasicImage<T>();
         }
-        std::memset(outData, 0, w * h * ch);
-        Image result(w, h, ch, outData);
+        std::memset(outData, 0, sizeof(T) * w * h * ch);
+        BasicImage<T> result(w, h, ch, outData);
 
         for (int y = 0; y < h; y++) {
             for (int x = 0; x < w; x++) {
-                const unsigned char* voxel = vol.getSlices()[constant].getPixel(x, y);
+                const T* voxel = vol.getSlices()[constant].getPixel(x, y);
                 if (!voxel) continue; 
-                unsigned char* outPix = result.getPixel(x, y);
+                T* outPix = result.getPixel(x, y);
                 for (int c = 0; c < ch; c++) {
                     outPix[c] = voxel[c];
                 }
@@ -57,22 +63,22 @@ Image Slice::sliceVolume(const Volume& vol, const std::string& plane, int consta
         // we read (x, constant, z)
         if (constant < 0 || constant >= h) {
             std::cerr << "[sliceVolume] 'constant' out of range for plane XZ.\n";
-            return Image();
+            return BasicImage<T>();
         }
-        unsigned char* outData = (unsigned char*)std::malloc(w * d * ch);
+        T* outData = (T*)std::malloc(sizeof(T) * w * d * ch);
         if (!outData) {
             std::cerr << "[sliceVolume] malloc fail for XZ.\n";
-            return Image();
+            return BasicImage<T>();
         }
-        std::memset(outData, 0, w * d * ch);
-        Image result(w, d, ch, outData);
+        std::memset(outData, 0, sizeof(T) * w * d * ch);
+        BasicImage<T> result(w, d, ch, outData);
 
         for (int z = 0; z < d; z++) {
             for (int x = 0; x < w; x++) {
-                const unsigned char* voxel = vol.getSlices()[z].getPixel(x, constant);
+                const T* voxel = vol.getSlices()[z].getPixel(x, constant);
                 if (!voxel) continue;
                 // (x, z) in result
-                unsigned char* outPix = result.getPixel(x, z);
+                T* outPix = result.getPixel(x, z);
                 for (int c = 0; c < ch; c++) {
                     outPix[c] = voxel[c];
                 }
@@ -86,22 +92,22 @@ Image Slice::sliceVolume(const Volume& vol, const std::string& plane, int consta
         // (y in [0..h-1], z in [0..d-1])
         if (constant < 0 || constant >= w) {
             std::cerr << "[sliceVolume] 'constant' out of range for plane YZ.\n";
-            return Image();
+            return BasicImage<T>();
         }
-        unsigned char* outData = (unsigned char*)std::malloc(h * d * ch);
+        T* outData = (T*)std::malloc(sizeof(T) * h * d * ch);
         if (!outData) {
             std::cerr << "[sliceVolume] malloc fail for YZ.\n";
-            return Image();
+            return BasicImage<T>();
         }
-        std::memset(outData, 0, h * d * ch);
-        Image result(h, d, ch, outData);
+        std::memset(outData, 0, sizeof(T) * h * d * ch);
+        BasicImage<T> result(h, d, ch, outData);
 
         for (int z = 0; z < d; z++) {
             for (int y = 0; y < h; y++) {
-                const unsigned char* voxel = vol.getSlices()[z].getPixel(constant, y);
+                const T* voxel = vol.getSlices()[z].getPixel(constant, y);
                 if (!voxel) continue;
                 // (y, z) in result
-                unsigned char* outPix = result.getPixel(y, z);
+                T* outPix = result.getPixel(y, z);
                 for (int c = 0; c < ch; c++) {
                     outPix[c] = voxel[c];
                 }
@@ -111,6 +117,208 @@ Image Slice::sliceVolume(const Volume& vol, const std::string& plane, int consta
     }
     else {
         std::cerr << "[sliceVolume] Unsupported plane type: " << plane << "\n";
+        return BasicImage<T>();
+    }
+}
+
+template Image Slice::sliceVolume(const Volume&, const std::string&, int);
+template Image16 Slice::sliceVolume(const Volume16&, const std::string&, int);
+template ImageF Slice::sliceVolume(const VolumeF&, const std::string&, int);
+
+template <typename T>
+BasicImage<T> Slice::sliceVolume(const BasicCompressedVolume<T>& vol, const std::string& plane, int constant) {
+    PROFILE_SCOPE_CAT("Slice::sliceVolume", "volume");
+    const int w = vol.getWidth();
+    const int h = vol.getHeight();
+    const int d = vol.getDepth();
+    const int ch = vol.getChannels();
+    const size_t rowLength = static_cast<size_t>(w) * ch;
+
+    // Output size and the range of `constant` for each plane, as in the BasicVolume overload.
+    int outW = 0, outH = 0, limit = 0;
+    if (plane == "XY") { outW = w; outH = h; limit = d; }
+    else if (plane == "XZ") { outW = w; outH = d; limit = h; }
+    else if (plane == "YZ") { outW = h; outH = d; limit = w; }
+    else {
+        std::cerr << "[sliceVolume] Unsupported plane type: " << plane << "\n";
+        return BasicImage<T>();
+    }
+    if (constant < 0 || constant >= limit) {
+        std::cerr << "[sliceVolume] 'constant' out of range for plane " << plane << ".\n";
+        return BasicImage<T>();
+    }
+    T* outData = (T*)std::malloc(sizeof(T) * outW * outH * ch);
+    if (!outData) {
+        std::cerr << "[sliceVolume] malloc fail for " << plane << ".\n";
+        return BasicImage<T>();
+    }
+    BasicImage<T> result(outW, outH, ch, outData);
+
+    if (plane == "XY") {
+        vol.decompressSlice(constant, outData);
+    }
+    else if (plane == "XZ") {
+        // Row `constant` of slice z is output row z.
+        parallelFor(0, d, [&](int z) {
+            vol.decompressRow(constant, z, outData + z * rowLength);
+        });
+    }
+    else {
+        // Pixel `constant` of every row of slice z makes up output row z.
+        parallelFor(0, d, [&](int z) {
+            std::vector<T> row(rowLength);
+            T* out = outData + static_cast<size_t>(z) * h * ch;
+            for (int y = 0; y < h; y++) {
+                vol.decompressRow(y, z, row.data());
+                std::memcpy(out + static_cast<size_t>(y) * ch, row.data() + static_cast<size_t>(constant) * ch, sizeof(T) * ch);
+            }
+        });
+    }
+    return result;
+}
+
+template Image Slice::sliceVolume(const CompressedVolume&, const std::string&, int);
+template Image16 Slice::sliceVolume(const CompressedVolume16&, const std::string&, int);
+
+
+namespace {
+
+    /*
+     * Samples one output row from precomputed voxel coordinates. The coordinate arrays are filled
+     * by plain loops that the compiler vectorises; this loop then does the (scalar) gathers.
+     * Positions outside the volume produce 0.
+     */
+    void sampleRow(const VolumeSampler& sampler, const float* xs, const float* ys, const float* zs,
+                   int n, Interpolation interp, unsigned char* dst) {
+        const int ch = sampler.getChannels();
+        float value[4];
+        for (int i = 0; i < n; i++) {
+            unsigned char* outPix = dst + i * ch;
+            if (!sampler.inside(xs[i], ys[i], zs[i])) {
+                std::memset(outPix, 0, ch);
+                continue;
+            }
+            sampler.sample(xs[i], ys[i], zs[i], interp, value);
+            for (int c = 0; c < ch; c++) {
+                outPix[c] = static_cast<unsigned char>(std::clamp(value[c] + 0.5f, 0.0f, 255.0f));
+            }
+        }
+    }
+
+    int volumeDiagonal(const Volume& vol) {
+        return static_cast<int>(std::ceil(std::sqrt(
+            static_cast<double>(vol.getWidth()) * vol.getWidth() +
+            static_cast<double>(vol.getHeight()) * vol.getHeight() +
+            static_cast<double>(vol.getDepth()) * vol.getDepth())));
+    }
+
+} // end anonymous namespace
+
+Image Slice::obliqueSlice(const Volume& vol, const Vec3& point, const Vec3& normal,
+                          Interpolation interp, int outWidth, int outHeight, float spacing) {
+    PROFILE_SCOPE_CAT("Slice::obliqueSlice", "volume");
+    int ch = vol.getChannels();
+    if (vol.getDepth() == 0 || ch == 0 || ch > 4) {
+        std::cerr << "[obliqueSlice] Volume is empty or has more than 4 channels.\n";
         return Image();
     }
+    if (normal.length() < 1e-6f) {
+        std::cerr << "[obliqueSlice] Plane normal must be non-zero.\n";
+        return Image();
+    }
+
+    // In-plane axes: a +z normal gives u = +x, v = +y (the XY plane).
+    Vec3 n = normal.normalized();
+    Vec3 u, v;
+    if (std::fabs(n.y) > 0.99f) {
+        u = Vec3{ 1.0f, 0.0f, 0.0f };
+        v = n.cross(u).normalized();
+        if (v.z < 0.0f) v = v * -1.0f; // keep z increasing down the image, like "XZ"
+    } else {
+        u = Vec3{ 0.0f, 1.0f, 0.0f }.cross(n).normalized();
+        v = n.cross(u);
+    }
+
+    int outW = outWidth > 0 ? outWidth : volumeDiagonal(vol);
+    int outH = outHeight > 0 ? outHeight : volumeDiagonal(vol);
+    if (spacing <= 0.0f) spacing = 1.0f;
+    u = u * spacing;
+    v = v * spacing;
+
+    unsigned char* outData = (unsigned char*)std::malloc((size_t)outW * outH * ch);
+    if (!outData) {
+        std::cerr << "[obliqueSlice] malloc fail.\n";
+        return Image();
+    }
+    Image result(outW, outH, ch, outData);
+
+    VolumeSampler sampler(vol);
+    const Vec3 origin = point - u * ((outW - 1) * 0.5f) - v * ((outH - 1) * 0.5f);
+    parallelFor(0, outH, [&](int y) {
+        std::vector<float> xs(outW), ys(outW), zs(outW);
+        const Vec3 start = origin + v * static_cast<float>(y);
+        for (int i = 0; i < outW; i++) {
+            xs[i] = start.x + u.x * i;
+            ys[i] = start.y + u.y * i;
+            zs[i] = start.z + u.z * i;
+        }
+        sampleRow(sampler, xs.data(), ys.data(), zs.data(), outW, interp, outData + (size_t)y * outW * ch);
+    });
+    return result;
+}
+
+Image Slice::curvedSlice(const Volume& vol, const std::vector<Vec3>& polyline,
+                         Interpolation interp, int outHeight, const Vec3& extrusion) {
+    PROFILE_SCOPE_CAT("Slice::curvedSlice", "volume");
+    int ch = vol.getChannels();
+    if (vol.getDepth() == 0 || ch == 0 || ch > 4) {
+        std::cerr << "[curvedSlice] Volume is empty or has more than 4 channels.\n";
+        return Image();
+    }
+    if (polyline.size() < 2) {
+        std::cerr << "[curvedSlice] The curve needs at least two points.\n";
+        return Image();
+    }
+
+    // Resample the polyline at unit arc length; each sample becomes one output column.
+    std::vector<float> cx, cy, cz;
+    cx.push_back(polyline[0].x);
+    cy.push_back(polyline[0].y);
+    cz.push_back(polyline[0].z);
+    float carried = 0.0f; // arc length already covered inside the current segment
+    for (size_t k = 1; k < polyline.size(); k++) {
+        const Vec3 seg = polyline[k] - polyline[k - 1];
+        const float len = seg.length();
+        if (len < 1e-6f) continue;
+        float t = 1.0f - carried;
+        for (; t <= len; t += 1.0f) {
+            const Vec3 p = polyline[k - 1] + seg * (t / len);
+            cx.push_back(p.x);
+            cy.push_back(p.y);
+            cz.push_back(p.z);
+        }
+        carried = len - (t - 1.0f);
+    }
+
+    const int outW = static_cast<int>(cx.size());
+    const int outH = outHeight > 0 ? outHeight : vol.getDepth();
+    unsigned char* outData = (unsigned char*)std::malloc((size_t)outW * outH * ch);
+    if (!outData) {
+        std::cerr << "[curvedSlice] malloc fail.\n";
+        return Image();
+    }
+    Image result(outW, outH, ch, outData);
+
+    VolumeSampler sampler(vol);
+    parallelFor(0, outH, [&](int y) {
+        std::vector<float> xs(outW), ys(outW), zs(outW);
+        const Vec3 shift = extrusion * static_cast<float>(y);
+        for (int i = 0; i < outW; i++) {
+            xs[i] = cx[i] + shift.x;
+            ys[i] = cy[i] + shift.y;
+            zs[i] = cz[i] + shift.z;
+        }
+        sampleRow(sampler, xs.data(), ys.data(), zs.data(), outW, interp, outData + (size_t)y * outW * ch);
+    });
+    return result;
 }
@@ -2,7 +2,10 @@
 #define SLICE_H
 
 #include <string>
+#include <vector>
+#include "CompressedVolume.h"
 #include "Volume.h"
+#include "VolumeSampler.h"
 
 /**
  * The Slice class is used to slice 3D body data in the XZ or YZ plane, returning a 2D Image.
@@ -17,9 +20,55 @@ public:
      * @param vol input 3D body data
      * @param plane "XZ" or "YZ" (can be extended to support "XY")
      * @param constant The coordinate of the corresponding plane (e.g. for "XZ", constant = Y value).
-     * @return Returns the generated 2D Image.
+     * @return Returns the generated 2D Image, with the voxel type of the volume.
      */
-    static Image sliceVolume(const Volume& vol, const std::string& plane, int constant);
+    template <typename T>
+    static BasicImage<T> sliceVolume(const BasicVolume<T>& vol, const std::string& plane, int constant);
+
+    /**
+     * Slicing function for a compressed volume; same planes and result as the overload above.
+     * Only the rows that the plane crosses are decoded, one slice of the volume per task.
+     * @param vol input compressed 3D body data
+     * @param plane "XY", "XZ" or "YZ"
+     * @param constant The coordinate of the corresponding plane.
+     * @return Returns the generated 2D Image, with the voxel type of the volume.
+     */
+    template <typename T>
+    static BasicImage<T> sliceVolume(const BasicCompressedVolume<T>& vol, const std::string& plane, int constant);
+
+    /**
+     * Oblique (multi-planar reformat) slice through an arbitrary plane.
+     * The plane passes through `point` with the given normal; the output image axes are two
+     * orthonormal in-plane directions, chosen so that a +z normal reproduces the XY plane.
+     * Samples that fall outside the volume are 0. Rows are resampled in parallel.
+     * @param vol input 3D body data
+     * @param point a point on the plane, in 0-based voxel coordinates; it maps to the image centre
+     * @param normal plane normal (need not be unit length)
+     * @param interp Nearest or Trilinear sampling
+     * @param outWidth output width in pixels (0 = volume diagonal)
+     * @param outHeight output height in pixels (0 = volume diagonal)
+     * @param spacing distance between output pixels, in voxels
+     * @return Returns the generated 2D Image (empty on invalid input).
+     */
+    static Image obliqueSlice(const Volume& vol, const Vec3& point, const Vec3& normal,
+                              Interpolation interp = Interpolation::Trilinear,
+                              int outWidth = 0, int outHeight = 0, float spacing = 1.0f);
+
+    /**
+     * Curved reformat: the surface swept by a polyline moved along a fixed direction.
+     * The polyline is resampled at unit arc length to give the output columns, and row j
+     * samples the curve shifted by j * extrusion. With the default +z extrusion, a curve
+     * drawn on the first slice unrolls the whole stack (e.g. a panoramic view).
+     * @param vol input 3D body data
+     * @param polyline curve vertices in 0-based voxel coordinates (at least two)
+     * @param interp Nearest or Trilinear sampling
+     * @param outHeight number of output rows (0 = volume depth)
+     * @param extrusion step between output rows, in voxels
+     * @return Returns the generated 2D Image (empty on invalid input).
+     */
+    static Image curvedSlice(const Volume& vol, const std::vector<Vec3>& polyline,
+                             Interpolation interp = Interpolation::Trilinear,
+                             int outHeight = 0, const Vec3& extrusion = Vec3{ 0.0f, 0.0f, 1.0f });
 };
 
 #endif // SLICE_H
@@ -0,0 +1,154 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements the shared worker pool behind parallelFor. Starting threads for every
+ * call cost more than the work on small images, so workers are kept and woken per range.
+ * Each participant owns a block of indices guarded by its own mutex; stealing from the back
+ * of another block keeps the owner walking forward through neighbouring rows.
+ */
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+    // Set on pool workers and on a caller while it runs a range, so nested calls run inline.
+    thread_local bool insideRange = false;
+
+} // end anonymous namespace
+
+struct alignas(64) ThreadPool::Block {
+    std::mutex mutex;
+    int next = 0;
+    int end = 0;
+};
+
+struct ThreadPool::Job {
+    const std::function<void(int)>* fn = nullptr;
+    std::unique_ptr<Block[]> blocks;
+    int participants = 0;
+    std::atomic<bool> failed{ false };
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+int ThreadPool::workerCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(workers_.size());
+}
+
+void ThreadPool::ensureWorkers(int count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (static_cast<int>(workers_.size()) < count) {
+        const int index = static_cast<int>(workers_.size()) + 1;
+        workers_.emplace_back([this, index]() { workerLoop(index); });
+    }
+}
+
+void ThreadPool::run(int count, int threads, const std::function<void(int)>& fn) {
+    if (count <= 0) return;
+    threads = std::clamp(threads, 1, count);
+    std::unique_lock<std::mutex> runLock(runMutex_, std::defer_lock);
+    if (threads == 1 || insideRange || !runLock.try_lock()) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+    ensureWorkers(threads - 1);
+
+    Job job;
+    job.fn = &fn;
+    job.participants = threads;
+    job.blocks.reset(new Block[threads]);
+    const int chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        job.blocks[t].next = std::min(count, t * chunk);
+        job.blocks[t].end = std::min(count, (t + 1) * chunk);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        active_ = threads - 1;
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    insideRange = true;
+    participate(job, 0);
+    insideRange = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return active_ == 0; });
+        job_ = nullptr;
+    }
+    if (job.error) std::rethrow_exception(job.error);
+}
+
+void ThreadPool::participate(Job& job, int self) {
+    for (;;) {
+        int index = -1;
+        {
+            Block& own = job.blocks[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.next < own.end) index = own.next++;
+        }
+        for (int d = 1; index < 0 && d < job.participants; ++d) {
+            Block& victim = job.blocks[(self + d) % job.participants];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.next < victim.end) index = --victim.end;
+        }
+        if (index < 0 || job.failed.load(std::memory_order_relaxed)) return;
+        try {
+            (*job.fn)(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.errorMutex);
+            if (!job.error) job.error = std::current_exception();
+            job.failed = true;
+        }
+    }
+}
+
+void ThreadPool::workerLoop(int index) {
+    insideRange = true;
+    std::uint64_t seen = 0;
+    for (;;) {
+        Job* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&]() { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+            job = job_;
+        }
+        // Workers numbered past this range's thread count sit it out.
+        if (!job || index >= job->participants) continue;
+        participate(*job, index);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--active_ == 0) done_.notify_one();
+        }
+    }
+}
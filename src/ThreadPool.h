@@ -0,0 +1,77 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Persistent worker threads that run index ranges with work stealing.
+ *
+ * A range [0, count) is cut into one contiguous block per participating thread, the
+ * calling thread included. Each thread works through its own block from the front and,
+ * once it is empty, steals single indices from the back of the other blocks. The split
+ * depends only on `count` and the thread count, so a callable whose indices are
+ * independent gives the same result however the work ends up scheduled.
+ *
+ * One range runs at a time. A call made while the pool is busy (from another thread, or
+ * from inside a running index) runs its range on the calling thread instead of waiting.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief The process-wide pool used by parallelFor and friends (see Parallel.h).
+     */
+    static ThreadPool& shared();
+
+    ThreadPool() = default;
+
+    /// Stops and joins the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Runs `fn(i)` for every i in [0, count) on up to `threads` threads.
+     *
+     * Workers are started the first time they are needed and then kept. If `fn` throws,
+     * the remaining indices are skipped and the first exception is rethrown here.
+     *
+     * @param count Number of indices.
+     * @param threads Threads to use, including the caller (clamped to [1, count]).
+     * @param fn Callable taking an index.
+     */
+    void run(int count, int threads, const std::function<void(int)>& fn);
+
+    /**
+     * @brief Number of worker threads started so far (the caller is not counted).
+     */
+    int workerCount() const;
+
+private:
+    struct Block;
+    struct Job;
+
+    void ensureWorkers(int count);
+    void workerLoop(int index);
+    static void participate(Job& job, int self);
+
+    std::mutex runMutex_;               ///< Held for the duration of one range.
+    mutable std::mutex mutex_;          ///< Guards the fields below.
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::vector<std::thread> workers_;  ///< Worker i takes part as thread i + 1.
+    Job* job_ = nullptr;
+    std::uint64_t generation_ = 0;
+    int active_ = 0;
+    bool stopping_ = false;
+};
+
+#endif // THREAD_POOL_H
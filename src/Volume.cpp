@@ -11,12 +11,16 @@
  */
 #include "Volume.h"
 #include "stb_image.h"
+#include "AsyncImageWriter.h"
 #include "Image.h"
+#include "Parallel.h"
+#include "Profiler.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 
 namespace fs = std::filesystem;
@@ -51,21 +55,56 @@ FilenamePattern parseFilename(const std::string& filename, const std::string& ba
     return { basename, numDigits, startNumber };
 }
 
-Volume::Volume()
-    : width(0), height(0), depth(0), channels(0) {
+// Slices decoded with all channels to decide whether ChannelMode::Auto collapses a volume.
+constexpr int kGreyProbeSlices = 3;
+
+template <typename T>
+BasicVolume<T>::BasicVolume()
+    : width(0), height(0), depth(0), channels(0), sourceChannels(0) {
 }
 
-Volume::~Volume() {
-    // Each Image's destructor automatically frees its data.
+template <typename T>
+BasicVolume<T>::BasicVolume(int width, int height, int depth, int channels)
+    : width(width), height(height), depth(depth), channels(channels), sourceChannels(channels) {
+    const size_t sliceSamples = static_cast<size_t>(width) * height * channels;
+    voxels.reset(new T[sliceSamples * depth]());
+    slices.reserve(depth);
+    for (int z = 0; z < depth; ++z) {
+        slices.push_back(BasicImage<T>::view(width, height, channels, voxels.get() + z * sliceSamples));
+        slices.back().setVerbose(false);
+    }
 }
 
-bool Volume::load(const std::string& directoryWithBasename) {
-    slices.clear();
-    width = 0;
-    height = 0;
-    depth = 0;
-    channels = 0;
+template <typename T>
+BasicVolume<T>::~BasicVolume() {
+    // The slices are views; the voxel store frees itself.
+}
+
+template <typename T>
+BasicVolume<T>::BasicVolume(BasicVolume&& other) noexcept
+    : width(other.width), height(other.height), depth(other.depth), channels(other.channels),
+      sourceChannels(other.sourceChannels), voxels(std::move(other.voxels)), slices(std::move(other.slices)),
+      brickMap(std::move(other.brickMap)), brickMapValid(other.brickMapValid.load()) {
+    other.brickMapValid = false;
+}
+
+template <typename T>
+BasicVolume<T>& BasicVolume<T>::operator=(BasicVolume&& other) noexcept {
+    width = other.width;
+    height = other.height;
+    depth = other.depth;
+    channels = other.channels;
+    sourceChannels = other.sourceChannels;
+    voxels = std::move(other.voxels);
+    slices = std::move(other.slices);
+    brickMap = std::move(other.brickMap);
+    brickMapValid = other.brickMapValid.load();
+    other.brickMapValid = false;
+    return *this;
+}
 
+template <typename T>
+std::vector<std::string> BasicVolume<T>::listSliceFiles(const std::string& directoryWithBasename) {
     // Extract directory and basename from the input path
     fs::path path(directoryWithBasename);
     std::string directory = path.parent_path().string();
@@ -79,7 +118,7 @@ bool Volume::load(const std::string& directoryWithBasename) {
     fs::path dirPath(directory);
     if (!fs::exists(dirPath) || !fs::is_directory(dirPath)) {
         std::cerr << "Directory does not exist: " << directory << std::endl;
-        return false;
+        return {};
     }
 
     // Define supported file extensions
@@ -101,95 +140,309 @@ bool Volume::load(const std::string& directoryWithBasename) {
         }
     }
 
-    if (files.empty()) {
-        std::cerr << "No image files matching basename '" << basename << "' found in directory: " << directory << std::endl;
-        return false;
-    }
-
     // Sort files by their numeric part
     std::sort(files.begin(), files.end(),
               [](const auto& a, const auto& b) { return a.first < b.first; });
 
+    std::vector<std::string> paths;
+    paths.reserve(files.size());
+    for (const auto& file : files) {
+        paths.push_back(directory + "/" + file.second);
+    }
+    return paths;
+}
+
+template <typename T>
+bool BasicVolume<T>::isGrey(const T* data, size_t pixels, int channels) {
+    if (channels == 1) return true;
+    if (channels < 1 || channels > 4) return false;
+    const int colour = channels >= 3 ? 3 : 1;
+    const bool alpha = channels == 2 || channels == 4;
+    const T opaque = static_cast<T>(PixelTraits<T>::maxValue);
+    for (size_t i = 0; i < pixels; ++i, data += channels) {
+        for (int c = 1; c < colour; ++c) {
+            if (data[c] != data[0]) return false;
+        }
+        if (alpha && data[channels - 1] != opaque) return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool BasicVolume<T>::loadSliceInto(const std::string& filename, T* dest, int width, int height, int fileChannels,
+                                   bool collapse, bool* grey) {
+    if (!collapse || fileChannels == 1) {
+        if (grey) *grey = fileChannels == 1;
+        return BasicImage<T>::loadInto(filename, dest, width, height, fileChannels);
+    }
+    // Decode the full slice into a per-thread buffer, then keep its first channel.
+    thread_local std::vector<T> scratch;
+    const size_t pixels = static_cast<size_t>(width) * height;
+    scratch.resize(pixels * fileChannels);
+    if (!BasicImage<T>::loadInto(filename, scratch.data(), width, height, fileChannels)) {
+        return false;
+    }
+    if (grey) *grey = isGrey(scratch.data(), pixels, fileChannels);
+    const T* src = scratch.data();
+    for (size_t i = 0; i < pixels; ++i, src += fileChannels) dest[i] = *src;
+    return true;
+}
+
+template <typename T>
+bool BasicVolume<T>::greySlices(const std::vector<std::string>& files, int width, int height, int channels) {
+    std::vector<char> grey(files.size(), 0);
+    parallelFor(0, static_cast<int>(files.size()), [&](int i) {
+        std::vector<T> probe(static_cast<size_t>(width) * height * channels);
+        grey[i] = BasicImage<T>::loadInto(files[i], probe.data(), width, height, channels) &&
+                  isGrey(probe.data(), static_cast<size_t>(width) * height, channels);
+    });
+    return !files.empty() && std::all_of(grey.begin(), grey.end(), [](char g) { return g != 0; });
+}
+
+template <typename T>
+bool BasicVolume<T>::load(const std::string& directoryWithBasename, ChannelMode mode) {
+    PROFILE_SCOPE_CAT("Volume::load", "io");
+    invalidateBrickMap();
+    slices.clear();
+    voxels.reset();
+    width = 0;
+    height = 0;
+    depth = 0;
+    channels = 0;
+    sourceChannels = 0;
+
+    fs::path path(directoryWithBasename);
+    std::string directory = path.parent_path().string();
+    if (directory.empty()) {
+        directory = ".";
+    }
+
+    std::vector<std::string> files = listSliceFiles(directoryWithBasename);
+    if (files.empty()) {
+        std::cerr << "No image files matching basename '" << path.filename().string()
+                  << "' found in directory: " << directory << std::endl;
+        return false;
+    }
+
     // Debug: Print the number of files found
     std::cout << "Found " << files.size() << " image files in directory: " << directory << "\n";
     for (const auto& file : files) {
-        std::cout << "File: " << file.second << " (number: " << file.first << ")\n";
+        std::cout << "File: " << fs::path(file).filename().string() << "\n";
     }
 
-    // Load all slices
-    int loadedCount = 0;
-    for (const auto& file : files) {
-        std::string filename = directory + "/" + file.second;
-        Image slice;
-        if (!slice.load(filename, 0)) {
-            std::cerr << "Failed to load slice: " << filename << std::endl;
-            continue; // Skip this slice, but keep loading others
+    // Size the voxel store from the first readable header.
+    size_t first = 0;
+    while (first < files.size() && !readImageInfo(files[first], width, height, channels)) {
+        std::cerr << "Failed to load slice: " << files[first] << std::endl;
+        ++first;
+    }
+    if (first == files.size()) {
+        std::cerr << "Failed to load any slices from directory: " << directory << std::endl;
+        return false;
+    }
+
+    // Decide whether multi-channel slices are stored as their first channel only.
+    const int count = static_cast<int>(files.size() - first);
+    bool collapse = channels > 1 && mode == ChannelMode::Collapse;
+    if (channels > 1 && mode == ChannelMode::Auto) {
+        const auto probeBegin = files.begin() + first;
+        collapse = greySlices(std::vector<std::string>(probeBegin, probeBegin + std::min(count, kGreyProbeSlices)),
+                              width, height, channels);
+    }
+    const int fileChannels = channels;
+
+    // Decode every slice straight into its place, several at once.
+    const size_t sliceSamples = static_cast<size_t>(width) * height * (collapse ? 1 : fileChannels);
+    voxels.reset(new T[sliceSamples * count]);
+    std::vector<char> loaded(count, 0);
+    std::vector<char> grey(count, 1);
+    parallelForDynamic(0, count, [&](int i) {
+        bool sliceGrey = true;
+        loaded[i] = loadSliceInto(files[first + i], voxels.get() + i * sliceSamples, width, height, fileChannels,
+                                  collapse, &sliceGrey);
+        grey[i] = sliceGrey;
+    });
+    if (collapse && mode == ChannelMode::Auto) {
+        for (int i = 0; i < count; ++i) {
+            if (loaded[i] && !grey[i]) {
+                std::cout << "Slice " << files[first + i] << " is not grey; loading every channel.\n";
+                return load(directoryWithBasename, ChannelMode::Keep);
+            }
         }
+    }
+    sourceChannels = fileChannels;
+    if (collapse) {
+        channels = 1;
+    }
 
-        if (loadedCount == 0) {
-            width = slice.getWidth();
-            height = slice.getHeight();
-            channels = slice.getChannels();
-        } else {
-            if (slice.getWidth() != width ||
-                slice.getHeight() != height ||
-                slice.getChannels() != channels) {
+    // Close up the gaps left by slices that failed or did not match.
+    int loadedCount = 0;
+    for (int i = 0; i < count; ++i) {
+        const std::string& filename = files[first + i];
+        if (!loaded[i]) {
+            int w = 0, h = 0, ch = 0;
+            if (readImageInfo(filename, w, h, ch) && (w != width || h != height || ch != sourceChannels)) {
                 std::cerr << "Slice file " << filename
                           << " does not match volume dimensions/channels. Skipping.\n";
-                continue;
+            } else {
+                std::cerr << "Failed to load slice: " << filename << std::endl;
             }
+            continue; // Skip this slice, but keep the others
         }
-
-        slices.push_back(std::move(slice));
+        if (loadedCount != i) {
+            std::memmove(voxels.get() + loadedCount * sliceSamples, voxels.get() + i * sliceSamples, sliceSamples * sizeof(T));
+        }
+        slices.push_back(BasicImage<T>::view(width, height, channels, voxels.get() + loadedCount * sliceSamples));
         loadedCount++;
     }
 
     depth = loadedCount;
     if (depth == 0) {
+        voxels.reset();
         std::cerr << "Failed to load any slices from directory: " << directory << std::endl;
         return false;
     }
 
     std::cout << "Loaded volume from directory '" << directory
               << "' with " << width << " x " << height
-              << " x " << depth << ", channels = " << channels << std::endl;
+              << " x " << depth << ", channels = " << channels;
+    if (channels != sourceChannels) {
+        std::cout << " (collapsed from " << sourceChannels << ")";
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+template <typename T>
+bool BasicVolume<T>::save(const std::string& directoryWithBasename, const std::string& extension, int pngLevel) const {
+    PROFILE_SCOPE_CAT("Volume::save", "io");
+    if (depth == 0) {
+        std::cerr << "[Error] No volume data to save.\n";
+        return false;
+    }
+
+    fs::path parent = fs::path(directoryWithBasename).parent_path();
+    if (!parent.empty() && !fs::exists(parent)) {
+        fs::create_directories(parent);
+    }
+
+    // Slices are encoded on background writers while the loop names and queues the next ones.
+    const int numDigits = std::max(3, static_cast<int>(std::to_string(depth - 1).size()));
+    AsyncImageWriter writer(std::min(depth, parallelThreadCount()));
+    for (int z = 0; z < depth; ++z) {
+        std::ostringstream name;
+        name << directoryWithBasename << std::setw(numDigits) << std::setfill('0') << z << "." << extension;
+        const BasicImage<T>& slice = slices[z];
+        writer.submit([&slice, file = name.str(), pngLevel]() { return slice.save(file, pngLevel); });
+    }
+    if (!writer.wait()) {
+        return false;
+    }
+    std::cout << "Saved " << depth << " slices as " << directoryWithBasename << "*." << extension << std::endl;
     return true;
 }
 
-int Volume::getWidth() const {
+template <typename T>
+int BasicVolume<T>::getWidth() const {
     return width;
 }
 
-int Volume::getHeight() const {
+template <typename T>
+int BasicVolume<T>::getHeight() const {
     return height;
 }
 
-int Volume::getDepth() const {
+template <typename T>
+int BasicVolume<T>::getDepth() const {
     return depth;
 }
 
-int Volume::getChannels() const {
+template <typename T>
+int BasicVolume<T>::getChannels() const {
     return channels;
 }
 
-std::vector<Image>& Volume::getSlices() {
+template <typename T>
+int BasicVolume<T>::getSourceChannels() const {
+    return sourceChannels;
+}
+
+template <typename T>
+std::vector<BasicImage<T>>& BasicVolume<T>::getSlices() {
+    invalidateBrickMap();
     return slices;
 }
 
-const std::vector<Image>& Volume::getSlices() const {
+template <typename T>
+const std::vector<BasicImage<T>>& BasicVolume<T>::getSlices() const {
     return slices;
 }
 
-unsigned char* Volume::getVoxel(int x, int y, int z) {
+template <typename T>
+T* BasicVolume<T>::getVoxelData() {
+    invalidateBrickMap();
+    return voxels.get();
+}
+
+template <typename T>
+const T* BasicVolume<T>::getVoxelData() const {
+    return voxels.get();
+}
+
+template <typename T>
+T* BasicVolume<T>::getVoxel(int x, int y, int z) {
+    invalidateBrickMap();
     if (z < 0 || z >= depth)   return nullptr;
     if (y < 0 || y >= height)  return nullptr;
     if (x < 0 || x >= width)   return nullptr;
     return slices[z].getPixel(x, y);
 }
 
-void Volume::setVoxel(int x, int y, int z, const unsigned char* pixel) {
+template <typename T>
+void BasicVolume<T>::setVoxel(int x, int y, int z, const T* pixel) {
+    invalidateBrickMap();
     if (z < 0 || z >= depth)   return;
     if (y < 0 || y >= height)  return;
     if (x < 0 || x >= width)   return;
     slices[z].setPixel(x, y, pixel);
-}
\ No newline at end of file
+}
+
+template <typename T>
+const BrickMap<T>* BasicVolume<T>::getBrickMap() const {
+    return brickMapValid.load(std::memory_order_acquire) ? &brickMap : nullptr;
+}
+
+template <typename T>
+const BrickMap<T>* BasicVolume<T>::ensureBrickMap() const {
+    if (brickMapValid.load(std::memory_order_acquire)) return &brickMap;
+    if (depth == 0) return nullptr;
+    std::lock_guard<std::mutex> lock(brickMapMutex);
+    if (!brickMapValid.load(std::memory_order_relaxed)) summarizeBricks();
+    return &brickMap;
+}
+
+template <typename T>
+void BasicVolume<T>::buildBrickMap() {
+    std::lock_guard<std::mutex> lock(brickMapMutex);
+    summarizeBricks();
+}
+
+template <typename T>
+void BasicVolume<T>::summarizeBricks() const {
+    PROFILE_SCOPE_CAT("Volume::buildBrickMap", "volume");
+    brickMap = BrickMap<T>(width, height, depth);
+    parallelFor(0, depth, [&](int z) {
+        brickMap.summarize(z, slices[z].getData(), channels);
+    });
+    brickMapValid.store(depth > 0, std::memory_order_release);
+}
+
+template <typename T>
+void BasicVolume<T>::setBrickMap(BrickMap<T>&& map) {
+    brickMap = std::move(map);
+    brickMapValid = brickMap.getDepth() == depth && depth > 0;
+}
+
+template class BasicVolume<unsigned char>;
+template class BasicVolume<std::uint16_t>;
+template class BasicVolume<float>;
@@ -1,40 +1,151 @@
 #ifndef VOLUME_H
 #define VOLUME_H
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
+#include "BrickMap.h"
 #include "Image.h"
 
 /**
- * @class Volume
- * @brief The Volume class is used to load and store 3D volume data (e.g., a series of sliced images).
+ * @brief How BasicVolume::load treats slice files with more than one channel.
+ */
+enum class ChannelMode {
+    Keep,     ///< Store every channel of the files.
+    Collapse, ///< Store only the first channel of every slice.
+    Auto      ///< Collapse if the first slices are grey (R = G = B, opaque alpha), else keep.
+};
+
+/**
+ * @class BasicVolume
+ * @brief The BasicVolume class is used to load and store 3D volume data (e.g., a series of sliced images).
  *
  * This class assumes the volume data is predominantly single-channel (greyscale) or RGB,
  * but multi-channel formats can also be supported. It provides methods for loading data,
  * accessing slices, and reading/writing voxel data directly.
+ * Voxels are stored as T: unsigned char (Volume), std::uint16_t (Volume16) or float (VolumeF).
+ * All slices live in one contiguous voxel store (slice-major, then row-major), and each
+ * element of getSlices() is a BasicImage view of its part of that store.
  */
-class Volume {
+template <typename T>
+class BasicVolume {
 public:
+    using value_type = T;           ///< Type of one channel sample.
+    using SliceType = BasicImage<T>; ///< Image type of one slice.
+
     /**
      * @brief Default constructor that initializes an empty Volume object.
      */
-    Volume();
+    BasicVolume();
+
+    /**
+     * @brief Creates a zero-filled volume with the given dimensions.
+     * @param width Width of each slice in pixels.
+     * @param height Height of each slice in pixels.
+     * @param depth Number of slices.
+     * @param channels Number of channels per voxel.
+     */
+    BasicVolume(int width, int height, int depth, int channels);
 
     /**
      * @brief Destructor to release allocated resources.
      */
-    ~Volume();
+    ~BasicVolume();
+
+    /**
+     * @brief Move constructor; the voxel store and its slice views are transferred without copying.
+     */
+    BasicVolume(BasicVolume&& other) noexcept;
+
+    /**
+     * @brief Move assignment operator; the voxel store and its slice views are transferred without copying.
+     */
+    BasicVolume& operator=(BasicVolume&& other) noexcept;
 
     /**
      * @brief Loads a 3D dataset from a specified directory.
      *
      * The implementation assumes that the slices are named sequentially (e.g., 001.png, 002.png, etc.).
      * The function continues loading until no more valid files are found.
+     * Slices are read with the sample type of the volume, so Volume16 keeps 16-bit PNG data.
+     * The voxel store is sized from the first slice's header and every slice is decoded
+     * straight into its place in it, several slices at a time.
+     *
+     * Greyscale scans are often stored as RGB or RGBA with R = G = B. With ChannelMode::Auto
+     * the first slices are checked, and if they are grey every slice is stored as its first
+     * channel only, so the volume and every kernel that reads it touch a third or a quarter of
+     * the bytes. If a later slice turns out to have colour, the volume is loaded again with
+     * all channels. getSourceChannels() reports the channel count of the files.
+     * No tile ranges are built here; see ensureBrickMap().
      *
      * @param directory Directory path containing the image slices.
+     * @param mode How multi-channel slices are stored (Keep by default).
      * @return Returns true if at least one slice is loaded successfully, otherwise false.
      */
-    bool load(const std::string& directory);
+    bool load(const std::string& directory, ChannelMode mode = ChannelMode::Keep);
+
+    /**
+     * @brief Decodes one slice file into `dest`, optionally keeping only its first channel.
+     *
+     * @param filename Path to the slice file.
+     * @param dest Destination for width * height * fileChannels samples, or width * height
+     *             when collapsing.
+     * @param width Expected width in pixels.
+     * @param height Expected height in pixels.
+     * @param fileChannels Expected channel count of the file.
+     * @param collapse Store only the first channel.
+     * @param grey If not null, set to whether the slice is grey (equal colour channels and
+     *             opaque alpha); only checked when collapsing.
+     * @return True if the file was decoded, false if it could not be read or has a different size.
+     */
+    static bool loadSliceInto(const std::string& filename, T* dest, int width, int height, int fileChannels,
+                              bool collapse, bool* grey = nullptr);
+
+    /**
+     * @brief Whether interleaved samples hold the same grey in every colour channel and
+     *        an opaque alpha (for 2 or 4 channels). Always true for 1 channel.
+     * @param data First sample.
+     * @param pixels Number of pixels.
+     * @param channels Samples per pixel.
+     * @return True if keeping only the first channel loses nothing.
+     */
+    static bool isGrey(const T* data, size_t pixels, int channels);
+
+    /**
+     * @brief Whether every file decodes as a grey slice (see isGrey).
+     * @param files Slice files, decoded several at once.
+     * @param width Expected width in pixels.
+     * @param height Expected height in pixels.
+     * @param channels Expected channel count of the files.
+     * @return True if there is at least one file and all of them are grey.
+     */
+    static bool greySlices(const std::vector<std::string>& files, int width, int height, int channels);
+
+    /**
+     * @brief Lists the slice files that load() would read, in slice order.
+     *
+     * Files match `<basename><digits>.<png|jpg|jpeg>` inside the directory part of the path
+     * and are sorted by their numeric part.
+     *
+     * @param directoryWithBasename Directory path followed by the slice basename (e.g. "Scans/TestVolume/vol").
+     * @return Full paths of the matching files, or an empty vector if none are found.
+     */
+    static std::vector<std::string> listSliceFiles(const std::string& directoryWithBasename);
+
+    /**
+     * @brief Saves every slice as a numbered image series that load() can read back.
+     *
+     * Slice z is written to `<directoryWithBasename><z>.<extension>`, with z zero-padded
+     * to at least three digits. Slices are encoded concurrently by an AsyncImageWriter.
+     *
+     * @param directoryWithBasename Directory path followed by the slice basename.
+     * @param extension File extension without the dot (png, jpg, bmp or tga).
+     * @param pngLevel Deflate level 0-9 for PNG slices, or -1 for the default.
+     * @return True if every slice was written, otherwise false.
+     */
+    bool save(const std::string& directoryWithBasename, const std::string& extension = "png", int pngLevel = -1) const;
 
     /**
      * @brief Gets the width (in pixels) of each slice in the volume.
@@ -60,17 +171,42 @@ public:
      */
     int getChannels() const;
 
+    /**
+     * @brief Gets the number of channels of the slice files the volume was loaded from.
+     *
+     * Larger than getChannels() when load() collapsed grey slices to one channel.
+     *
+     * @return The file channel count.
+     */
+    int getSourceChannels() const;
+
     /**
      * @brief Provides a reference to the internal slices for direct access.
      * @return A reference to the internal vector of Image slices.
      */
-    std::vector<Image>& getSlices();
+    std::vector<BasicImage<T>>& getSlices();
 
     /**
      * @brief Provides a constant reference to the internal slices for read-only access.
      * @return A constant reference to the internal vector of Image slices.
      */
-    const std::vector<Image>& getSlices() const;
+    const std::vector<BasicImage<T>>& getSlices() const;
+
+    /**
+     * @brief Gets the contiguous voxel store.
+     *
+     * Slice z starts at z * width * height * channels. Slices stay views of the store
+     * unless one is reloaded or given new data through getSlices(), which detaches it.
+     *
+     * @return Pointer to the first voxel, or nullptr for an empty volume.
+     */
+    T* getVoxelData();
+
+    /**
+     * @brief Gets the contiguous voxel store for read-only access.
+     * @return Pointer to the first voxel, or nullptr for an empty volume.
+     */
+    const T* getVoxelData() const;
 
     /**
      * @brief Retrieves a pointer to a voxel at the specified (x, y, z) coordinates.
@@ -85,7 +221,7 @@ public:
      * @param z Z-coordinate of the voxel (slice index).
      * @return Pointer to the voxel data or nullptr if out of bounds.
      */
-    unsigned char* getVoxel(int x, int y, int z);
+    T* getVoxel(int x, int y, int z);
 
     /**
      * @brief Sets the voxel value at the specified (x, y, z) coordinates.
@@ -97,14 +233,70 @@ public:
      * @param z Z-coordinate of the voxel.
      * @param pixel Pointer to the pixel data to set.
      */
-    void setVoxel(int x, int y, int z, const unsigned char* pixel);
+    void setVoxel(int x, int y, int z, const T* pixel);
+
+    /**
+     * @brief Gets the per-tile min/max ranges, if ensureBrickMap(), buildBrickMap() or setBrickMap() made them.
+     *
+     * The ranges are dropped as soon as a non-const accessor (getSlices, getVoxelData,
+     * getVoxel or setVoxel) is called, since the voxels may then change, and kernels go back
+     * to reading every voxel. Pointers obtained before the ranges were built must not be
+     * written through afterwards.
+     *
+     * @return The ranges, or nullptr if there are none.
+     */
+    const BrickMap<T>* getBrickMap() const;
+
+    /**
+     * @brief Gets the per-tile ranges, building them from the current voxels if there are none.
+     *
+     * Projections and thresholds call this, so only volumes that are projected or thresholded
+     * pay for the ranges, and a volume projected many times (e.g. one held by the server's
+     * cache) builds them once. Safe to call from several threads at once.
+     *
+     * @return The ranges, or nullptr for an empty volume.
+     */
+    const BrickMap<T>* ensureBrickMap() const;
+
+    /**
+     * @brief Builds the per-tile ranges from the current voxels, several slices at once.
+     */
+    void buildBrickMap();
+
+    /**
+     * @brief Installs ranges computed by a kernel that knows what it wrote (e.g. a threshold).
+     *
+     * Call after the voxels have been written, since writing drops the ranges.
+     *
+     * @param map Ranges matching the current voxels and the size of the volume.
+     */
+    void setBrickMap(BrickMap<T>&& map);
 
 private:
+    // Drops the tile ranges; called by every accessor that can write voxels.
+    void invalidateBrickMap() { brickMapValid.store(false, std::memory_order_relaxed); }
+
+    // Recomputes `brickMap` from the voxels and marks it valid.
+    void summarizeBricks() const;
+
     int width;                  ///< Width of each slice.
     int height;                 ///< Height of each slice.
     int depth;                  ///< Number of slices (depth of the volume).
     int channels;               ///< Number of channels per pixel.
-    std::vector<Image> slices;  ///< Stores all slices as Image objects.
+    int sourceChannels;         ///< Channels of the slice files (see getSourceChannels).
+    std::unique_ptr<T[]> voxels;       ///< Contiguous store of all slices.
+    std::vector<BasicImage<T>> slices; ///< Views of each slice in `voxels`.
+    mutable BrickMap<T> brickMap;      ///< Per-tile ranges (see getBrickMap), built on first use.
+    mutable std::atomic<bool> brickMapValid{ false }; ///< Whether `brickMap` matches the voxels.
+    mutable std::mutex brickMapMutex;  ///< Serialises ensureBrickMap() builds.
 };
 
+using Volume = BasicVolume<unsigned char>;   ///< 8 bits per voxel channel.
+using Volume16 = BasicVolume<std::uint16_t>; ///< 16 bits per voxel channel (e.g. CT scans).
+using VolumeF = BasicVolume<float>;          ///< Float voxels in [0, 1].
+
+extern template class BasicVolume<unsigned char>;
+extern template class BasicVolume<std::uint16_t>;
+extern template class BasicVolume<float>;
+
 #endif // VOLUME_H
\ No newline at end of file
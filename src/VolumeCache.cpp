@@ -0,0 +1,85 @@
+/*
+ * Group Name: Dijkstra
+ * Members:
+ *   - Antonio Nikoloski (GitHub: esemsc-an1224)
+ *   - Tyana Tshiota (GitHub: esemsc-tnt24)
+ *   - Yue Zigi (GitHub: esemsc-zy424)
+ *   - Yang Aijia (GitHub: esemsc-ay424)
+ *   - Zhou Xiaorui (GitHub: esemsc-zx24)
+ *   - Zhang Zewei (GitHub: esemsc-zz724)
+ *   - Azam Sazina (GitHub: esemsc-as1224)
+ */
+
+/*
+ * This file implements VolumeCache, the LRU store of decoded volumes used by the server.
+ * Entries live in a list ordered by last use with a hash map from key to list position, so
+ * lookups, promotions and evictions are all O(1).
+ */
+#include "VolumeCache.h"
+#include <iostream>
+#include <type_traits>
+
+VolumeCache::VolumeCache(size_t capacityBytes) {
+    stats_.capacity = capacityBytes;
+}
+
+std::shared_ptr<const Volume> VolumeCache::getVolume(const std::string& path) {
+    return get<unsigned char>(path);
+}
+
+std::shared_ptr<const Volume16> VolumeCache::getVolume16(const std::string& path) {
+    return get<std::uint16_t>(path);
+}
+
+VolumeCache::Stats VolumeCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+template <typename T>
+std::shared_ptr<const BasicVolume<T>> VolumeCache::get(const std::string& path) {
+    const std::string key = std::to_string(sizeof(T) * 8) + ":" + path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            ++stats_.hits;
+            return std::static_pointer_cast<const BasicVolume<T>>(it->second->volume);
+        }
+    }
+
+    auto volume = std::make_shared<BasicVolume<T>>();
+    if (!volume->load(path, ChannelMode::Auto)) {
+        return nullptr;
+    }
+    const size_t bytes = static_cast<size_t>(volume->getWidth()) * volume->getHeight() *
+                         volume->getDepth() * volume->getChannels() * sizeof(T);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.misses;
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // Another request loaded the same volume meanwhile; keep theirs.
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return std::static_pointer_cast<const BasicVolume<T>>(it->second->volume);
+    }
+    insertLocked(Entry{ key, volume, bytes });
+    return volume;
+}
+
+void VolumeCache::insertLocked(Entry entry) {
+    stats_.bytes += entry.bytes;
+    lru_.push_front(std::move(entry));
+    index_[lru_.front().key] = lru_.begin();
+
+    while (stats_.bytes > stats_.capacity && lru_.size() > 1) {
+        const Entry& victim = lru_.back();
+        std::cout << "[Cache] Evicting " << victim.key << " (" << victim.bytes / (1024 * 1024) << " MB)\n";
+        stats_.bytes -= victim.bytes;
+        index_.erase(victim.key);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+    stats_.entries = lru_.size();
+}
@@ -0,0 +1,77 @@
+#ifndef VOLUME_CACHE_H
+#define VOLUME_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Volume.h"
+
+/**
+ * @class VolumeCache
+ * @brief Keeps decoded volumes in memory, keyed by their `-d` path, with LRU eviction.
+ *
+ * Volumes are handed out as shared pointers to const, so a volume evicted while a request
+ * still uses it stays alive until that request finishes. 8-bit and 16-bit loads of the same
+ * path are separate entries. Misses load outside the lock, so a slow load does not block
+ * requests for volumes that are already cached. Volumes are loaded with ChannelMode::Auto,
+ * so grey slices stored as RGB or RGBA take one channel in the cache. Thread-safe.
+ */
+class VolumeCache {
+public:
+    /**
+     * @brief Hit, miss and size counters.
+     */
+    struct Stats {
+        size_t hits = 0;       ///< Requests served from memory.
+        size_t misses = 0;     ///< Requests that loaded from disk.
+        size_t evictions = 0;  ///< Entries dropped to stay under the capacity.
+        size_t entries = 0;    ///< Volumes currently cached.
+        size_t bytes = 0;      ///< Voxel bytes currently cached.
+        size_t capacity = 0;   ///< Byte budget.
+    };
+
+    /**
+     * @param capacityBytes Byte budget for cached voxel data. The most recent volume is
+     *                      always kept, even if it alone exceeds the budget.
+     */
+    explicit VolumeCache(size_t capacityBytes);
+
+    /**
+     * @brief Returns the 8-bit volume at `path`, loading it on a miss.
+     * @return The volume, or null if it could not be loaded.
+     */
+    std::shared_ptr<const Volume> getVolume(const std::string& path);
+
+    /**
+     * @brief Returns the 16-bit volume at `path`, loading it on a miss.
+     * @return The volume, or null if it could not be loaded.
+     */
+    std::shared_ptr<const Volume16> getVolume16(const std::string& path);
+
+    /**
+     * @brief Current counters.
+     */
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const void> volume;
+        size_t bytes;
+    };
+
+    template <typename T>
+    std::shared_ptr<const BasicVolume<T>> get(const std::string& path);
+
+    void insertLocked(Entry entry);
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    Stats stats_;
+};
+
+#endif // VOLUME_CACHE_H
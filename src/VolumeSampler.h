@@ -0,0 +1,146 @@
+#ifndef VOLUME_SAMPLER_H
+#define VOLUME_SAMPLER_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Volume.h"
+
+/**
+ * @brief Minimal 3D vector used for rays and reslicing planes (voxel units).
+ */
+struct Vec3 {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    Vec3 operator+(const Vec3& o) const { return { x + o.x, y + o.y, z + o.z }; }
+    Vec3 operator-(const Vec3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+    Vec3 operator*(float s) const { return { x * s, y * s, z * s }; }
+
+    float dot(const Vec3& o) const { return x * o.x + y * o.y + z * o.z; }
+    Vec3 cross(const Vec3& o) const { return { y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x }; }
+    float length() const { return std::sqrt(dot(*this)); }
+    Vec3 normalized() const {
+        float len = length();
+        return len > 0.0f ? *this * (1.0f / len) : *this;
+    }
+};
+
+/**
+ * @brief Interpolation used when sampling a volume at non-integer coordinates.
+ */
+enum class Interpolation {
+    Nearest,  ///< Value of the closest voxel.
+    Trilinear ///< Weighted average of the 8 surrounding voxels.
+};
+
+/**
+ * @class VolumeSampler
+ * @brief Fast read-only sampling of a Volume at arbitrary (x, y, z) positions.
+ *
+ * Slice pointers are cached once, so each sample is a handful of loads with no
+ * bounds-checked getVoxel() calls. Coordinates are in voxels: (0,0,0) is the centre of
+ * the first voxel and (w-1, h-1, d-1) the centre of the last one.
+ */
+class VolumeSampler {
+public:
+    /**
+     * @brief Caches the slice pointers of a volume. The volume must outlive the sampler.
+     * @param vol The volume to sample.
+     */
+    explicit VolumeSampler(const Volume& vol)
+        : w_(vol.getWidth()), h_(vol.getHeight()), d_(vol.getDepth()), ch_(vol.getChannels())
+    {
+        slices_.reserve(d_);
+        for (const auto& slice : vol.getSlices()) {
+            slices_.push_back(slice.getData());
+        }
+    }
+
+    int getWidth() const { return w_; }
+    int getHeight() const { return h_; }
+    int getDepth() const { return d_; }
+    int getChannels() const { return ch_; }
+
+    /**
+     * @brief Checks whether a position lies inside the sampled box [0, w-1] x [0, h-1] x [0, d-1].
+     */
+    bool inside(float x, float y, float z) const {
+        return x >= 0.0f && y >= 0.0f && z >= 0.0f &&
+               x <= w_ - 1 && y <= h_ - 1 && z <= d_ - 1;
+    }
+
+    /**
+     * @brief Samples every channel at a position, writing getChannels() floats to `out`.
+     *
+     * Positions outside the volume are clamped to the border voxels.
+     */
+    void sample(float x, float y, float z, Interpolation mode, float* out) const {
+        if (mode == Interpolation::Nearest) {
+            nearest(x, y, z, out);
+        } else {
+            trilinear(x, y, z, out);
+        }
+    }
+
+    /**
+     * @brief Nearest-neighbour sample of every channel (clamped to the volume).
+     */
+    void nearest(float x, float y, float z, float* out) const {
+        const int xi = std::clamp(static_cast<int>(std::lround(x)), 0, w_ - 1);
+        const int yi = std::clamp(static_cast<int>(std::lround(y)), 0, h_ - 1);
+        const int zi = std::clamp(static_cast<int>(std::lround(z)), 0, d_ - 1);
+        const unsigned char* p = slices_[zi] + (static_cast<size_t>(yi) * w_ + xi) * ch_;
+        for (int c = 0; c < ch_; ++c) out[c] = p[c];
+    }
+
+    /**
+     * @brief Trilinear sample of every channel (clamped to the volume).
+     */
+    void trilinear(float x, float y, float z, float* out) const {
+        x = std::clamp(x, 0.0f, static_cast<float>(w_ - 1));
+        y = std::clamp(y, 0.0f, static_cast<float>(h_ - 1));
+        z = std::clamp(z, 0.0f, static_cast<float>(d_ - 1));
+        const int x0 = static_cast<int>(x);
+        const int y0 = static_cast<int>(y);
+        const int z0 = static_cast<int>(z);
+        const int x1 = std::min(x0 + 1, w_ - 1);
+        const int y1 = std::min(y0 + 1, h_ - 1);
+        const int z1 = std::min(z0 + 1, d_ - 1);
+        const float fx = x - x0;
+        const float fy = y - y0;
+        const float fz = z - z0;
+
+        const size_t row0 = static_cast<size_t>(y0) * w_;
+        const size_t row1 = static_cast<size_t>(y1) * w_;
+        const unsigned char* s0 = slices_[z0];
+        const unsigned char* s1 = slices_[z1];
+        const unsigned char* p000 = s0 + (row0 + x0) * ch_;
+        const unsigned char* p100 = s0 + (row0 + x1) * ch_;
+        const unsigned char* p010 = s0 + (row1 + x0) * ch_;
+        const unsigned char* p110 = s0 + (row1 + x1) * ch_;
+        const unsigned char* p001 = s1 + (row0 + x0) * ch_;
+        const unsigned char* p101 = s1 + (row0 + x1) * ch_;
+        const unsigned char* p011 = s1 + (row1 + x0) * ch_;
+        const unsigned char* p111 = s1 + (row1 + x1) * ch_;
+        for (int c = 0; c < ch_; ++c) {
+            const float c00 = p000[c] + (p100[c] - p000[c]) * fx;
+            const float c10 = p010[c] + (p110[c] - p010[c]) * fx;
+            const float c01 = p001[c] + (p101[c] - p001[c]) * fx;
+            const float c11 = p011[c] + (p111[c] - p011[c]) * fx;
+            const float c0 = c00 + (c10 - c00) * fy;
+            const float c1 = c01 + (c11 - c01) * fy;
+            out[c] = c0 + (c1 - c0) * fz;
+        }
+    }
+
+private:
+    int w_;
+    int h_;
+    int d_;
+    int ch_;
+    std::vector<const unsigned char*> slices_;
+};
+
+#endif // VOLUME_SAMPLER_H